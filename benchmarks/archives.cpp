@@ -0,0 +1,64 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+using namespace nbl;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+void openArchive(benchmark::State& state)
+{
+	auto& environment = SEnvironment::get();
+	const auto path = environment.inputDirectory/"files.tar";
+	for (auto _ : state)
+	{
+		auto archive = environment.system->openFileArchive(path);
+		if (!archive)
+		{
+			state.SkipWithError("Failed to open the archive");
+			break;
+		}
+		benchmark::DoNotOptimize(archive);
+	}
+}
+
+void readArchiveFiles(benchmark::State& state)
+{
+	auto& environment = SEnvironment::get();
+	auto archive = environment.system->openFileArchive(environment.inputDirectory/"files.tar");
+	if (!archive)
+	{
+		state.SkipWithError("Failed to open the archive");
+		return;
+	}
+
+	core::vector<uint8_t> contents;
+	int64_t bytesRead = 0;
+	for (auto _ : state)
+	{
+		bytesRead = 0;
+		for (const auto& entry : system::IFileArchive::SFileList::span_t(archive->listAssets()))
+		{
+			auto file = archive->getFile(entry.pathRelativeToArchive,system::IFileBase::ECF_READ,"");
+			if (!file)
+			{
+				state.SkipWithError("Failed to open a file in the archive");
+				return;
+			}
+			contents.resize(file->getSize());
+			system::IFile::success_t success;
+			file->read(success,contents.data(),0u,contents.size());
+			bytesRead += success.getBytesProcessed();
+		}
+		benchmark::DoNotOptimize(contents.data());
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*bytesRead);
+}
+
+}
+
+BENCHMARK(openArchive)->Unit(benchmark::kMicrosecond);
+BENCHMARK(readArchiveFiles)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,278 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+#include <cfloat>
+#include <fstream>
+#include <random>
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace nbl::benchmarks
+{
+
+namespace
+{
+
+core::smart_refctd_ptr<system::ISystem> createSystem()
+{
+#ifdef _NBL_PLATFORM_LINUX_
+	return core::make_smart_refctd_ptr<system::CSystemLinux>();
+#else
+	return system::IApplicationFramework::createSystem();
+#endif
+}
+
+template<typename T>
+void writeRaw(std::ofstream& stream, const T& value)
+{
+	stream.write(reinterpret_cast<const char*>(&value),sizeof(T));
+}
+
+void writeOBJ(const system::path& path, const SSyntheticMesh& mesh)
+{
+	std::ofstream stream(path,std::ios::binary);
+	for (size_t i=0u; i<mesh.positions.size(); i+=3u)
+		stream << "v " << mesh.positions[i] << ' ' << mesh.positions[i+1u] << ' ' << mesh.positions[i+2u] << '\n';
+	for (size_t i=0u; i<mesh.indices.size(); i+=3u)
+		stream << "f " << mesh.indices[i]+1u << ' ' << mesh.indices[i+1u]+1u << ' ' << mesh.indices[i+2u]+1u << '\n';
+}
+
+void writePLY(const system::path& path, const SSyntheticMesh& mesh)
+{
+	std::ofstream stream(path,std::ios::binary);
+	stream << "ply\nformat binary_little_endian 1.0\n";
+	stream << "element vertex " << mesh.positions.size()/3u << "\nproperty float x\nproperty float y\nproperty float z\n";
+	stream << "element face " << mesh.indices.size()/3u << "\nproperty list uchar int vertex_indices\nend_header\n";
+	stream.write(reinterpret_cast<const char*>(mesh.positions.data()),mesh.positions.size()*sizeof(float));
+	for (size_t i=0u; i<mesh.indices.size(); i+=3u)
+	{
+		writeRaw<uint8_t>(stream,3u);
+		stream.write(reinterpret_cast<const char*>(mesh.indices.data()+i),3u*sizeof(uint32_t));
+	}
+}
+
+void writeSTL(const system::path& path, const SSyntheticMesh& mesh)
+{
+	std::ofstream stream(path,std::ios::binary);
+	const char header[80] = "Nabla benchmark grid";
+	stream.write(header,sizeof(header));
+	writeRaw<uint32_t>(stream,static_cast<uint32_t>(mesh.indices.size()/3u));
+	for (size_t i=0u; i<mesh.indices.size(); i+=3u)
+	{
+		core::vectorSIMDf v[3];
+		for (auto j=0u; j<3u; j++)
+		{
+			const float* position = mesh.positions.data()+mesh.indices[i+j]*3u;
+			v[j] = core::vectorSIMDf(position[0],position[1],position[2]);
+		}
+		const auto normal = core::normalize(core::cross(v[1]-v[0],v[2]-v[0]));
+		stream.write(reinterpret_cast<const char*>(normal.pointer),3u*sizeof(float));
+		for (auto j=0u; j<3u; j++)
+			stream.write(reinterpret_cast<const char*>(v[j].pointer),3u*sizeof(float));
+		writeRaw<uint16_t>(stream,0u);
+	}
+}
+
+void writeGLTF(const system::path& path, const SSyntheticMesh& mesh)
+{
+	auto binPath = path;
+	binPath.replace_extension(".bin");
+	const size_t positionBytes = mesh.positions.size()*sizeof(float);
+	const size_t indexBytes = mesh.indices.size()*sizeof(uint32_t);
+	{
+		std::ofstream stream(binPath,std::ios::binary);
+		stream.write(reinterpret_cast<const char*>(mesh.positions.data()),positionBytes);
+		stream.write(reinterpret_cast<const char*>(mesh.indices.data()),indexBytes);
+	}
+
+	float minPos[3] = {FLT_MAX,FLT_MAX,FLT_MAX};
+	float maxPos[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
+	for (size_t i=0u; i<mesh.positions.size(); i++)
+	{
+		minPos[i%3u] = core::min(minPos[i%3u],mesh.positions[i]);
+		maxPos[i%3u] = core::max(maxPos[i%3u],mesh.positions[i]);
+	}
+
+	std::ofstream stream(path,std::ios::binary);
+	stream << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],";
+	stream << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}],";
+	stream << "\"buffers\":[{\"uri\":\"" << binPath.filename().string() << "\",\"byteLength\":" << positionBytes+indexBytes << "}],";
+	stream << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << positionBytes << ",\"target\":34962},";
+	stream << "{\"buffer\":0,\"byteOffset\":" << positionBytes << ",\"byteLength\":" << indexBytes << ",\"target\":34963}],";
+	stream << "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" << mesh.positions.size()/3u << ",\"type\":\"VEC3\",";
+	stream << "\"min\":[" << minPos[0] << ',' << minPos[1] << ',' << minPos[2] << "],\"max\":[" << maxPos[0] << ',' << maxPos[1] << ',' << maxPos[2] << "]},";
+	stream << "{\"bufferView\":1,\"componentType\":5125,\"count\":" << mesh.indices.size() << ",\"type\":\"SCALAR\"}]}";
+}
+
+//! Minimal ustar writer, every file is 64 KiB of noise
+void writeTar(const system::path& path, const uint32_t fileCount, const uint32_t fileSize)
+{
+	std::ofstream stream(path,std::ios::binary);
+	std::mt19937 rng(Seed);
+	core::vector<char> contents(fileSize);
+	for (uint32_t i=0u; i<fileCount; i++)
+	{
+		char header[512] = {};
+		snprintf(header,100,"file%04u.bin",i);
+		snprintf(header+100,8,"%07o",0644u);
+		snprintf(header+108,8,"%07o",0u);
+		snprintf(header+116,8,"%07o",0u);
+		snprintf(header+124,12,"%011o",fileSize);
+		snprintf(header+136,12,"%011o",0u);
+		header[156] = '0';
+		memcpy(header+257,"ustar",6);
+		memcpy(header+263,"00",2);
+		// checksum is computed with the checksum field filled with spaces
+		memset(header+148,' ',8);
+		uint32_t checksum = 0u;
+		for (auto c : header)
+			checksum += static_cast<uint8_t>(c);
+		snprintf(header+148,8,"%06o",checksum);
+		stream.write(header,sizeof(header));
+
+		for (auto& c : contents)
+			c = static_cast<char>(rng());
+		stream.write(contents.data(),contents.size());
+		const char padding[512] = {};
+		stream.write(padding,core::roundUp(fileSize,512u)-fileSize);
+	}
+	const char end[1024] = {};
+	stream.write(end,sizeof(end));
+}
+
+bool writeImage(IAssetManager* assetManager, const system::path& path, core::smart_refctd_ptr<ICPUImage>&& image, const E_WRITER_FLAGS flags=EWF_NONE)
+{
+	auto view = createImageView(std::move(image));
+	IAssetWriter::SAssetWriteParams params(view.get(),flags);
+	return assetManager->writeAsset(path.string(),params,nullptr);
+}
+
+}
+
+SEnvironment& SEnvironment::get()
+{
+	static SEnvironment environment = []() -> SEnvironment
+	{
+		SEnvironment retval;
+		retval.system = createSystem();
+		retval.assetManager = core::make_smart_refctd_ptr<IAssetManager>(core::smart_refctd_ptr(retval.system));
+		retval.inputDirectory = std::filesystem::temp_directory_path()/"nbl_benchmarks";
+		std::filesystem::create_directories(retval.inputDirectory);
+
+		const auto mesh = createSyntheticMesh(512u);
+		writeOBJ(retval.inputDirectory/"grid.obj",mesh);
+		writePLY(retval.inputDirectory/"grid.ply",mesh);
+		writeSTL(retval.inputDirectory/"grid.stl",mesh);
+		writeGLTF(retval.inputDirectory/"grid.gltf",mesh);
+
+		auto* const am = retval.assetManager.get();
+		writeImage(am,retval.inputDirectory/"gradient.png",createSyntheticImage(EF_R8G8B8A8_SRGB,2048u,2048u));
+		writeImage(am,retval.inputDirectory/"gradient.jpg",createSyntheticImage(EF_R8G8B8_SRGB,2048u,2048u));
+		writeImage(am,retval.inputDirectory/"gradient.exr",createSyntheticImage(EF_R16G16B16A16_SFLOAT,2048u,2048u));
+		writeImage(am,retval.inputDirectory/"gradient.tga",createSyntheticImage(EF_R8G8B8A8_SRGB,2048u,2048u));
+		writeImage(am,retval.inputDirectory/"gradient_rle.tga",createSyntheticImage(EF_R8G8B8A8_SRGB,2048u,2048u),EWF_COMPRESSED);
+
+		writeTar(retval.inputDirectory/"files.tar",256u,64u<<10u);
+		return retval;
+	}();
+	return environment;
+}
+
+core::smart_refctd_ptr<ICPUImage> createSyntheticImage(const E_FORMAT format, const uint32_t width, const uint32_t height, const uint32_t mipLevels)
+{
+	ICPUImage::SCreationParams params = {};
+	params.type = IImage::ET_2D;
+	params.samples = ICPUImage::ESCF_1_BIT;
+	params.format = format;
+	params.extent = {width,height,1u};
+	params.mipLevels = mipLevels;
+	params.arrayLayers = 1u;
+	params.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	params.usage = IImage::EUF_SAMPLED_BIT;
+	auto image = ICPUImage::create(std::move(params));
+
+	const uint32_t texelSize = getTexelOrBlockBytesize(format);
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(mipLevels);
+	size_t bufferSize = 0ull;
+	for (uint32_t i=0u; i<mipLevels; i++)
+	{
+		const auto mipSize = image->getMipSize(i);
+		auto& region = regions->operator[](i);
+		region.bufferOffset = bufferSize;
+		region.bufferRowLength = mipSize.x;
+		region.bufferImageHeight = mipSize.y;
+		region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = 1u;
+		region.imageOffset = {0u,0u,0u};
+		region.imageExtent = {mipSize.x,mipSize.y,1u};
+		bufferSize += size_t(mipSize.x)*mipSize.y*texelSize;
+	}
+	auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(bufferSize);
+
+	// only the first level gets content, the rest is for the mip generation benchmarks to fill
+	std::mt19937 rng(Seed);
+	std::uniform_real_distribution<double> noise(-0.05,0.05);
+	auto* const texels = reinterpret_cast<uint8_t*>(buffer->getPointer());
+	for (uint32_t y=0u; y<height; y++)
+	for (uint32_t x=0u; x<width; x++)
+	{
+		const double u = double(x)/double(width);
+		const double v = double(y)/double(height);
+		double color[4] = {
+			core::clamp(u+noise(rng),0.0,1.0),
+			core::clamp(v+noise(rng),0.0,1.0),
+			core::clamp(0.5+0.5*std::sin(u*v*64.0)+noise(rng),0.0,1.0),
+			1.0
+		};
+		encodePixelsRuntime(format,texels+(size_t(y)*width+x)*texelSize,color);
+	}
+
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+core::smart_refctd_ptr<ICPUImageView> createImageView(core::smart_refctd_ptr<ICPUImage>&& image)
+{
+	ICPUImageView::SCreationParams params = {};
+	params.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+	params.format = image->getCreationParameters().format;
+	params.viewType = ICPUImageView::ET_2D;
+	params.subresourceRange.aspectMask = IImage::EAF_COLOR_BIT;
+	params.subresourceRange.baseMipLevel = 0u;
+	params.subresourceRange.levelCount = image->getCreationParameters().mipLevels;
+	params.subresourceRange.baseArrayLayer = 0u;
+	params.subresourceRange.layerCount = 1u;
+	params.image = std::move(image);
+	return ICPUImageView::create(std::move(params));
+}
+
+SSyntheticMesh createSyntheticMesh(const uint32_t resolution)
+{
+	SSyntheticMesh mesh;
+	mesh.positions.reserve(size_t(resolution)*resolution*3u);
+	for (uint32_t y=0u; y<resolution; y++)
+	for (uint32_t x=0u; x<resolution; x++)
+	{
+		const float u = float(x)/float(resolution-1u);
+		const float v = float(y)/float(resolution-1u);
+		mesh.positions.push_back(u);
+		mesh.positions.push_back(0.1f*std::sin(u*31.f)*std::cos(v*17.f));
+		mesh.positions.push_back(v);
+	}
+	mesh.indices.reserve(size_t(resolution-1u)*(resolution-1u)*6u);
+	for (uint32_t y=0u; y+1u<resolution; y++)
+	for (uint32_t x=0u; x+1u<resolution; x++)
+	{
+		const uint32_t i = y*resolution+x;
+		for (const auto offset : {0u,resolution,1u,1u,resolution,resolution+1u})
+			mesh.indices.push_back(i+offset);
+	}
+	return mesh;
+}
+
+}
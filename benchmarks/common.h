@@ -0,0 +1,42 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_BENCHMARKS_COMMON_H_INCLUDED_
+#define _NBL_BENCHMARKS_COMMON_H_INCLUDED_
+
+#include "nabla.h"
+
+#include <benchmark/benchmark.h>
+
+namespace nbl::benchmarks
+{
+
+//! Everything shared by the benchmarks, created on first use.
+/** The synthetic inputs are generated from a fixed seed into a scratch directory, so two runs of the same commit
+(or two different commits) always measure the very same bytes. */
+struct SEnvironment
+{
+	core::smart_refctd_ptr<system::ISystem> system;
+	core::smart_refctd_ptr<asset::IAssetManager> assetManager;
+	system::path inputDirectory;
+
+	static SEnvironment& get();
+};
+
+constexpr uint32_t Seed = 0x45u;
+
+//! Single mip, single layer 2D image filled with smooth gradients plus noise, so that compressors don't collapse it to nothing.
+core::smart_refctd_ptr<asset::ICPUImage> createSyntheticImage(const asset::E_FORMAT format, const uint32_t width, const uint32_t height, const uint32_t mipLevels=1u);
+core::smart_refctd_ptr<asset::ICPUImageView> createImageView(core::smart_refctd_ptr<asset::ICPUImage>&& image);
+
+//! `resolution` x `resolution` vertex heightfield grid, positions are tightly packed float3 and indices are triangle lists
+struct SSyntheticMesh
+{
+	core::vector<float> positions;
+	core::vector<uint32_t> indices;
+};
+SSyntheticMesh createSyntheticMesh(const uint32_t resolution);
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+"""
+Compares two Google Benchmark JSON outputs of `nbl_benchmarks` (e.g. from two commits) and reports regressions.
+
+    python compare.py baseline.json contender.json [--threshold 0.05]
+
+When the files contain repetition aggregates the medians are compared, otherwise the plain runs.
+Exits with 1 if any benchmark got slower by more than the threshold, so it can gate CI.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, "r") as file:
+        report = json.load(file)
+
+    plain = {}
+    medians = {}
+    for entry in report["benchmarks"]:
+        if "error_occurred" in entry and entry["error_occurred"]:
+            continue
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[entry["run_name"]] = entry
+        else:
+            plain[entry.get("run_name", entry["name"])] = entry
+    return medians if medians else plain
+
+
+def time_in_ns(entry):
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[entry.get("time_unit", "ns")]
+    return entry["real_time"] * scale
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two nbl_benchmarks JSON reports")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown counted as a regression (default 5%%)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    contender = load(args.contender)
+
+    regressions = 0
+    width = max([len("benchmark")] + [len(name) for name in baseline.keys() | contender.keys()])
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'contender':>12}  {'change':>8}")
+    for name in sorted(baseline.keys() | contender.keys()):
+        if name not in contender:
+            print(f"{name:<{width}}  {'':>12}  {'missing':>12}")
+            continue
+        if name not in baseline:
+            print(f"{name:<{width}}  {'new':>12}  {time_in_ns(contender[name]):>10.0f}ns")
+            continue
+
+        before = time_in_ns(baseline[name])
+        after = time_in_ns(contender[name])
+        change = (after - before) / before if before > 0.0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            marker = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            marker = "  improvement"
+        print(f"{name:<{width}}  {before:>10.0f}ns  {after:>10.0f}ns  {change:>+7.1%}{marker}")
+
+    if regressions:
+        print(f"\n{regressions} benchmark(s) regressed by more than {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
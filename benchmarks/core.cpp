@@ -0,0 +1,817 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+#include <mutex>
+#include <random>
+
+#include "nbl/core/algorithm/scan.h"
+#include "nbl/core/sampling/BxDFBatch.h"
+#include "nbl/core/sampling/Xoroshiro64Batch.h"
+#include "nbl/core/shapes/QuadraticBezierBatch.h"
+
+using namespace nbl;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+core::vector<uint32_t> createKeys(const size_t count)
+{
+	std::mt19937 rng(Seed);
+	core::vector<uint32_t> keys(count);
+	for (auto& key : keys)
+		key = rng();
+	return keys;
+}
+
+// allocation sizes follow a rough power law like a real streaming workload, and a random half gets freed every round
+template<class AddressAllocator>
+void churnAllocator(benchmark::State& state, AddressAllocator& allocator, const uint32_t maxAllocationSize)
+{
+	using size_type = typename AddressAllocator::size_type;
+	constexpr uint32_t AllocationCount = 4096u;
+
+	std::mt19937 rng(Seed);
+	core::vector<size_type> sizes(AllocationCount);
+	for (auto& size : sizes)
+		size = core::max<size_type>(maxAllocationSize>>(rng()%8u),1u);
+	core::vector<size_type> addresses(AllocationCount,AddressAllocator::invalid_address);
+
+	for (auto _ : state)
+	{
+		for (uint32_t i=0u; i<AllocationCount; i++)
+		if (addresses[i]==AddressAllocator::invalid_address)
+			addresses[i] = allocator.alloc_addr(sizes[i],16u);
+		for (uint32_t i=0u; i<AllocationCount; i++)
+		if (addresses[i]!=AddressAllocator::invalid_address && (rng()&0x1u))
+		{
+			allocator.free_addr(addresses[i],sizes[i]);
+			addresses[i] = AddressAllocator::invalid_address;
+		}
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*AllocationCount);
+}
+
+void generalPurposeAllocator(benchmark::State& state)
+{
+	using allocator_t = core::GeneralpurposeAddressAllocator<uint32_t>;
+	constexpr uint32_t BufferSize = 256u<<20u;
+	constexpr uint32_t MinBlockSize = 64u;
+	core::vector<uint8_t> reserved(allocator_t::reserved_size(16u,BufferSize,MinBlockSize));
+	allocator_t allocator(reserved.data(),0u,0u,16u,BufferSize,MinBlockSize);
+	churnAllocator(state,allocator,64u<<10u);
+}
+
+void poolAllocator(benchmark::State& state)
+{
+	using allocator_t = core::PoolAddressAllocator<uint32_t>;
+	constexpr uint32_t BlockSize = 256u;
+	constexpr uint32_t BufferSize = BlockSize*8192u;
+	core::vector<uint8_t> reserved(allocator_t::reserved_size(16u,BufferSize,BlockSize));
+	allocator_t allocator(reserved.data(),0u,0u,16u,BufferSize,BlockSize);
+	churnAllocator(state,allocator,BlockSize);
+}
+
+void vectorPushBack(benchmark::State& state)
+{
+	const auto count = state.range(0);
+	for (auto _ : state)
+	{
+		core::vector<uint64_t> container;
+		for (int64_t i=0; i<count; i++)
+			container.push_back(i);
+		benchmark::DoNotOptimize(container.data());
+	}
+	state.SetItemsProcessed(state.iterations()*count);
+}
+
+void unorderedMapInsertFind(benchmark::State& state)
+{
+	const auto keys = createKeys(state.range(0));
+	for (auto _ : state)
+	{
+		core::unordered_map<uint32_t,uint32_t> container;
+		for (const auto key : keys)
+			container.emplace(key,key);
+		uint32_t found = 0u;
+		for (const auto key : keys)
+			found += container.find(key)!=container.end();
+		benchmark::DoNotOptimize(found);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// keys follow a Zipf distribution (s=0.99) over a universe 64x larger than the caches, like asset or pipeline lookups do
+constexpr uint32_t CacheCapacity = 1u<<14u;
+constexpr uint32_t CacheLookupsPerIteration = 256u;
+
+const core::vector<uint32_t>& getZipfKeys()
+{
+	static const auto keys = []() -> core::vector<uint32_t>
+	{
+		constexpr uint32_t Universe = CacheCapacity*64u;
+		core::vector<double> cdf(Universe);
+		double sum = 0.0;
+		for (uint32_t i=0u; i<Universe; i++)
+			cdf[i] = sum += 1.0/std::pow(double(i+1u),0.99);
+		std::mt19937 rng(Seed);
+		std::uniform_real_distribution<double> dist(0.0,sum);
+		core::vector<uint32_t> retval(1u<<20u);
+		for (auto& key : retval)
+			key = std::lower_bound(cdf.begin(),cdf.end(),dist(rng))-cdf.begin();
+		return retval;
+	}();
+	return keys;
+}
+
+// every thread walks its own part of the key stream, misses insert the key
+template<typename Lookup>
+void zipfLookups(benchmark::State& state, Lookup&& lookup)
+{
+	const auto& keys = getZipfKeys();
+	size_t i = (keys.size()*state.thread_index())/state.threads();
+	int64_t hits = 0;
+	for (auto _ : state)
+	for (uint32_t j=0u; j<CacheLookupsPerIteration; j++)
+	{
+		hits += lookup(keys[i]);
+		if (++i==keys.size())
+			i = 0u;
+	}
+	const auto lookups = int64_t(state.iterations())*CacheLookupsPerIteration;
+	state.SetItemsProcessed(lookups);
+	state.counters["hitRate"] = benchmark::Counter(double(hits)/double(lookups),benchmark::Counter::kAvgThreads);
+}
+
+template<class Policy>
+void shardedCacheZipf(benchmark::State& state)
+{
+	static core::ConcurrentShardedCache<uint32_t,uint64_t,Policy> cache(CacheCapacity);
+	zipfLookups(state,[](const uint32_t key) -> bool
+		{
+			uint64_t value;
+			if (cache.get(key,value))
+				return true;
+			cache.insert(key,uint64_t(key));
+			return false;
+		}
+	);
+}
+
+// baseline, what sharing the existing cache between threads takes
+void lruCacheZipf(benchmark::State& state)
+{
+	static std::mutex lock;
+	static core::LRUCache<uint32_t,uint64_t> cache(CacheCapacity);
+	zipfLookups(state,[](const uint32_t key) -> bool
+		{
+			std::lock_guard guard(lock);
+			if (cache.get(key))
+				return true;
+			cache.insert(key,uint64_t(key));
+			return false;
+		}
+	);
+}
+
+void radixSort(benchmark::State& state)
+{
+	const auto keys = createKeys(state.range(0));
+	core::vector<uint32_t> input(keys.size()), scratch(keys.size());
+	for (auto _ : state)
+	{
+		std::copy(keys.begin(),keys.end(),input.begin());
+		auto sorted = core::radix_sort(input.data(),scratch.data(),input.size(),core::impl::KeyAdaptor<uint32_t>());
+		benchmark::DoNotOptimize(sorted);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// baseline for `radixSort`
+void stdSort(benchmark::State& state)
+{
+	const auto keys = createKeys(state.range(0));
+	core::vector<uint32_t> input(keys.size());
+	for (auto _ : state)
+	{
+		std::copy(keys.begin(),keys.end(),input.begin());
+		std::sort(input.begin(),input.end());
+		benchmark::DoNotOptimize(input.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void mortonEncode(benchmark::State& state)
+{
+	const auto x = createKeys(state.range(0)), y = createKeys(state.range(0)), z = createKeys(state.range(0));
+	core::vector<uint32_t> codes(x.size());
+	for (auto _ : state)
+	{
+		core::morton3d_encode<uint32_t>(x.data(),y.data(),z.data(),codes.data(),codes.size());
+		benchmark::DoNotOptimize(codes.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void spatialSort(benchmark::State& state)
+{
+	std::mt19937 rng(Seed);
+	std::uniform_real_distribution<float> dist(-1.f,1.f);
+	core::vector<float> positions(state.range(0)*3);
+	for (auto& coord : positions)
+		coord = dist(rng);
+	const float aabbMin[3] = {-1.f,-1.f,-1.f};
+	const float aabbMax[3] = {1.f,1.f,1.f};
+
+	const auto curve = static_cast<core::E_SPACE_FILLING_CURVE>(state.range(1));
+	core::vector<uint32_t> order(state.range(0));
+	for (auto _ : state)
+	{
+		core::spatial_sort(core::execution::par_unseq,curve,positions.data(),sizeof(float)*3u,static_cast<uint32_t>(order.size()),aabbMin,aabbMax,order.data());
+		benchmark::DoNotOptimize(order.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+
+// one number per call, like the shaders do
+void xoroshiroScalar(benchmark::State& state)
+{
+	auto generator = hlsl::Xoroshiro64Star::construct(hlsl::uint32_t2(Seed,~Seed));
+	core::vector<uint32_t> numbers(state.range(0));
+	for (auto _ : state)
+	{
+		for (auto& number : numbers)
+			number = generator();
+		benchmark::DoNotOptimize(numbers.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+template<uint32_t Lanes>
+void xoroshiroBatch(benchmark::State& state)
+{
+	core::Xoroshiro64Batch<Lanes> generator(hlsl::uint32_t2(Seed,~Seed));
+	core::vector<uint32_t> numbers(state.range(0));
+	for (auto _ : state)
+	{
+		generator.fill(numbers.data(),numbers.size());
+		benchmark::DoNotOptimize(numbers.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void xoroshiroBatchNormal(benchmark::State& state)
+{
+	core::Xoroshiro64Batch<16u> generator(hlsl::uint32_t2(Seed,~Seed));
+	core::vector<float> numbers(state.range(0));
+	for (auto _ : state)
+	{
+		generator.fillNormal(numbers.data(),numbers.size());
+		benchmark::DoNotOptimize(numbers.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+
+template<typename T>
+core::vector<T> createScanInput(const size_t count)
+{
+	std::mt19937 rng(Seed);
+	core::vector<T> input(count);
+	for (auto& value : input)
+		value = static_cast<T>(rng()&0xffu);
+	return input;
+}
+
+// what host code does by hand now
+template<typename T>
+void stdInclusiveScan(benchmark::State& state)
+{
+	const auto input = createScanInput<T>(state.range(0));
+	core::vector<T> output(input.size());
+	for (auto _ : state)
+	{
+		std::inclusive_scan(input.begin(),input.end(),output.begin());
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void stdInclusiveScanParallel(benchmark::State& state)
+{
+	const auto input = createScanInput<uint32_t>(state.range(0));
+	core::vector<uint32_t> output(input.size());
+	for (auto _ : state)
+	{
+		std::inclusive_scan(core::execution::par_unseq,input.begin(),input.end(),output.begin());
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+template<class BinOp>
+void inclusiveScan(benchmark::State& state)
+{
+	const auto input = createScanInput<typename BinOp::type_t>(state.range(0));
+	core::vector<typename BinOp::type_t> output(input.size());
+	for (auto _ : state)
+	{
+		if (state.range(1))
+			core::inclusive_scan<BinOp>(core::execution::par_unseq,input.data(),output.data(),input.size());
+		else
+			core::inclusive_scan<BinOp>(core::execution::seq,input.data(),output.data(),input.size());
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void reduceMax(benchmark::State& state)
+{
+	const auto input = createScanInput<uint32_t>(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(core::reduce<hlsl::maximum<uint32_t>>(core::execution::par_unseq,input.data(),input.size()));
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// keeps about half, like culling a property pool
+void compactHalf(benchmark::State& state)
+{
+	const auto input = createScanInput<uint32_t>(state.range(0));
+	core::vector<uint32_t> output(input.size());
+	for (auto _ : state)
+	{
+		const auto kept = core::compact(core::execution::par_unseq,input.data(),output.data(),input.size(),[](const uint32_t value) -> bool {return value&0x1u;});
+		benchmark::DoNotOptimize(kept);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// segments averaging `meanLength` values, like the per object ranges of a batch of draws
+core::vector<uint8_t> createSegmentStarts(const size_t count, const uint32_t meanLength)
+{
+	std::mt19937 rng(Seed+1u);
+	core::vector<uint8_t> segmentStarts(count);
+	for (auto& start : segmentStarts)
+		start = rng()%meanLength==0u;
+	return segmentStarts;
+}
+
+template<bool Inclusive, class ExecutionPolicy>
+void segmentedScan(ExecutionPolicy&& policy, const core::vector<uint32_t>& input, const core::vector<uint8_t>& segmentStarts, core::vector<uint32_t>& output)
+{
+	if constexpr (Inclusive)
+		core::segmented_inclusive_scan<hlsl::plus<uint32_t>>(policy,input.data(),segmentStarts.data(),output.data(),input.size());
+	else
+		core::segmented_exclusive_scan<hlsl::plus<uint32_t>>(policy,input.data(),segmentStarts.data(),output.data(),input.size());
+}
+
+template<bool Inclusive>
+const char* validateSegmentedScan(const core::vector<uint32_t>& input, const core::vector<uint8_t>& segmentStarts)
+{
+	core::vector<uint32_t> output(input.size());
+	for (const bool parallel : {false,true})
+	{
+		if (parallel)
+			segmentedScan<Inclusive>(core::execution::par_unseq,input,segmentStarts,output);
+		else
+			segmentedScan<Inclusive>(core::execution::seq,input,segmentStarts,output);
+		uint32_t carry = 0u;
+		for (size_t i=0ull; i<input.size(); i++)
+		{
+			if (segmentStarts[i])
+				carry = 0u;
+			if (output[i]!=(Inclusive ? (carry+input[i]):carry))
+				return "Segmented scan doesn't match a serial one";
+			carry += input[i];
+		}
+	}
+	return nullptr;
+}
+
+template<bool Inclusive>
+void segmentedScanBenchmark(benchmark::State& state)
+{
+	const auto input = createScanInput<uint32_t>(state.range(0));
+	const auto segmentStarts = createSegmentStarts(input.size(),state.range(1));
+	if (const auto error=validateSegmentedScan<Inclusive>(input,segmentStarts))
+	{
+		state.SkipWithError(error);
+		return;
+	}
+	core::vector<uint32_t> output(input.size());
+	for (auto _ : state)
+	{
+		segmentedScan<Inclusive>(core::execution::par_unseq,input,segmentStarts,output);
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// random curves and points in a 1000 unit square, short curves like the glyphs and strokes of a 2D scene
+struct SBezierScene
+{
+	explicit SBezierScene(const uint32_t count)
+	{
+		std::mt19937 rng(Seed);
+		std::uniform_real_distribution<float> center(0.f,1000.f), offset(-8.f,8.f);
+		for (auto& coordinate : coordinates)
+			coordinate.resize(count);
+		for (uint32_t i=0u; i<count; i++)
+		{
+			const float x = center(rng), y = center(rng);
+			for (uint32_t p=0u; p<3u; p++)
+			{
+				coordinates[p*2u+0u][i] = x+offset(rng);
+				coordinates[p*2u+1u][i] = y+offset(rng);
+			}
+			coordinates[6u][i] = center(rng);
+			coordinates[7u][i] = center(rng);
+		}
+	}
+
+	inline core::bezier::SQuadraticBezierSoA getCurves() const
+	{
+		return {{coordinates[0].data(),coordinates[1].data()},{coordinates[2].data(),coordinates[3].data()},{coordinates[4].data(),coordinates[5].data()}};
+	}
+
+	// control points followed by a query point per curve
+	core::vector<float> coordinates[8];
+};
+
+// one curve and point at a time through the `float` kernel, like porting the shader code directly would
+void bezierClosestPointScalar(benchmark::State& state)
+{
+	const SBezierScene scene(state.range(0));
+	const auto curves = scene.getCurves();
+	core::vector<float> t(state.range(0));
+	for (auto _ : state)
+	{
+		for (uint32_t i=0u; i<t.size(); i++)
+		{
+			using namespace core::bezier::kernel;
+			float distanceSquared;
+			t[i] = Quadratic<float>::constructFromBezier(QuadraticBezier<float>::load(curves,i)).getClosestT({scene.coordinates[6][i],scene.coordinates[7][i]},distanceSquared);
+		}
+		benchmark::DoNotOptimize(t.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void bezierClosestPointBatch(benchmark::State& state)
+{
+	const SBezierScene scene(state.range(0));
+	const float* const pos[2] = {scene.coordinates[6].data(),scene.coordinates[7].data()};
+	core::vector<float> t(state.range(0));
+	for (auto _ : state)
+	{
+		core::bezier::closestPoint(scene.getCurves(),pos,t.data(),nullptr,static_cast<uint32_t>(t.size()));
+		benchmark::DoNotOptimize(t.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void bezierTessellate(benchmark::State& state)
+{
+	const SBezierScene scene(state.range(0));
+	core::vector<uint32_t> offsets;
+	core::vector<float> points[2];
+	for (auto _ : state)
+	{
+		core::bezier::tessellate(core::execution::par_unseq,scene.getCurves(),static_cast<uint32_t>(state.range(0)),0.05f,64u,offsets,points);
+		benchmark::DoNotOptimize(points[0].data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// building the hierarchy and binning into 16x16 tiles of a 1000x1000 viewport, once per frame for a dynamic scene
+void bezierBinTiles(benchmark::State& state)
+{
+	const SBezierScene scene(state.range(0));
+	const float origin[2] = {0.f,0.f};
+	const float tileSize[2] = {16.f,16.f};
+	const uint32_t tileCount[2] = {63u,63u};
+	core::vector<uint32_t> offsets, curves;
+	for (auto _ : state)
+	{
+		const core::bezier::CQuadraticBezierBVH bvh(core::execution::par_unseq,scene.getCurves(),static_cast<uint32_t>(state.range(0)));
+		bvh.binTiles(core::execution::par_unseq,origin,tileSize,tileCount,1.f,offsets,curves);
+		benchmark::DoNotOptimize(curves.data());
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// random tangent space directions in the upper hemisphere, anisotropic metals from almost mirror-like to fully rough
+struct SBxDFScene
+{
+	explicit SBxDFScene(const uint32_t count)
+	{
+		std::mt19937 rng(Seed);
+		std::uniform_real_distribution<float> unit(0.f,1.f), roughness(0.05f,1.f), refractiveIndex(0.1f,2.f), extinction(1.f,8.f);
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			V[c].resize(count);
+			L[c].resize(count);
+			eta[c].resize(count);
+			etak[c].resize(count);
+		}
+		for (auto& sample : u)
+			sample.resize(count);
+		ax.resize(count);
+		ay.resize(count);
+		for (uint32_t i=0u; i<count; i++)
+		{
+			for (auto* direction : {V,L})
+			{
+				const float z = unit(rng);
+				const float r = std::sqrt(1.f-z*z);
+				const float phi = unit(rng)*2.f/core::bxdf::kernel::ReciprocalPi;
+				direction[0][i] = r*std::cos(phi);
+				direction[1][i] = r*std::sin(phi);
+				direction[2][i] = z;
+			}
+			u[0][i] = unit(rng);
+			u[1][i] = unit(rng);
+			ax[i] = roughness(rng);
+			ay[i] = roughness(rng);
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				eta[c][i] = refractiveIndex(rng);
+				etak[c][i] = extinction(rng);
+			}
+		}
+	}
+
+	inline uint32_t size() const {return static_cast<uint32_t>(ax.size());}
+
+	inline core::bxdf::SGGXConductorParams getParams() const
+	{
+		return {ax.data(),ay.data(),{eta[0].data(),eta[1].data(),eta[2].data()},{etak[0].data(),etak[1].data(),etak[2].data()}};
+	}
+
+	core::vector<float> V[3], L[3], u[2], ax, ay, eta[3], etak[3];
+};
+
+// SoA outputs of a BxDF batch
+struct SBxDFResults
+{
+	explicit SBxDFResults(const uint32_t count)
+	{
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			storage[c].resize(count);
+			storage[3u+c].resize(count);
+		}
+		storage[6].resize(count);
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			L[c] = storage[c].data();
+			value[c] = storage[3u+c].data();
+		}
+		pdf = storage[6].data();
+	}
+
+	core::vector<float> storage[7];
+	float* L[3];
+	float* value[3];
+	float* pdf;
+};
+
+inline bool bxdfValuesMatch(const float batch, const float reference, const float relativeTolerance=1e-4f)
+{
+	return std::abs(batch-reference)<=1e-6f+std::max(std::abs(batch),std::abs(reference))*relativeTolerance;
+}
+// the packet `sincos` is a polynomial, so components of directions near the horizon only agree to an absolute tolerance
+inline bool bxdfDirectionsMatch(const float* const batch[3], const uint32_t i, const core::bxdf::kernel::vec3<float>& reference)
+{
+	return std::abs(batch[0][i]-reference.x)<=1e-4f && std::abs(batch[1][i]-reference.y)<=1e-4f && std::abs(batch[2][i]-reference.z)<=1e-4f;
+}
+// the half vector of almost opposite directions and the cosine of directions grazing the horizon come out of a cancellation,
+// so the BxDF values there are too sensitive to the last bits of the inputs to compare
+inline bool bxdfWellConditioned(const core::bxdf::kernel::vec3<float>& V, const core::bxdf::kernel::vec3<float>& L)
+{
+	return V.dot(L)>-0.99f && L.z>0.05f;
+}
+
+// the HLSL BxDFs can't be compiled as C++ yet, so the batches are checked against a literal transcription of
+// the HLSL delta models and the `float` instantiation of the kernels which is a line by line port of the shader code
+const char* validateBxDFBatch(const SBxDFScene& scene)
+{
+	using namespace core::bxdf;
+	const auto count = scene.size();
+	const float* const V[3] = {scene.V[0].data(),scene.V[1].data(),scene.V[2].data()};
+	const float* const L[3] = {scene.L[0].data(),scene.L[1].data(),scene.L[2].data()};
+	const float* const u[2] = {scene.u[0].data(),scene.u[1].data()};
+	const auto params = scene.getParams();
+
+	SBxDFResults reflection(count), transmission(count), lambertian(count), eval(count), generate(count), reeval(count);
+	delta_reflection_generate(V,reflection.L,count);
+	delta_transmission_generate(V,transmission.L,count);
+	lambertian_cos_eval(L[2],lambertian.value[0],count);
+	lambertian_cos_generate(u,lambertian.L,lambertian.pdf,count);
+	ggx_cos_eval(V,L,params,eval.value,eval.pdf,count);
+	ggx_cos_generate(V,u,params,generate.L,generate.value,generate.pdf,count);
+	// evaluating the generated directions has to give back the quotient and pdf they were generated with
+	ggx_cos_eval(V,generate.L,params,reeval.value,reeval.pdf,count);
+
+	for (uint32_t i=0u; i<count; i++)
+	{
+		const kernel::vec3<float> v = {V[0][i],V[1][i],V[2][i]};
+		const kernel::vec3<float> l = {L[0][i],L[1][i],L[2][i]};
+		float eta[3], etak[3];
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			eta[c] = params.eta[c][i];
+			etak[c] = params.etak[c][i];
+		}
+
+		// `V.reflect(N,NdotV)` and `V.transmit()` from `builtin/hlsl/bxdf`
+		const float NdotV = v.z;
+		const float reflected[3] = {2.f*NdotV*0.f-v.x,2.f*NdotV*0.f-v.y,2.f*NdotV*1.f-v.z};
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			if (reflection.L[c][i]!=reflected[c])
+				return "delta_reflection_generate doesn't match the HLSL reflection";
+			if (transmission.L[c][i]!=-V[c][i])
+				return "delta_transmission_generate doesn't match the HLSL transmission";
+		}
+
+		if (!bxdfValuesMatch(lambertian.value[0][i],kernel::lambertian_cos_eval(l.z)))
+			return "lambertian_cos_eval doesn't match the scalar path";
+		if (!bxdfDirectionsMatch(lambertian.L,i,kernel::lambertian_cos_generate(u[0][i],u[1][i])))
+			return "lambertian_cos_generate doesn't match the scalar path";
+		if (!bxdfValuesMatch(lambertian.pdf[i],lambertian.L[2][i]*kernel::ReciprocalPi))
+			return "lambertian_cos_generate pdf isn't its cosine over PI";
+
+		float value[3], pdf;
+		kernel::ggx_cos_eval(v,l,params.ax[i],params.ay[i],eta,etak,value,pdf);
+		if (bxdfWellConditioned(v,l))
+		{
+			if (!bxdfValuesMatch(eval.pdf[i],pdf))
+				return "ggx_cos_eval pdf doesn't match the scalar path";
+			for (uint32_t c=0u; c<3u; c++)
+			if (!bxdfValuesMatch(eval.value[c][i],value[c]))
+				return "ggx_cos_eval doesn't match the scalar path";
+		}
+
+		const auto generatedL = kernel::ggx_cos_generate(v,u[0][i],u[1][i],params.ax[i],params.ay[i],eta,etak,value,pdf);
+		if (!bxdfDirectionsMatch(generate.L,i,generatedL))
+			return "ggx_cos_generate doesn't match the scalar path";
+		if (!bxdfValuesMatch(generate.pdf[i],pdf))
+			return "ggx_cos_generate pdf doesn't match the scalar path";
+		if (!bxdfWellConditioned(v,generatedL))
+			continue;
+		// the quotient goes with the cosine, which carries the absolute error of the generated direction
+		for (uint32_t c=0u; c<3u; c++)
+		if (!bxdfValuesMatch(generate.value[c][i],value[c],1e-3f))
+			return "ggx_cos_generate quotient doesn't match the scalar path";
+
+		if (!bxdfValuesMatch(reeval.pdf[i],generate.pdf[i],1e-3f))
+			return "ggx_cos_eval pdf of a generated direction isn't the one it was generated with";
+		for (uint32_t c=0u; c<3u; c++)
+		if (!bxdfValuesMatch(reeval.value[c][i],generate.value[c][i]*generate.pdf[i],1e-3f))
+			return "ggx_cos_eval of a generated direction isn't its quotient times pdf";
+	}
+	return nullptr;
+}
+
+// one sample at a time through the `float` kernel, like porting the shader code directly would
+void ggxEvalScalar(benchmark::State& state)
+{
+	const SBxDFScene scene(state.range(0));
+	SBxDFResults results(scene.size());
+	for (auto _ : state)
+	{
+		for (uint32_t i=0u; i<scene.size(); i++)
+		{
+			using namespace core::bxdf::kernel;
+			const float eta[3] = {scene.eta[0][i],scene.eta[1][i],scene.eta[2][i]};
+			const float etak[3] = {scene.etak[0][i],scene.etak[1][i],scene.etak[2][i]};
+			float value[3];
+			ggx_cos_eval<float>({scene.V[0][i],scene.V[1][i],scene.V[2][i]},{scene.L[0][i],scene.L[1][i],scene.L[2][i]},scene.ax[i],scene.ay[i],eta,etak,value,results.pdf[i]);
+			for (uint32_t c=0u; c<3u; c++)
+				results.value[c][i] = value[c];
+		}
+		benchmark::DoNotOptimize(results.pdf);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void ggxEvalBatch(benchmark::State& state)
+{
+	const SBxDFScene scene(state.range(0));
+	if (const auto error=validateBxDFBatch(scene))
+	{
+		state.SkipWithError(error);
+		return;
+	}
+	const float* const V[3] = {scene.V[0].data(),scene.V[1].data(),scene.V[2].data()};
+	const float* const L[3] = {scene.L[0].data(),scene.L[1].data(),scene.L[2].data()};
+	SBxDFResults results(scene.size());
+	for (auto _ : state)
+	{
+		core::bxdf::ggx_cos_eval(V,L,scene.getParams(),results.value,results.pdf,scene.size());
+		benchmark::DoNotOptimize(results.pdf);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void ggxGenerateScalar(benchmark::State& state)
+{
+	const SBxDFScene scene(state.range(0));
+	SBxDFResults results(scene.size());
+	for (auto _ : state)
+	{
+		for (uint32_t i=0u; i<scene.size(); i++)
+		{
+			using namespace core::bxdf::kernel;
+			const float eta[3] = {scene.eta[0][i],scene.eta[1][i],scene.eta[2][i]};
+			const float etak[3] = {scene.etak[0][i],scene.etak[1][i],scene.etak[2][i]};
+			float quotient[3];
+			const auto L = ggx_cos_generate<float>({scene.V[0][i],scene.V[1][i],scene.V[2][i]},scene.u[0][i],scene.u[1][i],scene.ax[i],scene.ay[i],eta,etak,quotient,results.pdf[i]);
+			results.L[0][i] = L.x;
+			results.L[1][i] = L.y;
+			results.L[2][i] = L.z;
+			for (uint32_t c=0u; c<3u; c++)
+				results.value[c][i] = quotient[c];
+		}
+		benchmark::DoNotOptimize(results.pdf);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void ggxGenerateBatch(benchmark::State& state)
+{
+	const SBxDFScene scene(state.range(0));
+	if (const auto error=validateBxDFBatch(scene))
+	{
+		state.SkipWithError(error);
+		return;
+	}
+	const float* const V[3] = {scene.V[0].data(),scene.V[1].data(),scene.V[2].data()};
+	const float* const u[2] = {scene.u[0].data(),scene.u[1].data()};
+	SBxDFResults results(scene.size());
+	for (auto _ : state)
+	{
+		core::bxdf::ggx_cos_generate(V,u,scene.getParams(),results.L,results.value,results.pdf,scene.size());
+		benchmark::DoNotOptimize(results.pdf);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+void lambertianGenerateBatch(benchmark::State& state)
+{
+	const SBxDFScene scene(state.range(0));
+	if (const auto error=validateBxDFBatch(scene))
+	{
+		state.SkipWithError(error);
+		return;
+	}
+	const float* const u[2] = {scene.u[0].data(),scene.u[1].data()};
+	SBxDFResults results(scene.size());
+	for (auto _ : state)
+	{
+		core::bxdf::lambertian_cos_generate(u,results.L,results.pdf,scene.size());
+		benchmark::DoNotOptimize(results.pdf);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+}
+
+BENCHMARK(generalPurposeAllocator);
+BENCHMARK(poolAllocator);
+BENCHMARK(vectorPushBack)->Arg(1<<10)->Arg(1<<20);
+BENCHMARK(unorderedMapInsertFind)->Arg(1<<10)->Arg(1<<20);
+BENCHMARK(shardedCacheZipf<core::cache_policy::CLOCK>)->ThreadRange(1,32)->UseRealTime();
+BENCHMARK(shardedCacheZipf<core::cache_policy::TwoQ>)->ThreadRange(1,32)->UseRealTime();
+BENCHMARK(shardedCacheZipf<core::cache_policy::ARC>)->ThreadRange(1,32)->UseRealTime();
+BENCHMARK(lruCacheZipf)->ThreadRange(1,32)->UseRealTime();
+BENCHMARK(radixSort)->Arg(1<<10)->Arg(1<<16)->Arg(1<<22);
+BENCHMARK(stdSort)->Arg(1<<10)->Arg(1<<16)->Arg(1<<22);
+BENCHMARK(mortonEncode)->Arg(1<<20)->Arg(1<<24);
+BENCHMARK(spatialSort)->Args({1<<20,core::ESFC_MORTON})->Args({1<<20,core::ESFC_HILBERT})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(xoroshiroScalar)->Arg(1<<20);
+BENCHMARK(xoroshiroBatch<8u>)->Arg(1<<20);
+BENCHMARK(xoroshiroBatch<16u>)->Arg(1<<20);
+BENCHMARK(xoroshiroBatchNormal)->Arg(1<<20);
+BENCHMARK(stdInclusiveScan<uint32_t>)->Arg(1<<24)->Unit(benchmark::kMillisecond);
+BENCHMARK(stdInclusiveScan<float>)->Arg(1<<24)->Unit(benchmark::kMillisecond);
+BENCHMARK(stdInclusiveScanParallel)->Arg(1<<24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(inclusiveScan<hlsl::plus<uint32_t>>)->Args({1<<24,0})->Args({1<<24,1})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(inclusiveScan<hlsl::plus<float>>)->Args({1<<24,0})->Args({1<<24,1})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(inclusiveScan<hlsl::minimum<int32_t>>)->Args({1<<24,1})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(reduceMax)->Arg(1<<24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(compactHalf)->Arg(1<<24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(segmentedScanBenchmark<true>)->Args({1<<24,4})->Args({1<<24,1024})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(segmentedScanBenchmark<false>)->Args({1<<24,4})->Args({1<<24,1024})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bezierClosestPointScalar)->Arg(1<<20);
+BENCHMARK(bezierClosestPointBatch)->Arg(1<<20);
+BENCHMARK(bezierTessellate)->Arg(1<<16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bezierBinTiles)->Arg(1<<16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(ggxEvalScalar)->Arg(1<<20);
+BENCHMARK(ggxEvalBatch)->Arg(1<<20);
+BENCHMARK(ggxGenerateScalar)->Arg(1<<20);
+BENCHMARK(ggxGenerateBatch)->Arg(1<<20);
+BENCHMARK(lambertianGenerateBatch)->Arg(1<<20);
@@ -0,0 +1,146 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+#include <random>
+
+using namespace nbl;
+using namespace nbl::asset;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+// bindless style layout, `stride==1` gives a compact binding range (direct table), anything bigger leaves holes (perfect hash)
+core::smart_refctd_ptr<ICPUDescriptorSetLayout> createLayout(const uint32_t bindingCount, const uint32_t stride)
+{
+	constexpr IDescriptor::E_TYPE Types[] = {
+		IDescriptor::E_TYPE::ET_STORAGE_BUFFER,
+		IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER,
+		IDescriptor::E_TYPE::ET_STORAGE_IMAGE,
+		IDescriptor::E_TYPE::ET_UNIFORM_BUFFER
+	};
+
+	std::mt19937 rng(Seed);
+	core::vector<ICPUDescriptorSetLayout::SBinding> bindings(bindingCount);
+	ICPUDescriptorSetLayout::fillBindingsSameType(bindings.data(),bindingCount,IDescriptor::E_TYPE::ET_STORAGE_BUFFER);
+	uint32_t binding = 0u;
+	for (auto& b : bindings)
+	{
+		b.binding = binding;
+		b.type = Types[rng()%std::size(Types)];
+		binding += stride>1u ? (1u+rng()%stride):1u;
+	}
+	return core::make_smart_refctd_ptr<ICPUDescriptorSetLayout>(bindings.data(),bindings.data()+bindings.size());
+}
+
+// queries every declared binding in a shuffled order, like writes coming from all over a renderer would
+core::vector<uint32_t> createQueries(const ICPUDescriptorSetLayout* layout)
+{
+	core::vector<uint32_t> queries;
+	for (const auto& info : layout->getBindingInfos())
+		queries.push_back(info.binding);
+	std::shuffle(queries.begin(),queries.end(),std::mt19937(Seed));
+	return queries;
+}
+
+void bindingTypeLookup(benchmark::State& state)
+{
+	const auto layout = createLayout(static_cast<uint32_t>(state.range(0)),static_cast<uint32_t>(state.range(1)));
+	const auto queries = createQueries(layout.get());
+	for (auto _ : state)
+	{
+		uint32_t typeSum = 0u;
+		for (const auto binding : queries)
+			typeSum += static_cast<uint32_t>(layout->getBindingType(binding));
+		benchmark::DoNotOptimize(typeSum);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*queries.size());
+}
+
+// what every write used to pay, a binary search per descriptor type until the binding is found
+void bindingTypeLookupPerRedirect(benchmark::State& state)
+{
+	const auto layout = createLayout(static_cast<uint32_t>(state.range(0)),static_cast<uint32_t>(state.range(1)));
+	const auto queries = createQueries(layout.get());
+	for (auto _ : state)
+	{
+		uint32_t typeSum = 0u;
+		for (const auto binding : queries)
+		for (uint32_t t=0u; t<static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT); t++)
+		{
+			const auto& redirect = layout->getDescriptorRedirect(static_cast<IDescriptor::E_TYPE>(t));
+			const uint32_t bindingCount = redirect.getBindingCount();
+			if (bindingCount==0u)
+				continue;
+			uint32_t low = 0u, high = bindingCount;
+			while (low<high)
+			{
+				const uint32_t mid = (low+high)>>1u;
+				if (redirect.getBinding(ICPUDescriptorSetLayout::CBindingRedirect::storage_range_index_t{mid}).data<binding)
+					low = mid+1u;
+				else
+					high = mid;
+			}
+			if (low<bindingCount && redirect.getBinding(ICPUDescriptorSetLayout::CBindingRedirect::storage_range_index_t{low}).data==binding)
+			{
+				typeSum += t;
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(typeSum);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*queries.size());
+}
+
+void storageOffsetBatchLookup(benchmark::State& state)
+{
+	const auto layout = createLayout(static_cast<uint32_t>(state.range(0)),static_cast<uint32_t>(state.range(1)));
+	const auto& redirect = layout->getDescriptorRedirect(IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER);
+	core::vector<ICPUDescriptorSetLayout::CBindingRedirect::binding_number_t> queries;
+	for (const auto binding : createQueries(layout.get()))
+		queries.push_back(binding);
+	core::vector<ICPUDescriptorSetLayout::CBindingRedirect::storage_offset_t> offsets(queries.size(),0u);
+	for (auto _ : state)
+	{
+		redirect.getStorageOffsets(queries,offsets.data());
+		benchmark::DoNotOptimize(offsets.data());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*queries.size());
+}
+
+void descriptorInfoLookup(benchmark::State& state)
+{
+	auto layout = createLayout(static_cast<uint32_t>(state.range(0)),static_cast<uint32_t>(state.range(1)));
+	const auto queries = createQueries(layout.get());
+	const auto set = core::make_smart_refctd_ptr<ICPUDescriptorSet>(std::move(layout));
+	for (auto _ : state)
+	{
+		size_t infoCount = 0ull;
+		for (const auto binding : queries)
+			infoCount += std::as_const(*set).getDescriptorInfos(binding).size();
+		benchmark::DoNotOptimize(infoCount);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*queries.size());
+}
+
+void layoutCreation(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		auto layout = createLayout(static_cast<uint32_t>(state.range(0)),static_cast<uint32_t>(state.range(1)));
+		benchmark::DoNotOptimize(layout);
+	}
+}
+
+}
+
+// second argument is the maximum stride between binding numbers
+#define NBL_DESCRIPTOR_BENCHMARK_ARGS Args({1<<10,1})->Args({1<<14,1})->Args({1<<14,64})->Args({1<<16,1024})
+BENCHMARK(bindingTypeLookup)->NBL_DESCRIPTOR_BENCHMARK_ARGS;
+BENCHMARK(bindingTypeLookupPerRedirect)->NBL_DESCRIPTOR_BENCHMARK_ARGS;
+BENCHMARK(storageOffsetBatchLookup)->NBL_DESCRIPTOR_BENCHMARK_ARGS;
+BENCHMARK(descriptorInfoLookup)->NBL_DESCRIPTOR_BENCHMARK_ARGS;
+BENCHMARK(layoutCreation)->NBL_DESCRIPTOR_BENCHMARK_ARGS->Unit(benchmark::kMillisecond);
+#undef NBL_DESCRIPTOR_BENCHMARK_ARGS
@@ -0,0 +1,308 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+#include "nbl/asset/filters/CBlitImageFilter.h"
+#include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
+#include "nbl/asset/filters/CSummedAreaTableImageFilter.h"
+#include "nbl/asset/filters/CSwizzleAndConvertImageFilter.h"
+#include "nbl/asset/format/colorspaceBatch.h"
+#include "nbl/asset/utils/CDerivativeMapCreator.h"
+
+#include <random>
+
+using namespace nbl;
+using namespace nbl::asset;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+// same kernel the mip map generator defaults to
+using blit_utils_t = CBlitUtilities<CChannelIndependentWeightFunction1D<CConvolutionWeightFunction1D<CWeightFunction1D<SKaiserFunction>,CWeightFunction1D<SMitchellFunction<>>>>>;
+
+struct SScratch
+{
+	explicit SScratch(const size_t size) : memory(reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(size,_NBL_SIMD_ALIGNMENT))) {}
+	~SScratch() {_NBL_ALIGNED_FREE(memory);}
+
+	uint8_t* const memory;
+};
+
+int64_t getImageBytes(const ICPUImage* image, const uint32_t mipLevel=0u)
+{
+	const auto extent = image->getMipSize(mipLevel);
+	return int64_t(extent.x)*extent.y*getTexelOrBlockBytesize(image->getCreationParameters().format);
+}
+
+void blit(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	auto inImage = createSyntheticImage(EF_R8G8B8A8_SRGB,size,size);
+	auto outImage = createSyntheticImage(EF_R8G8B8A8_SRGB,size/2u,size/2u);
+
+	using filter_t = CBlitImageFilter<VoidSwizzle,IdentityDither,void,true,blit_utils_t>;
+	const core::vectorSIMDu32 inExtent(size,size,1u,1u), outExtent(size/2u,size/2u,1u,1u);
+	filter_t::state_type blitState(blit_utils_t::getConvolutionKernels(inExtent,outExtent));
+	blitState.inExtentLayerCount = inExtent;
+	blitState.outExtentLayerCount = outExtent;
+	blitState.inImage = inImage.get();
+	blitState.outImage = outImage.get();
+	blitState.scratchMemoryByteSize = filter_t::getRequiredScratchByteSize(&blitState);
+	SScratch scratch(blitState.scratchMemoryByteSize);
+	blitState.scratchMemory = scratch.memory;
+	blitState.recomputeScaledKernelPhasedLUT();
+
+	for (auto _ : state)
+	if (!filter_t::execute(core::execution::par_unseq,&blitState))
+	{
+		state.SkipWithError("Blit failed");
+		break;
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(inImage.get()));
+}
+
+void convert(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	auto inImage = createSyntheticImage(EF_R8G8B8A8_SRGB,size,size);
+	auto outImage = createSyntheticImage(EF_R16G16B16A16_SFLOAT,size,size);
+
+	using filter_t = CSwizzleAndConvertImageFilter<EF_UNKNOWN,EF_UNKNOWN,DefaultSwizzle,IdentityDither,void,true>;
+	filter_t::state_type convertState;
+	convertState.inImage = inImage.get();
+	convertState.outImage = outImage.get();
+	convertState.extent = {size,size,1u};
+	convertState.layerCount = 1u;
+
+	for (auto _ : state)
+	if (!filter_t::execute(core::execution::par_unseq,&convertState))
+	{
+		state.SkipWithError("Conversion failed");
+		break;
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(inImage.get()));
+}
+
+void summedAreaTable(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	auto inImage = createSyntheticImage(EF_R8G8B8A8_UNORM,size,size);
+	auto outImage = createSyntheticImage(EF_R32G32B32A32_SFLOAT,size,size);
+
+	using filter_t = CSummedAreaTableImageFilter<false>;
+	filter_t::state_type satState;
+	satState.inImage = inImage.get();
+	satState.outImage = outImage.get();
+	satState.extent = {size,size,1u};
+	satState.layerCount = 1u;
+	satState.axesToSum = 0b11u;
+	satState.scratchMemoryByteSize = filter_t::state_type::getRequiredScratchByteSize(satState.inImage,satState.extent);
+	SScratch scratch(satState.scratchMemoryByteSize);
+	satState.scratchMemory = scratch.memory;
+
+	for (auto _ : state)
+	if (!filter_t::execute(core::execution::par_unseq,&satState))
+	{
+		state.SkipWithError("Summed area table failed");
+		break;
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(inImage.get()));
+}
+
+void mipMapGeneration(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	const uint32_t mipLevels = hlsl::findMSB(size)+1u;
+	auto image = createSyntheticImage(EF_R8G8B8A8_SRGB,size,size,mipLevels);
+
+	using filter_t = CMipMapGenerationImageFilter<VoidSwizzle,IdentityDither,void,true,blit_utils_t>;
+	filter_t::state_type mipState;
+	mipState.inOutImage = image.get();
+	mipState.baseLayer = 0u;
+	mipState.layerCount = 1u;
+	mipState.startMipLevel = 1u;
+	mipState.endMipLevel = mipLevels;
+	mipState.scratchMemoryByteSize = filter_t::getRequiredScratchByteSize(&mipState);
+	SScratch scratch(mipState.scratchMemoryByteSize);
+	mipState.scratchMemory = scratch.memory;
+
+	for (auto _ : state)
+	if (!filter_t::execute(core::execution::par_unseq,&mipState))
+	{
+		state.SkipWithError("Mip map generation failed");
+		break;
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(image.get()));
+}
+
+// the second argument picks between just the derivative map and the derivative map with its whole mip chain
+void derivativeMapFromNormalMap(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	const bool mipChain = state.range(1);
+	auto image = createSyntheticImage(EF_R8G8B8A8_UNORM,size,size);
+
+	core::vector<float> factors(hlsl::findMSB(size)+1u);
+	for (auto _ : state)
+	{
+		auto derivativeMap = mipChain ? CDerivativeMapCreator::createDerivativeMipChainFromNormalMap<true>(image.get(),factors.data()):CDerivativeMapCreator::createDerivativeMapFromNormalMap<true>(image.get(),factors.data());
+		if (!derivativeMap)
+		{
+			state.SkipWithError("Derivative map creation failed");
+			break;
+		}
+		benchmark::DoNotOptimize(derivativeMap);
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(image.get()));
+}
+
+void derivativeMapFromHeightMap(benchmark::State& state)
+{
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	auto image = createSyntheticImage(EF_R8_UNORM,size,size);
+
+	core::vector<float> factors(hlsl::findMSB(size)+1u);
+	for (auto _ : state)
+	{
+		auto derivativeMap = CDerivativeMapCreator::createDerivativeMipChainFromHeightMap<true>(image.get(),ISampler::ETC_REPEAT,ISampler::ETC_REPEAT,ISampler::ETBC_FLOAT_OPAQUE_BLACK,factors.data());
+		if (!derivativeMap)
+		{
+			state.SkipWithError("Derivative map creation failed");
+			break;
+		}
+		benchmark::DoNotOptimize(derivativeMap);
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*getImageBytes(image.get()));
+}
+
+core::vector<float> createLinearTexels(const size_t count)
+{
+	std::mt19937 rng(Seed);
+	std::uniform_real_distribution<float> dist(0.f,1.f);
+	core::vector<float> texels(count);
+	for (auto& texel : texels)
+		texel = dist(rng);
+	return texels;
+}
+
+// linear RGBA floats to 8 bit sRGB, the argument is the pixel count
+void srgb8Encode(benchmark::State& state)
+{
+	const size_t pixels = state.range(0);
+	const auto in = createLinearTexels(pixels*4u);
+	core::vector<uint8_t> out(in.size());
+	for (auto _ : state)
+	{
+		colorspace::encodeSRGB8(in.data(),out.data(),pixels,4u);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*pixels);
+}
+
+void srgb8Decode(benchmark::State& state)
+{
+	const size_t pixels = state.range(0);
+	core::vector<uint8_t> in(pixels*4u);
+	colorspace::encodeSRGB8(createLinearTexels(in.size()).data(),in.data(),pixels,4u);
+	core::vector<float> out(in.size());
+	for (auto _ : state)
+	{
+		colorspace::decodeSRGB8(in.data(),out.data(),pixels,4u);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*pixels);
+}
+
+// float RGBA through one of the OETFs, alpha stays linear
+void transferFunctionEncode(benchmark::State& state)
+{
+	const size_t pixels = state.range(0);
+	const auto oetf = static_cast<OPTICO_ELECTRICAL_TRANSFER_FUNCTION>(state.range(1));
+	const auto in = createLinearTexels(pixels*4u);
+	core::vector<float> out(in.size());
+	for (auto _ : state)
+	{
+		colorspace::encode(oetf,in.data(),out.data(),pixels,4u);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*pixels);
+}
+
+void gamutConversion(benchmark::State& state)
+{
+	const size_t pixels = state.range(0);
+	const auto matrix = colorspace::SGamutMatrix::conversion(ECP_SRGB,ECP_BT2020);
+	auto texels = createLinearTexels(pixels*4u);
+	for (auto _ : state)
+	{
+		colorspace::applyGamut(matrix,texels.data(),texels.data(),pixels,4u);
+		benchmark::DoNotOptimize(texels.data());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*pixels);
+}
+
+// writes through pointers gotten before and after a `clone()` must only ever show up in the buffer they came from
+bool validateBufferClones()
+{
+	constexpr size_t size = 4096u;
+	auto source = core::make_smart_refctd_ptr<ICPUBuffer>(size);
+	auto* const sourceData = reinterpret_cast<uint8_t*>(source->getPointer());
+	memset(sourceData,0x11,size);
+	// the source handed out a pointer, so the clone has to get its own copy
+	auto clone = core::smart_refctd_ptr_static_cast<ICPUBuffer>(source->clone());
+	sourceData[0] = 0x22u;
+	const auto* const cloneData = reinterpret_cast<const uint8_t*>(std::as_const(*clone).getPointer());
+	if (cloneData[0]!=0x11u || std::as_const(*source).getPointer()!=sourceData || source->isDataShared())
+		return false;
+	// nothing wrote to the clone yet, so its own clones share with it until one of them writes
+	auto second = core::smart_refctd_ptr_static_cast<ICPUBuffer>(clone->clone());
+	if (!clone->isDataShared() || !second->isDataShared())
+		return false;
+	auto* const secondData = reinterpret_cast<uint8_t*>(second->getPointer());
+	secondData[1] = 0x33u;
+	if (second->isDataShared() || cloneData[1]!=0x11u || std::as_const(*clone).getPointer()!=cloneData)
+		return false;
+	// the last holder of the shared data takes it back without copying
+	if (reinterpret_cast<uint8_t*>(clone->getPointer())!=cloneData || clone->isDataShared())
+		return false;
+	auto third = core::smart_refctd_ptr_static_cast<ICPUBuffer>(second->clone());
+	secondData[2] = 0x44u;
+	return reinterpret_cast<const uint8_t*>(std::as_const(*third).getPointer())[2]==0x11u;
+}
+
+// clones share the texels copy-on-write, the second argument makes every clone write to its buffer which forces the copy
+void cloneImage(benchmark::State& state)
+{
+	if (!validateBufferClones())
+	{
+		state.SkipWithError("Writes leaked between copy-on-write clones");
+		return;
+	}
+	const uint32_t size = static_cast<uint32_t>(state.range(0));
+	const bool write = state.range(1);
+	// the texels got written through `getPointer()`, so it's a clone of the image that can share them
+	const auto image = core::smart_refctd_ptr_static_cast<ICPUImage>(createSyntheticImage(EF_R8G8B8A8_SRGB,size,size)->clone());
+	for (auto _ : state)
+	{
+		auto clone = core::smart_refctd_ptr_static_cast<ICPUImage>(image->clone());
+		if (write)
+			*reinterpret_cast<uint8_t*>(clone->getBuffer()->getPointer()) = 0xffu;
+		benchmark::DoNotOptimize(clone);
+	}
+}
+
+}
+
+BENCHMARK(blit)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(convert)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(summedAreaTable)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(mipMapGeneration)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(derivativeMapFromNormalMap)->Args({4096,0})->Args({4096,1})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(derivativeMapFromHeightMap)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(srgb8Encode)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK(srgb8Decode)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK(transferFunctionEncode)->Args({1<<20,OETF_sRGB})->Args({1<<20,OETF_SMPTE_170M})->Args({1<<20,OETF_SMPTE_ST2084})->Args({1<<20,OETF_HDR10_HLG});
+BENCHMARK(gamutConversion)->Arg(1<<20);
+BENCHMARK(cloneImage)->Args({4096,0})->Args({4096,1})->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,83 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+// every iteration loads from scratch, the asset cache would otherwise turn all but the first into a lookup
+void loadAsset(benchmark::State& state, const char* fileName, const IAssetLoader::SAssetLoadParams::SImageDecodeParams& imageDecode={})
+{
+	auto& environment = SEnvironment::get();
+	const auto path = environment.inputDirectory/fileName;
+
+	IAssetLoader::SAssetLoadParams params;
+	params.cacheFlags = IAssetLoader::ECF_DUPLICATE_REFERENCES;
+	params.workingDirectory = environment.inputDirectory;
+	params.imageDecode = imageDecode;
+	for (auto _ : state)
+	{
+		auto bundle = environment.assetManager->getAsset(path.string(),params);
+		if (bundle.getContents().empty())
+		{
+			state.SkipWithError("Failed to load the synthetic input");
+			break;
+		}
+		benchmark::DoNotOptimize(bundle);
+	}
+	state.SetBytesProcessed(int64_t(state.iterations())*int64_t(std::filesystem::file_size(path)));
+}
+
+// what the partial decodes save is their time relative to the plain load of the same file
+IAssetLoader::SAssetLoadParams::SImageDecodeParams thumbnail(const uint32_t mipLevel)
+{
+	IAssetLoader::SAssetLoadParams::SImageDecodeParams retval = {};
+	retval.mipLevel = mipLevel;
+	return retval;
+}
+IAssetLoader::SAssetLoadParams::SImageDecodeParams tile(const uint32_t offset, const uint32_t size)
+{
+	IAssetLoader::SAssetLoadParams::SImageDecodeParams retval = {};
+	retval.offset[0] = retval.offset[1] = offset;
+	retval.extent[0] = retval.extent[1] = size;
+	return retval;
+}
+
+}
+
+#ifdef _NBL_COMPILE_WITH_OBJ_LOADER_
+BENCHMARK_CAPTURE(loadAsset,OBJ,"grid.obj")->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_PLY_LOADER_
+BENCHMARK_CAPTURE(loadAsset,PLY,"grid.ply")->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_STL_LOADER_
+BENCHMARK_CAPTURE(loadAsset,STL,"grid.stl")->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_GLTF_LOADER_
+BENCHMARK_CAPTURE(loadAsset,GLTF,"grid.gltf")->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
+BENCHMARK_CAPTURE(loadAsset,EXR,"gradient.exr")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,EXRThumbnail,"gradient.exr",thumbnail(3u))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,EXRTile,"gradient.exr",tile(256u,256u))->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_PNG_LOADER_
+BENCHMARK_CAPTURE(loadAsset,PNG,"gradient.png")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,PNGThumbnail,"gradient.png",thumbnail(3u))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,PNGTile,"gradient.png",tile(256u,256u))->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_TGA_LOADER_
+BENCHMARK_CAPTURE(loadAsset,TGA,"gradient.tga")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,TGARLE,"gradient_rle.tga")->Unit(benchmark::kMillisecond);
+#endif
+#ifdef _NBL_COMPILE_WITH_JPG_LOADER_
+BENCHMARK_CAPTURE(loadAsset,JPG,"gradient.jpg")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,JPGThumbnail,"gradient.jpg",thumbnail(3u))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadAsset,JPGTile,"gradient.jpg",tile(256u,256u))->Unit(benchmark::kMillisecond);
+#endif
@@ -0,0 +1,7 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+// the benchmarks register themselves from their own translation units
+BENCHMARK_MAIN();
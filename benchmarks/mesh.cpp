@@ -0,0 +1,206 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+constexpr uint32_t PositionAttribute = 0u;
+constexpr uint32_t NormalAttribute = 1u;
+// float3 position and a packed normal interleaved in one binding, like most loaders output
+constexpr uint32_t VertexSize = sizeof(float)*3u+sizeof(uint32_t);
+
+// the heightfield grid from `createSyntheticMesh` as an indexed triangle list meshbuffer
+core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBuffer(const uint32_t resolution)
+{
+	const auto mesh = createSyntheticMesh(resolution);
+
+	// the meshbuffer only cares about the vertex input, but a pipeline can't be made without a shader
+	auto shader = core::make_smart_refctd_ptr<ICPUShader>("void main() {}",IShader::E_SHADER_STAGE::ESS_VERTEX,IShader::E_CONTENT_TYPE::ECT_GLSL,"benchmarks/mesh");
+	ICPUShader::SSpecInfo specInfo = {};
+	specInfo.shader = shader.get();
+	ICPURenderpassIndependentPipeline::SCreationParams params = {};
+	params.shaders = {&specInfo,1};
+	auto& vertexInput = params.cached.vertexInput;
+	vertexInput.enabledBindingFlags = 0b1u;
+	vertexInput.enabledAttribFlags = (0b1u<<PositionAttribute)|(0b1u<<NormalAttribute);
+	vertexInput.bindings[0].stride = VertexSize;
+	vertexInput.attributes[PositionAttribute].format = EF_R32G32B32_SFLOAT;
+	vertexInput.attributes[NormalAttribute].format = EF_R8G8B8A8_SNORM;
+	vertexInput.attributes[NormalAttribute].relativeOffset = sizeof(float)*3u;
+	params.cached.primitiveAssembly.primitiveType = EPT_TRIANGLE_LIST;
+	auto layout = core::make_smart_refctd_ptr<ICPUPipelineLayout>(std::span<const SPushConstantRange>(),nullptr,nullptr,nullptr,nullptr);
+
+	const size_t vertexCount = mesh.positions.size()/3u;
+	auto vertices = core::make_smart_refctd_ptr<ICPUBuffer>(vertexCount*VertexSize);
+	auto* const vertexData = reinterpret_cast<uint8_t*>(vertices->getPointer());
+	for (size_t i=0u; i<vertexCount; i++)
+	{
+		memcpy(vertexData+i*VertexSize,mesh.positions.data()+i*3u,sizeof(float)*3u);
+		// straight up in snorm8, the actual direction doesn't matter for decoding speed
+		const uint32_t normal = 127u<<8u;
+		memcpy(vertexData+i*VertexSize+sizeof(float)*3u,&normal,sizeof(normal));
+	}
+	auto indices = core::make_smart_refctd_ptr<ICPUBuffer>(mesh.indices.size()*sizeof(uint32_t));
+	memcpy(indices->getPointer(),mesh.indices.data(),indices->getSize());
+
+	auto meshbuffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+	meshbuffer->setPipeline(ICPURenderpassIndependentPipeline::create(std::move(layout),params));
+	meshbuffer->setVertexBufferBinding({0ull,std::move(vertices)},0u);
+	meshbuffer->setIndexBufferBinding({0ull,std::move(indices)});
+	meshbuffer->setIndexType(EIT_32BIT);
+	meshbuffer->setIndexCount(static_cast<uint32_t>(mesh.indices.size()));
+	meshbuffer->setPositionAttributeIx(PositionAttribute);
+	meshbuffer->setNormalAttributeIx(NormalAttribute);
+	return meshbuffer;
+}
+
+// range(1) picks the `IMeshManipulator::E_BOUNDING_BOX_MODE`, range(2) runs it with `par_unseq`
+void recalculateBoundingBox(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	const auto mode = static_cast<IMeshManipulator::E_BOUNDING_BOX_MODE>(state.range(1));
+	for (auto _ : state)
+	{
+		if (state.range(2))
+			IMeshManipulator::recalculateBoundingBox(core::execution::par_unseq,meshbuffer.get(),mode);
+		else
+			IMeshManipulator::recalculateBoundingBox(core::execution::seq,meshbuffer.get(),mode);
+		benchmark::DoNotOptimize(meshbuffer->getBoundingBox());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*meshbuffer->getIndexCount());
+}
+
+// every iteration undoes the previous one, the winding doesn't matter for the cost, range(1)==0 reorders the vertices of the unindexed mesh instead
+void flipSurfaces(benchmark::State& state)
+{
+	auto meshbuffer = createMeshBuffer(state.range(0));
+	if (!state.range(1))
+		meshbuffer = IMeshManipulator::createMeshBufferUniquePrimitives(meshbuffer.get());
+	for (auto _ : state)
+	{
+		IMeshManipulator::flipSurfaces(meshbuffer.get());
+		benchmark::DoNotOptimize(meshbuffer->getIndices());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*meshbuffer->getIndexCount());
+}
+
+void createMeshBufferUniquePrimitives(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	for (auto _ : state)
+	{
+		auto unwelded = IMeshManipulator::createMeshBufferUniquePrimitives(meshbuffer.get(),state.range(1));
+		benchmark::DoNotOptimize(unwelded);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*meshbuffer->getIndexCount());
+}
+
+// SoA scratch for a span of decoded vertices
+constexpr uint32_t AttributeSpanSize = 256u;
+struct SAttributeSpan
+{
+	float channels[4][AttributeSpanSize];
+	float* const pointers[4] = {channels[0],channels[1],channels[2],channels[3]};
+};
+
+// baseline for `decodeAttributeSpans`, what all the manipulators did before
+void decodeAttributes(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	const uint32_t attrId = state.range(1);
+	const size_t vertexCount = meshbuffer->getAttribBoundBuffer(attrId).buffer->getSize()/VertexSize;
+	for (auto _ : state)
+	{
+		core::vectorSIMDf sum(0.f);
+		for (size_t i=0u; i<vertexCount; i++)
+		{
+			core::vectorSIMDf value(0.f,0.f,0.f,1.f);
+			meshbuffer->getAttribute(value,attrId,i);
+			sum += value;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*vertexCount);
+}
+
+void decodeAttributeSpans(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	const uint32_t attrId = state.range(1);
+	const size_t vertexCount = meshbuffer->getAttribBoundBuffer(attrId).buffer->getSize()/VertexSize;
+	SAttributeSpan span;
+	for (auto _ : state)
+	{
+		float sum = 0.f;
+		for (size_t first=0u; first<vertexCount; first+=AttributeSpanSize)
+		{
+			const size_t count = core::min<size_t>(vertexCount-first,AttributeSpanSize);
+			meshbuffer->getAttributeSpan(span.pointers,attrId,first,count);
+			for (size_t i=0u; i<count; i++)
+				sum += span.channels[0][i]+span.channels[1][i]+span.channels[2][i];
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*vertexCount);
+}
+
+// baseline for `encodeAttributeSpans`
+void encodeAttributes(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	const uint32_t attrId = state.range(1);
+	const size_t vertexCount = meshbuffer->getAttribBoundBuffer(attrId).buffer->getSize()/VertexSize;
+	for (auto _ : state)
+	{
+		for (size_t i=0u; i<vertexCount; i++)
+		{
+			const float x = float(i&0xffu)/255.f;
+			meshbuffer->setAttribute(core::vectorSIMDf(x,1.f-x,0.5f,1.f),attrId,i);
+		}
+		benchmark::DoNotOptimize(meshbuffer->getAttribBoundBuffer(attrId).buffer->getPointer());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*vertexCount);
+}
+
+void encodeAttributeSpans(benchmark::State& state)
+{
+	const auto meshbuffer = createMeshBuffer(state.range(0));
+	const uint32_t attrId = state.range(1);
+	const size_t vertexCount = meshbuffer->getAttribBoundBuffer(attrId).buffer->getSize()/VertexSize;
+	SAttributeSpan span;
+	for (uint32_t i=0u; i<AttributeSpanSize; i++)
+	{
+		const float x = float(i)/255.f;
+		span.channels[0][i] = x;
+		span.channels[1][i] = 1.f-x;
+		span.channels[2][i] = 0.5f;
+		span.channels[3][i] = 1.f;
+	}
+	for (auto _ : state)
+	{
+		for (size_t first=0u; first<vertexCount; first+=AttributeSpanSize)
+			meshbuffer->setAttributeSpan(span.pointers,attrId,first,core::min<size_t>(vertexCount-first,AttributeSpanSize));
+		benchmark::DoNotOptimize(meshbuffer->getAttribBoundBuffer(attrId).buffer->getPointer());
+	}
+	state.SetItemsProcessed(int64_t(state.iterations())*vertexCount);
+}
+
+}
+
+BENCHMARK(recalculateBoundingBox)
+	->Args({1024,IMeshManipulator::EBBM_EXACT,0})
+	->Args({1024,IMeshManipulator::EBBM_EXACT,1})
+	->Args({1024,IMeshManipulator::EBBM_QUANTIZED,1})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(flipSurfaces)->Args({1024,1})->Args({512,0})->Unit(benchmark::kMillisecond);
+BENCHMARK(createMeshBufferUniquePrimitives)->Args({512,0})->Args({512,1})->Unit(benchmark::kMillisecond);
+BENCHMARK(decodeAttributes)->Args({1024,PositionAttribute})->Args({1024,NormalAttribute})->Unit(benchmark::kMillisecond);
+BENCHMARK(decodeAttributeSpans)->Args({1024,PositionAttribute})->Args({1024,NormalAttribute})->Unit(benchmark::kMillisecond);
+BENCHMARK(encodeAttributes)->Args({1024,PositionAttribute})->Args({1024,NormalAttribute})->Unit(benchmark::kMillisecond);
+BENCHMARK(encodeAttributeSpans)->Args({1024,PositionAttribute})->Args({1024,NormalAttribute})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,181 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "common.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+using namespace nbl::benchmarks;
+
+namespace
+{
+
+// big enough for the optimizer and the front end to have some work, self contained so no include finder is needed
+constexpr const char* GLSLComputeShader = R"===(
+#version 460 core
+layout(local_size_x=256) in;
+layout(set=0, binding=0, std430) restrict readonly buffer InBuffer { vec4 inData[]; };
+layout(set=0, binding=1, std430) restrict writeonly buffer OutBuffer { vec4 outData[]; };
+layout(push_constant) uniform PushConstants { uint count; float exposure; } pc;
+
+shared vec4 scratch[256];
+
+vec3 tonemap(in vec3 color)
+{
+	color *= pc.exposure;
+	const mat3 toLMS = mat3(0.59719,0.07600,0.02840,0.35458,0.90834,0.13383,0.04823,0.01566,0.83777);
+	const mat3 fromLMS = mat3(1.60475,-0.10208,-0.00327,-0.53108,1.10813,-0.07276,-0.07367,-0.00605,1.07602);
+	vec3 v = toLMS*color;
+	vec3 a = v*(v+0.0245786)-0.000090537;
+	vec3 b = v*(0.983729*v+0.4329510)+0.238081;
+	return clamp(fromLMS*(a/b),vec3(0.0),vec3(1.0));
+}
+
+void main()
+{
+	const uint ix = gl_GlobalInvocationID.x;
+	vec4 value = ix<pc.count ? inData[ix]:vec4(0.0);
+	scratch[gl_LocalInvocationIndex] = value;
+	for (uint stride=1u; stride<256u; stride<<=1u)
+	{
+		barrier();
+		vec4 other = gl_LocalInvocationIndex>=stride ? scratch[gl_LocalInvocationIndex-stride]:vec4(0.0);
+		barrier();
+		scratch[gl_LocalInvocationIndex] += other;
+	}
+	barrier();
+	if (ix<pc.count)
+		outData[ix] = vec4(tonemap(scratch[gl_LocalInvocationIndex].rgb/float(gl_LocalInvocationIndex+1u)),value.a);
+}
+)===";
+
+void compileGLSL(benchmark::State& state)
+{
+	auto& environment = SEnvironment::get();
+	auto compiler = core::make_smart_refctd_ptr<CGLSLCompiler>(core::smart_refctd_ptr(environment.system));
+
+	CGLSLCompiler::SOptions options = {};
+	options.stage = IShader::E_SHADER_STAGE::ESS_COMPUTE;
+	options.debugInfoFlags = IShaderCompiler::E_DEBUG_INFO_FLAGS::EDIF_NONE;
+	options.preprocessorOptions.sourceIdentifier = "benchmark.comp";
+	for (auto _ : state)
+	{
+		auto shader = compiler->compileToSPIRV(GLSLComputeShader,options);
+		if (!shader)
+		{
+			state.SkipWithError("Compilation failed");
+			break;
+		}
+		benchmark::DoNotOptimize(shader);
+	}
+}
+
+#ifdef _NBL_COMPILE_WITH_HLSL_COMPILER_
+// every builtin HLSL header which compiles on its own behind an empty entry point, one compiler for all threads so they share its DXC pool
+struct SHLSLCorpus
+{
+	core::smart_refctd_ptr<CHLSLCompiler> compiler;
+	core::vector<std::string> sources;
+
+	static inline CHLSLCompiler::SOptions getOptions(const CHLSLCompiler* compiler)
+	{
+		CHLSLCompiler::SOptions options = {};
+		options.stage = IShader::E_SHADER_STAGE::ESS_COMPUTE;
+		options.debugInfoFlags = IShaderCompiler::E_DEBUG_INFO_FLAGS::EDIF_NONE;
+		options.preprocessorOptions.sourceIdentifier = "benchmark.comp.hlsl";
+		options.preprocessorOptions.includeFinder = compiler->getDefaultIncludeFinder();
+		return options;
+	}
+
+	static const SHLSLCorpus& get()
+	{
+		static const SHLSLCorpus corpus = []() -> SHLSLCorpus
+		{
+			auto& environment = SEnvironment::get();
+			SHLSLCorpus retval;
+			retval.compiler = core::make_smart_refctd_ptr<CHLSLCompiler>(core::smart_refctd_ptr(environment.system));
+			const auto options = getOptions(retval.compiler.get());
+			for (const auto& item : environment.system->listItemsInDirectory("nbl/builtin/hlsl"))
+			{
+				if (item.extension()!=".hlsl")
+					continue;
+				auto source = "#include \""+item.generic_string()+"\"\n[numthreads(64,1,1)] void main() {}\n";
+				// some headers declare their own entry points or need defines from the includer
+				if (retval.compiler->compileToSPIRV(source.c_str(),options))
+					retval.sources.push_back(std::move(source));
+			}
+			return retval;
+		}();
+		return corpus;
+	}
+};
+
+// throughput of concurrent compiles, every thread goes through the corpus from its own starting point
+void compileHLSL(benchmark::State& state)
+{
+	const auto& corpus = SHLSLCorpus::get();
+	if (corpus.sources.empty())
+	{
+		state.SkipWithError("No builtin HLSL header compiled");
+		return;
+	}
+
+	const auto options = SHLSLCorpus::getOptions(corpus.compiler.get());
+	size_t i = state.thread_index();
+	for (auto _ : state)
+	{
+		auto shader = corpus.compiler->compileToSPIRV(corpus.sources[i++%corpus.sources.size()].c_str(),options);
+		if (!shader)
+		{
+			state.SkipWithError("Compilation failed");
+			break;
+		}
+		benchmark::DoNotOptimize(shader);
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.counters["dxcInstances"] = benchmark::Counter(corpus.compiler->getDXCInstanceCount(),benchmark::Counter::kAvgThreads);
+}
+
+// only the Wave front end of `compileHLSL`, the difference between the two is DXC itself
+void preprocessHLSL(benchmark::State& state)
+{
+	const auto& corpus = SHLSLCorpus::get();
+	if (corpus.sources.empty())
+	{
+		state.SkipWithError("No builtin HLSL header compiled");
+		return;
+	}
+
+	const auto options = SHLSLCorpus::getOptions(corpus.compiler.get());
+	size_t i = state.thread_index();
+	for (auto _ : state)
+	{
+		auto stage = options.stage;
+		auto code = corpus.compiler->preprocessShader(std::string(corpus.sources[i++%corpus.sources.size()]),stage,options.preprocessorOptions);
+		if (code.empty())
+		{
+			state.SkipWithError("Preprocessing failed");
+			break;
+		}
+		benchmark::DoNotOptimize(code);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+#else
+// still registered so that runs from every build list the same benchmarks
+void compileHLSL(benchmark::State& state)
+{
+	state.SkipWithError("Nabla got built without its DXC based HLSL compiler");
+}
+
+void preprocessHLSL(benchmark::State& state)
+{
+	state.SkipWithError("Nabla got built without its DXC based HLSL compiler");
+}
+#endif
+
+}
+
+BENCHMARK(compileGLSL)->Unit(benchmark::kMillisecond);
+BENCHMARK(compileHLSL)->ThreadRange(1,32)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(preprocessHLSL)->ThreadRange(1,32)->Unit(benchmark::kMillisecond)->UseRealTime();
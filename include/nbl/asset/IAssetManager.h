@@ -180,6 +180,7 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             If (_params.cacheFlags & ECF_DONT_CACHE_TOP_LEVEL)==ECF_DONT_CACHE_TOP_LEVEL, returned bundle is not being cached.
             (_params.cacheFlags & ECF_DUPLICATE_TOP_LEVEL)==ECF_DUPLICATE_TOP_LEVEL implies behaviour with ECF_DONT_CACHE_TOP_LEVEL, but Asset is not searched for in the cache (loaders tryout always happen).
 			With no flags (for top hierarchy level) given, Asset is looked for in the cache (whether it is already loaded), or - if not found - added to the cache just after getting loaded.
+            Partial image decodes (`_params.imageDecode` not the whole image) always behave as if ECF_DUPLICATE_TOP_LEVEL was given.
             Empty bundle is returned if no loader could load the Asset.
 
 			Take a look on @param _hierarchyLevel.
@@ -225,7 +226,10 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             if (params.workingDirectory.empty())
                 params.workingDirectory = filename.parent_path();
 
-            const uint64_t levelFlags = params.cacheFlags >> ((uint64_t)_hierarchyLevel * 2ull);
+            uint64_t levelFlags = params.cacheFlags >> ((uint64_t)_hierarchyLevel * 2ull);
+            // the cache is keyed by path alone, so a thumbnail or tile must never be found for a whole image request nor the other way around
+            if (!params.imageDecode.isWholeImage())
+                levelFlags |= IAssetLoader::ECF_DUPLICATE_TOP_LEVEL;
 
             SAssetBundle bundle;
             if ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL)
@@ -265,7 +269,7 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             {
                 bool addToCache;
                 bundle = _override->handleLoadFail(addToCache, file.get(), filename.string(), filename.string(), ctx, _hierarchyLevel);
-                if (!bundle.getContents().empty() && addToCache)
+                if (!bundle.getContents().empty() && addToCache && params.imageDecode.isWholeImage())
                     _override->insertAssetIntoCache(bundle, filename.string(), ctx, _hierarchyLevel);
             }
 
@@ -4,6 +4,7 @@
 #ifndef _NBL_ASSET_I_CPU_BUFFER_H_INCLUDED_
 #define _NBL_ASSET_I_CPU_BUFFER_H_INCLUDED_
 
+#include <atomic>
 #include <type_traits>
 
 #include "nbl/core/alloc/null_allocator.h"
@@ -21,11 +22,46 @@ namespace nbl::asset
     One of Assets used for storage of large arrays, so that storage can be decoupled
     from other objects such as meshbuffers, images, animations and shader source/bytecode.
 
+    Clones are copy-on-write, they share the data of the buffer they were cloned from until one of them asks for the
+    non-const `getPointer()`, at which point only that one gets a copy of its own. Sharing works from any buffer whose
+    memory was allocated by `ICPUBuffer` itself, or from any `EM_IMMUTABLE` one since its data can't change anyway,
+    other custom allocated buffers get cloned with a deep copy. The source buffer normally shares too, unless it's still
+    `EM_MUTABLE` and has handed out a pointer through the non-const `getPointer()`, then it keeps its memory to itself
+    and the clone gets a deep copy, so writes through that pointer after the `clone()` never show up in the clone.
+
     @see IAsset
 */
 class ICPUBuffer : public asset::IBuffer, public asset::IAsset
 {
     protected:
+        //! Keeps the memory shared between copy-on-write clones alive, either by owning it or by holding onto the immutable buffer it belongs to.
+        class CSharedData final : public core::IReferenceCounted
+        {
+            public:
+                inline CSharedData(void* _data) : m_data(_data) {}
+                inline CSharedData(core::smart_refctd_ptr<const core::IReferenceCounted>&& _backing) : m_data(nullptr), m_backing(std::move(_backing)) {}
+
+                //! takes back ownership of the memory, only allowed for the last reference, returns nullptr if the memory isn't owned
+                inline void* release()
+                {
+                    assert(getReferenceCount()==1);
+                    void* retval = m_data;
+                    m_data = nullptr;
+                    return retval;
+                }
+
+            protected:
+                inline ~CSharedData()
+                {
+                    if (m_data)
+                        _NBL_ALIGNED_FREE(m_data);
+                }
+
+            private:
+                void* m_data;
+                core::smart_refctd_ptr<const core::IReferenceCounted> m_backing;
+        };
+
         //! Non-allocating constructor for CCustormAllocatorCPUBuffer derivative
         ICPUBuffer(size_t sizeInBytes, void* dat) : asset::IBuffer({ dat ? sizeInBytes : 0,EUF_TRANSFER_DST_BIT }), data(dat) {}
 
@@ -40,13 +76,24 @@ class ICPUBuffer : public asset::IBuffer, public asset::IAsset
                 return;
 
             m_creationParams.size = sizeInBytes;
+            m_canShareData = true;
         }
 
         core::smart_refctd_ptr<IAsset> clone(uint32_t = ~0u) const override final
         {
+            if (auto shared=getSharedData(); shared)
+            {
+                auto cp = core::smart_refctd_ptr<ICPUBuffer>(new ICPUBuffer(m_creationParams.size,data),core::dont_grab);
+                clone_common(cp.get());
+                cp->m_sharedData = std::move(shared);
+                cp->m_isShared.store(true,std::memory_order_release);
+                return cp;
+            }
+
             auto cp = core::make_smart_refctd_ptr<ICPUBuffer>(m_creationParams.size);
             clone_common(cp.get());
-            memcpy(cp->getPointer(), data, m_creationParams.size);
+            // not through `getPointer()`, nothing can write to the copy yet so its own clones may share it
+            memcpy(cp->data, data, m_creationParams.size);
 
             return cp;
         }
@@ -67,12 +114,21 @@ class ICPUBuffer : public asset::IBuffer, public asset::IAsset
 
         //! Returns pointer to data.
         const void* getPointer() const {return data;}
+        //! Write access, if the data is shared with clones it gets copied first so the returned pointer may change (nullptr if the copy can't be allocated).
         void* getPointer() 
         { 
             assert(!isImmutable_debug());
+            if (m_isShared.load(std::memory_order_acquire) && !makeDataUnique())
+                return nullptr;
+            // cloning while another thread writes is a race on the data anyway, so relaxed is enough
+            if (!m_hasWriters.load(std::memory_order_relaxed))
+                m_hasWriters.store(true,std::memory_order_relaxed);
             return data;
         }
 
+        //! Whether the data is currently shared copy-on-write with other buffers.
+        inline bool isDataShared() const {return m_isShared.load(std::memory_order_acquire);}
+
         bool canBeRestoredFrom(const IAsset* _other) const override final
         {
             if (!_other)
@@ -101,6 +157,12 @@ class ICPUBuffer : public asset::IBuffer, public asset::IAsset
         }
 
     protected:
+        // derived classes free their own memory in their destructors, which leaves `data` null by the time this runs
+        virtual ~ICPUBuffer()
+        {
+            freeData();
+        }
+
         void restoreFromDummy_impl(IAsset* _other, uint32_t _levelsBelow) override final
         {
             auto* other = static_cast<ICPUBuffer*>(_other);
@@ -108,7 +170,15 @@ class ICPUBuffer : public asset::IBuffer, public asset::IAsset
             // NO THIS IS A NIGHTMARE!
             // FIXME: ONLY SWAP FOR COMPATIBLE ALLOCATORS! OTHERWISE MEMCPY!
             if (willBeRestoredFrom(_other))
+            {
                 std::swap(data, other->data);
+                std::swap(m_sharedData, other->m_sharedData);
+                std::swap(m_canShareData, other->m_canShareData);
+                const bool hadWriters = m_hasWriters.exchange(other->m_hasWriters.load(std::memory_order_relaxed),std::memory_order_relaxed);
+                other->m_hasWriters.store(hadWriters,std::memory_order_relaxed);
+                m_isShared.store(bool(m_sharedData),std::memory_order_release);
+                other->m_isShared.store(bool(other->m_sharedData),std::memory_order_release);
+            }
         }
 
         // REMEMBER TO CALL FROM DTOR!
@@ -116,13 +186,89 @@ class ICPUBuffer : public asset::IBuffer, public asset::IAsset
         // TODO: idea make a macro for overriding all `delete` operators of a class to enforce a finalizer that runs in reverse order to destructors (to allow polymorphic cleanups)
         virtual void freeData()
         {
-            if (data)
+            // shared memory belongs to the `CSharedData`
+            if (m_sharedData)
+            {
+                m_sharedData = nullptr;
+                m_isShared.store(false,std::memory_order_release);
+            }
+            else if (data)
                 _NBL_ALIGNED_FREE(data);
             data = nullptr;
             m_creationParams.size = 0ull;
         }
 
         void* data;
+
+    private:
+        inline void lockSharing() const
+        {
+            while (m_shareLock.test_and_set(std::memory_order_acquire))
+                m_shareLock.wait(true,std::memory_order_relaxed);
+        }
+        inline void unlockSharing() const
+        {
+            m_shareLock.clear(std::memory_order_release);
+            m_shareLock.notify_one();
+        }
+
+        // what a clone of this buffer should share, nullptr if it needs a deep copy
+        inline core::smart_refctd_ptr<CSharedData> getSharedData() const
+        {
+            if (!data)
+                return nullptr;
+            lockSharing();
+            core::smart_refctd_ptr<CSharedData> retval;
+            if (m_sharedData)
+                retval = m_sharedData;
+            else if (m_canShareData && !m_hasWriters.load(std::memory_order_relaxed))
+            {
+                // the memory gets handed over to the shared storage, so this buffer turns copy-on-write as well
+                m_sharedData = core::make_smart_refctd_ptr<CSharedData>(data);
+                m_canShareData = false;
+                m_isShared.store(true,std::memory_order_release);
+                retval = m_sharedData;
+            }
+            else if (getMutability()==EM_IMMUTABLE) // not kept around, it would be a reference cycle
+                retval = core::make_smart_refctd_ptr<CSharedData>(core::smart_refctd_ptr<const core::IReferenceCounted>(this));
+            unlockSharing();
+            return retval;
+        }
+
+        inline bool makeDataUnique()
+        {
+            lockSharing();
+            if (m_sharedData)
+            {
+                // whoever holds the last reference takes the memory back instead of copying it
+                void* unique = m_sharedData->getReferenceCount()==1 ? m_sharedData->release():nullptr;
+                if (!unique)
+                {
+                    unique = _NBL_ALIGNED_MALLOC(m_creationParams.size,_NBL_SIMD_ALIGNMENT);
+                    if (!unique)
+                    {
+                        unlockSharing();
+                        return false;
+                    }
+                    memcpy(unique,data,m_creationParams.size);
+                }
+                data = unique;
+                m_sharedData = nullptr;
+                m_canShareData = true;
+                m_isShared.store(false,std::memory_order_release);
+            }
+            unlockSharing();
+            return true;
+        }
+
+        // set while `data` points into memory shared copy-on-write, `m_isShared` mirrors it so writes don't need the lock
+        mutable core::smart_refctd_ptr<CSharedData> m_sharedData;
+        mutable std::atomic_bool m_isShared = false;
+        mutable std::atomic_flag m_shareLock = ATOMIC_FLAG_INIT;
+        // `data` got allocated by this class and can be handed over to a `CSharedData`
+        mutable bool m_canShareData = false;
+        // the non-const `getPointer()` handed out `data`, so it can't be shared without the writes leaking into clones
+        std::atomic_bool m_hasWriters = false;
 };
 
 
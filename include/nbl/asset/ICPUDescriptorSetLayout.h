@@ -35,6 +35,8 @@ class ICPUDescriptorSetLayout : public IDescriptorSetLayout<ICPUSampler>, public
                 cp->m_descriptorRedirects[t] = m_descriptorRedirects[t].clone();
             cp->m_immutableSamplerRedirect = m_immutableSamplerRedirect.clone();
             cp->m_mutableSamplerRedirect = m_mutableSamplerRedirect.clone();
+            cp->m_bindingInfos = m_bindingInfos;
+            cp->m_bindingLookup = m_bindingLookup;
 
             if (m_samplers)
             {
@@ -61,6 +63,7 @@ class ICPUDescriptorSetLayout : public IDescriptorSetLayout<ICPUSampler>, public
                 result += m_descriptorRedirects[t].conservativeSizeEstimate();
             result += m_immutableSamplerRedirect.conservativeSizeEstimate();
             result += m_mutableSamplerRedirect.conservativeSizeEstimate();
+            result += m_bindingInfos.size() * sizeof(SBindingInfo) + m_bindingLookup.conservativeSizeEstimate();
 
             result += m_samplers->size() * sizeof(void*);
 
@@ -135,19 +135,29 @@ class ICPUImage final : public IImage, public IAsset
 		{
 			assert(!isImmutable_debug());
 
-			auto localXYZLayerOffset = inRegionCoord/info.getDimension();
-			outBlockCoord = inRegionCoord-localXYZLayerOffset*info.getDimension();
-			return reinterpret_cast<uint8_t*>(buffer->getPointer())+region->getByteOffset(localXYZLayerOffset,region->getByteStrides(info));
+			// the buffer might share its data copy-on-write, which needs to be resolved before handing out a writable pointer
+			if (!buffer->getPointer())
+				return nullptr;
+			return const_cast<void*>(std::as_const(*this).getTexelBlockData(region,inRegionCoord,outBlockCoord));
 		}
 		inline const void* getTexelBlockData(const IImage::SBufferCopy* region, const core::vectorSIMDu32& inRegionCoord, core::vectorSIMDu32& outBlockCoord) const
 		{
-			return const_cast<typename std::decay<decltype(*this)>::type*>(this)->getTexelBlockData(region,inRegionCoord,outBlockCoord);
+			auto localXYZLayerOffset = inRegionCoord/info.getDimension();
+			outBlockCoord = inRegionCoord-localXYZLayerOffset*info.getDimension();
+			const ICPUBuffer* buf = buffer.get();
+			return reinterpret_cast<const uint8_t*>(buf->getPointer())+region->getByteOffset(localXYZLayerOffset,region->getByteStrides(info));
 		}
 
 		inline void* getTexelBlockData(uint32_t mipLevel, const core::vectorSIMDu32& boundedTexelCoord, core::vectorSIMDu32& outBlockCoord)
 		{
 			assert(!isImmutable_debug());
 
+			if (!buffer->getPointer())
+				return nullptr;
+			return const_cast<void*>(std::as_const(*this).getTexelBlockData(mipLevel,boundedTexelCoord,outBlockCoord));
+		}
+		inline const void* getTexelBlockData(uint32_t mipLevel, const core::vectorSIMDu32& boundedTexelCoord, core::vectorSIMDu32& outBlockCoord) const
+		{
 			// get region for coord
 			const auto* region = getRegion(mipLevel,boundedTexelCoord);
 			if (!region)
@@ -157,10 +167,6 @@ class ICPUImage final : public IImage, public IAsset
 			inRegionCoord -= core::vectorSIMDu32(region->imageOffset.x,region->imageOffset.y,region->imageOffset.z,region->imageSubresource.baseArrayLayer);
 			return getTexelBlockData(region,inRegionCoord,outBlockCoord);
 		}
-		inline const void* getTexelBlockData(uint32_t mipLevel, const core::vectorSIMDu32& inRegionCoord, core::vectorSIMDu32& outBlockCoord) const
-		{
-			return const_cast<typename std::decay<decltype(*this)>::type*>(this)->getTexelBlockData(mipLevel,inRegionCoord,outBlockCoord);
-		}
 
 
 		//! regions will be copied and sorted
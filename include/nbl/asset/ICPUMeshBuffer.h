@@ -12,6 +12,7 @@
 #include "nbl/asset/bawformat/BlobSerializable.h"
 #include "nbl/asset/format/decodePixels.h"
 #include "nbl/asset/format/encodePixels.h"
+#include "nbl/asset/format/attributeSpans.h"
 
 namespace nbl::asset
 {
@@ -350,7 +351,8 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             if (!m_indexBufferBinding.buffer)
                 return nullptr;
 
-            return reinterpret_cast<const uint8_t*>(m_indexBufferBinding.buffer->getPointer()) + m_indexBufferBinding.offset;
+            const ICPUBuffer* buf = m_indexBufferBinding.buffer.get();
+            return reinterpret_cast<const uint8_t*>(buf->getPointer()) + m_indexBufferBinding.offset;
         }
 
         //! Accesses given index of mapped position attribute buffer.
@@ -381,6 +383,19 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
         {
             assert(!isImmutable_debug());
 
+            const uint8_t* ptr = std::as_const(*this).getAttribPointer(attrId);
+            if (!ptr)
+                return nullptr;
+            // the buffer might share its data copy-on-write, getting write access can move it
+            ICPUBuffer* mappedAttrBuf = m_vertexBufferBindings[getBindingNumForAttribute(attrId)].buffer.get();
+            const uint8_t* oldData = reinterpret_cast<const uint8_t*>(std::as_const(*mappedAttrBuf).getPointer());
+            uint8_t* newData = reinterpret_cast<uint8_t*>(mappedAttrBuf->getPointer());
+            if (!newData)
+                return nullptr;
+            return newData+(ptr-oldData);
+        }
+        inline const uint8_t* getAttribPointer(uint32_t attrId) const
+        {
             if (!m_pipeline)
                 return nullptr;
 
@@ -393,7 +408,7 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             if (!isVertexAttribBufferBindingEnabled(bindingNum))
                 return nullptr;
 
-            ICPUBuffer* mappedAttrBuf = m_vertexBufferBindings[bindingNum].buffer.get();
+            const ICPUBuffer* mappedAttrBuf = m_vertexBufferBindings[bindingNum].buffer.get();
             if (!mappedAttrBuf)
                 return nullptr;
 
@@ -403,11 +418,7 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             if (ix < 0 || static_cast<uint64_t>(ix) >= mappedAttrBuf->getSize())
                 return nullptr;
 
-            return reinterpret_cast<uint8_t*>(mappedAttrBuf->getPointer()) + ix;
-        }
-        inline const uint8_t* getAttribPointer(uint32_t attrId) const
-        {
-            return const_cast<typename std::decay<decltype(*this)>::type&>(*this).getAttribPointer(attrId);
+            return reinterpret_cast<const uint8_t*>(mappedAttrBuf->getPointer()) + ix;
         }
 
         static inline bool getAttribute(core::vectorSIMDf& output, const void* src, E_FORMAT format)
@@ -464,7 +475,8 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
 
             const uint8_t* src = getAttribPointer(attrId);
             src += ix * getAttribStride(attrId);
-            if (src >= reinterpret_cast<const uint8_t*>(m_vertexBufferBindings[bindingId].buffer->getPointer()) + m_vertexBufferBindings[bindingId].buffer->getSize())
+            const ICPUBuffer* buf = m_vertexBufferBindings[bindingId].buffer.get();
+            if (src >= reinterpret_cast<const uint8_t*>(buf->getPointer()) + buf->getSize())
                 return false;
 
             return getAttribute(output, src, getAttribFormat(attrId));
@@ -618,18 +630,200 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             return setAttribute(_input, dst, getAttribFormat(attrId));
         }
 
+        //! Decodes a whole span of elements of a strided attribute array into 4 SoA float channels, the format is dispatched on once per call.
+        /** Channels the format doesn't have are filled with the same (0,0,0,1) defaults as getAttribute(), nullptr channels are skipped.
+        Formats without a specialized kernel in `nbl/asset/format/attributeSpans.h` go through getAttribute() element by element.
+        @param[out] output 4 channel pointers, each with room for `count` floats.
+        @param[in] indices If not null the `i`-th element is read from `src+indices[i]*stride` instead of `src+i*stride`.
+        @returns false if the format is not decodable to floats, same as getAttribute().
+        */
+        static inline bool getAttributeSpan(float* const* output, const void* src, size_t stride, E_FORMAT format, size_t count, const uint32_t* indices=nullptr)
+        {
+            if (!src)
+                return false;
+            if (decodeAttributeSpan(format,src,stride,count,output,indices))
+                return true;
+
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(src);
+            for (size_t i=0u; i<count; i++)
+            {
+                core::vectorSIMDf tmp(0.f,0.f,0.f,1.f);
+                if (!getAttribute(tmp,base+(indices ? size_t(indices[i]):i)*stride,format))
+                    return false;
+                for (auto c=0u; c<4u; c++)
+                if (output[c])
+                    output[c][i] = tmp[c];
+            }
+            return true;
+        }
+
+        //! Integer attribute variant of getAttributeSpan(float* const*, const void*, size_t, E_FORMAT, size_t, const uint32_t*), values narrower than 32bit are widened.
+        static inline bool getAttributeSpan(uint32_t* const* output, const void* src, size_t stride, E_FORMAT format, size_t count, const uint32_t* indices=nullptr)
+        {
+            if (!src)
+                return false;
+            if (decodeAttributeSpan(format,src,stride,count,output,indices))
+                return true;
+
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(src);
+            for (size_t i=0u; i<count; i++)
+            {
+                uint32_t tmp[4] = {0u,0u,0u,1u};
+                if (!getAttribute(tmp,base+(indices ? size_t(indices[i]):i)*stride,format))
+                    return false;
+                for (auto c=0u; c<4u; c++)
+                if (output[c])
+                    output[c][i] = tmp[c];
+            }
+            return true;
+        }
+
+        //! Encodes 4 SoA float channels into a span of a strided attribute array, nullptr channels are left untouched.
+        /** Formats without a specialized kernel go through setAttribute() element by element, in which case all channels need to be provided. */
+        static inline bool setAttributeSpan(const float* const* input, void* dst, size_t stride, E_FORMAT format, size_t count, const uint32_t* indices=nullptr)
+        {
+            if (!dst)
+                return false;
+            if (encodeAttributeSpan(format,dst,stride,count,input,indices))
+                return true;
+
+            uint8_t* base = reinterpret_cast<uint8_t*>(dst);
+            for (size_t i=0u; i<count; i++)
+            {
+                core::vectorSIMDf tmp(0.f,0.f,0.f,1.f);
+                for (auto c=0u; c<4u; c++)
+                if (input[c])
+                    tmp[c] = input[c][i];
+                if (!setAttribute(tmp,base+(indices ? size_t(indices[i]):i)*stride,format))
+                    return false;
+            }
+            return true;
+        }
+
+        //! Start of the attribute's data (see getAttribPointer()) if the vertex `lastIx` still lies within the bound buffer, nullptr otherwise.
+        inline const uint8_t* getAttribSpanPointer(uint32_t attrId, size_t lastIx) const
+        {
+            if (!m_pipeline || !isAttributeEnabled(attrId))
+                return nullptr;
+            const uint8_t* src = getAttribPointer(attrId);
+            const ICPUBuffer* buf = base_t::getAttribBoundBuffer(attrId).buffer.get();
+            if (!src || !buf)
+                return nullptr;
+            const uint8_t* bufEnd = reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize();
+            if (src+lastIx*getAttribStride(attrId)+getTexelOrBlockBytesize(getAttribFormat(attrId))>bufEnd)
+                return nullptr;
+            return src;
+        }
+        //! How many vertices, counting from getAttribSpanPointer(), lie within the bound buffer. So `lastIx` has to be less than this for the span to be valid.
+        inline size_t getAttribSpanCapacity(uint32_t attrId) const
+        {
+            const uint8_t* src = getAttribSpanPointer(attrId,0u);
+            if (!src)
+                return 0ull;
+            const size_t stride = getAttribStride(attrId);
+            if (stride==0ull)
+                return ~0ull;
+            const ICPUBuffer* buf = base_t::getAttribBoundBuffer(attrId).buffer.get();
+            const uint8_t* bufEnd = reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize();
+            return size_t(bufEnd-src-getTexelOrBlockBytesize(getAttribFormat(attrId)))/stride+1ull;
+        }
+
+        //! Decodes vertices [first,first+count) of the attribute, vertex numbers are incremented by `baseVertex` like in getAttribute().
+        /** Bounds are checked once for the whole span, nothing is written if any vertex falls outside the bound buffer. */
+        template<typename T>
+        inline bool getAttributeSpan(T* const* output, uint32_t attrId, size_t first, size_t count) const
+        {
+            if (count==0u)
+                return true;
+            const uint8_t* src = getAttribSpanPointer(attrId,first+count-1u);
+            if (!src)
+                return false;
+            const size_t stride = getAttribStride(attrId);
+            return getAttributeSpan(output,src+first*stride,stride,getAttribFormat(attrId),count);
+        }
+        //! Gathers the vertices listed in `indices` instead of a contiguous range.
+        template<typename T>
+        inline bool gatherAttributeSpan(T* const* output, uint32_t attrId, const uint32_t* indices, size_t count) const
+        {
+            if (count==0u)
+                return true;
+            const uint8_t* src = getAttribSpanPointer(attrId,*std::max_element(indices,indices+count));
+            if (!src)
+                return false;
+            return getAttributeSpan(output,src,getAttribStride(attrId),getAttribFormat(attrId),count,indices);
+        }
+        //! Copies the elements of the vertices listed in `indices` as they are, `outputStride` bytes apart, for any format.
+        inline bool gatherAttributeSpan(void* output, size_t outputStride, uint32_t attrId, const uint32_t* indices, size_t count) const
+        {
+            if (count==0u)
+                return true;
+            const uint8_t* src = getAttribSpanPointer(attrId,*std::max_element(indices,indices+count));
+            if (!src)
+                return false;
+            copyAttributeSpan(getTexelOrBlockBytesize(getAttribFormat(attrId)),src,getAttribStride(attrId),output,outputStride,count,indices);
+            return true;
+        }
+
+        //! Encodes vertices [first,first+count) of the attribute, vertex numbers are incremented by `baseVertex` like in setAttribute().
+        inline bool setAttributeSpan(const float* const* input, uint32_t attrId, size_t first, size_t count)
+        {
+            assert(!isImmutable_debug());
+            if (count==0u)
+                return true;
+            // the non-const `getAttribPointer` resolves copy-on-write sharing of the buffer
+            if (!getAttribPointer(attrId))
+                return false;
+            uint8_t* dst = const_cast<uint8_t*>(getAttribSpanPointer(attrId,first+count-1u));
+            if (!dst)
+                return false;
+            const size_t stride = getAttribStride(attrId);
+            return setAttributeSpan(input,dst+first*stride,stride,getAttribFormat(attrId),count);
+        }
+        //! Overwrites vertices [first,first+count) of the attribute with the elements `inputStride` bytes apart in `input` as they are, for any format.
+        inline bool setAttributeSpan(const void* input, size_t inputStride, uint32_t attrId, size_t first, size_t count)
+        {
+            assert(!isImmutable_debug());
+            if (count==0u)
+                return true;
+            if (!getAttribPointer(attrId))
+                return false;
+            uint8_t* dst = const_cast<uint8_t*>(getAttribSpanPointer(attrId,first+count-1u));
+            if (!dst)
+                return false;
+            const size_t stride = getAttribStride(attrId);
+            copyAttributeSpan(getTexelOrBlockBytesize(getAttribFormat(attrId)),input,inputStride,dst+first*stride,stride,count);
+            return true;
+        }
+        //! Scatters to the vertices listed in `indices` instead of a contiguous range.
+        inline bool scatterAttributeSpan(const float* const* input, uint32_t attrId, const uint32_t* indices, size_t count)
+        {
+            assert(!isImmutable_debug());
+            if (count==0u)
+                return true;
+            if (!getAttribPointer(attrId))
+                return false;
+            uint8_t* dst = const_cast<uint8_t*>(getAttribSpanPointer(attrId,*std::max_element(indices,indices+count)));
+            if (!dst)
+                return false;
+            return setAttributeSpan(input,dst,getAttribStride(attrId),getAttribFormat(attrId),count,indices);
+        }
+
         //!
         inline const core::matrix3x4SIMD* getInverseBindPoses() const
         {
             if (!m_inverseBindPoseBufferBinding.buffer)
                 return nullptr;
 
-            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(m_inverseBindPoseBufferBinding.buffer->getPointer());
+            const ICPUBuffer* buf = m_inverseBindPoseBufferBinding.buffer.get();
+            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buf->getPointer());
             return reinterpret_cast<const core::matrix3x4SIMD*>(ptr+m_inverseBindPoseBufferBinding.offset);
         }
         inline core::matrix3x4SIMD* getInverseBindPoses()
         {
             assert(!isImmutable_debug());
+            // resolves copy-on-write sharing of the buffer before handing out a writable pointer
+            if (m_inverseBindPoseBufferBinding.buffer && !m_inverseBindPoseBufferBinding.buffer->getPointer())
+                return nullptr;
             return const_cast<core::matrix3x4SIMD*>(const_cast<const ICPUMeshBuffer*>(this)->getInverseBindPoses());
         }
 
@@ -639,12 +833,15 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             if (!m_jointAABBBufferBinding.buffer)
                 return nullptr;
 
-            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(m_jointAABBBufferBinding.buffer->getPointer());
+            const ICPUBuffer* buf = m_jointAABBBufferBinding.buffer.get();
+            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buf->getPointer());
             return reinterpret_cast<const core::aabbox3df*>(ptr+ m_jointAABBBufferBinding.offset);
         }
         inline core::aabbox3df* getJointAABBs()
         {
             assert(!isImmutable_debug());
+            if (m_jointAABBBufferBinding.buffer && !m_jointAABBBufferBinding.buffer->getPointer())
+                return nullptr;
             return const_cast<core::aabbox3df*>(const_cast<const ICPUMeshBuffer*>(this)->getJointAABBs());
         }
 
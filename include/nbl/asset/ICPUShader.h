@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 
 
 #include "nbl/asset/IAsset.h"
@@ -51,7 +52,9 @@ class ICPUShader : public IAsset, public IShader
 
 		core::smart_refctd_ptr<IAsset> clone(uint32_t _depth = ~0u) const override
 		{
-			auto buf = (_depth > 0u && m_code) ? core::smart_refctd_ptr_static_cast<ICPUBuffer>(m_code->clone(_depth-1u)) : m_code;
+			// immutable code (such as blobs interned in a `CShaderBlobPool`) can be shared instead of deep-copied
+			const bool deepCopy = _depth>0u && m_code && m_code->getMutability()!=EM_IMMUTABLE;
+			auto buf = deepCopy ? core::smart_refctd_ptr_static_cast<ICPUBuffer>(m_code->clone(_depth-1u)) : m_code;
 			auto cp = core::smart_refctd_ptr<ICPUShader>(new ICPUShader(std::move(buf), getStage(), m_contentType, std::string(getFilepathHint())), core::dont_grab);
 			clone_common(cp.get());
 
@@ -68,6 +71,17 @@ class ICPUShader : public IAsset, public IShader
 
 		const ICPUBuffer* getContent() const { return m_code.get(); };
 
+		//! High level source is not guaranteed to be null-terminated (it may alias a mapped file), use this instead of treating the content as a C-string
+		inline std::string_view getSourceView() const
+		{
+			const ICPUBuffer* code = getContent();
+			if (!code || !code->getPointer())
+				return {};
+			std::string_view retval(reinterpret_cast<const char*>(code->getPointer()),code->getSize());
+			// the C-string constructor and most generators store null terminators in the buffer
+			return retval.substr(0,retval.find_last_not_of('\0')+1);
+		}
+
 		inline E_CONTENT_TYPE getContentType() const { return m_contentType; }
 		
 		inline bool isContentHighLevelLanguage() const
@@ -14,6 +14,160 @@
 namespace nbl::asset
 {
 
+namespace impl
+{
+// Maps a sorted set of unique binding numbers to their position in it in constant time.
+// Compact binding ranges get a direct index table, sparse ones (bindless layouts with holes) get a perfect hash with per-bucket displacements,
+// and if no displacement can be found within a bounded number of attempts the lookup degrades to a binary search.
+// The keys are not stored, `find` gets handed the same accessor as construction, so that a hit can be verified and foreign bindings rejected.
+class CBindingLookup
+{
+	public:
+		static constexpr inline uint32_t Invalid = ~0u;
+
+		inline CBindingLookup() = default;
+
+		template<typename KeyAt>
+		inline CBindingLookup(const uint32_t count, KeyAt&& keyAt)
+		{
+			if (count==0u)
+				return;
+
+			const uint32_t first = keyAt(0u);
+			const uint64_t range = uint64_t(keyAt(count-1u))-first+1ull;
+			if (range<=uint64_t(count)*MaxDenseSlotsPerBinding+MinDenseSlots)
+			{
+				m_method = E_METHOD::EM_DIRECT;
+				m_base = first;
+				m_slots.resize(range,Invalid);
+				for (uint32_t i=0u; i<count; i++)
+					m_slots[keyAt(i)-first] = i;
+				return;
+			}
+
+			// place the biggest buckets first while the table is still empty
+			core::vector<core::vector<uint32_t>> buckets(count);
+			for (uint32_t i=0u; i<count; i++)
+				buckets[hash(keyAt(i),0u)%count].push_back(i);
+			core::vector<uint32_t> order(count);
+			std::iota(order.begin(),order.end(),0u);
+			std::stable_sort(order.begin(),order.end(),[&buckets](const uint32_t a, const uint32_t b)->bool{return buckets[a].size()>buckets[b].size();});
+
+			const uint32_t slotCount = core::roundUpToPoT(count*2u);
+			m_slots.resize(slotCount,Invalid);
+			m_displacements.resize(count,0u);
+			core::vector<uint32_t> candidates;
+			for (const auto b : order)
+			{
+				const auto& bucket = buckets[b];
+				if (bucket.empty())
+					break;
+
+				bool placed = false;
+				for (uint32_t displacement=1u; !placed && displacement<MaxDisplacementAttempts; displacement++)
+				{
+					candidates.clear();
+					placed = true;
+					for (const auto ix : bucket)
+					{
+						const uint32_t slot = hash(keyAt(ix),displacement)&(slotCount-1u);
+						if (m_slots[slot]!=Invalid || std::find(candidates.begin(),candidates.end(),slot)!=candidates.end())
+						{
+							placed = false;
+							break;
+						}
+						candidates.push_back(slot);
+					}
+					if (placed)
+					{
+						m_displacements[b] = displacement;
+						for (size_t k=0ull; k<bucket.size(); k++)
+							m_slots[candidates[k]] = bucket[k];
+					}
+				}
+
+				if (!placed)
+				{
+					m_slots = {};
+					m_displacements = {};
+					m_method = E_METHOD::EM_BINARY_SEARCH;
+					return;
+				}
+			}
+			m_method = E_METHOD::EM_PERFECT_HASH;
+		}
+
+		template<typename KeyAt>
+		inline uint32_t find(const uint32_t key, const uint32_t count, KeyAt&& keyAt) const
+		{
+			switch (m_method)
+			{
+				case E_METHOD::EM_DIRECT:
+				{
+					// relies on unsigned wraparound for keys below `m_base`
+					const uint32_t slot = key-m_base;
+					return slot<m_slots.size() ? m_slots[slot]:Invalid;
+				}
+				case E_METHOD::EM_PERFECT_HASH:
+				{
+					const uint32_t displacement = m_displacements[hash(key,0u)%m_displacements.size()];
+					const uint32_t ix = m_slots[hash(key,displacement)&(m_slots.size()-1u)];
+					return (ix!=Invalid && keyAt(ix)==key) ? ix:Invalid;
+				}
+				default:
+					break;
+			}
+
+			uint32_t low = 0u, high = count;
+			while (low<high)
+			{
+				const uint32_t mid = (low+high)>>1u;
+				if (keyAt(mid)<key)
+					low = mid+1u;
+				else
+					high = mid;
+			}
+			return (low<count && keyAt(low)==key) ? low:Invalid;
+		}
+
+		inline size_t conservativeSizeEstimate() const
+		{
+			return (m_slots.size()+m_displacements.size())*sizeof(uint32_t);
+		}
+
+	private:
+		// a direct table is allowed to waste this much memory on holes in the binding range
+		static constexpr inline uint32_t MaxDenseSlotsPerBinding = 4u;
+		static constexpr inline uint32_t MinDenseSlots = 64u;
+		static constexpr inline uint32_t MaxDisplacementAttempts = 0x1u<<12u;
+
+		enum class E_METHOD : uint8_t
+		{
+			EM_BINARY_SEARCH,
+			EM_DIRECT,
+			EM_PERFECT_HASH
+		};
+
+		// integer mixer from "Prospecting for Hash Functions", the displacement acts as the seed
+		static inline uint32_t hash(uint32_t key, const uint32_t displacement)
+		{
+			key ^= displacement*0x9e3779b9u;
+			key ^= key>>16u;
+			key *= 0x7feb352du;
+			key ^= key>>15u;
+			key *= 0x846ca68bu;
+			key ^= key>>16u;
+			return key;
+		}
+
+		E_METHOD m_method = E_METHOD::EM_BINARY_SEARCH;
+		uint32_t m_base = 0u;
+		// direct table indexed by `binding-m_base`, or the hash table, both store indices into the sorted bindings
+		core::vector<uint32_t> m_slots;
+		core::vector<uint32_t> m_displacements;
+};
+}
+
 //! Interface class for Descriptor Set Layouts
 /*
 	The descriptor set layout specifies the bindings (in the shader GLSL
@@ -89,6 +243,7 @@ public:
 
 		// Returns index into the binding property arrays below (including `m_storageOffsets`), for the given binding number `binding`.
 		// Assumes `m_bindingNumbers` is sorted and that there are no duplicate values in it.
+		// Constant time for all but pathological layouts, see `impl::CBindingLookup`.
 		inline storage_range_index_t findBindingStorageIndex(const binding_number_t binding) const
 		{
 			if (!m_bindingNumbers)
@@ -96,14 +251,26 @@ public:
 
 			assert(m_storageOffsets && (m_count != 0u));
 
-			auto found = std::lower_bound(m_bindingNumbers, m_bindingNumbers + m_count, binding, [](binding_number_t a, binding_number_t b) -> bool {return a.data < b.data; });
+			const uint32_t foundIndex = m_lookup.find(binding.data, m_count, [this](const uint32_t ix) -> uint32_t {return m_bindingNumbers[ix].data; });
+			assert(foundIndex == Invalid || foundIndex < m_count);
+			return { foundIndex };
+		}
 
-			if ((found >= m_bindingNumbers + m_count) || (found->data != binding.data))
-				return { Invalid };
+		// Batched version of the above, `out` needs to have space for `bindings.size()` elements.
+		inline void findBindingStorageIndices(const std::span<const binding_number_t> bindings, storage_range_index_t* out) const
+		{
+			for (const auto binding : bindings)
+				*(out++) = findBindingStorageIndex(binding);
+		}
 
-			const uint32_t foundIndex = found - m_bindingNumbers;
-			assert(foundIndex < m_count);
-			return { foundIndex };
+		// Batched `getStorageOffset`, bindings not present in the redirect produce `Invalid`.
+		inline void getStorageOffsets(const std::span<const binding_number_t> bindings, storage_offset_t* out) const
+		{
+			for (const auto binding : bindings)
+			{
+				const auto index = findBindingStorageIndex(binding);
+				*(out++) = (index.data == Invalid) ? storage_offset_t{ Invalid } : getStorageOffset(index);
+			}
 		}
 
 		inline binding_number_t getBinding(const storage_range_index_t index) const
@@ -203,6 +370,13 @@ public:
 
 			std::inclusive_scan(m_storageOffsets, m_storageOffsets + m_count, m_storageOffsets,
 				[](storage_offset_t a, storage_offset_t b) -> storage_offset_t { return storage_offset_t{ a.data + b.data }; }, storage_offset_t{ 0u });
+
+			buildLookup();
+		}
+
+		inline void buildLookup()
+		{
+			m_lookup = impl::CBindingLookup(m_count, [this](const uint32_t ix) -> uint32_t {return m_bindingNumbers[ix].data; });
 		}
 
 		inline void init()
@@ -259,12 +433,13 @@ public:
 			{
 				result.init();
 				memcpy(result.m_data.get(), m_data.get(), getRequiredMemorySize());
+				result.m_lookup = m_lookup;
 			}
 
 			return result;
 		}
 
-		inline size_t conservativeSizeEstimate() const { return getRequiredMemorySize() + sizeof(*this); }
+		inline size_t conservativeSizeEstimate() const { return getRequiredMemorySize() + m_lookup.conservativeSizeEstimate() + sizeof(*this); }
 
 		uint32_t m_count = 0u;
 
@@ -274,6 +449,21 @@ public:
 		storage_offset_t* m_storageOffsets = nullptr;
 
 		std::unique_ptr<uint8_t[]> m_data = nullptr;
+		// kept outside of `m_data` because it is derived state, and `isIdenticallyDefined` compares `m_data` bytewise
+		impl::CBindingLookup m_lookup;
+	};
+
+	// Everything about a binding in one place, so that write and copy paths only need a single lookup instead of one per redirect.
+	struct SBindingInfo
+	{
+		uint32_t binding;
+		IDescriptor::E_TYPE type;
+		uint32_t count;
+		// offset into the storage of `type` descriptors
+		uint32_t descriptorOffset;
+		// offsets into immutable and mutable sampler storage, only one can be valid and only for combined image samplers
+		uint32_t immutableSamplerOffset;
+		uint32_t mutableSamplerOffset;
 	};
 
 	// utility functions
@@ -337,6 +527,29 @@ public:
 		return result;
 	}
 
+	// Returns nullptr if the layout doesn't declare `binding`.
+	inline const SBindingInfo* findBindingInfo(const uint32_t binding) const
+	{
+		const uint32_t ix = m_bindingLookup.find(binding, static_cast<uint32_t>(m_bindingInfos.size()), [this](const uint32_t i) -> uint32_t {return m_bindingInfos[i].binding; });
+		return ix != impl::CBindingLookup::Invalid ? (m_bindingInfos.data() + ix) : nullptr;
+	}
+
+	// Batched version of the above, `out` needs to have space for `bindings.size()` elements.
+	inline void findBindingInfos(const std::span<const uint32_t> bindings, const SBindingInfo** out) const
+	{
+		for (const auto binding : bindings)
+			*(out++) = findBindingInfo(binding);
+	}
+
+	inline IDescriptor::E_TYPE getBindingType(const uint32_t binding) const
+	{
+		const auto* info = findBindingInfo(binding);
+		return info ? info->type : IDescriptor::E_TYPE::ET_COUNT;
+	}
+
+	// sorted by binding number
+	inline std::span<const SBindingInfo> getBindingInfos() const { return m_bindingInfos; }
+
 	inline const CBindingRedirect& getDescriptorRedirect(const IDescriptor::E_TYPE type) const { return m_descriptorRedirects[static_cast<uint32_t>(type)]; }
 	inline const CBindingRedirect& getImmutableSamplerRedirect() const { return m_immutableSamplerRedirect; }
 	inline const CBindingRedirect& getMutableSamplerRedirect() const { return m_mutableSamplerRedirect; }
@@ -389,6 +602,34 @@ protected:
 				std::copy_n(b.samplers, b.count, dst);
 			}
 		}
+
+		buildBindingInfos();
+	}
+
+	// flattens the per-type redirects into one table sorted by binding number
+	inline void buildBindingInfos()
+	{
+		m_bindingInfos.clear();
+		m_bindingInfos.reserve(getTotalBindingCount());
+		for (uint32_t t = 0u; t < static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT); ++t)
+		{
+			const auto& redirect = m_descriptorRedirects[t];
+			for (uint32_t i = 0u; i < redirect.getBindingCount(); ++i)
+			{
+				const typename CBindingRedirect::storage_range_index_t index = { i };
+				const auto binding = redirect.getBinding(index);
+				m_bindingInfos.push_back({
+					.binding = binding.data,
+					.type = static_cast<IDescriptor::E_TYPE>(t),
+					.count = redirect.getCount(index),
+					.descriptorOffset = redirect.getStorageOffset(index).data,
+					.immutableSamplerOffset = m_immutableSamplerRedirect.getStorageOffset(binding).data,
+					.mutableSamplerOffset = m_mutableSamplerRedirect.getStorageOffset(binding).data
+				});
+			}
+		}
+		std::sort(m_bindingInfos.begin(), m_bindingInfos.end(), [](const SBindingInfo& lhs, const SBindingInfo& rhs) -> bool {return lhs.binding < rhs.binding; });
+		m_bindingLookup = impl::CBindingLookup(static_cast<uint32_t>(m_bindingInfos.size()), [this](const uint32_t ix) -> uint32_t {return m_bindingInfos[ix].binding; });
 	}
 
 	virtual ~IDescriptorSetLayout() = default;
@@ -396,6 +637,8 @@ protected:
 	CBindingRedirect m_descriptorRedirects[static_cast<uint32_t>(asset::IDescriptor::E_TYPE::ET_COUNT)];
 	CBindingRedirect m_immutableSamplerRedirect;
 	CBindingRedirect m_mutableSamplerRedirect;
+	core::vector<SBindingInfo> m_bindingInfos;
+	impl::CBindingLookup m_bindingLookup;
 
 	core::smart_refctd_dynamic_array<core::smart_refctd_ptr<sampler_type>> m_samplers = nullptr;
 };
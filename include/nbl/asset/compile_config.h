@@ -51,6 +51,10 @@ library. */
 currently only supports zip archives, though. */
 //#define _NBL_COMPILE_WITH_LZMA_
 
+//! Define _NBL_COMPILE_WITH_ZSTD_ if you want to read and write zstd supercompressed KTX2 files.
+/** zstd is not bundled in 3rdparty, so without it KTX2 supercompression falls back to zlib. */
+//#define _NBL_COMPILE_WITH_ZSTD_
+
 //#endif
 
 //! Define __NBL_COMPILE_WITH_MOUNT_ARCHIVE_LOADER_ if you want to mount folders as archives
@@ -0,0 +1,360 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_ATTRIBUTE_SPANS_H_INCLUDED_
+#define _NBL_ASSET_ATTRIBUTE_SPANS_H_INCLUDED_
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+
+#include "nbl/core/declarations.h"
+#include "nbl/asset/format/EFormat.h"
+
+//! Bulk conversion between strided (interleaved) vertex attribute arrays and SoA channel arrays
+/*
+	The format is switched on once per span instead of once per element, and every kernel is specialized on the
+	element type, channel count and whether the elements are gathered through an index list.
+
+	Channel pointers may be nullptr, such channels are skipped when decoding and left untouched when encoding.
+	When decoding, channels which the format does not have are filled with the (0,0,0,1) defaults.
+
+	The functions return false for formats which have no specialized kernel (packed, BGR swizzled, sRGB, 64bit etc.),
+	in which case nothing has been read or written and the caller should fall back to per-element `decodePixels`/`encodePixels`.
+*/
+namespace nbl::asset
+{
+
+namespace impl
+{
+	template<bool Gather>
+	inline size_t attributeSpanOffset(const size_t i, const size_t stride, const uint32_t* indices)
+	{
+		if constexpr (Gather)
+			return size_t(indices[i])*stride;
+		else
+			return i*stride;
+	}
+
+	template<typename OutT>
+	inline void fillAttributeSpanDefaults(const uint32_t firstChannel, const size_t count, OutT* const* output)
+	{
+		for (uint32_t c=firstChannel; c<4u; c++)
+		if (output[c])
+			std::fill_n(output[c],count,OutT(c==3u ? 1:0));
+	}
+
+	struct SAttribIdentity
+	{
+		template<typename T>
+		inline float operator()(const T x) const { return static_cast<float>(x); }
+	};
+	template<typename T>
+	struct SAttribUnorm
+	{
+		static inline constexpr float Max = float(std::numeric_limits<T>::max());
+
+		inline float operator()(const T x) const { return float(x)*(1.f/Max); }
+		inline T operator()(const float x) const { return T(core::clamp(x,0.f,1.f)*Max+0.5f); }
+	};
+	template<typename T>
+	struct SAttribSnorm
+	{
+		static inline constexpr float Max = float(std::numeric_limits<T>::max());
+
+		// the most negative value maps to -1 as well
+		inline float operator()(const T x) const { return core::max(float(x)*(1.f/Max),-1.f); }
+		inline T operator()(const float x) const { return T(std::lround(core::clamp(x,-1.f,1.f)*Max)); }
+	};
+	struct SAttribHalf
+	{
+		inline float operator()(const uint16_t x) const { return core::Float16Compressor::decompress(x); }
+		inline uint16_t operator()(const float x) const { return core::Float16Compressor::compress(x); }
+	};
+	//! integer attributes are widened to 32bit, signed ones with sign extension (same as `ICPUMeshBuffer::getAttribute`)
+	struct SAttribInteger
+	{
+		template<typename T>
+		inline uint32_t operator()(const T x) const { return static_cast<uint32_t>(static_cast<std::conditional_t<std::is_signed_v<T>,int32_t,uint32_t>>(x)); }
+	};
+
+	template<typename T, uint32_t Channels, bool Gather, typename OutT, class Convert>
+	inline bool decodeAttributeSpan(const uint8_t* src, const size_t stride, const size_t count, OutT* const* output, const uint32_t* indices, const Convert convert)
+	{
+		for (uint32_t c=0u; c<Channels; c++)
+		{
+			OutT* out = output[c];
+			if (!out)
+				continue;
+			const uint8_t* channelSrc = src+c*sizeof(T);
+			size_t i = 0ull;
+			#ifdef __NBL_COMPILE_WITH_AVX2_
+			// 8 elements per gather, the offsets need to fit in 32bit signed integers
+			if constexpr (std::is_same_v<T,float> && std::is_same_v<OutT,float> && !Gather)
+			if (stride<=(0x7fffffffull>>3))
+			{
+				const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0,1,2,3,4,5,6,7),_mm256_set1_epi32(int32_t(stride)));
+				for (; i+8ull<=count; i+=8ull)
+					_mm256_storeu_ps(out+i,_mm256_i32gather_ps(reinterpret_cast<const float*>(channelSrc+i*stride),offsets,1));
+			}
+			#endif
+			for (; i<count; i++)
+			{
+				T val;
+				memcpy(&val,channelSrc+attributeSpanOffset<Gather>(i,stride,indices),sizeof(T));
+				out[i] = convert(val);
+			}
+		}
+		fillAttributeSpanDefaults(Channels,count,output);
+		return true;
+	}
+
+	template<typename T, uint32_t Channels, bool Gather, class Convert>
+	inline bool encodeAttributeSpan(uint8_t* dst, const size_t stride, const size_t count, const float* const* input, const uint32_t* indices, const Convert convert)
+	{
+		for (uint32_t c=0u; c<Channels; c++)
+		{
+			const float* in = input[c];
+			if (!in)
+				continue;
+			uint8_t* channelDst = dst+c*sizeof(T);
+			for (size_t i=0ull; i<count; i++)
+			{
+				T val;
+				if constexpr (std::is_same_v<T,float>)
+					val = in[i];
+				else
+					val = convert(in[i]);
+				memcpy(channelDst+attributeSpanOffset<Gather>(i,stride,indices),&val,sizeof(T));
+			}
+		}
+		return true;
+	}
+
+	template<bool Signed, bool Gather>
+	inline bool decodeAttributeSpan_2_10_10_10(const uint8_t* src, const size_t stride, const size_t count, float* const* output, const uint32_t* indices)
+	{
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			float* out = output[c];
+			if (!out)
+				continue;
+			const uint32_t shift = c*10u;
+			for (size_t i=0ull; i<count; i++)
+			{
+				uint32_t pix;
+				memcpy(&pix,src+attributeSpanOffset<Gather>(i,stride,indices),sizeof(uint32_t));
+				if constexpr (Signed)
+				{
+					// arithmetic shift does the sign extension
+					const int32_t val = int32_t(pix<<(c!=3u ? (22u-shift):0u))>>(c!=3u ? 22u:30u);
+					out[i] = c!=3u ? core::max(float(val)*(1.f/511.f),-1.f):core::max(float(val),-1.f);
+				}
+				else
+				{
+					const uint32_t val = pix>>shift;
+					out[i] = c!=3u ? float(val&0x3ffu)*(1.f/1023.f):float(val&0x3u)*(1.f/3.f);
+				}
+			}
+		}
+		return true;
+	}
+
+	template<bool Gather>
+	inline bool decodeAttributeSpan(const E_FORMAT format, const uint8_t* src, const size_t stride, const size_t count, float* const* output, const uint32_t* indices)
+	{
+		switch (format)
+		{
+			case EF_R32_SFLOAT: return decodeAttributeSpan<float,1u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R32G32_SFLOAT: return decodeAttributeSpan<float,2u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R32G32B32_SFLOAT: return decodeAttributeSpan<float,3u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R32G32B32A32_SFLOAT: return decodeAttributeSpan<float,4u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+
+			case EF_R16_SFLOAT: return decodeAttributeSpan<uint16_t,1u,Gather>(src,stride,count,output,indices,SAttribHalf{});
+			case EF_R16G16_SFLOAT: return decodeAttributeSpan<uint16_t,2u,Gather>(src,stride,count,output,indices,SAttribHalf{});
+			case EF_R16G16B16_SFLOAT: return decodeAttributeSpan<uint16_t,3u,Gather>(src,stride,count,output,indices,SAttribHalf{});
+			case EF_R16G16B16A16_SFLOAT: return decodeAttributeSpan<uint16_t,4u,Gather>(src,stride,count,output,indices,SAttribHalf{});
+
+			case EF_R8_UNORM: return decodeAttributeSpan<uint8_t,1u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8_UNORM: return decodeAttributeSpan<uint8_t,2u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8B8_UNORM: return decodeAttributeSpan<uint8_t,3u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8B8A8_UNORM: return decodeAttributeSpan<uint8_t,4u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8_SNORM: return decodeAttributeSpan<int8_t,1u,Gather>(src,stride,count,output,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8_SNORM: return decodeAttributeSpan<int8_t,2u,Gather>(src,stride,count,output,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8B8_SNORM: return decodeAttributeSpan<int8_t,3u,Gather>(src,stride,count,output,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8B8A8_SNORM: return decodeAttributeSpan<int8_t,4u,Gather>(src,stride,count,output,indices,SAttribSnorm<int8_t>{});
+			case EF_R8_USCALED: return decodeAttributeSpan<uint8_t,1u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8_USCALED: return decodeAttributeSpan<uint8_t,2u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8B8_USCALED: return decodeAttributeSpan<uint8_t,3u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8B8A8_USCALED: return decodeAttributeSpan<uint8_t,4u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8_SSCALED: return decodeAttributeSpan<int8_t,1u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8_SSCALED: return decodeAttributeSpan<int8_t,2u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8B8_SSCALED: return decodeAttributeSpan<int8_t,3u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R8G8B8A8_SSCALED: return decodeAttributeSpan<int8_t,4u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+
+			case EF_R16_UNORM: return decodeAttributeSpan<uint16_t,1u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16_UNORM: return decodeAttributeSpan<uint16_t,2u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16B16_UNORM: return decodeAttributeSpan<uint16_t,3u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16B16A16_UNORM: return decodeAttributeSpan<uint16_t,4u,Gather>(src,stride,count,output,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16_SNORM: return decodeAttributeSpan<int16_t,1u,Gather>(src,stride,count,output,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16_SNORM: return decodeAttributeSpan<int16_t,2u,Gather>(src,stride,count,output,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16B16_SNORM: return decodeAttributeSpan<int16_t,3u,Gather>(src,stride,count,output,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16B16A16_SNORM: return decodeAttributeSpan<int16_t,4u,Gather>(src,stride,count,output,indices,SAttribSnorm<int16_t>{});
+			case EF_R16_USCALED: return decodeAttributeSpan<uint16_t,1u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16_USCALED: return decodeAttributeSpan<uint16_t,2u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16B16_USCALED: return decodeAttributeSpan<uint16_t,3u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16B16A16_USCALED: return decodeAttributeSpan<uint16_t,4u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16_SSCALED: return decodeAttributeSpan<int16_t,1u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16_SSCALED: return decodeAttributeSpan<int16_t,2u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16B16_SSCALED: return decodeAttributeSpan<int16_t,3u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+			case EF_R16G16B16A16_SSCALED: return decodeAttributeSpan<int16_t,4u,Gather>(src,stride,count,output,indices,SAttribIdentity{});
+
+			case EF_A2B10G10R10_UNORM_PACK32: return decodeAttributeSpan_2_10_10_10<false,Gather>(src,stride,count,output,indices);
+			case EF_A2B10G10R10_SNORM_PACK32: return decodeAttributeSpan_2_10_10_10<true,Gather>(src,stride,count,output,indices);
+			default:
+				break;
+		}
+		return false;
+	}
+
+	template<bool Gather>
+	inline bool decodeAttributeSpan(const E_FORMAT format, const uint8_t* src, const size_t stride, const size_t count, uint32_t* const* output, const uint32_t* indices)
+	{
+		switch (format)
+		{
+			case EF_R8_UINT: return decodeAttributeSpan<uint8_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8_UINT: return decodeAttributeSpan<uint8_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8B8_UINT: return decodeAttributeSpan<uint8_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8B8A8_UINT: return decodeAttributeSpan<uint8_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8_SINT: return decodeAttributeSpan<int8_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8_SINT: return decodeAttributeSpan<int8_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8B8_SINT: return decodeAttributeSpan<int8_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R8G8B8A8_SINT: return decodeAttributeSpan<int8_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+
+			case EF_R16_UINT: return decodeAttributeSpan<uint16_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16_UINT: return decodeAttributeSpan<uint16_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16B16_UINT: return decodeAttributeSpan<uint16_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16B16A16_UINT: return decodeAttributeSpan<uint16_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16_SINT: return decodeAttributeSpan<int16_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16_SINT: return decodeAttributeSpan<int16_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16B16_SINT: return decodeAttributeSpan<int16_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R16G16B16A16_SINT: return decodeAttributeSpan<int16_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+
+			case EF_R32_UINT: return decodeAttributeSpan<uint32_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32_UINT: return decodeAttributeSpan<uint32_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32B32_UINT: return decodeAttributeSpan<uint32_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32B32A32_UINT: return decodeAttributeSpan<uint32_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32_SINT: return decodeAttributeSpan<int32_t,1u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32_SINT: return decodeAttributeSpan<int32_t,2u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32B32_SINT: return decodeAttributeSpan<int32_t,3u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			case EF_R32G32B32A32_SINT: return decodeAttributeSpan<int32_t,4u,Gather>(src,stride,count,output,indices,SAttribInteger{});
+			default:
+				break;
+		}
+		return false;
+	}
+
+	template<bool Gather>
+	inline bool encodeAttributeSpan(const E_FORMAT format, uint8_t* dst, const size_t stride, const size_t count, const float* const* input, const uint32_t* indices)
+	{
+		switch (format)
+		{
+			case EF_R32_SFLOAT: return encodeAttributeSpan<float,1u,Gather>(dst,stride,count,input,indices,SAttribIdentity{});
+			case EF_R32G32_SFLOAT: return encodeAttributeSpan<float,2u,Gather>(dst,stride,count,input,indices,SAttribIdentity{});
+			case EF_R32G32B32_SFLOAT: return encodeAttributeSpan<float,3u,Gather>(dst,stride,count,input,indices,SAttribIdentity{});
+			case EF_R32G32B32A32_SFLOAT: return encodeAttributeSpan<float,4u,Gather>(dst,stride,count,input,indices,SAttribIdentity{});
+
+			case EF_R16_SFLOAT: return encodeAttributeSpan<uint16_t,1u,Gather>(dst,stride,count,input,indices,SAttribHalf{});
+			case EF_R16G16_SFLOAT: return encodeAttributeSpan<uint16_t,2u,Gather>(dst,stride,count,input,indices,SAttribHalf{});
+			case EF_R16G16B16_SFLOAT: return encodeAttributeSpan<uint16_t,3u,Gather>(dst,stride,count,input,indices,SAttribHalf{});
+			case EF_R16G16B16A16_SFLOAT: return encodeAttributeSpan<uint16_t,4u,Gather>(dst,stride,count,input,indices,SAttribHalf{});
+
+			case EF_R8_UNORM: return encodeAttributeSpan<uint8_t,1u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8_UNORM: return encodeAttributeSpan<uint8_t,2u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8B8_UNORM: return encodeAttributeSpan<uint8_t,3u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8G8B8A8_UNORM: return encodeAttributeSpan<uint8_t,4u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint8_t>{});
+			case EF_R8_SNORM: return encodeAttributeSpan<int8_t,1u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8_SNORM: return encodeAttributeSpan<int8_t,2u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8B8_SNORM: return encodeAttributeSpan<int8_t,3u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int8_t>{});
+			case EF_R8G8B8A8_SNORM: return encodeAttributeSpan<int8_t,4u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int8_t>{});
+
+			case EF_R16_UNORM: return encodeAttributeSpan<uint16_t,1u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16_UNORM: return encodeAttributeSpan<uint16_t,2u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16B16_UNORM: return encodeAttributeSpan<uint16_t,3u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16G16B16A16_UNORM: return encodeAttributeSpan<uint16_t,4u,Gather>(dst,stride,count,input,indices,SAttribUnorm<uint16_t>{});
+			case EF_R16_SNORM: return encodeAttributeSpan<int16_t,1u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16_SNORM: return encodeAttributeSpan<int16_t,2u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16B16_SNORM: return encodeAttributeSpan<int16_t,3u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int16_t>{});
+			case EF_R16G16B16A16_SNORM: return encodeAttributeSpan<int16_t,4u,Gather>(dst,stride,count,input,indices,SAttribSnorm<int16_t>{});
+			default:
+				break;
+		}
+		return false;
+	}
+
+	template<size_t ElementSize, bool Gather>
+	inline void copyAttributeSpan(const uint8_t* src, const size_t srcStride, uint8_t* dst, const size_t dstStride, const size_t count, const uint32_t* indices)
+	{
+		for (size_t i=0u; i<count; i++)
+			memcpy(dst+i*dstStride,src+attributeSpanOffset<Gather>(i,srcStride,indices),ElementSize);
+	}
+	template<bool Gather>
+	inline void copyAttributeSpan(const size_t elementSize, const uint8_t* src, const size_t srcStride, uint8_t* dst, const size_t dstStride, const size_t count, const uint32_t* indices)
+	{
+		// fixed size copies for the common attribute sizes
+		switch (elementSize)
+		{
+			case 4u: return copyAttributeSpan<4u,Gather>(src,srcStride,dst,dstStride,count,indices);
+			case 8u: return copyAttributeSpan<8u,Gather>(src,srcStride,dst,dstStride,count,indices);
+			case 12u: return copyAttributeSpan<12u,Gather>(src,srcStride,dst,dstStride,count,indices);
+			case 16u: return copyAttributeSpan<16u,Gather>(src,srcStride,dst,dstStride,count,indices);
+			default:
+				for (size_t i=0u; i<count; i++)
+					memcpy(dst+i*dstStride,src+attributeSpanOffset<Gather>(i,srcStride,indices),elementSize);
+				break;
+		}
+	}
+}
+
+//! Decodes `count` elements laid out `stride` bytes apart (or at `src+indices[i]*stride` if `indices` is not null) into 4 float channels.
+inline bool decodeAttributeSpan(const E_FORMAT format, const void* src, const size_t stride, const size_t count, float* const* output, const uint32_t* indices=nullptr)
+{
+	const auto* base = reinterpret_cast<const uint8_t*>(src);
+	if (indices)
+		return impl::decodeAttributeSpan<true>(format,base,stride,count,output,indices);
+	return impl::decodeAttributeSpan<false>(format,base,stride,count,output,indices);
+}
+
+//! Integer formats only, narrower integers get widened to 32bit.
+inline bool decodeAttributeSpan(const E_FORMAT format, const void* src, const size_t stride, const size_t count, uint32_t* const* output, const uint32_t* indices=nullptr)
+{
+	const auto* base = reinterpret_cast<const uint8_t*>(src);
+	if (indices)
+		return impl::decodeAttributeSpan<true>(format,base,stride,count,output,indices);
+	return impl::decodeAttributeSpan<false>(format,base,stride,count,output,indices);
+}
+
+//! Normalized values get clamped and rounded to nearest.
+inline bool encodeAttributeSpan(const E_FORMAT format, void* dst, const size_t stride, const size_t count, const float* const* input, const uint32_t* indices=nullptr)
+{
+	auto* base = reinterpret_cast<uint8_t*>(dst);
+	if (indices)
+		return impl::encodeAttributeSpan<true>(format,base,stride,count,input,indices);
+	return impl::encodeAttributeSpan<false>(format,base,stride,count,input,indices);
+}
+
+//! Copies `count` elements of `elementSize` bytes from `src` (laid out like in `decodeAttributeSpan`) to `dstStride` bytes apart in `dst` without any conversion, so any format works.
+inline void copyAttributeSpan(const size_t elementSize, const void* src, const size_t srcStride, void* dst, const size_t dstStride, const size_t count, const uint32_t* indices=nullptr)
+{
+	const auto* srcBase = reinterpret_cast<const uint8_t*>(src);
+	auto* dstBase = reinterpret_cast<uint8_t*>(dst);
+	if (indices)
+		return impl::copyAttributeSpan<true>(elementSize,srcBase,srcStride,dstBase,dstStride,count,indices);
+	return impl::copyAttributeSpan<false>(elementSize,srcBase,srcStride,dstBase,dstStride,count,indices);
+}
+
+}
+#endif
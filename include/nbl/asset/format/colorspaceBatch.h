@@ -0,0 +1,579 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_FORMAT_COLORSPACE_BATCH_H_INCLUDED_
+#define _NBL_ASSET_FORMAT_COLORSPACE_BATCH_H_INCLUDED_
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "nbl/core/math/floatpacket.h"
+#include "nbl/core/math/colorutil.h"
+#include "nbl/asset/format/EColorSpace.h"
+
+//! CPU batch colour transfer functions and gamut conversions
+/*
+	Ports of `builtin/hlsl/colorspace` for converting whole images or rows on the CPU. Every transfer function has a kernel in
+	`colorspace::kernel` templated on the packet type, the batch functions run them 16 wide with AVX-512, 8 wide with AVX2 and
+	finish the remainder with the `float` instantiation which defers to the standard library and is the reference implementation.
+
+	The packet kernels are built on the polynomial `packet::exp2`, `packet::log2` and `packet::pow`. Measured against the same formulas
+	evaluated in double precision over the [0,1] input range (and [-2,64] for the extended range sRGB) the max relative errors are:
+	- sRGB encode 3 ulp, decode 7 ulp
+	- Rec.709/Rec.2020 (SMPTE 170M) encode 6 ulp, decode 9 ulp
+	- Gamma 2.2 encode 4 ulp, decode 10 ulp, DCI-P3 encode 3 ulp, decode 24 ulp
+	- HLG encode 2 ulp, decode 5 ulp
+	- PQ (SMPTE ST 2084) 1.2e-5 encode and 2.3e-5 decode, the steep `x^78.84375` costs precision but it's still 1/20 of a 12 bit code
+	- ACEScc and ACEScct encode 6.1e-8 absolute, decode 11 ulp
+	Most of that is the float rounding of the exponents (`2.4f` is not 2.4), the polynomials themselves are accurate to 1-2 ulp.
+
+	8 bit sRGB has dedicated table driven paths which are exact, decoding is a 256 entry table and encoding rounds to the nearest code
+	using a table of the rounding thresholds bucketed by the top bits of the float (so a single lookup and compare per channel).
+*/
+namespace nbl::asset::colorspace
+{
+namespace packet = core::packet;
+
+namespace kernel
+{
+
+//! Linear to nonlinear, `x` is normalized so that 1 is the reference white (10000 nits for PQ)
+namespace oetf
+{
+
+template<typename P>
+inline P identity(const P x) { return x; }
+
+//! Mirrored for negative values, so it works for scRGB too
+template<typename P>
+inline P sRGB(const P x)
+{
+	const P absX = packet::abs(x);
+	const P encoded = packet::select(absX>P(0.0031308f),packet::madd(packet::pow(absX,P(1.f/2.4f)),P(1.055f),P(-0.055f)),absX*P(12.92f));
+	return packet::select(x<P(0.f),-encoded,encoded);
+}
+
+template<typename P>
+inline P DCI_P3_XYZ(const P x)
+{
+	return packet::pow(x*P(1.f/52.37f),P(1.f/2.6f));
+}
+
+//! Rec.709 and Rec.2020, with the continuous constants the shaders use
+template<typename P>
+inline P SMPTE_170M(const P x)
+{
+	constexpr float Alpha = 1.099296826809443f;
+	return packet::select(x>=P(0.018053968510808f),packet::madd(packet::pow(x,P(0.45f)),P(Alpha),P(1.f-Alpha)),x*P(4.5f));
+}
+
+template<typename P>
+inline P SMPTE_ST2084(const P x)
+{
+	constexpr float c2 = 18.8515625f;
+	constexpr float c3 = 18.6875f;
+	const P Lm1 = packet::pow(x,P(0.1593017578125f));
+	return packet::pow(packet::madd(Lm1,P(c2),P(c3-c2+1.f))/packet::madd(Lm1,P(c3),P(1.f)),P(78.84375f));
+}
+
+template<typename P>
+inline P HDR10_HLG(const P x)
+{
+	return packet::select(x>P(1.f/12.f),packet::madd(packet::log2(x-P(0.02372241f)),P(0.1239574303172f),P(1.0042934693729f)),packet::sqrt(x*P(3.f)));
+}
+
+template<typename P>
+inline P Gamma_2_2(const P x)
+{
+	return packet::pow(x,P(1.f/2.2f));
+}
+
+template<typename P>
+inline P ACEScc(const P x)
+{
+	// log2 of 2^-16 for negative values, a linear segment up to 2^-15
+	const P small = packet::madd(packet::max(x,P(0.f)),P(0.5f),P(0.0000152587890625f));
+	const P logArg = packet::select(x>=P(0.000030517578125f),x,small);
+	return (packet::log2(logArg)+P(9.72f))*P(1.f/17.52f);
+}
+
+template<typename P>
+inline P ACEScct(const P x)
+{
+	return packet::select(x>P(0.0078125f),(packet::log2(x)+P(9.72f))*P(1.f/17.52f),packet::madd(x,P(10.5402377416545f),P(0.0729055341958355f)));
+}
+
+}
+
+//! Nonlinear to linear, inverses of the `oetf` kernels
+namespace eotf
+{
+
+template<typename P>
+inline P identity(const P x) { return x; }
+
+template<typename P>
+inline P sRGB(const P x)
+{
+	const P absX = packet::abs(x);
+	const P decoded = packet::select(absX>P(0.04045f),packet::pow((absX+P(0.055f))*P(1.f/1.055f),P(2.4f)),absX*P(1.f/12.92f));
+	return packet::select(x<P(0.f),-decoded,decoded);
+}
+
+template<typename P>
+inline P DCI_P3_XYZ(const P x)
+{
+	return packet::pow(x*P(52.37f),P(2.6f));
+}
+
+template<typename P>
+inline P SMPTE_170M(const P x)
+{
+	constexpr float Alpha = 1.099296826809443f;
+	return packet::select(x>=P(0.081242858298635f),packet::pow((x+P(Alpha-1.f))*P(1.f/Alpha),P(1.f/0.45f)),x*P(1.f/4.5f));
+}
+
+template<typename P>
+inline P SMPTE_ST2084(const P x)
+{
+	constexpr float c2 = 18.8515625f;
+	constexpr float c3 = 18.6875f;
+	const P common = packet::pow(x,P(1.f/78.84375f));
+	return packet::pow(packet::max(common-P(c3-c2+1.f),P(0.f))/packet::madd(common,P(-c3),P(c2)),P(1.f/0.1593017578125f));
+}
+
+template<typename P>
+inline P HDR10_HLG(const P x)
+{
+	return packet::select(x>P(0.5f),packet::exp2((x-P(1.0042934693729f))*P(1.f/0.1239574303172f))+P(0.02372241f),x*x*P(1.f/3.f));
+}
+
+template<typename P>
+inline P Gamma_2_2(const P x)
+{
+	return packet::pow(x,P(2.2f));
+}
+
+//! clamped to the largest half float, like the ACES reference
+template<typename P>
+inline P ACEScc(const P x)
+{
+	const P common = packet::exp2(packet::madd(x,P(17.52f),P(-9.72f)));
+	return packet::min(packet::select(x>=P(-0.301369863f),common,packet::madd(common,P(2.f),P(-0.000030517578125f))),P(65504.f));
+}
+
+template<typename P>
+inline P ACEScct(const P x)
+{
+	const P common = packet::exp2(packet::madd(x,P(17.52f),P(-9.72f)));
+	return packet::min(packet::select(x>=P(0.155251141552511f),common,(x-P(0.0729055341958355f))*P(1.f/10.5402377416545f)),P(65504.f));
+}
+
+}
+
+// lane `i` of a packet loaded from `AlphaLanes+(i&3)` is set when float `i` of interleaved RGBA data is the alpha
+inline constexpr float AlphaLanes[16u+3u] = {
+	0.f,0.f,0.f,1.f, 0.f,0.f,0.f,1.f, 0.f,0.f,0.f,1.f, 0.f,0.f,0.f,1.f, 0.f,0.f,0.f
+};
+
+//! Applies `f` to every float, or every float but the alpha when `channels==4`
+template<typename F>
+inline void transform(const float* in, float* out, const size_t texelCount, const uint32_t channels, F&& f)
+{
+	const size_t count = texelCount*channels;
+	if (channels!=4u)
+	{
+		packet::dispatch(count,[&]<typename P>(const size_t i) -> void
+		{
+			packet::store(out+i,f(packet::load<P>(in+i)));
+		});
+		return;
+	}
+	packet::dispatch(count,[&]<typename P>(const size_t i) -> void
+	{
+		const P x = packet::load<P>(in+i);
+		packet::store(out+i,packet::select(packet::load<P>(AlphaLanes+(i&3u))>P(0.f),x,f(x)));
+	});
+}
+
+}
+
+//! Applies the OETF (linear to nonlinear) to `texelCount` texels of `channels` interleaved floats, a 4th channel is alpha and stays linear.
+//! `in` and `out` can alias, returns false for `OETF_UNKNOWN`.
+inline bool encode(const OPTICO_ELECTRICAL_TRANSFER_FUNCTION oetf, const float* in, float* out, const size_t texelCount, const uint32_t channels=1u)
+{
+	switch (oetf)
+	{
+		case OETF_IDENTITY:
+			if (in!=out)
+				std::memmove(out,in,sizeof(float)*texelCount*channels);
+			return true;
+		case OETF_sRGB:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::sRGB(x);});
+			return true;
+		case OETF_DCI_P3_XYZ:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::DCI_P3_XYZ(x);});
+			return true;
+		case OETF_SMPTE_170M:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::SMPTE_170M(x);});
+			return true;
+		case OETF_SMPTE_ST2084:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::SMPTE_ST2084(x);});
+			return true;
+		case OETF_HDR10_HLG:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::HDR10_HLG(x);});
+			return true;
+		case OETF_GAMMA_2_2:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::Gamma_2_2(x);});
+			return true;
+		case OETF_ACEScc:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::ACEScc(x);});
+			return true;
+		case OETF_ACEScct:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::oetf::ACEScct(x);});
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+//! Applies the EOTF (nonlinear to linear), same layout rules as `encode`
+inline bool decode(const ELECTRO_OPTICAL_TRANSFER_FUNCTION eotf, const float* in, float* out, const size_t texelCount, const uint32_t channels=1u)
+{
+	switch (eotf)
+	{
+		case EOTF_IDENTITY:
+			if (in!=out)
+				std::memmove(out,in,sizeof(float)*texelCount*channels);
+			return true;
+		case EOTF_sRGB:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::sRGB(x);});
+			return true;
+		case EOTF_DCI_P3_XYZ:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::DCI_P3_XYZ(x);});
+			return true;
+		case EOTF_SMPTE_170M:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::SMPTE_170M(x);});
+			return true;
+		case EOTF_SMPTE_ST2084:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::SMPTE_ST2084(x);});
+			return true;
+		case EOTF_HDR10_HLG:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::HDR10_HLG(x);});
+			return true;
+		case EOTF_GAMMA_2_2:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::Gamma_2_2(x);});
+			return true;
+		case EOTF_ACEScc:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::ACEScc(x);});
+			return true;
+		case EOTF_ACEScct:
+			kernel::transform(in,out,texelCount,channels,[](const auto x) {return kernel::eotf::ACEScct(x);});
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+
+//! Linear 3x3 transform between colour primaries, `out[r] = sum(m[r][c]*in[c])`
+/*
+	Goes through CIE XYZ with the matrices of `builtin/hlsl/colorspace/encodeCIEXYZ.hlsl`, without chromatic adaptation (like the shaders),
+	kept in double precision until applied so chains of conversions don't accumulate float error.
+*/
+struct SGamutMatrix
+{
+	double m[3][3];
+
+	static inline SGamutMatrix identity()
+	{
+		return {{{1.0,0.0,0.0},{0.0,1.0,0.0},{0.0,0.0,1.0}}};
+	}
+
+	//! RGB of the given primaries to CIE XYZ, `ECP_PASS_THROUGH` and `ECP_DCI_P3` (whose data is XYZ already) give the identity
+	static inline SGamutMatrix toXYZ(const E_COLOR_PRIMARIES primaries)
+	{
+		switch (primaries)
+		{
+			case ECP_SRGB:
+				return {{{0.412391,0.357584,0.180481},{0.212639,0.715169,0.072192},{0.019331,0.119195,0.950532}}};
+			case ECP_DISPLAY_P3:
+				return {{{0.4865709486,0.2656676932,0.1982172852},{0.2289745641,0.6917385218,0.0792869141},{0.0,0.0451133819,1.0439443689}}};
+			case ECP_BT2020:
+				return {{{0.636958,0.144617,0.168881},{0.262700,0.677998,0.059302},{0.0,0.028073,1.060985}}};
+			case ECP_ADOBERGB:
+				return {{{0.5766690429,0.1855582379,0.1882286462},{0.2973449753,0.6273635663,0.0752914585},{0.0270313614,0.0706888525,0.9913375368}}};
+			case ECP_ACES:
+				return {{{0.9525523959,0.0,0.0000936786},{0.3439664498,0.7281660966,-0.0721325464},{0.0,0.0,1.0088251844}}};
+			case ECP_ACES_CC_T:
+				return {{{0.6624541811,0.1340042065,0.1561876870},{0.2722287168,0.6740817658,0.0536895174},{-0.0055746495,0.0040607335,1.0103391003}}};
+			default:
+				break;
+		}
+		return identity();
+	}
+	static inline SGamutMatrix fromXYZ(const E_COLOR_PRIMARIES primaries)
+	{
+		return toXYZ(primaries).inverse();
+	}
+	//! Converts linear RGB with `from` primaries to linear RGB with `to` primaries
+	static inline SGamutMatrix conversion(const E_COLOR_PRIMARIES from, const E_COLOR_PRIMARIES to)
+	{
+		if (from==to)
+			return identity();
+		return fromXYZ(to)*toXYZ(from);
+	}
+
+	inline SGamutMatrix operator*(const SGamutMatrix& other) const
+	{
+		SGamutMatrix retval;
+		for (auto r=0u; r<3u; r++)
+		for (auto c=0u; c<3u; c++)
+			retval.m[r][c] = m[r][0]*other.m[0][c]+m[r][1]*other.m[1][c]+m[r][2]*other.m[2][c];
+		return retval;
+	}
+	inline SGamutMatrix inverse() const
+	{
+		SGamutMatrix retval;
+		// adjugate over the determinant
+		for (auto r=0u; r<3u; r++)
+		for (auto c=0u; c<3u; c++)
+		{
+			const uint32_t r0 = (c+1u)%3u, r1 = (c+2u)%3u;
+			const uint32_t c0 = (r+1u)%3u, c1 = (r+2u)%3u;
+			retval.m[r][c] = m[r0][c0]*m[r1][c1]-m[r0][c1]*m[r1][c0];
+		}
+		const double det = m[0][0]*retval.m[0][0]+m[0][1]*retval.m[1][0]+m[0][2]*retval.m[2][0];
+		for (auto& row : retval.m)
+		for (auto& e : row)
+			e /= det;
+		return retval;
+	}
+};
+
+//! Applies the gamut matrix to Structure-of-Arrays RGB, `in` and `out` can alias
+inline void applyGamut(const SGamutMatrix& matrix, const float* const in[3], float* const out[3], const size_t count)
+{
+	float m[3][3];
+	for (auto r=0u; r<3u; r++)
+	for (auto c=0u; c<3u; c++)
+		m[r][c] = static_cast<float>(matrix.m[r][c]);
+	packet::dispatch(count,[&]<typename P>(const size_t i) -> void
+	{
+		const P rgb[3] = {packet::load<P>(in[0]+i),packet::load<P>(in[1]+i),packet::load<P>(in[2]+i)};
+		for (auto r=0u; r<3u; r++)
+			packet::store(out[r]+i,packet::madd(rgb[0],P(m[r][0]),packet::madd(rgb[1],P(m[r][1]),rgb[2]*P(m[r][2]))));
+	});
+}
+
+//! Applies the gamut matrix to interleaved RGB (`channels==3`) or RGBA (`channels==4`) texels, alpha is left alone, `in` and `out` can alias
+inline void applyGamut(const SGamutMatrix& matrix, const float* in, float* out, const size_t texelCount, const uint32_t channels)
+{
+	// deinterleave a chunk at a time so the packets see SoA data and the chunk stays in L1
+	constexpr size_t ChunkTexels = 256u;
+	float soa[3][ChunkTexels];
+	float* const planes[3] = {soa[0],soa[1],soa[2]};
+	for (size_t base=0u; base<texelCount; base+=ChunkTexels)
+	{
+		const size_t count = std::min(texelCount-base,ChunkTexels);
+		const float* src = in+base*channels;
+		for (size_t t=0u; t<count; t++)
+		for (auto c=0u; c<3u; c++)
+			soa[c][t] = src[t*channels+c];
+		applyGamut(matrix,planes,planes,count);
+		float* dst = out+base*channels;
+		for (size_t t=0u; t<count; t++)
+		{
+			for (auto c=0u; c<3u; c++)
+				dst[t*channels+c] = soa[c][t];
+			if (channels==4u)
+				dst[t*channels+3u] = src[t*channels+3u];
+		}
+	}
+}
+
+
+namespace impl
+{
+struct SSRGB8Tables
+{
+	// linear inputs get clamped to [2^-13,1], everything below encodes to 0 and the clamp makes NaN encode to 0 as well
+	static inline constexpr uint32_t MinBits = 0x39000000u;
+	// 256 buckets per octave is fine enough to never have more than one threshold between two codes in a bucket
+	static inline constexpr uint32_t BucketShift = 15u;
+	// plus one for 1.0 itself
+	static inline constexpr uint32_t BucketCount = ((0x3f800000u-MinBits)>>BucketShift)+1u;
+
+	inline SSRGB8Tables()
+	{
+		for (uint32_t i=0u; i<256u; i++)
+		{
+			toLinear[i] = core::srgb2lin(i/255.);
+			toLinearFloat[i] = static_cast<float>(toLinear[i]);
+		}
+
+		// a float encodes to code `k+1` iff its at or above `thresholds[k]`
+		uint32_t thresholds[255];
+		// rounding to nearest needs the smallest float at or above the linear value halfway between two codes
+		for (uint32_t k=0u; k<255u; k++)
+		{
+			const double midpoint = core::srgb2lin((k+0.5)/255.);
+			float threshold = static_cast<float>(midpoint);
+			if (threshold<midpoint)
+				threshold = std::nextafter(threshold,2.f);
+			std::memcpy(thresholds+k,&threshold,sizeof(float));
+		}
+		fillBuckets(thresholds,fromLinear);
+		// rounding down uses the float closest to the code's linear value, so decoded values encode back to the same code
+		for (uint32_t k=0u; k<255u; k++)
+		{
+			const float threshold = static_cast<float>(core::srgb2lin((k+1u)/255.));
+			std::memcpy(thresholds+k,&threshold,sizeof(float));
+		}
+		fillBuckets(thresholds,fromLinearFloor);
+	}
+
+	// each entry holds the code of the bucket's first float and the low bits of the threshold in the bucket (or 0x8000 if there's none)
+	static inline void fillBuckets(const uint32_t thresholds[255], uint32_t* buckets)
+	{
+		uint32_t k = 0u;
+		for (uint32_t bucket=0u; bucket<BucketCount; bucket++)
+		{
+			const uint32_t first = MinBits+(bucket<<BucketShift);
+			while (k<255u && thresholds[k]<=first)
+				k++;
+			uint32_t entry = k<<16u;
+			if (k<255u && thresholds[k]<first+(0x1u<<BucketShift))
+			{
+				entry |= thresholds[k]-first;
+				assert(k+1u>=255u || thresholds[k+1u]>=first+(0x1u<<BucketShift));
+			}
+			else
+				entry |= 0x1u<<BucketShift;
+			buckets[bucket] = entry;
+		}
+	}
+
+	double toLinear[256];
+	float toLinearFloat[256];
+	uint32_t fromLinear[BucketCount];
+	uint32_t fromLinearFloor[BucketCount];
+};
+
+inline const SSRGB8Tables& getSRGB8Tables()
+{
+	static const SSRGB8Tables tables;
+	return tables;
+}
+
+inline uint32_t encodeSRGB8(const uint32_t* buckets, float x)
+{
+	constexpr float Min = 0x1p-13f;
+	if (!(x>Min))
+		x = Min;
+	if (x>1.f)
+		x = 1.f;
+	uint32_t bits;
+	std::memcpy(&bits,&x,sizeof(float));
+	const uint32_t entry = buckets[(bits-SSRGB8Tables::MinBits)>>SSRGB8Tables::BucketShift];
+	return (entry>>16u)+((bits&((0x1u<<SSRGB8Tables::BucketShift)-1u))>=(entry&0xffffu) ? 1u:0u);
+}
+
+#ifdef __NBL_COMPILE_WITH_AVX2_
+// 8 lanes of `encodeSRGB8` and `encodeUNORM8` picked by `alphaMask`, codes end up in the low byte of each 32bit lane
+inline __m256i encodeSRGB8(const uint32_t* buckets, const __m256 x, const __m256 alphaMask)
+{
+	// `max` returns the second operand for NaN
+	const __m256 clamped = _mm256_min_ps(_mm256_max_ps(x,_mm256_set1_ps(0x1p-13f)),_mm256_set1_ps(1.f));
+	const __m256i bits = _mm256_castps_si256(clamped);
+	const __m256i bucket = _mm256_srli_epi32(_mm256_sub_epi32(bits,_mm256_set1_epi32(SSRGB8Tables::MinBits)),SSRGB8Tables::BucketShift);
+	const __m256i entry = _mm256_i32gather_epi32(reinterpret_cast<const int*>(buckets),bucket,4);
+	// the compare is -1 while below the threshold
+	const __m256i below = _mm256_cmpgt_epi32(_mm256_and_si256(entry,_mm256_set1_epi32(0xffff)),_mm256_and_si256(bits,_mm256_set1_epi32((0x1u<<SSRGB8Tables::BucketShift)-1u)));
+	const __m256i srgb = _mm256_add_epi32(_mm256_add_epi32(_mm256_srli_epi32(entry,16),_mm256_set1_epi32(1)),below);
+
+	const __m256 alpha = _mm256_min_ps(_mm256_max_ps(x,_mm256_setzero_ps()),_mm256_set1_ps(1.f));
+	const __m256i linear = _mm256_cvtps_epi32(_mm256_mul_ps(alpha,_mm256_set1_ps(255.f)));
+	return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(srgb),_mm256_castsi256_ps(linear),alphaMask));
+}
+#endif
+
+// alpha is stored linearly, rounded to nearest even like the SIMD conversion
+inline uint32_t encodeUNORM8(float x)
+{
+	x = x>0.f ? x:0.f;
+	x = x<1.f ? x:1.f;
+	return static_cast<uint32_t>(std::nearbyint(x*255.f));
+}
+}
+
+//! Exactly the same as `core::srgb2lin(x/255.)` without the `pow`
+inline double decodeSRGB8(const uint8_t x)
+{
+	return impl::getSRGB8Tables().toLinear[x];
+}
+
+//! Linear to the nearest 8 bit sRGB code, clamps to [0,1] and encodes NaN as 0
+inline uint8_t encodeSRGB8(const float x)
+{
+	return static_cast<uint8_t>(impl::encodeSRGB8(impl::getSRGB8Tables().fromLinear,x));
+}
+
+//! Linear to 8 bit sRGB rounding down like the UNORM encodes of `encodePixels`, so dithering stays unbiased. Values decoded from a code
+//! encode back to it even after a roundtrip through float.
+inline uint8_t encodeSRGB8Floor(const float x)
+{
+	return static_cast<uint8_t>(impl::encodeSRGB8(impl::getSRGB8Tables().fromLinearFloor,x));
+}
+
+//! Decodes `texelCount` texels of `channels` interleaved 8 bit sRGB values to linear floats, a 4th channel is linear alpha
+inline void decodeSRGB8(const uint8_t* in, float* out, const size_t texelCount, const uint32_t channels)
+{
+	const auto& tables = impl::getSRGB8Tables();
+	const size_t count = texelCount*channels;
+	size_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	const __m256 alphaMask = channels==4u ? _mm256_cmp_ps(_mm256_loadu_ps(kernel::AlphaLanes),_mm256_setzero_ps(),_CMP_GT_OQ):_mm256_setzero_ps();
+	for (; i+8u<=count; i+=8u)
+	{
+		const __m256i codes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in+i)));
+		const __m256 linear = _mm256_i32gather_ps(tables.toLinearFloat,codes,4);
+		const __m256 alpha = _mm256_div_ps(_mm256_cvtepi32_ps(codes),_mm256_set1_ps(255.f));
+		_mm256_storeu_ps(out+i,_mm256_blendv_ps(linear,alpha,alphaMask));
+	}
+#endif
+	for (; i<count; i++)
+		out[i] = channels==4u && (i&3u)==3u ? float(in[i])/255.f:tables.toLinearFloat[in[i]];
+}
+
+//! Encodes `texelCount` texels of `channels` interleaved linear floats to the nearest 8 bit sRGB codes, a 4th channel is linear alpha
+inline void encodeSRGB8(const float* in, uint8_t* out, const size_t texelCount, const uint32_t channels)
+{
+	const auto& tables = impl::getSRGB8Tables();
+	const size_t count = texelCount*channels;
+	size_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	const __m256 alphaMask = channels==4u ? _mm256_cmp_ps(_mm256_loadu_ps(kernel::AlphaLanes),_mm256_setzero_ps(),_CMP_GT_OQ):_mm256_setzero_ps();
+	for (; i+32u<=count; i+=32u)
+	{
+		const __m256i codes[4] = {
+			impl::encodeSRGB8(tables.fromLinear,_mm256_loadu_ps(in+i),alphaMask),
+			impl::encodeSRGB8(tables.fromLinear,_mm256_loadu_ps(in+i+8u),alphaMask),
+			impl::encodeSRGB8(tables.fromLinear,_mm256_loadu_ps(in+i+16u),alphaMask),
+			impl::encodeSRGB8(tables.fromLinear,_mm256_loadu_ps(in+i+24u),alphaMask)
+		};
+		// the packs interleave the 128bit lanes, the permute puts the dwords back in order
+		const __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(codes[0],codes[1]),_mm256_packus_epi32(codes[2],codes[3]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out+i),_mm256_permutevar8x32_epi32(bytes,_mm256_setr_epi32(0,4,1,5,2,6,3,7)));
+	}
+#endif
+	for (; i<count; i++)
+		out[i] = static_cast<uint8_t>(channels==4u && (i&3u)==3u ? impl::encodeUNORM8(in[i]):impl::encodeSRGB8(tables.fromLinear,in[i]));
+}
+
+}
+
+#endif
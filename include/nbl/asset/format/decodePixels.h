@@ -11,6 +11,7 @@
 #include "nbl/core/declarations.h"
 #include "nbl/asset/format/EFormat.h"
 #include "nbl/core/math/colorutil.h"
+#include "nbl/asset/format/colorspaceBatch.h"
 
 namespace nbl
 {
@@ -960,42 +961,42 @@ namespace asset
     inline void decodePixels<asset::EF_R8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint8_t& pix = reinterpret_cast<const uint8_t*>(_pix[0])[0];
-        _output[0] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
     }
 
     template<>
     inline void decodePixels<asset::EF_R8G8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint16_t& pix = reinterpret_cast<const uint16_t*>(_pix[0])[0];
-        _output[0] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
-        _output[1] = core::srgb2lin(((pix >> 8) & 0xffULL) / 255.);
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
+        _output[1] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 8));
     }
 
     template<>
     inline void decodePixels<asset::EF_R8G8B8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint32_t& pix = reinterpret_cast<const uint32_t*>(_pix[0])[0];
-        _output[0] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
-        _output[1] = core::srgb2lin(((pix >> 8) & 0xffULL) / 255.);
-        _output[2] = core::srgb2lin(((pix >> 16) & 0xffULL) / 255.);
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
+        _output[1] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 8));
+        _output[2] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 16));
     }
 
     template<>
     inline void decodePixels<asset::EF_B8G8R8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint32_t& pix = reinterpret_cast<const uint32_t*>(_pix[0])[0];
-        _output[2] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
-        _output[1] = core::srgb2lin(((pix >> 8) & 0xffULL) / 255.);
-        _output[0] = core::srgb2lin(((pix >> 16) & 0xffULL) / 255.);
+        _output[2] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
+        _output[1] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 8));
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 16));
     }
 
     template<>
     inline void decodePixels<asset::EF_R8G8B8A8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint32_t& pix = reinterpret_cast<const uint32_t*>(_pix[0])[0];
-        _output[0] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
-        _output[1] = core::srgb2lin(((pix >> 8) & 0xffULL) / 255.);
-        _output[2] = core::srgb2lin(((pix >> 16) & 0xffULL) / 255.);
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
+        _output[1] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 8));
+        _output[2] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 16));
         _output[3] = ((pix >> 24) & 0xffULL) / 255.;
     }
 
@@ -1003,9 +1004,9 @@ namespace asset
     inline void decodePixels<asset::EF_B8G8R8A8_SRGB, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint32_t& pix = reinterpret_cast<const uint32_t*>(_pix[0])[0];
-        _output[2] = core::srgb2lin(((pix >> 0) & 0xffULL) / 255.);
-        _output[1] = core::srgb2lin(((pix >> 8) & 0xffULL) / 255.);
-        _output[0] = core::srgb2lin(((pix >> 16) & 0xffULL) / 255.);
+        _output[2] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 0));
+        _output[1] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 8));
+        _output[0] = colorspace::decodeSRGB8(static_cast<uint8_t>(pix >> 16));
         _output[3] = ((pix >> 24) & 0xffULL) / 255.;
     }
 
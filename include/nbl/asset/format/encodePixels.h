@@ -10,6 +10,7 @@
 
 #include "nbl/core/declarations.h"
 #include "nbl/asset/format/EFormat.h"
+#include "nbl/asset/format/colorspaceBatch.h"
 
 namespace nbl
 {
@@ -2211,11 +2212,7 @@ namespace asset
         {
             const uint8_t mask = 0xffULL;
             pix &= (~(mask << 0));
-            double inp = _input[0];
-            if (inp <= 0.0031308) inp *= 12.92;
-            else inp = 1.055 * pow(inp, 1. / 2.4) - 0.055;
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 0);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]))) << 0);
         }
 
     }
@@ -2227,20 +2224,12 @@ namespace asset
         {
             const uint16_t mask = 0xffULL;
             pix &= (~(mask << 0));
-            double inp = _input[0];
-            if (inp <= 0.0031308) inp *= 12.92;
-            else inp = 1.055 * pow(inp, 1. / 2.4) - 0.055;
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 0);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]))) << 0);
         }
         {
             const uint16_t mask = 0xffULL;
             pix &= (~(mask << 8));
-            double inp = _input[1];
-            if (inp <= 0.0031308) inp *= 12.92;
-            else inp = 1.055 * pow(inp, 1. / 2.4) - 0.055;
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 8);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[1]))) << 8);
         }
 
     }
@@ -2250,19 +2239,13 @@ namespace asset
     {
         uint8_t* pix = reinterpret_cast<uint8_t*>(_pix);
         {
-            double inp = core::lin2srgb(_input[0]);
-            inp *= 255.;
-            pix[0] = static_cast<uint8_t>(inp);
+            pix[0] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]));
         }
         {
-            double inp = core::lin2srgb(_input[1]);
-            inp *= 255.;
-            pix[1] = static_cast<uint8_t>(inp);
+            pix[1] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[1]));
         }
         {
-            double inp = core::lin2srgb(_input[2]);
-            inp *= 255.;
-            pix[2] = static_cast<uint8_t>(inp);
+            pix[2] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[2]));
         }
     }
 
@@ -2271,19 +2254,13 @@ namespace asset
     {
         uint8_t* pix = reinterpret_cast<uint8_t*>(_pix);
         {
-            double inp = core::lin2srgb(_input[2]);
-            inp *= 255.;
-            pix[0] = static_cast<uint8_t>(inp);
+            pix[0] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[2]));
         }
         {
-            double inp = core::lin2srgb(_input[1]);
-            inp *= 255.;
-            pix[1] = static_cast<uint8_t>(inp);
+            pix[1] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[1]));
         }
         {
-            double inp = core::lin2srgb(_input[0]);
-            inp *= 255.;
-            pix[2] = static_cast<uint8_t>(inp);
+            pix[2] = colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]));
         }
     }
 
@@ -2294,23 +2271,17 @@ namespace asset
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 0));
-            double inp = core::lin2srgb(_input[0]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 0);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]))) << 0);
         }
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 8));
-            double inp = core::lin2srgb(_input[1]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 8);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[1]))) << 8);
         }
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 16));
-            double inp = core::lin2srgb(_input[2]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 16);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[2]))) << 16);
         }
         {
             const uint32_t mask = 0xffULL;
@@ -2327,23 +2298,17 @@ namespace asset
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 0));
-            double inp = core::lin2srgb(_input[2]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 0);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[2]))) << 0);
         }
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 8));
-            double inp = core::lin2srgb(_input[1]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 8);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[1]))) << 8);
         }
         {
             const uint32_t mask = 0xffULL;
             pix &= (~(mask << 16));
-            double inp = core::lin2srgb(_input[0]);
-            inp *= 255.;
-            pix |= ((uint64_t(inp) & mask) << 16);
+            pix |= (uint64_t(colorspace::encodeSRGB8Floor(static_cast<float>(_input[0]))) << 16);
         }
         {
             const uint32_t mask = 0xffULL;
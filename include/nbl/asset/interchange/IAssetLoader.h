@@ -94,6 +94,22 @@ public:
 
     struct SAssetLoadParams
     {
+		//! Lets image loaders decode less than the whole image, e.g. a thumbnail or a tile of some mip level.
+		/** Loaders do it natively where the format allows (JPEG DCT scaling, EXR scanline ranges, stored mip chains),
+		otherwise the image gets decoded whole and then cropped and box filtered down. Other loaders ignore it.
+		The asset cache is keyed by path alone, so `IAssetManager` neither looks partial loads up in it nor inserts them, regardless of the caching flags. */
+		struct SImageDecodeParams
+		{
+			inline bool hasRegion() const {return extent[0]!=0u && extent[1]!=0u;}
+			inline bool isWholeImage() const {return mipLevel==0u && !hasRegion();}
+
+			//! how many times to halve the resolution, formats with mip chains skip their top levels and keep the rest of the chain
+			uint32_t mipLevel = 0u;
+			//! rectangle in texels of `mipLevel` which gets clamped to the level, zero width or height means all of it (only that one level is kept)
+			uint32_t offset[2] = {0u,0u};
+			uint32_t extent[2] = {0u,0u};
+		};
+
 		SAssetLoadParams(size_t _decryptionKeyLen = 0u, const uint8_t* _decryptionKey = nullptr,
 			E_CACHING_FLAGS _cacheFlags = ECF_CACHE_EVERYTHING,const E_LOADER_PARAMETER_FLAGS& _loaderFlags = ELPF_NONE, 
 			system::logger_opt_ptr _logger = nullptr, const std::filesystem::path& cwd = "") :
@@ -110,6 +126,7 @@ public:
 			loaderFlags(rhs.loaderFlags),
 			meshManipulatorOverride(rhs.meshManipulatorOverride),
 			restoreLevels(rhs.restoreLevels),
+			imageDecode(rhs.imageDecode),
 			logger(rhs.logger),
 			workingDirectory(rhs.workingDirectory),
 			reload(_reload)
@@ -122,6 +139,7 @@ public:
         E_LOADER_PARAMETER_FLAGS loaderFlags;				//!< Flags having an impact on extraordinary tasks during loading process
 		IMeshManipulator* meshManipulatorOverride = nullptr;    //!< pointer used for specifying custom mesh manipulator to use, if nullptr - default mesh manipulator will be used
 		uint32_t restoreLevels = 0u;
+		SImageDecodeParams imageDecode = {};
 		const bool reload = false;
 		std::filesystem::path workingDirectory = "";
 		system::logger_opt_ptr logger;
@@ -17,6 +17,28 @@ namespace nbl::asset
 class IImageLoader : public IAssetLoader, public IImageAssetHandlerBase
 {
 	public:
+		using SImageDecodeParams = SAssetLoadParams::SImageDecodeParams;
+
+		//! What a loader decoded natively, so that `applyDecodeParams` knows what is left to do
+		struct SDecodedRegion
+		{
+			//! full resolution extent of the image in the file
+			uint32_t fullExtent[2];
+			//! how many times the loader already halved the resolution
+			uint32_t mipLevel = 0u;
+			//! where the first texel of the decoded image lies, in texels of `mipLevel`
+			uint32_t offset[2] = {0u,0u};
+		};
+
+		//! Clamps the requested rectangle to level `params.mipLevel` of an image of `fullExtent`, returns false if nothing is left of it
+		static bool getDecodeRect(const SImageDecodeParams& params, const uint32_t fullExtent[2], uint32_t outOffset[2], uint32_t outExtent[2]);
+
+		//! The decode-and-blit fallback, crops and box filters the single level 2D image `decoded` into what `params` asked for.
+		/** Returns `decoded` itself when there is nothing left to do and nullptr when the request can't be satisfied. Scaling of
+		block compressed formats is not possible, neither is cropping them, they only ever get their stored levels dropped natively. */
+		static core::smart_refctd_ptr<ICPUImage> applyDecodeParams(core::smart_refctd_ptr<ICPUImage>&& decoded, const SImageDecodeParams& params, const SDecodedRegion& region, const system::logger_opt_ptr logger);
+		//! Same for loaders which return views of images with stored mip chains, after they dropped the levels they could, only single layer 2D views get cropped or scaled further.
+		static core::smart_refctd_ptr<ICPUImageView> applyDecodeParamsToView(core::smart_refctd_ptr<ICPUImageView>&& decoded, const SImageDecodeParams& params, const SDecodedRegion& region, const system::logger_opt_ptr logger);
 
 	protected:
 
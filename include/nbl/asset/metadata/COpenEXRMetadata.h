@@ -32,6 +32,23 @@ class COpenEXRMetadata final : public IAssetMetadata
                 std::string m_name;
         };
 
+        //! Compression of the chunks written by `CImageWriterOpenEXR`, every chunk gets compressed as a separate task on OpenEXR's thread pool
+        enum E_COMPRESSION : uint8_t
+        {
+            EC_NONE,
+            //! lossless, 16 scanlines per chunk, the default
+            EC_ZIP,
+            //! lossless wavelet, 32 scanlines per chunk, best on noisy images
+            EC_PIZ,
+            //! lossy DCT for `half` channels, 32 scanlines per chunk, `float` and `uint` channels stay lossless
+            EC_DWAA
+        };
+        //! Pass a pointer to this as `IAssetWriter::SAssetWriteParams::userData` when writing .exr files, nullptr means the defaults
+        struct SWriteParams
+        {
+            E_COMPRESSION compression = EC_ZIP;
+        };
+
         COpenEXRMetadata(uint32_t imageCount) : IAssetMetadata(), m_metaStorage(createContainer<CImage>(imageCount))
         {
         }
@@ -11,6 +11,7 @@
 
 namespace nbl::asset
 {
+	// All methods are const and safe to call from multiple threads at once, the HLSL compiler keeps a pool of DXC instances internally
 	class NBL_API2 CCompilerSet : public core::IReferenceCounted
 	{
 	public:
@@ -19,8 +20,14 @@ namespace nbl::asset
 #ifdef _NBL_PLATFORM_WINDOWS_
 			m_HLSLCompiler(core::make_smart_refctd_ptr<CHLSLCompiler>(core::smart_refctd_ptr(sys))),
 #endif
-			m_GLSLCompiler(core::make_smart_refctd_ptr<CGLSLCompiler>(core::smart_refctd_ptr(sys)))
-		{}
+			m_GLSLCompiler(core::make_smart_refctd_ptr<CGLSLCompiler>(core::smart_refctd_ptr(sys))),
+			m_blobPool(core::make_smart_refctd_ptr<CShaderBlobPool>())
+		{
+#ifdef _NBL_PLATFORM_WINDOWS_
+			m_HLSLCompiler->setBlobPool(core::smart_refctd_ptr(m_blobPool));
+#endif
+			m_GLSLCompiler->setBlobPool(core::smart_refctd_ptr(m_blobPool));
+		}
 
 		core::smart_refctd_ptr<ICPUShader> compileToSPIRV(const asset::ICPUShader* shader, const IShaderCompiler::SCompilerOptions& options) const;
 
@@ -41,12 +48,16 @@ namespace nbl::asset
 				return nullptr;
 		}
 
+		//! Shared by both compilers and the shader loaders of the owning asset manager, query its statistics to see how much deduplication saves
+		inline CShaderBlobPool* getBlobPool() const { return m_blobPool.get(); }
+
 	protected:
 
 #ifdef _NBL_PLATFORM_WINDOWS_
 		core::smart_refctd_ptr<CHLSLCompiler> m_HLSLCompiler = nullptr;
 #endif
 		core::smart_refctd_ptr<CGLSLCompiler> m_GLSLCompiler = nullptr;
+		core::smart_refctd_ptr<CShaderBlobPool> m_blobPool = nullptr;
 	};
 }
 
@@ -10,7 +10,7 @@ namespace nbl::asset
 {
 
 //! `isotropicNormalization` makes filter to use max value of all channels for normalization instead of per-channel max
-class CDerivativeMapCreator
+class NBL_API2 CDerivativeMapCreator
 {
 	public:
 		CDerivativeMapCreator() = delete;
@@ -22,11 +22,30 @@ class CDerivativeMapCreator
 		static core::smart_refctd_ptr<asset::ICPUImageView> createDerivativeMapViewFromHeightMap(asset::ICPUImage* _inImg, asset::ISampler::E_TEXTURE_CLAMP _uwrap, asset::ISampler::E_TEXTURE_CLAMP _vwrap, asset::ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor);
 
 		//! Normalization is always done per-layer
+		//! and always isotropic, `isotropicNormalization==false` only makes it write the (equal) factor for both channels
 		template<bool isotropicNormalization>
 		static core::smart_refctd_ptr<asset::ICPUImage> createDerivativeMapFromNormalMap(asset::ICPUImage* _inImg, float* out_normalizationFactor);
 		template<bool isotropicNormalization>
 		static core::smart_refctd_ptr<asset::ICPUImageView> createDerivativeMapViewFromNormalMap(asset::ICPUImage* _inImg, float* out_normalizationFactor);
 
+		//! Fused variants which produce the derivative map together with `mipLevels` levels of its 2x2 box filtered mip chain, 0 means the full chain.
+		/*
+			The image is processed in parallel in 64x64 tiles, each tile computes its derivatives and reduces them down to its 1x1 mip in scratch memory,
+			the few levels coarser than a tile get reduced from the tiles' last level. The first traversal only finds the max of each level (per tile, then
+			reduced across tiles), the second recomputes the tiles and writes every level out already normalized, so the unnormalized derivatives never
+			get stored at full resolution.
+
+			`out_normalizationFactors` receives the factor(s) of every level, level 0 first, so it needs room for `(isotropicNormalization ? 1:2)*levelCount`
+			floats, where `levelCount` is `mipLevels` clamped to `IImage::calculateFullMipPyramidLevelCount`. Averaging can't grow the magnitudes, so by default
+			all levels get normalized with the factors of level 0, which keeps the chain usable with a single scale and trilinear filtering.
+			`perMipNormalization` normalizes each level with its own max instead, for better precision of the coarse levels when the scales get passed per level.
+			Height maps differentiate with the same sampled Gaussian derivative as `createDerivativeMapFromHeightMap`.
+		*/
+		template<bool isotropicNormalization>
+		static core::smart_refctd_ptr<asset::ICPUImage> createDerivativeMipChainFromHeightMap(asset::ICPUImage* _inImg, asset::ISampler::E_TEXTURE_CLAMP _uwrap, asset::ISampler::E_TEXTURE_CLAMP _vwrap, asset::ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactors, const uint32_t mipLevels=0u, const bool perMipNormalization=false);
+		template<bool isotropicNormalization>
+		static core::smart_refctd_ptr<asset::ICPUImage> createDerivativeMipChainFromNormalMap(asset::ICPUImage* _inImg, float* out_normalizationFactors, const uint32_t mipLevels=0u, const bool perMipNormalization=false);
+
 	private:
 		static inline asset::E_FORMAT getRGformat(asset::E_FORMAT f)
 		{
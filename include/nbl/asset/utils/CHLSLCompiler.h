@@ -11,10 +11,12 @@
 
 
 #ifdef _NBL_PLATFORM_WINDOWS_
+// DXC only gets wrapped on Windows so far, code that needs `CHLSLCompiler` should check this rather than the platform
+#define _NBL_COMPILE_WITH_HLSL_COMPILER_
 
 namespace nbl::asset::impl
 {
-	class DXC;
+	class DXCPool;
 }
 
 namespace nbl::asset
@@ -66,11 +68,15 @@ class NBL_API2 CHLSLCompiler final : public IShaderCompiler
 			L"-fspv-target-env=vulkan1.3"
 		};
 		constexpr static inline uint32_t RequiredArgumentCount = sizeof(RequiredArguments) / sizeof(RequiredArguments[0]);
+
+		// DXC instances are not safe for concurrent use, so every `compileToSPIRV` borrows one from an internal pool for its duration.
+		// Instances get created lazily, so this is effectively the peak number of threads that have compiled concurrently so far.
+		uint32_t getDXCInstanceCount() const;
 		
 	protected:
 		// This can't be a unique_ptr due to it being an undefined type 
 		// when Nabla is used as a lib
-		nbl::asset::impl::DXC* m_dxcCompilerTypes;
+		nbl::asset::impl::DXCPool* m_dxcPool;
 
 		static CHLSLCompiler::SOptions option_cast(const IShaderCompiler::SCompilerOptions& options)
 		{
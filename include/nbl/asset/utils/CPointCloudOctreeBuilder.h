@@ -0,0 +1,100 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_POINT_CLOUD_OCTREE_BUILDER_H_INCLUDED_
+#define _NBL_ASSET_C_POINT_CLOUD_OCTREE_BUILDER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include "nbl/asset/ICPUMeshBuffer.h"
+
+namespace nbl::asset
+{
+
+//! Builds a level of detail octree over a point list `ICPUMeshBuffer`, reordering its vertices so every node owns a contiguous range
+/*
+	All points get sorted along a Morton curve through the cube around the cloud, then the octree is built one level at a time.
+	Every inner node keeps an evenly strided subset of at most `SParams::maxPointsPerNode` of the points in its cell as its
+	representatives and hands the rest down to its children, leaves keep everything that is left. Because the points of a cell
+	are Morton sorted, the strided subset is spatially uniform, rendering the representatives of a node approximates its whole subtree.
+
+	The nodes are stored breadth first and their points are laid out in node order in every vertex binding, so:
+	- the points of one node are a single contiguous range which can be read from a file tile or uploaded to a GPU buffer as is,
+	- all points of the levels up to some depth are a prefix of the vertex data, i.e. cutting the buffer short gives a coarser LOD.
+
+	Each level is processed in parallel over its points, a build touches the data `O(depth)` times. Points are indexed with 32 bits,
+	so larger scans should be split into tiles with a build per tile.
+*/
+class NBL_API2 CPointCloudOctreeBuilder final
+{
+	public:
+		//! Octree keys get quantized to this many bits per axis, which is also the deepest an octree can get
+		static inline constexpr uint32_t MaxDepth = 16u;
+
+		struct SParams
+		{
+			//! representatives per inner node and capacity of a leaf, the granularity at which the cloud gets streamed
+			uint32_t maxPointsPerNode = 0x4000u;
+			//! nodes at this depth become leaves no matter how many points they hold (e.g. coincident points), clamped to `MaxDepth`
+			uint32_t maxDepth = MaxDepth;
+		};
+
+		//! 32 bytes with no padding, the node table can be written out or uploaded (std430) as is
+		struct SNode
+		{
+			//! the cell is the cube `[cellMin,cellMin+cellSize]`, its subtree can't have points outside of it
+			float cellMin[3];
+			float cellSize;
+			//! first vertex and vertex count of the node's own points in the reordered meshbuffer
+			uint32_t pointOffset;
+			uint32_t pointCount;
+			//! children are stored consecutively, one per set bit of `childMask` in octant order (octant bit 0 is X, 1 is Y, 2 is Z)
+			uint32_t firstChild;
+			uint8_t childMask;
+			uint8_t depth;
+			uint16_t reserved;
+
+			inline bool isLeaf() const {return childMask==0u;}
+			//! index of the node covering `octant` of this one's cell, or `~0u` if there are no points in it
+			inline uint32_t getChild(const uint32_t octant) const
+			{
+				if (!(childMask&(0x1u<<octant)))
+					return ~0u;
+				return firstChild+hlsl::bitCount(static_cast<uint32_t>(childMask)&((0x1u<<octant)-1u));
+			}
+		};
+		static_assert(sizeof(SNode)==32u);
+
+		struct SResult
+		{
+			//! non-indexed point list, nullptr on failure
+			core::smart_refctd_ptr<ICPUMeshBuffer> meshbuffer;
+			//! breadth first, the root is node 0
+			core::vector<SNode> nodes;
+			//! nodes of depth `d` are `[levelOffsets[d],levelOffsets[d+1])`, the last entry is the node count
+			core::vector<uint32_t> levelOffsets;
+
+			//! number of leading points which make up all the levels up to and including `depth`
+			inline uint32_t getPointCountUpToDepth(const uint32_t depth) const
+			{
+				if (!meshbuffer || levelOffsets.empty())
+					return 0u;
+				if (depth+1u>=levelOffsets.size()-1u)
+					return meshbuffer->getIndexCount();
+				return nodes[levelOffsets[depth+1u]].pointOffset;
+			}
+		};
+
+		//! `inbuffer` needs to be a point list with a position attribute, every vertex up to `IMeshManipulator::upperBoundVertexID` is a point.
+		static SResult build(const ICPUMeshBuffer* inbuffer, const SParams& params={});
+
+		//! Byte range of the node's points in the given vertex binding of the built meshbuffer, ready to be used as a file or upload region.
+		static inline std::pair<size_t,size_t> getPointRange(const ICPUMeshBuffer* meshbuffer, const SNode& node, const uint32_t binding)
+		{
+			const size_t stride = meshbuffer->getPipeline()->getCachedCreationParams().vertexInput.bindings[binding].stride;
+			return {meshbuffer->getVertexBufferBindings()[binding].offset+stride*node.pointOffset,stride*node.pointCount};
+		}
+};
+
+}
+#endif
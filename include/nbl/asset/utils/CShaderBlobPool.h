@@ -0,0 +1,127 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_SHADER_BLOB_POOL_H_INCLUDED_
+#define _NBL_ASSET_C_SHADER_BLOB_POOL_H_INCLUDED_
+
+#include <mutex>
+
+#include "nbl/core/declarations.h"
+#include "nbl/system/IFile.h"
+
+#include "nbl/asset/ICPUBuffer.h"
+
+namespace nbl::asset
+{
+
+//! Interning pool for shader source and SPIR-V blobs
+/*
+	Every blob handed out by the pool is an immutable `ICPUBuffer` which is shared by all shaders with byte-identical code,
+	so permutations which compile down to the same SPIR-V or loads of the same source only keep a single copy alive.
+
+	A pooled blob does not own its memory directly, it aliases the storage of a "backing" object it keeps a reference to,
+	this lets the pool adopt compiler outputs without a copy and wrap read-only mapped files (builtin archives, mmapped files) zero-copy.
+	Because of the latter, high level source obtained from the pool is NOT guaranteed to be null-terminated, use `ICPUShader::getSourceView`.
+
+	Blobs nobody but the pool references anymore get dropped automatically whenever the pool has doubled in size since the last trim,
+	so the cost is amortized over the inserts and the pool only outgrows the live set by a constant factor.
+
+	All methods are safe to call from multiple threads at once.
+*/
+class NBL_API2 CShaderBlobPool final : public core::IReferenceCounted
+{
+	public:
+		struct SStatistics
+		{
+			//! number of `intern` calls that produced a blob
+			uint64_t internRequests = 0ull;
+			//! requests which were satisfied by a blob already in the pool
+			uint64_t hits = 0ull;
+			//! blobs currently held by the pool and their total size
+			uint64_t uniqueBlobs = 0ull;
+			uint64_t uniqueBytes = 0ull;
+			//! bytes which would have been held in duplicate copies without interning
+			uint64_t bytesDeduplicated = 0ull;
+			//! blobs currently held by the pool which alias a mapped file instead of owning a copy
+			uint64_t zeroCopyBlobs = 0ull;
+		};
+
+		CShaderBlobPool() = default;
+
+		//! Returns the pooled blob with contents identical to `blob`, if there is none then `blob` gets adopted (without a copy).
+		core::smart_refctd_ptr<ICPUBuffer> intern(core::smart_refctd_ptr<ICPUBuffer>&& blob);
+
+		//! Only copies `data` if there is no identical blob in the pool yet.
+		core::smart_refctd_ptr<ICPUBuffer> intern(const void* data, const size_t size);
+
+		//! Wraps the whole contents of a read-only mapped file without copying, the blob keeps the file (and its mapping) alive.
+		//! Returns nullptr if the file is not mapped or the mapping is writable (contents could change under the pool).
+		core::smart_refctd_ptr<ICPUBuffer> intern(core::smart_refctd_ptr<system::IFile>&& file);
+
+		//! Zero-copy if the file has a read-only mapping, otherwise reads the file and interns the contents.
+		core::smart_refctd_ptr<ICPUBuffer> load(system::IFile* file);
+
+		//! Drops the blobs which are not referenced by anything but the pool right away, returns the number of bytes released.
+		size_t trim();
+
+		SStatistics getStatistics() const;
+
+		inline bool isPooled(const ICPUBuffer* blob) const
+		{
+			return blob && dynamic_cast<const CBlob*>(blob);
+		}
+
+	protected:
+		~CShaderBlobPool() = default;
+
+		class CBlob final : public ICPUBuffer
+		{
+			public:
+				CBlob(core::smart_refctd_ptr<const core::IReferenceCounted>&& backing, const void* contents, const size_t size, const uint64_t hash, const bool zeroCopy)
+					: ICPUBuffer(size,const_cast<void*>(contents)), m_backing(std::move(backing)), m_hash(hash), m_zeroCopy(zeroCopy)
+				{
+					// pooled blobs are shared between unrelated shaders, nobody may write to them or turn them into dummies
+					m_mutability = EM_IMMUTABLE;
+				}
+
+				inline uint64_t getHash() const { return m_hash; }
+				inline bool isZeroCopy() const { return m_zeroCopy; }
+
+			protected:
+				~CBlob()
+				{
+					freeData();
+				}
+
+				inline void freeData() override
+				{
+					// memory belongs to the backing object
+					data = nullptr;
+					m_creationParams.size = 0ull;
+					m_backing = nullptr;
+				}
+
+			private:
+				core::smart_refctd_ptr<const core::IReferenceCounted> m_backing;
+				const uint64_t m_hash;
+				const bool m_zeroCopy;
+		};
+
+		static uint64_t hash(const void* data, const size_t size);
+
+		// must be called with the lock held
+		CBlob* find_impl(const uint64_t hash, const void* data, const size_t size) const;
+		core::smart_refctd_ptr<ICPUBuffer> insert_impl(core::smart_refctd_ptr<CBlob>&& blob);
+		size_t trim_impl();
+
+		// don't bother trimming tiny pools
+		constexpr static inline size_t MinTrimThreshold = 64u;
+
+		mutable std::mutex m_mutex;
+		core::unordered_multimap<uint64_t,core::smart_refctd_ptr<CBlob>> m_blobs;
+		size_t m_trimThreshold = MinTrimThreshold;
+		SStatistics m_stats = {};
+};
+
+}
+#endif
@@ -0,0 +1,160 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_STREAMING_MESH_PIPELINE_H_INCLUDED_
+#define _NBL_ASSET_C_STREAMING_MESH_PIPELINE_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/system/IFile.h"
+
+#include "nbl/asset/ICPUMeshBuffer.h"
+
+namespace nbl::asset
+{
+
+//! Out-of-core processing of triangle meshes which are too big to ever be held in memory as a whole `ICPUMeshBuffer`
+/*
+	The input index and vertex data are read a chunk of triangles at a time from files (ideally mapped ones, then nothing but
+	the referenced pages get touched), every chunk becomes a small self-contained `ICPUMeshBuffer` holding only the vertices
+	its triangles reference, goes through the chain of stages and gets appended to the output files before the next chunk is read.
+	Peak memory is therefore bounded by the chunk size and not by the mesh size.
+
+	Chunks are clusters of consecutive input triangles, vertices shared between triangles of different chunks are duplicated
+	in the output, and every stage only ever sees a single chunk, so welding, normal smoothing and cache optimization
+	are local to the cluster. For best results the input triangles should already be in some spatially coherent order.
+
+	The output is a triangle list with 32bit indices and a single interleaved vertex binding, the layout of which is
+	the layout of the processed chunks. All chunks must come out of the stages with the same layout.
+*/
+class NBL_API2 CStreamingMeshPipeline final : public core::IReferenceCounted
+{
+	public:
+		//! `meshbuffer` is always a triangle list with 32bit indices and all attributes interleaved in vertex binding 0
+		struct SChunk
+		{
+			core::smart_refctd_ptr<ICPUMeshBuffer> meshbuffer;
+			//! first triangle of the chunk in the input
+			uint64_t firstTriangle = 0ull;
+		};
+
+		class IStage : public core::IReferenceCounted
+		{
+			public:
+				//! Free to replace `chunk.meshbuffer` altogether, returning false aborts the whole pipeline.
+				virtual bool process(SChunk& chunk) = 0;
+
+			protected:
+				virtual ~IStage() = default;
+		};
+
+		struct SInput
+		{
+			//! Binding 0 of the vertex input params describes the layout of `vertices`, must be a triangle list.
+			const ICPURenderpassIndependentPipeline* pipeline = nullptr;
+			system::IFile* vertices = nullptr;
+			size_t vertexOffset = 0ull;
+			uint64_t vertexCount = 0ull;
+			system::IFile* indices = nullptr;
+			size_t indexOffset = 0ull;
+			uint64_t indexCount = 0ull;
+			E_INDEX_TYPE indexType = EIT_32BIT;
+			//! get set on every chunk's meshbuffer
+			uint32_t positionAttributeIx = 0u;
+			uint32_t normalAttributeIx = 3u;
+		};
+		struct SOutput
+		{
+			//! both files need to be writable, data gets written starting at the offsets
+			system::IFile* vertices = nullptr;
+			size_t vertexOffset = 0ull;
+			system::IFile* indices = nullptr;
+			size_t indexOffset = 0ull;
+		};
+		struct SResult
+		{
+			//! vertex input params of binding 0 describe the output layout, nullptr if the pipeline failed
+			core::smart_refctd_ptr<ICPURenderpassIndependentPipeline> pipeline;
+			uint64_t vertexCount = 0ull;
+			uint64_t indexCount = 0ull;
+			uint64_t chunkCount = 0ull;
+			//! largest vertex and index data of a single chunk as read from the input
+			size_t maxChunkBytes = 0ull;
+		};
+
+		//! Welds vertices within a chunk whose data is bit-for-bit identical
+		class NBL_API2 CWeldStage final : public IStage
+		{
+			public:
+				bool process(SChunk& chunk) override;
+		};
+
+		//! Converts the attributes to the given formats, `EF_UNKNOWN` entries keep their current format
+		class NBL_API2 CRequantizeStage final : public IStage
+		{
+			public:
+				CRequantizeStage(const E_FORMAT (&formats)[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT])
+				{
+					std::copy_n(formats,ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT,m_formats);
+				}
+
+				bool process(SChunk& chunk) override;
+
+			private:
+				E_FORMAT m_formats[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT];
+				core::smart_refctd_ptr<ICPURenderpassIndependentPipeline> m_pipeline;
+		};
+
+		//! Area weighted smooth normals into the meshbuffer's normal attribute, which gets added with `format` if missing
+		class NBL_API2 CNormalStage final : public IStage
+		{
+			public:
+				CNormalStage(const E_FORMAT format=EF_A2B10G10R10_SNORM_PACK32) : m_format(format) {}
+
+				bool process(SChunk& chunk) override;
+
+			private:
+				const E_FORMAT m_format;
+				core::smart_refctd_ptr<ICPURenderpassIndependentPipeline> m_pipeline;
+		};
+
+		//! Accumulates the bounding box of everything that passed through it, also sets the bounding box of every chunk
+		class NBL_API2 CBoundsStage final : public IStage
+		{
+			public:
+				bool process(SChunk& chunk) override;
+
+				inline const core::aabbox3df& getBoundingBox() const {return m_aabb;}
+
+			private:
+				core::aabbox3df m_aabb = core::aabbox3df(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+		};
+
+		//! Forsyth triangle reordering followed by reordering the vertices in order of first use, within the chunk
+		class NBL_API2 CCacheOptimizationStage final : public IStage
+		{
+			public:
+				bool process(SChunk& chunk) override;
+		};
+
+		CStreamingMeshPipeline() = default;
+
+		inline void addStage(core::smart_refctd_ptr<IStage>&& stage)
+		{
+			if (stage)
+				m_stages.push_back(std::move(stage));
+		}
+
+		//! Processes the whole input, `trianglesPerChunk` is the knob for the peak memory use
+		SResult run(const SInput& input, const SOutput& output, const uint32_t trianglesPerChunk=0x10000u, system::logger_opt_ptr logger=nullptr) const;
+
+	protected:
+		~CStreamingMeshPipeline() = default;
+
+		//! Repacks the chunk's vertices into the given formats (`EF_UNKNOWN` disables an attribute), `pipeline` gets created on first use and reused after.
+		static core::smart_refctd_ptr<ICPUMeshBuffer> relayout(const ICPUMeshBuffer* chunk, const E_FORMAT* formats, core::smart_refctd_ptr<ICPURenderpassIndependentPipeline>& pipeline);
+
+		core::vector<core::smart_refctd_ptr<IStage>> m_stages;
+};
+
+}
+#endif
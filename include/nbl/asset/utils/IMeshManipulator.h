@@ -7,8 +7,11 @@
 
 #include <array>
 #include <functional>
+#include <numeric>
 
 #include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+#include "nbl/core/math/floatpacket.h"
 #include "vector3d.h"
 #include "aabbox3d.h"
 
@@ -353,6 +356,17 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 		static float DistanceToPlane(core::vectorSIMDf InPoint, core::vectorSIMDf PlanePoint, core::vectorSIMDf PlaneNormal);
 		static core::matrix3x4SIMD calculateOBB(const nbl::asset::ICPUMeshBuffer* meshbuffer);
 
+		enum E_BOUNDING_BOX_MODE : uint8_t
+		{
+			//! bounds of exactly the vertices referenced by the index buffer, indices past the end of the vertex buffers and restart indices are skipped
+			EBBM_EXACT,
+			//! Bounds of every vertex up to the largest index other than the restart index, reduced directly on the stored (possibly quantized) position values.
+			/** Skips the index gather and per-vertex decode, so its meant for very large point clouds and scans.
+			The box is conservative but can be larger than the exact one if some vertices are not referenced by the index buffer.
+			Falls back to `EBBM_EXACT` when joint AABBs are requested or the position format has no quantized kernel (e.g. half floats). */
+			EBBM_QUANTIZED
+		};
+
 		//! Calculates bounding box of the meshbuffer
 		static inline core::aabbox3df calculateBoundingBox(
 			const ICPUMeshBuffer* meshbuffer, core::aabbox3df* outJointAABBs=nullptr,
@@ -360,7 +374,21 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 			E_INDEX_TYPE indexTypeOverride=static_cast<E_INDEX_TYPE>(~0u)
 		)
 		{
-			core::aabbox3df aabb(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+			return calculateBoundingBox(core::execution::seq,meshbuffer,outJointAABBs,EBBM_EXACT,indexCountOverride,indexBufferOverride,indexTypeOverride);
+		}
+
+		//! Calculates bounding box of the meshbuffer with the vertices split into batches, which get processed according to the execution policy
+		/** Every batch reduces into its own partial AABB and partial joint AABBs which get merged at the end, so the result does not depend on the policy.
+		Meshbuffers too small to be worth splitting are processed as a single batch. */
+		template<class ExecutionPolicy>
+		static inline core::aabbox3df calculateBoundingBox(
+			ExecutionPolicy&& policy, const ICPUMeshBuffer* meshbuffer, core::aabbox3df* outJointAABBs=nullptr,
+			const E_BOUNDING_BOX_MODE mode=EBBM_EXACT, uint32_t indexCountOverride=0u, const void* indexBufferOverride=nullptr,
+			E_INDEX_TYPE indexTypeOverride=static_cast<E_INDEX_TYPE>(~0u)
+		)
+		{
+			const core::aabbox3df emptyAABB(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+			core::aabbox3df aabb = emptyAABB;
 			if (!meshbuffer->getPipeline())
 				return aabb;
 			
@@ -370,83 +398,81 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 				return aabb;
 			
 			const bool computeJointAABBs = outJointAABBs&&meshbuffer->isSkinned();
-			if (computeJointAABBs)
-			for (auto i=0u; i<meshbuffer->getJointCount(); i++)
+			const uint32_t jointCount = computeJointAABBs ? meshbuffer->getJointCount():0u;
+			for (auto i=0u; i<jointCount; i++)
 				outJointAABBs[i] = aabb;
 
 			if (indexCountOverride==0u)
 				indexCountOverride = meshbuffer->getIndexCount();
-			auto impl = [meshbuffer,computeJointAABBs,&aabb,indexCountOverride](const auto* indexPtr, auto* jointAABBs) -> void
-			{
-				const uint32_t jointCount = meshbuffer->getJointCount();
-				const auto jointIDAttr = meshbuffer->getJointIDAttributeIx();
-				const auto jointWeightAttrId = meshbuffer->getJointWeightAttributeIx();
-				const auto maxInfluences = core::min(meshbuffer->deduceMaxJointsPerVertex(), meshbuffer->getMaxJointsPerVertex());
-				const uint32_t maxWeights = computeJointAABBs ? getFormatChannelCount(meshbuffer->getAttribFormat(jointWeightAttrId)):0u;
-				const auto* inverseBindPoses = meshbuffer->getInverseBindPoses();
-
-				for (uint32_t j=0u; j<indexCountOverride; j++)
-				{
-					uint32_t ix;
-					if constexpr (std::is_void_v<std::remove_pointer_t<decltype(indexPtr)>>)
-						ix = j;
-					else
-						ix = indexPtr[j];
-					const auto pos = meshbuffer->getPosition(ix);
-
-					bool noJointInfluence = true;
-					if constexpr (!std::is_void_v<std::remove_pointer_t<decltype(jointAABBs)>>)
-					{
-						uint32_t jointIDs[4u];
-						meshbuffer->getAttribute(jointIDs,jointIDAttr,ix);
-						core::vectorSIMDf weights;
-						meshbuffer->getAttribute(weights,jointWeightAttrId,ix);
-						float weightRemainder = 1.f;
-						for (auto i=0u; i<maxInfluences; i++)
-						{
-							const auto jointID = jointIDs[i];
-							if (jointID<jointCount)
-							if ((i<maxWeights ? weights[i]:weightRemainder)>FLT_MIN)
-							{
-								core::vectorSIMDf boneSpacePos;
-								inverseBindPoses[jointID].transformVect(boneSpacePos,pos);
-								jointAABBs[jointID].addInternalPoint(boneSpacePos.getAsVector3df());
-								noJointInfluence = false;
-							}
-							weightRemainder -= weights[i];
-						}
-					}
-					
-					if (noJointInfluence)
-						aabb.addInternalPoint(pos.getAsVector3df());
-				}
-			};
-
 			if (!indexBufferOverride)
 				indexBufferOverride = meshbuffer->getIndices();
 			if (indexTypeOverride>EIT_UNKNOWN)
 				indexTypeOverride = meshbuffer->getIndexType();
-			void* void_null = nullptr;
-			switch (indexTypeOverride)
+			if (!indexBufferOverride)
+				indexTypeOverride = EIT_UNKNOWN;
+
+			// in quantized mode we run over the vertices themselves instead of the indices
+			uint32_t itemCount = indexCountOverride;
+			const bool quantized = mode==EBBM_QUANTIZED && !computeJointAABBs && hasQuantizedBoundingBoxKernel(meshbuffer->getAttribFormat(posAttrId));
+			if (quantized)
 			{
-				case EIT_32BIT:
-					if (computeJointAABBs)
-						impl(reinterpret_cast<const uint32_t*>(indexBufferOverride),outJointAABBs);
-					else
-						impl(reinterpret_cast<const uint32_t*>(indexBufferOverride),void_null);
-					break;
-				case EIT_16BIT:
-					if (computeJointAABBs)
-						impl(reinterpret_cast<const uint16_t*>(indexBufferOverride),outJointAABBs);
-					else
-						impl(reinterpret_cast<const uint16_t*>(indexBufferOverride),void_null);
-					break;
-				default:
-					if (computeJointAABBs)
-						impl(void_null,outJointAABBs);
-					else
-						impl(void_null,void_null);
-					break;
+				// the restart index is the largest value of the index type and doesn't reference a vertex
+				const bool restart = meshbuffer->getPipeline()->getCachedCreationParams().primitiveAssembly.primitiveRestartEnable;
+				auto countReferenced = [&]<typename IndexT>(const IndexT* indices) -> uint64_t
+				{
+					return std::transform_reduce(policy,indices,indices+indexCountOverride,0ull,
+						[](const uint64_t a, const uint64_t b) -> uint64_t {return core::max(a,b);},
+						[restart](const IndexT ix) -> uint64_t {return restart&&ix==std::numeric_limits<IndexT>::max() ? 0ull:(uint64_t(ix)+1ull);}
+					);
+				};
+				uint64_t vertexCount = indexCountOverride;
+				switch (indexTypeOverride)
+				{
+					case EIT_16BIT:
+						vertexCount = countReferenced(reinterpret_cast<const uint16_t*>(indexBufferOverride));
+						break;
+					case EIT_32BIT:
+						vertexCount = countReferenced(reinterpret_cast<const uint32_t*>(indexBufferOverride));
+						break;
+					default:
+						break;
+				}
+				// an index past the end of the buffer would make the whole batch it lands in unreadable
+				itemCount = static_cast<uint32_t>(core::min<uint64_t>(vertexCount,meshbuffer->getAttribSpanCapacity(posAttrId)));
+			}
+
+			// batches need to be big enough to amortize the scheduling and the partial joint AABBs
+			constexpr uint32_t MinBatchSize = 0x2000u;
+			const uint32_t maxBatchCount = core::parallel_batch_count<ExecutionPolicy>(itemCount,MinBatchSize);
+
+			// every batch gets its partial AABB followed by its partial joint AABBs
+			const uint32_t partialStride = jointCount+1u;
+			core::vector<core::aabbox3df> partials(size_t(maxBatchCount)*partialStride,emptyAABB);
+			const uint32_t batchCount = core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),itemCount,MinBatchSize,[&](const uint32_t batch, const uint32_t begin, const uint32_t end) -> void
+			{
+				core::aabbox3df* partial = partials.data()+size_t(batch)*partialStride;
+				if (quantized)
+					calculateBoundingBoxQuantized_impl(meshbuffer,begin,end,partial[0]);
+				else
+					calculateBoundingBox_impl(meshbuffer,indexBufferOverride,indexTypeOverride,begin,end,partial[0],computeJointAABBs ? (partial+1):nullptr);
+			});
+
+			// merging `addInternalBox` style would drag in the corners of empty partials
+			auto merge = [](core::aabbox3df& dst, const core::aabbox3df& src) -> void
+			{
+				dst.MinEdge.X = core::min(dst.MinEdge.X,src.MinEdge.X);
+				dst.MinEdge.Y = core::min(dst.MinEdge.Y,src.MinEdge.Y);
+				dst.MinEdge.Z = core::min(dst.MinEdge.Z,src.MinEdge.Z);
+				dst.MaxEdge.X = core::max(dst.MaxEdge.X,src.MaxEdge.X);
+				dst.MaxEdge.Y = core::max(dst.MaxEdge.Y,src.MaxEdge.Y);
+				dst.MaxEdge.Z = core::max(dst.MaxEdge.Z,src.MaxEdge.Z);
+			};
+			for (uint32_t batch=0u; batch<batchCount; batch++)
+			{
+				const core::aabbox3df* partial = partials.data()+size_t(batch)*partialStride;
+				merge(aabb,partial[0]);
+				for (auto i=0u; i<jointCount; i++)
+					merge(outJointAABBs[i],partial[i+1u]);
 			}
 			return aabb;
 		}
@@ -456,17 +482,22 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 		{
 			meshbuffer->setBoundingBox(calculateBoundingBox(meshbuffer,meshbuffer->getJointAABBs()));
 		}
+		template<class ExecutionPolicy>
+		static inline void recalculateBoundingBox(ExecutionPolicy&& policy, ICPUMeshBuffer* meshbuffer, const E_BOUNDING_BOX_MODE mode=EBBM_EXACT)
+		{
+			meshbuffer->setBoundingBox(calculateBoundingBox(std::forward<ExecutionPolicy>(policy),meshbuffer,meshbuffer->getJointAABBs(),mode));
+		}
 
 		//! Flips the direction of surfaces.
 		/** Changes backfacing triangles to frontfacing
-		triangles and vice versa.
+		triangles and vice versa. Meshes without an index buffer get their per vertex attributes reordered.
 		\param mesh Mesh on which the operation is performed. */
 		static void flipSurfaces(ICPUMeshBuffer* inbuffer);
 
 		//! Creates a copy of a mesh with all vertices unwelded
 		/** \param mesh Input mesh
 		\return Mesh consisting only of unique faces. All vertices
-		which were previously shared are now duplicated. */
+		which were previously shared are now duplicated, nullptr if an index points outside the vertex buffers. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer, bool _makeIndexBuf = false);
 
 		//
@@ -486,6 +517,17 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 		\return Mesh without redundant vertices. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferWelded(ICPUMeshBuffer *inbuffer, const SErrorMetric* errMetrics, const bool& optimIndexType = true, const bool& makeNewMesh = false);
 
+		//! Creates a copy of the meshbuffer with its vertices reordered along a space filling curve through their bounding box, indices get remapped to match.
+		/** Neighbouring vertices end up close in memory which helps vertex fetch, point cloud rendering and spatial queries. Per-vertex bindings get
+		repacked into new buffers (`baseVertex` becomes 0), per-instance bindings are left alone. Non-indexed meshbuffers that aren't point lists get a 32bit
+		index buffer so that their primitives survive the reordering.
+		@return A new meshbuffer or nullptr if there's no position attribute. */
+		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferSpatiallyOrdered(const ICPUMeshBuffer* inbuffer, const core::E_SPACE_FILLING_CURVE curve=core::ESFC_MORTON);
+
+		//! Creates a copy of the meshbuffer where new vertex `i` is old vertex `order[i]`, with the same rules as `createMeshBufferSpatiallyOrdered`.
+		/** `order` must be a permutation of `[0,upperBoundVertexID(inbuffer))`. */
+		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferWithVertexOrder(const ICPUMeshBuffer* inbuffer, const uint32_t* order);
+
 		//! Throws meshbuffer into full optimizing pipeline consisting of: vertices welding, z-buffer optimization, vertex cache optimization (Forsyth's algorithm), fetch optimization and attributes requantization. A new meshbuffer is created unless given meshbuffer doesn't own (getMeshDataAndFormat()==NULL) a data format descriptor.
 		/**@return A new meshbuffer or NULL if an error occured. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createOptimizedMeshBuffer(const ICPUMeshBuffer* inbuffer, const SErrorMetric* _errMetric);
@@ -687,6 +729,271 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 		//!
 		virtual CQuantNormalCache* getQuantNormalCache() = 0;
 		virtual CQuantQuaternionCache* getQuantQuaternionCache() = 0;
+
+	protected:
+		//! Min and max of a contiguous array of floats, folded into `minVal` and `maxVal`
+		static inline void reduceMinMax(const float* values, const uint32_t count, float& minVal, float& maxVal)
+		{
+			using P = core::packet::native;
+			constexpr uint32_t Width = core::packet::traits<P>::Width;
+			P minP(minVal), maxP(maxVal);
+			uint32_t i = 0u;
+			for (; i+Width<=count; i+=Width)
+			{
+				const P v = core::packet::load<P>(values+i);
+				minP = core::packet::min(minP,v);
+				maxP = core::packet::max(maxP,v);
+			}
+			minVal = core::packet::hmin(minP);
+			maxVal = core::packet::hmax(maxP);
+			for (; i<count; i++)
+			{
+				minVal = core::min(minVal,values[i]);
+				maxVal = core::max(maxVal,values[i]);
+			}
+		}
+
+		//! Per channel min and max of the stored values of a strided attribute array
+		template<typename T, uint32_t Channels>
+		static inline void reduceStoredMinMax(const uint8_t* src, const size_t stride, const uint32_t count, T* minVal, T* maxVal)
+		{
+			std::fill_n(minVal,Channels,std::numeric_limits<T>::max());
+			std::fill_n(maxVal,Channels,std::numeric_limits<T>::lowest());
+			uint32_t i = 0u;
+			using P = core::packet::native;
+			constexpr uint32_t Width = core::packet::traits<P>::Width;
+			if constexpr (std::is_same_v<T,float> && Width>1u)
+			if (stride==sizeof(float)*Channels)
+			{
+				// tightly packed, `Channels` packets hold `Width` whole vertices and lane `l` of packet `r` is always channel `(r*Width+l)%Channels`
+				const float* values = reinterpret_cast<const float*>(src);
+				P minP[Channels], maxP[Channels];
+				std::fill_n(minP,Channels,P(FLT_MAX));
+				std::fill_n(maxP,Channels,P(-FLT_MAX));
+				for (; i+Width<=count; i+=Width)
+				for (uint32_t r=0u; r<Channels; r++)
+				{
+					const P v = core::packet::load<P>(values+size_t(i)*Channels+r*Width);
+					minP[r] = core::packet::min(minP[r],v);
+					maxP[r] = core::packet::max(maxP[r],v);
+				}
+				float minLanes[Width], maxLanes[Width];
+				for (uint32_t r=0u; r<Channels; r++)
+				{
+					core::packet::store(minLanes,minP[r]);
+					core::packet::store(maxLanes,maxP[r]);
+					for (uint32_t l=0u; l<Width; l++)
+					{
+						const uint32_t c = (r*Width+l)%Channels;
+						minVal[c] = core::min(minVal[c],minLanes[l]);
+						maxVal[c] = core::max(maxVal[c],maxLanes[l]);
+					}
+				}
+			}
+			for (; i<count; i++)
+			{
+				const uint8_t* element = src+size_t(i)*stride;
+				for (uint32_t c=0u; c<Channels; c++)
+				{
+					T val;
+					memcpy(&val,element+c*sizeof(T),sizeof(T));
+					minVal[c] = core::min(minVal[c],val);
+					maxVal[c] = core::max(maxVal[c],val);
+				}
+			}
+		}
+
+		//! Calls `f(T{},std::integral_constant<uint32_t,Channels>{})` for position formats whose decode is monotonic in every stored channel
+		template<class F>
+		static inline bool visitQuantizedPositionFormat(const E_FORMAT format, F&& f)
+		{
+			using two_t = std::integral_constant<uint32_t,2u>;
+			using three_t = std::integral_constant<uint32_t,3u>;
+			using four_t = std::integral_constant<uint32_t,4u>;
+			switch (format)
+			{
+				case EF_R32G32_SFLOAT: f(float{},two_t{}); return true;
+				case EF_R32G32B32_SFLOAT: f(float{},three_t{}); return true;
+				case EF_R32G32B32A32_SFLOAT: f(float{},four_t{}); return true;
+				case EF_R8G8_UNORM: [[fallthrough]];
+				case EF_R8G8_USCALED: f(uint8_t{},two_t{}); return true;
+				case EF_R8G8B8_UNORM: [[fallthrough]];
+				case EF_R8G8B8_USCALED: f(uint8_t{},three_t{}); return true;
+				case EF_R8G8B8A8_UNORM: [[fallthrough]];
+				case EF_R8G8B8A8_USCALED: f(uint8_t{},four_t{}); return true;
+				case EF_R8G8_SNORM: [[fallthrough]];
+				case EF_R8G8_SSCALED: f(int8_t{},two_t{}); return true;
+				case EF_R8G8B8_SNORM: [[fallthrough]];
+				case EF_R8G8B8_SSCALED: f(int8_t{},three_t{}); return true;
+				case EF_R8G8B8A8_SNORM: [[fallthrough]];
+				case EF_R8G8B8A8_SSCALED: f(int8_t{},four_t{}); return true;
+				case EF_R16G16_UNORM: [[fallthrough]];
+				case EF_R16G16_USCALED: f(uint16_t{},two_t{}); return true;
+				case EF_R16G16B16_UNORM: [[fallthrough]];
+				case EF_R16G16B16_USCALED: f(uint16_t{},three_t{}); return true;
+				case EF_R16G16B16A16_UNORM: [[fallthrough]];
+				case EF_R16G16B16A16_USCALED: f(uint16_t{},four_t{}); return true;
+				case EF_R16G16_SNORM: [[fallthrough]];
+				case EF_R16G16_SSCALED: f(int16_t{},two_t{}); return true;
+				case EF_R16G16B16_SNORM: [[fallthrough]];
+				case EF_R16G16B16_SSCALED: f(int16_t{},three_t{}); return true;
+				case EF_R16G16B16A16_SNORM: [[fallthrough]];
+				case EF_R16G16B16A16_SSCALED: f(int16_t{},four_t{}); return true;
+				default:
+					break;
+			}
+			return false;
+		}
+		static inline bool hasQuantizedBoundingBoxKernel(const E_FORMAT format)
+		{
+			return visitQuantizedPositionFormat(format,[](auto,auto) -> void {});
+		}
+
+		//! `EBBM_QUANTIZED` reduction of vertices [begin,end)
+		static inline void calculateBoundingBoxQuantized_impl(const ICPUMeshBuffer* meshbuffer, const uint32_t begin, const uint32_t end, core::aabbox3df& aabb)
+		{
+			const auto posAttrId = meshbuffer->getPositionAttributeIx();
+			const E_FORMAT format = meshbuffer->getAttribFormat(posAttrId);
+			const size_t stride = meshbuffer->getAttribStride(posAttrId);
+			const uint8_t* src = meshbuffer->getAttribSpanPointer(posAttrId,end-1u);
+			if (!src)
+				return;
+			src += size_t(begin)*stride;
+
+			visitQuantizedPositionFormat(format,[&]<typename T, uint32_t Channels>(T, std::integral_constant<uint32_t,Channels>) -> void
+			{
+				T minVal[Channels], maxVal[Channels];
+				reduceStoredMinMax<T,Channels>(src,stride,end-begin,minVal,maxVal);
+				// decode is monotonic per channel, so only the extremes need decoding
+				core::vectorSIMDf minEdge(0.f,0.f,0.f,1.f), maxEdge(0.f,0.f,0.f,1.f);
+				ICPUMeshBuffer::getAttribute(minEdge,minVal,format);
+				ICPUMeshBuffer::getAttribute(maxEdge,maxVal,format);
+				aabb.addInternalPoint(minEdge.getAsVector3df());
+				aabb.addInternalPoint(maxEdge.getAsVector3df());
+			});
+		}
+
+		//! `EBBM_EXACT` reduction of the vertices referenced by indices [begin,end)
+		template<typename IndexT, bool Skinned>
+		static inline void calculateBoundingBox_impl(const ICPUMeshBuffer* meshbuffer, const IndexT* indexPtr, const uint32_t begin, const uint32_t end, core::aabbox3df& aabb, core::aabbox3df* jointAABBs)
+		{
+			constexpr bool Indexed = !std::is_void_v<IndexT>;
+			const auto posAttrId = meshbuffer->getPositionAttributeIx();
+			const uint32_t jointCount = meshbuffer->getJointCount();
+			const auto jointIDAttr = meshbuffer->getJointIDAttributeIx();
+			const auto jointWeightAttrId = meshbuffer->getJointWeightAttributeIx();
+			const auto maxInfluences = core::min(meshbuffer->deduceMaxJointsPerVertex(), meshbuffer->getMaxJointsPerVertex());
+			const uint32_t maxWeights = Skinned ? getFormatChannelCount(meshbuffer->getAttribFormat(jointWeightAttrId)):0u;
+			const auto* inverseBindPoses = meshbuffer->getInverseBindPoses();
+
+			// attributes get decoded a span at a time into SoA arrays, instead of vertex by vertex
+			constexpr uint32_t SpanSize = 256u;
+			uint32_t indices[SpanSize];
+			float positions[4][SpanSize];
+			// only the skinning transform needs the W component
+			float* const posChannels[4] = {positions[0],positions[1],positions[2],Skinned ? positions[3]:nullptr};
+			uint32_t jointIDs[4][SpanSize];
+			uint32_t* const jointIDChannels[4] = {jointIDs[0],jointIDs[1],jointIDs[2],jointIDs[3]};
+			float weights[4][SpanSize];
+			float* const weightChannels[4] = {weights[0],weights[1],weights[2],weights[3]};
+			// vertices past the end of their buffers get skipped one by one, so a single bad index doesn't cost the rest of its span
+			const auto clampCapacity = [](const size_t capacity) -> uint32_t {return static_cast<uint32_t>(core::min<size_t>(capacity,~0u));};
+			uint32_t vertexLimit = clampCapacity(meshbuffer->getAttribSpanCapacity(posAttrId));
+			// the restart index is the largest value of the index type, capping the limit below it filters it out too
+			if constexpr (Indexed)
+			if (meshbuffer->getPipeline()->getCachedCreationParams().primitiveAssembly.primitiveRestartEnable)
+				vertexLimit = core::min<uint32_t>(vertexLimit,std::numeric_limits<IndexT>::max());
+			const uint32_t jointLimit = Skinned ? core::min(clampCapacity(meshbuffer->getAttribSpanCapacity(jointIDAttr)),clampCapacity(meshbuffer->getAttribSpanCapacity(jointWeightAttrId))):0u;
+
+			for (uint32_t first=begin; first<end; first+=SpanSize)
+			{
+				uint32_t count = core::min(SpanSize,end-first);
+				if constexpr (Indexed)
+				{
+					uint32_t kept = 0u;
+					for (uint32_t j=0u; j<count; j++)
+					if (const uint32_t ix=indexPtr[first+j]; ix<vertexLimit)
+						indices[kept++] = ix;
+					count = kept;
+				}
+				else
+					count = first<vertexLimit ? core::min(count,vertexLimit-first):0u;
+				if (count==0u)
+					continue;
+				const bool hasPositions = Indexed ? meshbuffer->gatherAttributeSpan(posChannels,posAttrId,indices,count):meshbuffer->getAttributeSpan(posChannels,posAttrId,first,count);
+				if (!hasPositions)
+					continue;
+
+				if constexpr (Skinned)
+				{
+					// vertices whose joint data lies past the end of its buffers count as not skinned, they read vertex 0 in the meantime
+					uint32_t jointIndices[SpanSize];
+					for (uint32_t j=0u; j<count; j++)
+					{
+						const uint32_t ix = Indexed ? indices[j]:(first+j);
+						jointIndices[j] = ix<jointLimit ? ix:0u;
+					}
+					const bool hasJoints = jointLimit && meshbuffer->gatherAttributeSpan(jointIDChannels,jointIDAttr,jointIndices,count) && meshbuffer->gatherAttributeSpan(weightChannels,jointWeightAttrId,jointIndices,count);
+					for (uint32_t j=0u; j<count; j++)
+					{
+						const core::vectorSIMDf pos(positions[0][j],positions[1][j],positions[2][j],positions[3][j]);
+
+						bool noJointInfluence = true;
+						float weightRemainder = 1.f;
+						if (hasJoints && (Indexed ? indices[j]:(first+j))<jointLimit)
+						for (auto i=0u; i<maxInfluences; i++)
+						{
+							const auto jointID = jointIDs[i][j];
+							if (jointID<jointCount)
+							if ((i<maxWeights ? weights[i][j]:weightRemainder)>FLT_MIN)
+							{
+								core::vectorSIMDf boneSpacePos;
+								inverseBindPoses[jointID].transformVect(boneSpacePos,pos);
+								jointAABBs[jointID].addInternalPoint(boneSpacePos.getAsVector3df());
+								noJointInfluence = false;
+							}
+							weightRemainder -= weights[i][j];
+						}
+
+						if (noJointInfluence)
+							aabb.addInternalPoint(pos.getAsVector3df());
+					}
+				}
+				else
+				{
+					core::vector3df minEdge(aabb.MinEdge), maxEdge(aabb.MaxEdge);
+					reduceMinMax(positions[0],count,minEdge.X,maxEdge.X);
+					reduceMinMax(positions[1],count,minEdge.Y,maxEdge.Y);
+					reduceMinMax(positions[2],count,minEdge.Z,maxEdge.Z);
+					aabb.MinEdge = minEdge;
+					aabb.MaxEdge = maxEdge;
+				}
+			}
+		}
+		static inline void calculateBoundingBox_impl(const ICPUMeshBuffer* meshbuffer, const void* indices, const E_INDEX_TYPE indexType, const uint32_t begin, const uint32_t end, core::aabbox3df& aabb, core::aabbox3df* jointAABBs)
+		{
+			switch (indexType)
+			{
+				case EIT_32BIT:
+					if (jointAABBs)
+						calculateBoundingBox_impl<uint32_t,true>(meshbuffer,reinterpret_cast<const uint32_t*>(indices),begin,end,aabb,jointAABBs);
+					else
+						calculateBoundingBox_impl<uint32_t,false>(meshbuffer,reinterpret_cast<const uint32_t*>(indices),begin,end,aabb,jointAABBs);
+					break;
+				case EIT_16BIT:
+					if (jointAABBs)
+						calculateBoundingBox_impl<uint16_t,true>(meshbuffer,reinterpret_cast<const uint16_t*>(indices),begin,end,aabb,jointAABBs);
+					else
+						calculateBoundingBox_impl<uint16_t,false>(meshbuffer,reinterpret_cast<const uint16_t*>(indices),begin,end,aabb,jointAABBs);
+					break;
+				default:
+					if (jointAABBs)
+						calculateBoundingBox_impl<void,true>(meshbuffer,nullptr,begin,end,aabb,jointAABBs);
+					else
+						calculateBoundingBox_impl<void,false>(meshbuffer,nullptr,begin,end,aabb,jointAABBs);
+					break;
+			}
+		}
 };
 
 } // end namespace scene
@@ -12,6 +12,10 @@
 
 #include "nbl/asset/ICPUShader.h"
 #include "nbl/asset/utils/ISPIRVOptimizer.h"
+#include "nbl/asset/utils/CShaderBlobPool.h"
+
+#include <mutex>
+#include <shared_mutex>
 
 namespace nbl::asset
 {
@@ -86,6 +90,34 @@ class NBL_API2 IShaderCompiler : public core::IReferenceCounted
 
 				void addGenerator(const core::smart_refctd_ptr<IIncludeGenerator>& generator);
 
+				// The preprocessor's tokens of an include, defined by the preprocessor itself
+				struct SLexedTokens;
+				// An include which has been resolved and loaded once, and then analyzed so that the preprocessor can skip repeated inclusions
+				// without re-reading or re-lexing the file.
+				struct SCachedInclude
+				{
+					system::path absolutePath = {};
+					std::string contents = {};
+					// name of the macro if the whole file is enclosed in `#ifndef GUARD` or `#if !defined(GUARD)` ... `#endif`, empty otherwise
+					std::string guardMacro = {};
+					// whether the file contains an unconditional `#pragma once`
+					bool pragmaOnce = false;
+					// set for files on disk, the entry gets reloaded once either of these changes
+					bool onDisk = false;
+					std::filesystem::file_time_type lastWriteTime = {};
+					uintmax_t fileSize = 0ull;
+					// `contents` lexed by the first translation unit to include the file, null if lexing failed
+					mutable std::once_flag lexOnce;
+					mutable std::shared_ptr<const SLexedTokens> lexed;
+				};
+				// Same as `getIncludeStandard` (if `standard` is true) or `getIncludeRelative`, but memoizes both the path resolution and the loaded contents.
+				// Files on disk get reloaded when their modification time or size changes. Safe to call from multiple threads at once,
+				// returns nullptr if the include cannot be found.
+				std::shared_ptr<const SCachedInclude> getCachedInclude(const system::path& requestingSourceDir, const std::string& includeName, const bool standard) const;
+
+				// Needs to be called if includes could now resolve to different files (other than by adding search paths or generators)
+				void invalidateCache() const;
+
 			protected:
 				IIncludeLoader::found_t trySearchPaths(const std::string& includeName) const;
 
@@ -100,6 +132,12 @@ class NBL_API2 IShaderCompiler : public core::IReferenceCounted
 				std::vector<LoaderSearchPath> m_loaders;
 				std::vector<core::smart_refctd_ptr<IIncludeGenerator>> m_generators;
 				core::smart_refctd_ptr<CFileSystemIncludeLoader> m_defaultFileSystemLoader;
+
+				mutable std::shared_mutex m_cacheMutex;
+				// keyed by include type, requesting directory and the include name
+				mutable core::unordered_map<std::string,std::shared_ptr<const SCachedInclude>> m_resolvedIncludes;
+				// keyed by absolute path, so that different spellings of the same include share an entry
+				mutable core::unordered_map<std::string,std::shared_ptr<const SCachedInclude>> m_loadedIncludes;
 		};
 
 		enum class E_SPIRV_VERSION : uint32_t
@@ -295,11 +333,33 @@ class NBL_API2 IShaderCompiler : public core::IReferenceCounted
 		CIncludeFinder* getDefaultIncludeFinder() { return m_defaultIncludeFinder.get(); }
 
 		const CIncludeFinder* getDefaultIncludeFinder() const { return m_defaultIncludeFinder.get(); }
+
+		//! When set, the SPIR-V produced by `compileToSPIRV` gets interned in the pool, so identical outputs share one blob.
+		//! Not thread-safe, set the pool up before compiling.
+		inline void setBlobPool(core::smart_refctd_ptr<CShaderBlobPool>&& pool) { m_blobPool = std::move(pool); }
+		inline CShaderBlobPool* getBlobPool() const { return m_blobPool.get(); }
 	protected:
 
 		virtual void insertIntoStart(std::string& code, std::ostringstream&& ins) const = 0;
 
+		// only copies `code` if there's no pool or the pool does not hold an identical blob yet
+		inline core::smart_refctd_ptr<ICPUBuffer> makeCodeBuffer(const void* code, const size_t size) const
+		{
+			if (m_blobPool)
+				return m_blobPool->intern(code,size);
+			auto retval = core::make_smart_refctd_ptr<ICPUBuffer>(size);
+			memcpy(retval->getPointer(),code,size);
+			return retval;
+		}
+		inline core::smart_refctd_ptr<ICPUBuffer> makeCodeBuffer(core::smart_refctd_ptr<ICPUBuffer>&& code) const
+		{
+			if (m_blobPool && code)
+				return m_blobPool->intern(std::move(code));
+			return std::move(code);
+		}
+
 		core::smart_refctd_ptr<system::ISystem> m_system;
+		core::smart_refctd_ptr<CShaderBlobPool> m_blobPool;
 	private:
 		core::smart_refctd_ptr<CIncludeFinder> m_defaultIncludeFinder;
 };
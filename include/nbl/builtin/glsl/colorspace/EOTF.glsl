@@ -48,10 +48,10 @@ vec3 nbl_glsl_eotf_SMPTE_170M(in vec3 nonlinear)
 vec3 nbl_glsl_eotf_SMPTE_ST2084(in vec3 nonlinear)
 {
     const vec3 invm2 = vec3(1.0 / 78.84375);
-    vec3 _common = pow(invm2, invm2);
+    vec3 _common = pow(nonlinear, invm2);
 
     const vec3 c2 = vec3(18.8515625);
-    const float c3 = 18.68875;
+    const float c3 = 18.6875;
     const vec3 c1 = vec3(c3 + 1.0) - c2;
 
     const vec3 invm1 = vec3(1.0 / 0.1593017578125);
@@ -84,13 +84,13 @@ vec3 nbl_glsl_eotf_ACEScc(in vec3 nonlinear)
 {
     bvec3 right = greaterThanEqual(nonlinear, vec3(-0.301369863));
     vec3 _common = exp2(nonlinear * 17.52 - vec3(9.72));
-    return max(mix(_common * 2.0 - vec3(0.000030517578125), _common, right), vec3(65504.0));
+    return min(mix(_common * 2.0 - vec3(0.000030517578125), _common, right), vec3(65504.0));
 }
 
 vec3 nbl_glsl_eotf_ACEScct(in vec3 nonlinear)
 {
     bvec3 right = greaterThanEqual(nonlinear, vec3(0.155251141552511));
-    return max(mix((nonlinear - vec3(0.0729055341958355)) / 10.5402377416545, exp2(nonlinear * 17.52 - vec3(9.72)), right), vec3(65504.0));
+    return min(mix((nonlinear - vec3(0.0729055341958355)) / 10.5402377416545, exp2(nonlinear * 17.52 - vec3(9.72)), right), vec3(65504.0));
 }
 
 #endif
\ No newline at end of file
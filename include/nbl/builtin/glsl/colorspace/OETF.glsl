@@ -49,7 +49,7 @@ vec3 nbl_glsl_oetf_SMPTE_ST2084(in vec3 linear)
     const vec3 m1 = vec3(0.1593017578125);
     const vec3 m2 = vec3(78.84375);
     const float c2 = 18.8515625;
-    const float c3 = 18.68875;
+    const float c3 = 18.6875;
     const vec3 c1 = vec3(c3 - c2 + 1.0);
 
     vec3 L_m1 = pow(linear, m1);
@@ -75,10 +75,10 @@ T SMPTE_ST2084(NBL_CONST_REF_ARG(T) nonlinear)
 {
     typedef typename scalar_type<T>::type Val_t;
     const T invm2 = promote<T, Val_t>(1.0 / 78.84375);
-    T _common = pow(invm2, invm2);
+    T _common = pow(nonlinear, invm2);
 
     const T c2 = promote<T, Val_t>(18.8515625);
-    const Val_t c3 = 18.68875;
+    const Val_t c3 = 18.6875;
     const T c1 = promote<T, Val_t>(c3 + 1.0) - c2;
 
     const T invm1 = promote<T, Val_t>(1.0 / 0.1593017578125);
@@ -118,7 +118,7 @@ T ACEScc(NBL_CONST_REF_ARG(T) nonlinear)
     typedef typename scalar_type<T>::type Val_t;
     bool3 right = (nonlinear >= promote<T, Val_t>(-0.301369863));
     T _common = exp2(nonlinear * Val_t(17.52) - promote<T, Val_t>(9.72));
-    return max(lerp(_common * Val_t(2.0) - promote<T, Val_t>(0.000030517578125), _common, right), promote<T, Val_t>(65504.0));
+    return min(lerp(_common * Val_t(2.0) - promote<T, Val_t>(0.000030517578125), _common, right), promote<T, Val_t>(65504.0));
 }
 
 template<typename T>
@@ -126,7 +126,7 @@ T ACEScct(NBL_CONST_REF_ARG(T) nonlinear)
 {
     typedef typename scalar_type<T>::type Val_t;
     bool3 right = (nonlinear >= promote<T, Val_t>(0.155251141552511));
-    return max(lerp((nonlinear - promote<T, Val_t>(0.0729055341958355)) / Val_t(10.5402377416545), exp2(nonlinear * Val_t(17.52) - promote<T, Val_t>(9.72)), right), promote<T, Val_t>(65504.0));
+    return min(lerp((nonlinear - promote<T, Val_t>(0.0729055341958355)) / Val_t(10.5402377416545), exp2(nonlinear * Val_t(17.52) - promote<T, Val_t>(9.72)), right), promote<T, Val_t>(65504.0));
 }
 
 }
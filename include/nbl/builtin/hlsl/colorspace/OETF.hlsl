@@ -76,7 +76,7 @@ T SMPTE_ST2084(NBL_CONST_REF_ARG(T) _linear)
     const T m1 = promote<T, Val_t>(0.1593017578125);
     const T m2 = promote<T, Val_t>(78.84375);
     const Val_t c2 = 18.8515625;
-    const Val_t c3 = 18.68875;
+    const Val_t c3 = 18.6875;
     const T c1 = promote<T, Val_t>(c3 - c2 + 1.0);
 
     T L_m1 = pow(_linear, m1);
@@ -417,7 +417,7 @@ struct Quadratic
         // if A = 0, solve linear instead
         if(Alen2 < exp2(-23.0f)*dot(B,B))
         {
-            candidates[0] = abs(dot(2.0*Bdiv2, CsubPos)) / dot(2.0*Bdiv2, 2.0*Bdiv2);
+            candidates[0] = -dot(2.0*Bdiv2, CsubPos) / dot(2.0*Bdiv2, 2.0*Bdiv2);
             candidates[1] = PARAMETER_THRESHOLD;
             candidates[2] = PARAMETER_THRESHOLD;
         }
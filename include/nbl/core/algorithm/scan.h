@@ -0,0 +1,385 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_ALGORITHM_SCAN_H_INCLUDED_
+#define _NBL_CORE_ALGORITHM_SCAN_H_INCLUDED_
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <thread>
+
+#include "nbl/core/execution.h"
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/decl/compile_config.h"
+#include "nbl/builtin/hlsl/functional.hlsl"
+
+//! Host counterparts of the scans and reductions `video::CScanner` runs on the GPU
+/*
+	The operators are the same as on the GPU: `hlsl::bit_and`, `bit_or`, `bit_xor`, `plus`, `multiplies`, `minimum` and `maximum`
+	from `builtin/hlsl/functional.hlsl`, with the same identities. Any other functor with a `type_t` and a static `identity` works too,
+	it only needs to be associative.
+
+	Everything runs in three phases over one batch per task: every batch gets reduced in parallel, the batch totals get scanned serially,
+	then every batch gets scanned in parallel starting from its carry. That reads the input twice and writes it once. A single pass with a
+	decoupled look-back would read it once, but it needs tiles to start in order, which the execution policies don't guarantee.
+
+	With AVX2 the operators above are vectorized for `uint32_t`, `int32_t` and `float`, the types `CScanner` takes. Batches get reduced
+	with one accumulator per lane and scanned 8 at a time with log-step scans in registers. This regroups the operations, so float results
+	can differ from a serial scan by rounding, just like on the GPU. Segmented scans carry the segment start flags through the same log-step
+	scans, and only reduce the part of a batch after its last segment start.
+*/
+namespace nbl::core
+{
+
+namespace impl
+{
+// a batch per task when running in parallel, big enough to amortize launching it
+inline constexpr size_t MinScanBatchSize = 0x8000ull;
+
+// the batching is a function of `count` only so the phases line up, every pass goes through `core::parallel_for_batches_n` with it
+template<class ExecutionPolicy>
+inline size_t getScanBatchCount(const size_t count)
+{
+	// with a single thread the second pass over the input buys nothing
+	if (std::thread::hardware_concurrency()<=1u)
+		return 1ull;
+	return core::parallel_batch_count<ExecutionPolicy>(count,MinScanBatchSize);
+}
+
+template<class BinOp, typename T=typename BinOp::type_t>
+inline constexpr bool IsVectorizableScanOp = sizeof(T)==4ull && (std::is_integral_v<T>||std::is_same_v<T,float>) && (
+	std::is_same_v<BinOp,hlsl::plus<T>> || std::is_same_v<BinOp,hlsl::multiplies<T>> ||
+	std::is_same_v<BinOp,hlsl::minimum<T>> || std::is_same_v<BinOp,hlsl::maximum<T>> ||
+	std::is_same_v<BinOp,hlsl::bit_and<T>> || std::is_same_v<BinOp,hlsl::bit_or<T>> || std::is_same_v<BinOp,hlsl::bit_xor<T>>
+);
+
+#ifdef __NBL_COMPILE_WITH_AVX2_
+// `BinOp` on 8 lanes, the operands are in the order of the scalar functor so NaNs and signed zeros come out the same
+template<class BinOp>
+inline __m256i scanOp8(const __m256i lhs, const __m256i rhs)
+{
+	using T = typename BinOp::type_t;
+	constexpr bool IsFloat = std::is_same_v<T,float>;
+	const __m256 lhsf = _mm256_castsi256_ps(lhs);
+	const __m256 rhsf = _mm256_castsi256_ps(rhs);
+	if constexpr (std::is_same_v<BinOp,hlsl::plus<T>>)
+		return IsFloat ? _mm256_castps_si256(_mm256_add_ps(lhsf,rhsf)):_mm256_add_epi32(lhs,rhs);
+	else if constexpr (std::is_same_v<BinOp,hlsl::multiplies<T>>)
+		return IsFloat ? _mm256_castps_si256(_mm256_mul_ps(lhsf,rhsf)):_mm256_mullo_epi32(lhs,rhs);
+	// `minimum` is `rhs<lhs ? rhs:lhs` and `_mm256_min_ps(a,b)` is `a<b ? a:b`
+	else if constexpr (std::is_same_v<BinOp,hlsl::minimum<T>>)
+	{
+		if constexpr (IsFloat)
+			return _mm256_castps_si256(_mm256_min_ps(rhsf,lhsf));
+		else
+			return std::is_signed_v<T> ? _mm256_min_epi32(lhs,rhs):_mm256_min_epu32(lhs,rhs);
+	}
+	else if constexpr (std::is_same_v<BinOp,hlsl::maximum<T>>)
+	{
+		if constexpr (IsFloat)
+			return _mm256_castps_si256(_mm256_max_ps(rhsf,lhsf));
+		else
+			return std::is_signed_v<T> ? _mm256_max_epi32(lhs,rhs):_mm256_max_epu32(lhs,rhs);
+	}
+	else if constexpr (std::is_same_v<BinOp,hlsl::bit_and<T>>)
+		return _mm256_and_si256(lhs,rhs);
+	else if constexpr (std::is_same_v<BinOp,hlsl::bit_or<T>>)
+		return _mm256_or_si256(lhs,rhs);
+	else
+		return _mm256_xor_si256(lhs,rhs);
+}
+
+// Hillis-Steele inclusive scan within the register, shifting in the identity
+template<class BinOp>
+inline __m256i inclusiveScan8(__m256i x, const __m256i identity)
+{
+	x = scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,_mm256_setr_epi32(0,0,1,2,3,4,5,6)),identity,0x01),x);
+	x = scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,_mm256_setr_epi32(0,0,0,1,2,3,4,5)),identity,0x03),x);
+	x = scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,_mm256_setr_epi32(0,0,0,0,0,1,2,3)),identity,0x0f),x);
+	return x;
+}
+
+// all ones in the lanes whose `segmentStarts` byte is non-zero
+inline __m256i loadSegmentStarts8(const uint8_t* segmentStarts)
+{
+	const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(segmentStarts)));
+	return _mm256_xor_si256(_mm256_cmpeq_epi32(bytes,_mm256_setzero_si256()),_mm256_set1_epi32(-1));
+}
+
+// `inclusiveScan8` over (start,value) pairs, a start discards everything to its left, `starts` comes out as whether any lane up to it started a segment
+template<class BinOp>
+inline __m256i segmentedInclusiveScan8(__m256i x, __m256i& starts, const __m256i identity)
+{
+	const __m256i none = _mm256_setzero_si256();
+	__m256i shift = _mm256_setr_epi32(0,0,1,2,3,4,5,6);
+	x = _mm256_blendv_epi8(scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,shift),identity,0x01),x),x,starts);
+	starts = _mm256_or_si256(starts,_mm256_blend_epi32(_mm256_permutevar8x32_epi32(starts,shift),none,0x01));
+	shift = _mm256_setr_epi32(0,0,0,1,2,3,4,5);
+	x = _mm256_blendv_epi8(scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,shift),identity,0x03),x),x,starts);
+	starts = _mm256_or_si256(starts,_mm256_blend_epi32(_mm256_permutevar8x32_epi32(starts,shift),none,0x03));
+	shift = _mm256_setr_epi32(0,0,0,0,0,1,2,3);
+	x = _mm256_blendv_epi8(scanOp8<BinOp>(_mm256_blend_epi32(_mm256_permutevar8x32_epi32(x,shift),identity,0x0f),x),x,starts);
+	starts = _mm256_or_si256(starts,_mm256_blend_epi32(_mm256_permutevar8x32_epi32(starts,shift),none,0x0f));
+	return x;
+}
+#endif
+
+// one past the last non-zero entry of `segmentStarts`, 0 if there's none
+inline size_t findLastSegmentStart(const uint8_t* segmentStarts, const size_t count)
+{
+	size_t i = count;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	for (; i>=32ull; i-=32ull)
+	{
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(segmentStarts+i-32ull));
+		const uint32_t nonZero = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes,_mm256_setzero_si256())));
+		if (nonZero)
+			return i-std::countl_zero(nonZero);
+	}
+#endif
+	for (; i; i--)
+	if (segmentStarts[i-1ull])
+		return i;
+	return 0ull;
+}
+
+template<class BinOp, typename T=typename BinOp::type_t>
+inline T reduceBatch(const T* input, const size_t count, BinOp op)
+{
+	T retval = BinOp::identity;
+	size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	if constexpr (IsVectorizableScanOp<BinOp>)
+	{
+		// two registers to hide the latency of the float operations, the lanes only get combined at the end
+		const __m256i identity = _mm256_set1_epi32(std::bit_cast<int32_t>(BinOp::identity));
+		__m256i accumulators[2] = {identity,identity};
+		for (; i+16ull<=count; i+=16ull)
+		for (uint32_t a=0u; a<2u; a++)
+			accumulators[a] = scanOp8<BinOp>(accumulators[a],_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input+i+a*8ull)));
+		alignas(32) T lanes[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes),scanOp8<BinOp>(accumulators[0],accumulators[1]));
+		for (const T lane : lanes)
+			retval = op(retval,lane);
+	}
+#endif
+	for (; i<count; i++)
+		retval = op(retval,input[i]);
+	return retval;
+}
+
+// scans starting from `carry` and returns the carry for whatever comes next, `input` may equal `output`
+template<bool Inclusive, class BinOp, typename T=typename BinOp::type_t>
+inline T scanBatch(const T* input, T* output, const size_t count, T carry, BinOp op)
+{
+	size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	if constexpr (IsVectorizableScanOp<BinOp>)
+	{
+		const __m256i identity = _mm256_set1_epi32(std::bit_cast<int32_t>(BinOp::identity));
+		__m256i carries = _mm256_set1_epi32(std::bit_cast<int32_t>(carry));
+		for (; i+8ull<=count; i+=8ull)
+		{
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input+i));
+			const __m256i scanned = scanOp8<BinOp>(carries,inclusiveScan8<BinOp>(x,identity));
+			__m256i* const out = reinterpret_cast<__m256i*>(output+i);
+			if constexpr (Inclusive)
+				_mm256_storeu_si256(out,scanned);
+			else
+				_mm256_storeu_si256(out,_mm256_blend_epi32(_mm256_permutevar8x32_epi32(scanned,_mm256_setr_epi32(0,0,1,2,3,4,5,6)),carries,0x01));
+			carries = _mm256_permutevar8x32_epi32(scanned,_mm256_set1_epi32(7));
+		}
+		carry = std::bit_cast<T>(_mm256_cvtsi256_si32(carries));
+	}
+#endif
+	for (; i<count; i++)
+	{
+		const T next = op(carry,input[i]);
+		output[i] = Inclusive ? next:carry;
+		carry = next;
+	}
+	return carry;
+}
+
+template<bool Inclusive, class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void scan(ExecutionPolicy&& policy, const T* input, T* output, const size_t count, BinOp op)
+{
+	const size_t batchCount = getScanBatchCount<ExecutionPolicy>(count);
+	if (batchCount==1ull)
+	{
+		scanBatch<Inclusive>(input,output,count,BinOp::identity,op);
+		return;
+	}
+
+	core::vector<T> carries(batchCount);
+	core::parallel_for_batches_n(policy,batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		carries[batch] = reduceBatch(input+begin,end-begin,op);
+	});
+	scanBatch<false>(carries.data(),carries.data(),batchCount,BinOp::identity,op);
+	core::parallel_for_batches_n(std::forward<ExecutionPolicy>(policy),batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		scanBatch<Inclusive>(input+begin,output+begin,end-begin,carries[batch],op);
+	});
+}
+
+// `scanBatch` starting over from the identity wherever `segmentStarts` is non-zero
+template<bool Inclusive, class BinOp, typename T=typename BinOp::type_t>
+inline T segmentedScanBatch(const T* input, const uint8_t* segmentStarts, T* output, const size_t count, T carry, BinOp op)
+{
+	size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	if constexpr (IsVectorizableScanOp<BinOp>)
+	{
+		const __m256i identity = _mm256_set1_epi32(std::bit_cast<int32_t>(BinOp::identity));
+		__m256i carries = _mm256_set1_epi32(std::bit_cast<int32_t>(carry));
+		for (; i+8ull<=count; i+=8ull)
+		{
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input+i));
+			const __m256i starts = loadSegmentStarts8(segmentStarts+i);
+			__m256i scanned;
+			// most runs of 8 don't start a segment, unless the segments are tiny
+			if (_mm256_testz_si256(starts,starts))
+				scanned = scanOp8<BinOp>(carries,inclusiveScan8<BinOp>(x,identity));
+			else
+			{
+				__m256i startedBefore = starts;
+				const __m256i segmentScanned = segmentedInclusiveScan8<BinOp>(x,startedBefore,identity);
+				// the carry only reaches the lanes before the first start
+				scanned = _mm256_blendv_epi8(scanOp8<BinOp>(carries,segmentScanned),segmentScanned,startedBefore);
+			}
+			__m256i* const out = reinterpret_cast<__m256i*>(output+i);
+			if constexpr (Inclusive)
+				_mm256_storeu_si256(out,scanned);
+			else
+			{
+				const __m256i shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(scanned,_mm256_setr_epi32(0,0,1,2,3,4,5,6)),carries,0x01);
+				_mm256_storeu_si256(out,_mm256_blendv_epi8(shifted,identity,starts));
+			}
+			carries = _mm256_permutevar8x32_epi32(scanned,_mm256_set1_epi32(7));
+		}
+		carry = std::bit_cast<T>(_mm256_cvtsi256_si32(carries));
+	}
+#endif
+	for (; i<count; i++)
+	{
+		if (segmentStarts[i])
+			carry = BinOp::identity;
+		const T next = op(carry,input[i]);
+		output[i] = Inclusive ? next:carry;
+		carry = next;
+	}
+	return carry;
+}
+
+template<bool Inclusive, class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void segmented_scan(ExecutionPolicy&& policy, const T* input, const uint8_t* segmentStarts, T* output, const size_t count, BinOp op)
+{
+	const size_t batchCount = getScanBatchCount<ExecutionPolicy>(count);
+	if (batchCount==1ull)
+	{
+		segmentedScanBatch<Inclusive>(input,segmentStarts,output,count,BinOp::identity,op);
+		return;
+	}
+
+	// reduction of the batch's last segment and whether that segment started in the batch
+	struct SBatchTotal
+	{
+		T value;
+		bool restarts;
+	};
+	core::vector<SBatchTotal> totals(batchCount);
+	core::parallel_for_batches_n(policy,batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		// everything before the last start gets discarded anyway
+		const size_t lastStart = findLastSegmentStart(segmentStarts+begin,end-begin);
+		const size_t first = begin+(lastStart ? (lastStart-1ull):0ull);
+		totals[batch] = {reduceBatch(input+first,end-first,op),lastStart!=0ull};
+	});
+	core::vector<T> carries(batchCount);
+	T carry = BinOp::identity;
+	for (size_t batch=0ull; batch<batchCount; batch++)
+	{
+		carries[batch] = carry;
+		carry = totals[batch].restarts ? totals[batch].value:op(carry,totals[batch].value);
+	}
+	core::parallel_for_batches_n(std::forward<ExecutionPolicy>(policy),batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		segmentedScanBatch<Inclusive>(input+begin,segmentStarts+begin,output+begin,end-begin,carries[batch],op);
+	});
+}
+}
+
+//! `output[n] = op(input[0],...,input[n])`, `input` and `output` may be the same array
+template<class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void inclusive_scan(ExecutionPolicy&& policy, const T* input, T* output, const size_t count, BinOp op={})
+{
+	impl::scan<true>(std::forward<ExecutionPolicy>(policy),input,output,count,op);
+}
+
+//! `output[n] = op(input[0],...,input[n-1])`, so `output[0]` is the identity, `input` and `output` may be the same array
+template<class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void exclusive_scan(ExecutionPolicy&& policy, const T* input, T* output, const size_t count, BinOp op={})
+{
+	impl::scan<false>(std::forward<ExecutionPolicy>(policy),input,output,count,op);
+}
+
+//! `op` over all of `input`, the identity for an empty range
+template<class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline T reduce(ExecutionPolicy&& policy, const T* input, const size_t count, BinOp op={})
+{
+	const size_t batchCount = impl::getScanBatchCount<ExecutionPolicy>(count);
+	if (batchCount==1ull)
+		return impl::reduceBatch(input,count,op);
+
+	core::vector<T> totals(batchCount);
+	core::parallel_for_batches_n(std::forward<ExecutionPolicy>(policy),batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		totals[batch] = impl::reduceBatch(input+begin,end-begin,op);
+	});
+	return impl::reduceBatch(totals.data(),batchCount,op);
+}
+
+//! Like `inclusive_scan` but starting over from the identity wherever `segmentStarts` is non-zero, the first element always starts a segment
+template<class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void segmented_inclusive_scan(ExecutionPolicy&& policy, const T* input, const uint8_t* segmentStarts, T* output, const size_t count, BinOp op={})
+{
+	impl::segmented_scan<true>(std::forward<ExecutionPolicy>(policy),input,segmentStarts,output,count,op);
+}
+
+//! Like `exclusive_scan` but starting over from the identity wherever `segmentStarts` is non-zero, so the first element of every segment gets the identity
+template<class BinOp, class ExecutionPolicy, typename T=typename BinOp::type_t>
+inline void segmented_exclusive_scan(ExecutionPolicy&& policy, const T* input, const uint8_t* segmentStarts, T* output, const size_t count, BinOp op={})
+{
+	impl::segmented_scan<false>(std::forward<ExecutionPolicy>(policy),input,segmentStarts,output,count,op);
+}
+
+//! Copies the elements `pred` accepts to the front of `output` keeping their order, returns how many there were
+/**
+	`input` and `output` must not overlap, `output` needs space for all `count` elements in the worst case. The predicate gets called
+	twice per element, once to count and once to write, so it needs to give the same answer both times.
+*/
+template<class ExecutionPolicy, typename T, class Predicate>
+inline size_t compact(ExecutionPolicy&& policy, const T* input, T* output, const size_t count, Predicate&& pred)
+{
+	const size_t batchCount = impl::getScanBatchCount<ExecutionPolicy>(count);
+	if (batchCount==1ull)
+		return std::copy_if(input,input+count,output,pred)-output;
+
+	core::vector<size_t> offsets(batchCount+1ull);
+	core::parallel_for_batches_n(policy,batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		offsets[batch+1ull] = std::count_if(input+begin,input+end,pred);
+	});
+	impl::scanBatch<true>(offsets.data(),offsets.data(),offsets.size(),size_t(0ull),hlsl::plus<size_t>());
+	core::parallel_for_batches_n(std::forward<ExecutionPolicy>(policy),batchCount,count,[&](const size_t batch, const size_t begin, const size_t end) -> void
+	{
+		std::copy_if(input+begin,input+end,output+offsets[batch],pred);
+	});
+	return offsets.back();
+}
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_ALGORITHM_SPATIAL_SORT_H_INCLUDED_
+#define _NBL_CORE_ALGORITHM_SPATIAL_SORT_H_INCLUDED_
+
+#include "nbl/core/execution.h"
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/algorithm/radix_sort.h"
+#include "nbl/core/math/morton.h"
+
+namespace nbl::core
+{
+
+enum E_SPACE_FILLING_CURVE : uint8_t
+{
+	ESFC_MORTON,
+	ESFC_HILBERT
+};
+
+//! What `spatial_sort` actually sorts, the original index travels with the key so the result is a gather permutation.
+struct SSpatialSortItem
+{
+	uint64_t key;
+	uint32_t index;
+};
+
+namespace impl
+{
+// only looks at the bits the curve can produce, so 10 bits per axis take 3 radix passes instead of the 6 a full 64bit key would
+template<uint32_t KeyBits>
+struct SpatialKeyAdaptor
+{
+	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = KeyBits;
+
+	template<auto bit_offset, auto radix_mask>
+	inline decltype(radix_mask) operator()(const SSpatialSortItem& item) const
+	{
+		return static_cast<decltype(radix_mask)>(item.key>>static_cast<uint64_t>(bit_offset))&radix_mask;
+	}
+};
+}
+
+//! Computes the order in which to visit `count` points so that it follows a space filling curve through `[aabbMin,aabbMax]`.
+/**
+	`positions` points at the XYZ floats of the first point, consecutive points are `stride` bytes apart. Writes `count` indices to `outOrder`,
+	`outOrder[i]` is the index of the point which should end up at position `i`. Keys get computed in parallel batches according to `policy`,
+	then radix sorted. `BitsPerAxis` can be at most 21, more bits only help when the points are denser than `2^BitsPerAxis` per axis.
+	If `outKeys` is not null, the sorted curve keys get written there too, `outKeys[i]` being the key of point `outOrder[i]`.
+*/
+template<uint32_t BitsPerAxis=10u, class ExecutionPolicy>
+inline void spatial_sort(
+	ExecutionPolicy&& policy, const E_SPACE_FILLING_CURVE curve,
+	const float* positions, const size_t stride, const uint32_t count,
+	const float* aabbMin, const float* aabbMax, uint32_t* outOrder, uint64_t* outKeys=nullptr
+)
+{
+	static_assert(BitsPerAxis>0u && BitsPerAxis<=21u, "Keys need to fit in 64 bits");
+	if (count==0u)
+		return;
+
+	float scale[3];
+	for (auto axis=0u; axis<3u; axis++)
+		scale[axis] = morton_quantization_scale(aabbMin[axis],aabbMax[axis],BitsPerAxis);
+
+	core::vector<SSpatialSortItem> items(count), scratch(count);
+	core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),count,0x4000u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+	{
+		for (uint32_t i=begin; i<end; i++)
+		{
+			const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions)+stride*i);
+			uint64_t coord[3];
+			for (auto axis=0u; axis<3u; axis++)
+				coord[axis] = morton_quantize(position[axis],aabbMin[axis],scale[axis],BitsPerAxis);
+			if (curve==ESFC_HILBERT)
+				items[i].key = hilbert3d_encode<uint64_t>(coord[0],coord[1],coord[2],BitsPerAxis);
+			else
+				items[i].key = morton3d_encode<uint64_t>(coord[0],coord[1],coord[2]);
+			items[i].index = i;
+		}
+	});
+
+	// radix sort is stable, so points quantized into the same cell keep their relative order
+	const auto* sorted = core::radix_sort(items.data(),scratch.data(),items.size(),impl::SpatialKeyAdaptor<BitsPerAxis*3u>());
+	for (uint32_t i=0u; i<count; i++)
+		outOrder[i] = sorted[i].index;
+	if (outKeys)
+	for (uint32_t i=0u; i<count; i++)
+		outKeys[i] = sorted[i].key;
+}
+
+}
+
+#endif
@@ -704,6 +704,8 @@ template<typename size_type>
 class GeneralpurposeAddressAllocatorST : public GeneralpurposeAddressAllocator<size_type>
 {
     public:
+        using GeneralpurposeAddressAllocator<size_type>::GeneralpurposeAddressAllocator;
+
         inline void defragment() noexcept
         {
             GeneralpurposeAddressAllocator<size_type>::defragment();
@@ -0,0 +1,844 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_CONTAINERS_CONCURRENT_SHARDED_CACHE_H_INCLUDED_
+#define _NBL_CORE_CONTAINERS_CONCURRENT_SHARDED_CACHE_H_INCLUDED_
+
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/math/intutil.h"
+#include "nbl/system/SReadWriteSpinLock.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+
+namespace nbl::core
+{
+
+namespace impl
+{
+// Set of doubly linked lists threaded through a fixed array of nodes, every node belongs to at most one list at a time.
+// Used by the eviction policies to keep recency order of slots without allocating.
+template<uint8_t ListCount>
+class IntrusiveSlotLists
+{
+	public:
+		static inline constexpr uint32_t invalid = ~0u;
+		static inline constexpr uint8_t no_list = 0xffu;
+
+		inline void init(const uint32_t nodeCount)
+		{
+			m_prev.assign(nodeCount,invalid);
+			m_next.assign(nodeCount,invalid);
+			m_owner.assign(nodeCount,no_list);
+			for (auto& list : m_lists)
+				list = {};
+		}
+
+		inline uint8_t owner(const uint32_t node) const {return m_owner[node];}
+		inline uint32_t size(const uint8_t list) const {return m_lists[list].size;}
+		// least recently pushed node
+		inline uint32_t back(const uint8_t list) const {return m_lists[list].tail;}
+
+		inline void pushFront(const uint8_t list, const uint32_t node)
+		{
+			assert(m_owner[node]==no_list);
+			auto& l = m_lists[list];
+			m_prev[node] = invalid;
+			m_next[node] = l.head;
+			if (l.head!=invalid)
+				m_prev[l.head] = node;
+			else
+				l.tail = node;
+			l.head = node;
+			l.size++;
+			m_owner[node] = list;
+		}
+
+		inline void remove(const uint32_t node)
+		{
+			const auto list = m_owner[node];
+			if (list==no_list)
+				return;
+			auto& l = m_lists[list];
+			if (m_prev[node]!=invalid)
+				m_next[m_prev[node]] = m_next[node];
+			else
+				l.head = m_next[node];
+			if (m_next[node]!=invalid)
+				m_prev[m_next[node]] = m_prev[node];
+			else
+				l.tail = m_prev[node];
+			l.size--;
+			m_owner[node] = no_list;
+		}
+
+		inline void moveToFront(const uint8_t list, const uint32_t node)
+		{
+			remove(node);
+			pushFront(list,node);
+		}
+
+	private:
+		struct SList
+		{
+			uint32_t head = invalid;
+			uint32_t tail = invalid;
+			uint32_t size = 0u;
+		};
+		std::array<SList,ListCount> m_lists = {};
+		core::vector<uint32_t> m_prev, m_next;
+		core::vector<uint8_t> m_owner;
+};
+
+// Remembers the hashes of recently evicted keys (without their values) in a number of LRU ordered lists
+template<uint8_t ListCount>
+class GhostLists
+{
+		using lists_t = IntrusiveSlotLists<ListCount>;
+	public:
+		static inline constexpr uint8_t no_list = lists_t::no_list;
+
+		inline void init(const uint32_t capacity)
+		{
+			m_lists.init(capacity);
+			m_hashes.resize(capacity);
+			m_free.resize(capacity);
+			for (uint32_t i=0u; i<capacity; i++)
+				m_free[i] = capacity-1u-i;
+			m_lookup.clear();
+			m_lookup.reserve(capacity);
+		}
+
+		inline uint32_t size(const uint8_t list) const {return m_lists.size(list);}
+
+		// returns which list the hash was found in and removes it, or `no_list`
+		inline uint8_t extract(const uint64_t hash)
+		{
+			auto found = m_lookup.find(hash);
+			if (found==m_lookup.end())
+				return no_list;
+			const auto node = found->second;
+			const auto list = m_lists.owner(node);
+			release(node);
+			m_lookup.erase(found);
+			return list;
+		}
+
+		inline void push(const uint8_t list, const uint64_t hash)
+		{
+			if (m_free.empty())
+				popBack(m_lists.size(0)>=m_lists.size(ListCount-1) ? 0u:(ListCount-1));
+			const auto node = m_free.back();
+			m_free.pop_back();
+			m_hashes[node] = hash;
+			// hash collisions with an existing ghost just refresh it
+			if (auto [it,inserted]=m_lookup.try_emplace(hash,node); !inserted)
+			{
+				release(it->second);
+				it->second = node;
+			}
+			m_lists.pushFront(list,node);
+		}
+
+		inline void popBack(const uint8_t list)
+		{
+			const auto node = m_lists.back(list);
+			if (node==lists_t::invalid)
+				return;
+			m_lookup.erase(m_hashes[node]);
+			release(node);
+		}
+
+	private:
+		inline void release(const uint32_t node)
+		{
+			m_lists.remove(node);
+			m_free.push_back(node);
+		}
+
+		lists_t m_lists;
+		core::vector<uint64_t> m_hashes;
+		core::vector<uint32_t> m_free;
+		core::unordered_map<uint64_t,uint32_t> m_lookup;
+};
+
+// Hits recorded by concurrent readers holding the shard's read lock, for a policy to apply to its lists the next time it's called with the shard exclusively locked.
+// A slot gets recorded at most once between two drains so the buffer can't overflow, repeated hits to the same slot in the meantime don't move it any further.
+class DeferredHits
+{
+	public:
+		inline void init(const uint32_t capacity)
+		{
+			m_recorded = std::make_unique<std::atomic_uint8_t[]>(capacity);
+			for (uint32_t i=0u; i<capacity; i++)
+				m_recorded[i].store(0u,std::memory_order_relaxed);
+			m_slots.resize(capacity);
+			m_count.store(0u,std::memory_order_relaxed);
+		}
+
+		inline void record(const uint32_t slot)
+		{
+			// avoid dirtying the cacheline if the slot is already recorded
+			if (m_recorded[slot].load(std::memory_order_relaxed) || m_recorded[slot].exchange(1u,std::memory_order_relaxed))
+				return;
+			m_slots[m_count.fetch_add(1u,std::memory_order_relaxed)] = slot;
+		}
+
+		// in the order the slots were first hit
+		template<typename F>
+		inline void drain(F&& apply)
+		{
+			const auto count = m_count.load(std::memory_order_relaxed);
+			for (uint32_t i=0u; i<count; i++)
+			{
+				m_recorded[m_slots[i]].store(0u,std::memory_order_relaxed);
+				apply(m_slots[i]);
+			}
+			m_count.store(0u,std::memory_order_relaxed);
+		}
+
+	private:
+		std::unique_ptr<std::atomic_uint8_t[]> m_recorded;
+		core::vector<uint32_t> m_slots;
+		std::atomic_uint32_t m_count = 0u;
+};
+}
+
+// Eviction policies for `ConcurrentShardedCache`, one instance exists per shard and all methods except `onHit` get called with the shard exclusively locked.
+// `onHit` gets called with the shard locked for reading if `ConcurrentHits` is true, otherwise the cache takes an exclusive lock for every hit.
+// If `LocklessHits` is also true it may get called without any lock at all, racing with the other methods (see `ConcurrentShardedCache::OptimisticHits`).
+namespace cache_policy
+{
+// Second chance FIFO, a hit only sets an atomic reference bit so lookups never need an exclusive lock
+class CLOCK
+{
+	public:
+		static inline constexpr bool ConcurrentHits = true;
+		static inline constexpr bool LocklessHits = true;
+
+		inline void init(const uint32_t capacity)
+		{
+			// lookups which don't lock may still set bits while the cache gets cleared, so keep the same array
+			if (!m_referenced || m_capacity!=capacity)
+				m_referenced = std::make_unique<std::atomic_uint8_t[]>(capacity);
+			m_capacity = capacity;
+			for (uint32_t i=0u; i<capacity; i++)
+				m_referenced[i].store(0u,std::memory_order_relaxed);
+			m_hand = 0u;
+		}
+
+		inline void onHit(const uint32_t slot)
+		{
+			// avoid dirtying the cacheline if the bit is already set
+			if (!m_referenced[slot].load(std::memory_order_relaxed))
+				m_referenced[slot].store(1u,std::memory_order_relaxed);
+		}
+		// only gets called when all slots are occupied
+		inline uint32_t selectVictim(const uint64_t hash)
+		{
+			while (m_referenced[m_hand].exchange(0u,std::memory_order_relaxed))
+				advance();
+			const auto victim = m_hand;
+			advance();
+			return victim;
+		}
+		inline void onEvict(const uint32_t slot, const uint64_t victimHash) {}
+		inline void onInsert(const uint32_t slot, const uint64_t hash) {m_referenced[slot].store(0u,std::memory_order_relaxed);}
+		inline void onErase(const uint32_t slot) {m_referenced[slot].store(0u,std::memory_order_relaxed);}
+
+	private:
+		inline void advance()
+		{
+			if (++m_hand==m_capacity)
+				m_hand = 0u;
+		}
+
+		std::unique_ptr<std::atomic_uint8_t[]> m_referenced;
+		uint32_t m_capacity = 0u;
+		uint32_t m_hand = 0u;
+};
+
+// Johnson & Shasha's full 2Q, new entries go into a FIFO and only get promoted to the main LRU if they're requested again soon after their eviction.
+// Hits only get recorded and are applied to the LRU order before the next insertion or erasure, so lookups share the read lock.
+class TwoQ
+{
+		enum E_LIST : uint8_t
+		{
+			EL_A1_IN = 0,
+			EL_AM,
+			EL_COUNT
+		};
+		// ghosts only live in one list
+		enum E_GHOST_LIST : uint8_t
+		{
+			EGL_A1_OUT = 0
+		};
+	public:
+		static inline constexpr bool ConcurrentHits = true;
+		static inline constexpr bool LocklessHits = false;
+
+		inline void init(const uint32_t capacity)
+		{
+			m_lists.init(capacity);
+			m_hits.init(capacity);
+			// tuning recommended by the paper
+			m_maxA1In = std::max(capacity/4u,1u);
+			m_ghosts.init(std::max(capacity/2u,1u));
+			m_pendingGhost = false;
+		}
+
+		inline void onHit(const uint32_t slot) {m_hits.record(slot);}
+		inline uint32_t selectVictim(const uint64_t hash)
+		{
+			applyHits();
+			// only entries evicted from A1in get remembered
+			m_pendingGhost = m_lists.size(EL_A1_IN)>m_maxA1In || m_lists.size(EL_AM)==0u;
+			return m_lists.back(m_pendingGhost ? EL_A1_IN:EL_AM);
+		}
+		// called right after `selectVictim` with the hash of the evicted key
+		inline void onEvict(const uint32_t slot, const uint64_t victimHash)
+		{
+			m_lists.remove(slot);
+			if (m_pendingGhost)
+				m_ghosts.push(EGL_A1_OUT,victimHash);
+		}
+		inline void onInsert(const uint32_t slot, const uint64_t hash)
+		{
+			applyHits();
+			const bool wasGhost = m_ghosts.extract(hash)!=decltype(m_ghosts)::no_list;
+			m_lists.pushFront(wasGhost ? EL_AM:EL_A1_IN,slot);
+		}
+		inline void onErase(const uint32_t slot)
+		{
+			applyHits();
+			m_lists.remove(slot);
+		}
+
+	private:
+		inline void applyHits()
+		{
+			m_hits.drain([this](const uint32_t slot) -> void
+			{
+				// a hit in A1in does nothing, correlated references shouldn't promote
+				if (m_lists.owner(slot)==EL_AM)
+					m_lists.moveToFront(EL_AM,slot);
+			});
+		}
+
+		impl::IntrusiveSlotLists<EL_COUNT> m_lists;
+		impl::DeferredHits m_hits;
+		impl::GhostLists<1> m_ghosts;
+		uint32_t m_maxA1In = 0u;
+		bool m_pendingGhost = false;
+};
+
+// Megiddo & Modha's Adaptive Replacement Cache, balances between recency and frequency by tracking recently evicted keys.
+// Like with `TwoQ` hits get applied lazily before the next insertion or erasure.
+class ARC
+{
+		enum E_LIST : uint8_t
+		{
+			EL_T1 = 0, // seen once recently
+			EL_T2, // seen at least twice recently
+			EL_COUNT
+		};
+		enum E_GHOST_LIST : uint8_t
+		{
+			EGL_B1 = 0,
+			EGL_B2,
+			EGL_COUNT
+		};
+		using GhostLists = impl::GhostLists<EGL_COUNT>;
+	public:
+		static inline constexpr bool ConcurrentHits = true;
+		static inline constexpr bool LocklessHits = false;
+
+		inline void init(const uint32_t capacity)
+		{
+			m_capacity = capacity;
+			m_lists.init(capacity);
+			m_hits.init(capacity);
+			m_ghosts.init(capacity);
+			m_target = 0u;
+			m_ghostHit = GhostLists::no_list;
+		}
+
+		inline void onHit(const uint32_t slot) {m_hits.record(slot);}
+		// gets called before the eviction, so we adapt the T1 target size here
+		inline uint32_t selectVictim(const uint64_t hash)
+		{
+			applyHits();
+			m_ghostHit = m_ghosts.extract(hash);
+			adapt();
+			const auto t1Size = m_lists.size(EL_T1);
+			const bool fromT1 = (t1Size && (t1Size>m_target || (m_ghostHit==EGL_B2 && t1Size==m_target))) || m_lists.size(EL_T2)==0u;
+			return m_lists.back(fromT1 ? EL_T1:EL_T2);
+		}
+		inline void onEvict(const uint32_t slot, const uint64_t victimHash)
+		{
+			const auto list = m_lists.owner(slot);
+			m_lists.remove(slot);
+			// keep |T1|+|B1| and the whole directory bounded, the ghost lists themselves never hold more than the capacity
+			if (list==EL_T1 && m_ghosts.size(EGL_B1)+m_lists.size(EL_T1)>=m_capacity)
+				m_ghosts.popBack(EGL_B1);
+			m_ghosts.push(list==EL_T1 ? EGL_B1:EGL_B2,victimHash);
+		}
+		inline void onInsert(const uint32_t slot, const uint64_t hash)
+		{
+			applyHits();
+			// if we didn't have to evict, we haven't looked up the ghosts yet
+			if (m_ghostHit==GhostLists::no_list)
+			{
+				m_ghostHit = m_ghosts.extract(hash);
+				adapt();
+			}
+			m_lists.pushFront(m_ghostHit!=GhostLists::no_list ? EL_T2:EL_T1,slot);
+			m_ghostHit = GhostLists::no_list;
+		}
+		inline void onErase(const uint32_t slot)
+		{
+			applyHits();
+			m_lists.remove(slot);
+		}
+
+	private:
+		inline void applyHits()
+		{
+			m_hits.drain([this](const uint32_t slot) -> void {m_lists.moveToFront(EL_T2,slot);});
+		}
+		inline void adapt()
+		{
+			const auto b1 = m_ghosts.size(EGL_B1);
+			const auto b2 = m_ghosts.size(EGL_B2);
+			if (m_ghostHit==EGL_B1)
+				m_target = std::min(m_target+std::max(b1 ? (b2/b1):0u,1u),m_capacity);
+			else if (m_ghostHit==EGL_B2)
+			{
+				const auto delta = std::max(b2 ? (b1/b2):0u,1u);
+				m_target = m_target>delta ? (m_target-delta):0u;
+			}
+		}
+
+		impl::IntrusiveSlotLists<EL_COUNT> m_lists;
+		impl::DeferredHits m_hits;
+		GhostLists m_ghosts;
+		uint32_t m_capacity = 0u;
+		// target size for T1
+		uint32_t m_target = 0u;
+		uint8_t m_ghostHit = GhostLists::no_list;
+};
+}
+
+// Thread-safe fixed capacity Key-Value cache.
+// Keys get distributed over power-of-two many shards, each with its own reader-writer spinlock, open addressing hash table and eviction policy.
+// Lookups only take the shard's read lock, the policies just record the hit (a reference bit for `CLOCK`, a deferred reordering for `TwoQ` and `ARC`).
+// Only `cache_policy::CLOCK` can take hits without any lock: if the keys and values are also plain data compared with `std::equal_to`, lookups
+// read the shard optimistically and retry if its version changed meanwhile (a seqlock), so readers never write to the lock's cacheline.
+// Values don't need to be default constructible.
+template<typename Key, typename Value, class Policy=cache_policy::CLOCK, typename MapHash=std::hash<Key>, typename MapEquals=std::equal_to<Key> >
+class ConcurrentShardedCache
+{
+	public:
+		// a torn read of the key or value must not be able to do any harm, because it gets discarded only after it has been compared and copied
+		static inline constexpr bool OptimisticHits = Policy::LocklessHits && std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value> && std::is_same_v<MapEquals,std::equal_to<Key>>;
+
+		struct SStatistics
+		{
+			uint64_t hits = 0ull;
+			uint64_t misses = 0ull;
+			uint64_t insertions = 0ull;
+			uint64_t evictions = 0ull;
+		};
+
+		// `capacity` is the total amount of entries, split evenly between the shards (rounded up), `shardCount` gets rounded up to a power of two
+		inline ConcurrentShardedCache(const uint32_t capacity, const uint32_t shardCount=16u, MapHash&& _hash=MapHash(), MapEquals&& _equals=MapEquals()) :
+			m_hash(std::move(_hash)), m_equals(std::move(_equals)), m_shardCount(core::roundUpToPoT(std::max(shardCount,1u))),
+			m_shardShift(64u-std::countr_zero(m_shardCount))
+		{
+			assert(capacity>0u);
+			m_shards = std::make_unique<Shard[]>(m_shardCount);
+			const uint32_t shardCapacity = (capacity+m_shardCount-1u)/m_shardCount;
+			for (uint32_t i=0u; i<m_shardCount; i++)
+				m_shards[i].init(shardCapacity);
+		}
+
+		inline uint32_t getCapacity() const {return m_shardCount*m_shards[0].capacity;}
+		inline uint32_t getShardCount() const {return m_shardCount;}
+
+		// approximate if other threads are modifying the cache at the same time
+		inline uint32_t getSize() const
+		{
+			uint32_t retval = 0u;
+			for (uint32_t i=0u; i<m_shardCount; i++)
+			{
+				system::read_lock_guard<> lock(m_shards[i].lock);
+				retval += m_shards[i].size;
+			}
+			return retval;
+		}
+
+		// copies the value out (so it can't be evicted from under you), marks the entry as recently used
+		inline bool get(const Key& key, Value& outValue)
+		{
+			return lookup(key,[&outValue](const Value& value) -> void {outValue = value;});
+		}
+		inline std::optional<Value> get(const Key& key)
+		{
+			std::optional<Value> retval;
+			lookup(key,[&retval](const Value& value) -> void {retval.emplace(value);});
+			return retval;
+		}
+
+		// does not alter the use order nor the statistics
+		inline bool contains(const Key& key) const
+		{
+			const auto hash = hashKey(key);
+			auto& shard = getShard(hash);
+			system::read_lock_guard<> lock(shard.lock);
+			return shard.find(key,hash,m_equals)!=Shard::invalid;
+		}
+
+		// insert an element into the cache, or update an existing one with the same key
+		template<typename K, typename V>
+		inline void insert(K&& key, V&& value)
+		{
+			const auto hash = hashKey(key);
+			auto& shard = getShard(hash);
+			SWriteGuard guard(shard);
+			if (const auto slot=shard.find(key,hash,m_equals); slot!=Shard::invalid)
+			{
+				shard.slots[slot]->second = std::forward<V>(value);
+				shard.policy.onHit(slot);
+				return;
+			}
+
+			uint32_t slot;
+			if (shard.size==shard.capacity)
+			{
+				slot = shard.policy.selectVictim(hash);
+				const auto victimHash = shard.hashes[slot];
+				shard.policy.onEvict(slot,victimHash);
+				shard.unindex(slot);
+				shard.release(slot);
+				shard.evictions.fetch_add(1ull,std::memory_order_relaxed);
+			}
+			else
+			{
+				slot = shard.freeSlots.back();
+				shard.freeSlots.pop_back();
+				shard.size++;
+			}
+			shard.assign(slot,std::forward<K>(key),std::forward<V>(value));
+			shard.hashes[slot] = hash;
+			shard.index(slot,hash);
+			shard.policy.onInsert(slot,hash);
+			shard.insertions.fetch_add(1ull,std::memory_order_relaxed);
+		}
+
+		// remove element at key if present
+		inline bool erase(const Key& key)
+		{
+			const auto hash = hashKey(key);
+			auto& shard = getShard(hash);
+			SWriteGuard guard(shard);
+			const auto slot = shard.find(key,hash,m_equals);
+			if (slot==Shard::invalid)
+				return false;
+			shard.policy.onErase(slot);
+			shard.unindex(slot);
+			shard.release(slot);
+			shard.freeSlots.push_back(slot);
+			shard.size--;
+			return true;
+		}
+
+		inline void clear()
+		{
+			for (uint32_t i=0u; i<m_shardCount; i++)
+			{
+				SWriteGuard guard(m_shards[i]);
+				m_shards[i].init(m_shards[i].capacity);
+			}
+		}
+
+		inline SStatistics getStatistics() const
+		{
+			SStatistics retval = {};
+			for (uint32_t i=0u; i<m_shardCount; i++)
+			{
+				const auto& shard = m_shards[i];
+				retval.hits += shard.hits.load(std::memory_order_relaxed);
+				retval.misses += shard.misses.load(std::memory_order_relaxed);
+				retval.insertions += shard.insertions.load(std::memory_order_relaxed);
+				retval.evictions += shard.evictions.load(std::memory_order_relaxed);
+			}
+			return retval;
+		}
+		inline void resetStatistics()
+		{
+			for (uint32_t i=0u; i<m_shardCount; i++)
+			{
+				auto& shard = m_shards[i];
+				shard.hits.store(0ull,std::memory_order_relaxed);
+				shard.misses.store(0ull,std::memory_order_relaxed);
+				shard.insertions.store(0ull,std::memory_order_relaxed);
+				shard.evictions.store(0ull,std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		static inline constexpr uint32_t MaxOptimisticAttempts = 4u;
+
+		// calls `onFound` with the value of a hit, under the shard's lock unless it's an optimistic hit on a validated copy
+		template<typename F>
+		inline bool lookup(const Key& key, F&& onFound)
+		{
+			const auto hash = hashKey(key);
+			auto& shard = getShard(hash);
+			if constexpr (OptimisticHits)
+			{
+				// writers could keep getting in the way, after a few tries wait for them on the lock
+				for (uint32_t attempt=0u; attempt<MaxOptimisticAttempts; attempt++)
+				{
+					const auto version = shard.version.load(std::memory_order_acquire);
+					if (version&0x1u)
+						break;
+					slot_storage_t entry;
+					const auto slot = shard.findOptimistic(key,hash,entry);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (shard.version.load(std::memory_order_relaxed)!=version)
+						continue;
+					if (slot==Shard::invalid)
+					{
+						shard.misses.fetch_add(1ull,std::memory_order_relaxed);
+						return false;
+					}
+					shard.policy.onHit(slot);
+					onFound(entry.value());
+					shard.hits.fetch_add(1ull,std::memory_order_relaxed);
+					return true;
+				}
+			}
+			uint32_t slot;
+			if constexpr (Policy::ConcurrentHits)
+			{
+				system::read_lock_guard<> lock(shard.lock);
+				slot = shard.find(key,hash,m_equals);
+				if (slot!=Shard::invalid)
+				{
+					shard.policy.onHit(slot);
+					onFound(shard.slots[slot]->second);
+				}
+			}
+			else
+			{
+				system::write_lock_guard<> lock(shard.lock);
+				slot = shard.find(key,hash,m_equals);
+				if (slot!=Shard::invalid)
+				{
+					shard.policy.onHit(slot);
+					onFound(shard.slots[slot]->second);
+				}
+			}
+			if (slot!=Shard::invalid)
+			{
+				shard.hits.fetch_add(1ull,std::memory_order_relaxed);
+				return true;
+			}
+			shard.misses.fetch_add(1ull,std::memory_order_relaxed);
+			return false;
+		}
+
+		using entry_t = std::pair<Key,Value>;
+		// what optimistic readers copy an entry into before they know whether it was torn, `std::pair` itself isn't trivially copyable
+		struct slot_storage_t
+		{
+			inline const Key& key() const {return *std::launder(reinterpret_cast<const Key*>(keyBytes));}
+			inline const Value& value() const {return *std::launder(reinterpret_cast<const Value*>(valueBytes));}
+
+			alignas(Key) std::byte keyBytes[sizeof(Key)];
+			alignas(Value) std::byte valueBytes[sizeof(Value)];
+		};
+
+		// keep shards on separate cachelines so that readers of different shards don't contend on the lock
+		struct alignas(64) Shard
+		{
+			static inline constexpr uint32_t invalid = ~0u;
+
+			// open addressing with linear probing, the tag is the low half of the hash so we only compare keys on likely matches
+			struct SIndexEntry
+			{
+				uint32_t tag;
+				uint32_t slot = invalid;
+			};
+
+			inline void init(const uint32_t _capacity)
+			{
+				capacity = _capacity;
+				size = 0u;
+				// optimistic readers may still be looking at the old entries, they're plain data so they can just stay
+				if (!OptimisticHits || slots.size()!=capacity)
+				{
+					slots.clear();
+					slots.resize(capacity);
+				}
+				hashes.resize(capacity);
+				freeSlots.resize(capacity);
+				for (uint32_t i=0u; i<capacity; i++)
+					freeSlots[i] = capacity-1u-i;
+				// keep load factor at or below 50%
+				table.assign(core::roundUpToPoT(capacity*2u),SIndexEntry{});
+				tableMask = table.size()-1u;
+				policy.init(capacity);
+			}
+
+			template<typename K>
+			inline uint32_t find(const K& key, const uint64_t hash, const MapEquals& equals) const
+			{
+				const auto tag = static_cast<uint32_t>(hash);
+				for (uint32_t i=tag&tableMask; table[i].slot!=invalid; i=(i+1u)&tableMask)
+				if (table[i].tag==tag && equals(slots[table[i].slot]->first,key))
+					return table[i].slot;
+				return invalid;
+			}
+
+			// Same as `find` but safe to run while a writer modifies the shard, copies the entry out so it can be used once the read is validated.
+			// Slots used by optimistic readers never get disengaged, the engaged flag can't change between checking it and reading the entry.
+			template<typename K>
+			inline uint32_t findOptimistic(const K& key, const uint64_t hash, slot_storage_t& outEntry) const
+			{
+				const auto tag = static_cast<uint32_t>(hash);
+				// entries being shifted around by a writer could otherwise keep us probing
+				for (uint32_t i=tag&tableMask, probes=0u; probes<=tableMask; i=(i+1u)&tableMask, probes++)
+				{
+					const SIndexEntry entry = table[i];
+					if (entry.slot==invalid)
+						break;
+					if (entry.tag!=tag || entry.slot>=capacity || !slots[entry.slot].has_value())
+						continue;
+					std::memcpy(outEntry.keyBytes,&slots[entry.slot]->first,sizeof(Key));
+					if (!std::equal_to<Key>()(outEntry.key(),key))
+						continue;
+					std::memcpy(outEntry.valueBytes,&slots[entry.slot]->second,sizeof(Value));
+					return entry.slot;
+				}
+				return invalid;
+			}
+
+			// optimistic readers need the slot to stay engaged, which `emplace` doesn't do for a moment
+			template<typename K, typename V>
+			inline void assign(const uint32_t slot, K&& key, V&& value)
+			{
+				if (OptimisticHits && slots[slot].has_value())
+					*slots[slot] = entry_t(std::forward<K>(key),std::forward<V>(value));
+				else
+					slots[slot].emplace(std::forward<K>(key),std::forward<V>(value));
+			}
+			// the entries of optimistic caches are plain data, so they don't hold onto anything
+			inline void release(const uint32_t slot)
+			{
+				if constexpr (!OptimisticHits)
+					slots[slot].reset();
+			}
+
+			inline void index(const uint32_t slot, const uint64_t hash)
+			{
+				const auto tag = static_cast<uint32_t>(hash);
+				uint32_t i = tag&tableMask;
+				while (table[i].slot!=invalid)
+					i = (i+1u)&tableMask;
+				table[i] = {tag,slot};
+			}
+
+			// backward shift deletion, so we never need tombstones
+			inline void unindex(const uint32_t slot)
+			{
+				const auto tag = static_cast<uint32_t>(hashes[slot]);
+				uint32_t hole = tag&tableMask;
+				while (table[hole].slot!=slot)
+					hole = (hole+1u)&tableMask;
+				for (uint32_t i=(hole+1u)&tableMask; table[i].slot!=invalid; i=(i+1u)&tableMask)
+				{
+					const uint32_t home = table[i].tag&tableMask;
+					// can the entry at `i` be moved to the hole without going before its home position?
+					const bool canMove = hole<=i ? (home<=hole || home>i):(home<=hole && home>i);
+					if (canMove)
+					{
+						table[hole] = table[i];
+						hole = i;
+					}
+				}
+				table[hole] = SIndexEntry{};
+			}
+
+			mutable system::SReadWriteSpinLock lock;
+			// odd while a writer modifies the shard, only used by optimistic readers
+			std::atomic_uint32_t version = 0u;
+			uint32_t capacity = 0u;
+			uint32_t size = 0u;
+			uint32_t tableMask = 0u;
+			core::vector<SIndexEntry> table;
+			core::vector<std::optional<entry_t>> slots;
+			core::vector<uint64_t> hashes;
+			core::vector<uint32_t> freeSlots;
+			Policy policy;
+
+			std::atomic_uint64_t hits = 0ull;
+			std::atomic_uint64_t misses = 0ull;
+			std::atomic_uint64_t insertions = 0ull;
+			std::atomic_uint64_t evictions = 0ull;
+		};
+
+		// locks the shard exclusively and keeps its version odd for the duration, so optimistic readers know to retry
+		struct SWriteGuard
+		{
+			inline SWriteGuard(Shard& _shard) : lock(_shard.lock), shard(_shard)
+			{
+				if constexpr (OptimisticHits)
+				{
+					shard.version.store(shard.version.load(std::memory_order_relaxed)+1u,std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+				}
+			}
+			inline ~SWriteGuard()
+			{
+				if constexpr (OptimisticHits)
+					shard.version.store(shard.version.load(std::memory_order_relaxed)+1u,std::memory_order_release);
+			}
+
+			system::write_lock_guard<> lock;
+			Shard& shard;
+		};
+
+		template<typename K>
+		inline uint64_t hashKey(const K& key) const
+		{
+			// `std::hash` is the identity for integers, so scramble it (MurmurHash3's finalizer)
+			uint64_t h = m_hash(key);
+			h ^= h>>33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h>>33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h>>33;
+			return h;
+		}
+		// shards get chosen by the high bits of the hash, the table positions by the low bits
+		inline Shard& getShard(const uint64_t hash) const
+		{
+			return m_shards[m_shardCount>1u ? (hash>>m_shardShift):0ull];
+		}
+
+		MapHash m_hash;
+		MapEquals m_equals;
+		const uint32_t m_shardCount;
+		const uint32_t m_shardShift;
+		std::unique_ptr<Shard[]> m_shards;
+};
+
+}
+#endif
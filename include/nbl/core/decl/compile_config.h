@@ -28,6 +28,15 @@
 #   define __NBL_COMPILE_WITH_SSE3
 #   define __NBL_COMPILE_WITH_X86_SIMD_ // SSE 4.2 
 #   include <immintrin.h>
+#   ifdef __AVX2__ // only if built with `NBL_ENABLE_AVX2`
+#       define __NBL_COMPILE_WITH_AVX2_
+#   endif
+#   if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)) // MSVC has no macro for BMI2, but `/arch:AVX2` allows it
+#       define __NBL_COMPILE_WITH_BMI2_
+#   endif
+#   ifdef __AVX512F__ // only if built with `NBL_ENABLE_AVX512`
+#       define __NBL_COMPILE_WITH_AVX512_
+#   endif
 #endif
 
 #ifdef _MSC_VER
@@ -36,12 +36,14 @@
 #include "nbl/core/alloc/SimpleBlockBasedAllocator.h"
 // algorithm
 #include "nbl/core/algorithm/radix_sort.h"
+#include "nbl/core/algorithm/spatial_sort.h"
 #include "nbl/core/algorithm/utility.h"
 // containers
 #include "nbl/core/containers/dynamic_array.h"
 #include "nbl/core/containers/refctd_dynamic_array.h"
 #include "nbl/core/containers/FixedCapacityDoublyLinkedList.h"
 #include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/containers/ConcurrentShardedCache.h"
 // math
 #include "nbl/core/math/intutil.h"
 #include "nbl/core/math/colorutil.h"
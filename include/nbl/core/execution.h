@@ -17,6 +17,13 @@
 #include "oneapi/dpl/pstl/glue_algorithm_ranges_defs.h"
 #endif
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+
+#include "nbl/core/decl/Types.h"
+
 #define ALIAS_TEMPLATE_FUNCTION(highLevelF, lowLevelF) \
 template<typename... Args> \
 inline auto highLevelF(Args&&... args) -> decltype(lowLevelF(std::forward<Args>(args)...)) \
@@ -57,6 +64,55 @@ ALIAS_TEMPLATE_FUNCTION(nth_element, oneapi::dpl::nth_element)
 //template <class _ExPo, class _FwdIt1, class _FwdIt2>
 //const auto swap_ranges = oneapi::dpl::swap_ranges<_ExPo, _FwdIt1, _FwdIt2>;
 #endif
+
+//! How many batches `parallel_for_batches` would split `count` items into, one for `execution::seq`
+/** Otherwise as many as keep every batch at least `minBatchSize` items long, but no more than 4 per hardware thread. */
+template<class ExecutionPolicy, typename T>
+inline T parallel_batch_count(const T count, const std::type_identity_t<T> minBatchSize)
+{
+	static_assert(std::is_unsigned_v<T>);
+	if constexpr (std::is_same_v<std::remove_cvref_t<ExecutionPolicy>,execution::sequenced_policy>)
+		return T(1);
+	const T maxBatches = static_cast<T>(std::max(std::thread::hardware_concurrency(),1u))*T(4);
+	return std::clamp<T>((count+minBatchSize-T(1))/minBatchSize,T(1),maxBatches);
+}
+
+//! Runs `func(batch,begin,end)` over `batchCount` equally sized batches of `[0,count)` according to `policy`
+/**
+	The batching is a function of `batchCount` and `count` alone, so consecutive passes over the same range line up batch for batch.
+	When `count` doesn't divide nicely, trailing batches can come out empty, `func` still gets called for them with `begin==end`.
+*/
+template<class ExecutionPolicy, typename T, typename F>
+inline void parallel_for_batches_n(ExecutionPolicy&& policy, const T batchCount, const T count, F&& func)
+{
+	static_assert(std::is_unsigned_v<T>);
+	const T batchSize = (count+batchCount-T(1))/batchCount;
+	core::vector<T> batches(batchCount);
+	std::iota(batches.begin(),batches.end(),T(0));
+	core::for_each(std::forward<ExecutionPolicy>(policy),batches.begin(),batches.end(),[&](const T batch) -> void
+	{
+		const T begin = std::min<T>(batch*batchSize,count);
+		func(batch,begin,std::min<T>(begin+batchSize,count));
+	});
+}
+
+//! Runs `func(batch,begin,end)` over batches of `[0,count)` according to `policy`, returns how many batches there were
+/**
+	Batches are sized by `parallel_batch_count`, none of them are empty and the batch indices are dense,
+	so the return value can size or reduce per batch results. Nothing runs when `count` is 0.
+*/
+template<class ExecutionPolicy, typename T, typename F>
+inline T parallel_for_batches(ExecutionPolicy&& policy, const T count, const std::type_identity_t<T> minBatchSize, F&& func)
+{
+	if (count==T(0))
+		return T(0);
+	const T maxBatchCount = parallel_batch_count<ExecutionPolicy>(count,minBatchSize);
+	const T batchSize = (count+maxBatchCount-T(1))/maxBatchCount;
+	// rounding the size up can leave the last few batches with nothing to do, drop them
+	const T batchCount = (count+batchSize-T(1))/batchSize;
+	parallel_for_batches_n(std::forward<ExecutionPolicy>(policy),batchCount,count,std::forward<F>(func));
+	return batchCount;
+}
 }
 
 #undef ALIAS_TEMPLATE_FUNCTION
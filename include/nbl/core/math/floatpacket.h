@@ -0,0 +1,352 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_MATH_FLOAT_PACKET_H_INCLUDED_
+#define _NBL_CORE_MATH_FLOAT_PACKET_H_INCLUDED_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "nbl/core/decl/compile_config.h"
+
+//! Thin wrappers over 8 (AVX2) and 16 (AVX-512) wide float registers.
+/*
+	Batch kernels are written once as templates over the packet type `P` and only use the operators and
+	`packet::` functions below, `float` is a valid packet of width 1 so the same kernel instantiated with `float`
+	processes remainders and doubles as the scalar reference implementation.
+*/
+namespace nbl::core::packet
+{
+
+template<typename P>
+struct traits;
+
+template<>
+struct traits<float>
+{
+	using mask_t = bool;
+	static inline constexpr uint32_t Width = 1u;
+};
+
+inline float load(const float* ptr, const float) { return *ptr; }
+inline void store(float* ptr, const float v) { *ptr = v; }
+
+inline float select(const bool mask, const float a, const float b) { return mask ? a:b; }
+inline float madd(const float a, const float b, const float c) { return a*b+c; }
+inline float sqrt(const float x) { return std::sqrt(x); }
+inline float rsqrt(const float x) { return 1.f/std::sqrt(x); }
+inline float min(const float a, const float b) { return a<b ? a:b; }
+inline float max(const float a, const float b) { return a>b ? a:b; }
+inline float abs(const float x) { return std::abs(x); }
+inline float floor(const float x) { return std::floor(x); }
+inline void sincos(const float x, float& s, float& c)
+{
+	s = std::sin(x);
+	c = std::cos(x);
+}
+inline float exp2(const float x) { return std::exp2(x); }
+inline float log2(const float x) { return std::log2(x); }
+inline float pow(const float x, const float y) { return std::pow(x,y); }
+inline float acos(const float x) { return std::acos(x); }
+inline bool any(const bool mask) { return mask; }
+inline float hmin(const float x) { return x; }
+inline float hmax(const float x) { return x; }
+
+
+#ifdef __NBL_COMPILE_WITH_AVX2_
+struct mask8
+{
+	__m256 v;
+
+	inline friend mask8 operator&(const mask8 a, const mask8 b) { return {_mm256_and_ps(a.v,b.v)}; }
+	inline friend mask8 operator|(const mask8 a, const mask8 b) { return {_mm256_or_ps(a.v,b.v)}; }
+	inline friend mask8 operator!(const mask8 a) { return {_mm256_xor_ps(a.v,_mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+};
+
+struct float8
+{
+	__m256 v;
+
+	float8() = default;
+	inline float8(const __m256 _v) : v(_v) {}
+	// implicit on purpose, so kernels can mix packets and scalar constants
+	inline float8(const float x) : v(_mm256_set1_ps(x)) {}
+
+	inline friend float8 operator+(const float8 a, const float8 b) { return _mm256_add_ps(a.v,b.v); }
+	inline friend float8 operator-(const float8 a, const float8 b) { return _mm256_sub_ps(a.v,b.v); }
+	inline friend float8 operator*(const float8 a, const float8 b) { return _mm256_mul_ps(a.v,b.v); }
+	inline friend float8 operator/(const float8 a, const float8 b) { return _mm256_div_ps(a.v,b.v); }
+	inline friend float8 operator-(const float8 a) { return _mm256_xor_ps(a.v,_mm256_set1_ps(-0.f)); }
+
+	inline friend mask8 operator<(const float8 a, const float8 b) { return {_mm256_cmp_ps(a.v,b.v,_CMP_LT_OQ)}; }
+	inline friend mask8 operator<=(const float8 a, const float8 b) { return {_mm256_cmp_ps(a.v,b.v,_CMP_LE_OQ)}; }
+	inline friend mask8 operator>(const float8 a, const float8 b) { return {_mm256_cmp_ps(a.v,b.v,_CMP_GT_OQ)}; }
+	inline friend mask8 operator>=(const float8 a, const float8 b) { return {_mm256_cmp_ps(a.v,b.v,_CMP_GE_OQ)}; }
+	inline friend mask8 operator==(const float8 a, const float8 b) { return {_mm256_cmp_ps(a.v,b.v,_CMP_EQ_OQ)}; }
+};
+
+template<>
+struct traits<float8>
+{
+	using mask_t = mask8;
+	static inline constexpr uint32_t Width = 8u;
+};
+
+inline float8 load(const float* ptr, const float8) { return _mm256_loadu_ps(ptr); }
+inline void store(float* ptr, const float8 v) { _mm256_storeu_ps(ptr,v.v); }
+
+inline float8 select(const mask8 mask, const float8 a, const float8 b) { return _mm256_blendv_ps(b.v,a.v,mask.v); }
+inline float8 madd(const float8 a, const float8 b, const float8 c) { return _mm256_fmadd_ps(a.v,b.v,c.v); }
+inline float8 sqrt(const float8 x) { return _mm256_sqrt_ps(x.v); }
+// not `_mm256_rsqrt_ps`, batch results need to match the scalar path to more than 12 bits
+inline float8 rsqrt(const float8 x) { return _mm256_div_ps(_mm256_set1_ps(1.f),_mm256_sqrt_ps(x.v)); }
+inline float8 min(const float8 a, const float8 b) { return _mm256_min_ps(a.v,b.v); }
+inline float8 max(const float8 a, const float8 b) { return _mm256_max_ps(a.v,b.v); }
+inline float8 abs(const float8 x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f),x.v); }
+inline float8 floor(const float8 x) { return _mm256_round_ps(x.v,_MM_FROUND_TO_NEG_INF|_MM_FROUND_NO_EXC); }
+inline float8 round(const float8 x) { return _mm256_round_ps(x.v,_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+// `2^n` for integral `n` in [-127,128], the ends give 0 and infinity
+inline float8 exp2i(const float8 n) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n.v),_mm256_set1_epi32(127)),23)); }
+// splits a positive normal `x` into the mantissa in [1,2) and the unbiased exponent
+inline float8 frexp(const float8 x, float8& e)
+{
+	const __m256i bits = _mm256_castps_si256(x.v);
+	e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits,23),_mm256_set1_epi32(127)));
+	return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits,_mm256_set1_epi32(0x007fffff)),_mm256_set1_epi32(0x3f800000)));
+}
+inline bool any(const mask8 mask) { return _mm256_movemask_ps(mask.v)!=0; }
+inline float hmin(const float8 x)
+{
+	__m128 v = _mm_min_ps(_mm256_castps256_ps128(x.v),_mm256_extractf128_ps(x.v,1));
+	v = _mm_min_ps(v,_mm_movehl_ps(v,v));
+	return _mm_cvtss_f32(_mm_min_ss(v,_mm_movehdup_ps(v)));
+}
+inline float hmax(const float8 x)
+{
+	__m128 v = _mm_max_ps(_mm256_castps256_ps128(x.v),_mm256_extractf128_ps(x.v,1));
+	v = _mm_max_ps(v,_mm_movehl_ps(v,v));
+	return _mm_cvtss_f32(_mm_max_ss(v,_mm_movehdup_ps(v)));
+}
+#endif
+
+#ifdef __NBL_COMPILE_WITH_AVX512_
+struct mask16
+{
+	__mmask16 v;
+
+	inline friend mask16 operator&(const mask16 a, const mask16 b) { return {_kand_mask16(a.v,b.v)}; }
+	inline friend mask16 operator|(const mask16 a, const mask16 b) { return {_kor_mask16(a.v,b.v)}; }
+	inline friend mask16 operator!(const mask16 a) { return {_knot_mask16(a.v)}; }
+};
+
+struct float16
+{
+	__m512 v;
+
+	float16() = default;
+	inline float16(const __m512 _v) : v(_v) {}
+	inline float16(const float x) : v(_mm512_set1_ps(x)) {}
+
+	inline friend float16 operator+(const float16 a, const float16 b) { return _mm512_add_ps(a.v,b.v); }
+	inline friend float16 operator-(const float16 a, const float16 b) { return _mm512_sub_ps(a.v,b.v); }
+	inline friend float16 operator*(const float16 a, const float16 b) { return _mm512_mul_ps(a.v,b.v); }
+	inline friend float16 operator/(const float16 a, const float16 b) { return _mm512_div_ps(a.v,b.v); }
+	inline friend float16 operator-(const float16 a) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v),_mm512_set1_epi32(0x80000000))); }
+
+	inline friend mask16 operator<(const float16 a, const float16 b) { return {_mm512_cmp_ps_mask(a.v,b.v,_CMP_LT_OQ)}; }
+	inline friend mask16 operator<=(const float16 a, const float16 b) { return {_mm512_cmp_ps_mask(a.v,b.v,_CMP_LE_OQ)}; }
+	inline friend mask16 operator>(const float16 a, const float16 b) { return {_mm512_cmp_ps_mask(a.v,b.v,_CMP_GT_OQ)}; }
+	inline friend mask16 operator>=(const float16 a, const float16 b) { return {_mm512_cmp_ps_mask(a.v,b.v,_CMP_GE_OQ)}; }
+	inline friend mask16 operator==(const float16 a, const float16 b) { return {_mm512_cmp_ps_mask(a.v,b.v,_CMP_EQ_OQ)}; }
+};
+
+template<>
+struct traits<float16>
+{
+	using mask_t = mask16;
+	static inline constexpr uint32_t Width = 16u;
+};
+
+inline float16 load(const float* ptr, const float16) { return _mm512_loadu_ps(ptr); }
+inline void store(float* ptr, const float16 v) { _mm512_storeu_ps(ptr,v.v); }
+
+inline float16 select(const mask16 mask, const float16 a, const float16 b) { return _mm512_mask_blend_ps(mask.v,b.v,a.v); }
+inline float16 madd(const float16 a, const float16 b, const float16 c) { return _mm512_fmadd_ps(a.v,b.v,c.v); }
+inline float16 sqrt(const float16 x) { return _mm512_sqrt_ps(x.v); }
+inline float16 rsqrt(const float16 x) { return _mm512_div_ps(_mm512_set1_ps(1.f),_mm512_sqrt_ps(x.v)); }
+inline float16 min(const float16 a, const float16 b) { return _mm512_min_ps(a.v,b.v); }
+inline float16 max(const float16 a, const float16 b) { return _mm512_max_ps(a.v,b.v); }
+inline float16 abs(const float16 x) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x.v),_mm512_set1_epi32(0x7fffffff))); }
+inline float16 floor(const float16 x) { return _mm512_roundscale_ps(x.v,_MM_FROUND_TO_NEG_INF|_MM_FROUND_NO_EXC); }
+inline float16 round(const float16 x) { return _mm512_roundscale_ps(x.v,_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+inline float16 exp2i(const float16 n) { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n.v),_mm512_set1_epi32(127)),23)); }
+inline float16 frexp(const float16 x, float16& e)
+{
+	const __m512i bits = _mm512_castps_si512(x.v);
+	e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits,23),_mm512_set1_epi32(127)));
+	return _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits,_mm512_set1_epi32(0x007fffff)),_mm512_set1_epi32(0x3f800000)));
+}
+inline bool any(const mask16 mask) { return mask.v!=0; }
+inline float hmin(const float16 x) { return _mm512_reduce_min_ps(x.v); }
+inline float hmax(const float16 x) { return _mm512_reduce_max_ps(x.v); }
+#endif
+
+//! Widest packet enabled in the build, for kernels which don't need to handle remainders with narrower packets
+#if defined(__NBL_COMPILE_WITH_AVX512_)
+using native = float16;
+#elif defined(__NBL_COMPILE_WITH_AVX2_)
+using native = float8;
+#else
+using native = float;
+#endif
+
+//! Loads `traits<P>::Width` consecutive floats
+template<typename P>
+inline P load(const float* ptr) { return load(ptr,P{}); }
+
+//! Runs `kernel.template operator()<P>(i)` over `[0,count)` with the widest packets available and finishes the remainder with `float`
+template<typename Kernel>
+inline void dispatch(const size_t count, Kernel&& kernel)
+{
+	size_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_AVX512_
+	for (; i+traits<float16>::Width<=count; i+=traits<float16>::Width)
+		kernel.template operator()<float16>(i);
+#endif
+#ifdef __NBL_COMPILE_WITH_AVX2_
+	for (; i+traits<float8>::Width<=count; i+=traits<float8>::Width)
+		kernel.template operator()<float8>(i);
+#endif
+	for (; i<count; i++)
+		kernel.template operator()<float>(i);
+}
+
+//! Polynomial sine and cosine for packets, max error around 2 ulp for |x|<8192
+/*
+	Cody-Waite reduction by multiples of PI/2 followed by the usual minimax polynomials on [-PI/4,PI/4].
+	Only used for the vector widths, the scalar `sincos` above defers to the standard library.
+*/
+template<typename P> requires (traits<P>::Width>1u)
+inline void sincos(const P x, P& s, P& c)
+{
+	const P q = floor(madd(x,P(0.636619772367581343f),P(0.5f)));
+	// extended precision PI/2
+	P r = madd(q,P(-1.5703125f),x);
+	r = madd(q,P(-4.837512969970703125e-4f),r);
+	r = madd(q,P(-7.54978995489188216e-8f),r);
+	const P r2 = r*r;
+
+	P sinr = madd(r2,P(-1.9515295891e-4f),P(8.3321608736e-3f));
+	sinr = madd(sinr,r2,P(-1.6666654611e-1f));
+	sinr = madd(sinr*r2,r,r);
+	P cosr = madd(r2,P(2.443315711809948e-5f),P(-1.388731625493765e-3f));
+	cosr = madd(cosr,r2,P(4.166664568298827e-2f));
+	cosr = madd(cosr*r2,r2,madd(r2,P(-0.5f),P(1.f)));
+
+	// quadrant in [0,4)
+	const P quadrant = q-floor(q*P(0.25f))*P(4.f);
+	const auto swap = (quadrant==P(1.f))|(quadrant==P(3.f));
+	const P sinAbs = select(swap,cosr,sinr);
+	const P cosAbs = select(swap,sinr,cosr);
+	s = select(quadrant>=P(2.f),-sinAbs,sinAbs);
+	c = select((quadrant==P(1.f))|(quadrant==P(2.f)),-cosAbs,cosAbs);
+}
+
+//! Polynomial `acos(x)` for packets, max absolute error around 2e-7, `x` outside [-1,1] gives NaN just like the scalar one
+/*
+	Abramowitz & Stegun 4.4.46 `acos(|x|) = sqrt(1-|x|)*poly(|x|)`, reflected with `acos(-x) = PI-acos(x)`.
+*/
+template<typename P> requires (traits<P>::Width>1u)
+inline P acos(const P x)
+{
+	const P ax = abs(x);
+	P p = madd(ax,P(-0.0012624911f),P(0.0066700901f));
+	p = madd(p,ax,P(-0.0170881256f));
+	p = madd(p,ax,P(0.0308918810f));
+	p = madd(p,ax,P(-0.0501743046f));
+	p = madd(p,ax,P(0.0889789874f));
+	p = madd(p,ax,P(-0.2145988016f));
+	p = madd(p,ax,P(1.5707963050f));
+	const P retval = sqrt(P(1.f)-ax)*p;
+	return select(x<P(0.f),P(3.14159265358979323846f)-retval,retval);
+}
+
+namespace impl
+{
+// `2^f` for `f` in [-0.5,0.5], degree 6 minimax polynomial
+template<typename P>
+inline P exp2_reduced(const P f)
+{
+	P p = madd(f,P(1.535336188319500e-4f),P(1.339887440266574e-3f));
+	p = madd(p,f,P(9.618437357674640e-3f));
+	p = madd(p,f,P(5.550332471162809e-2f));
+	p = madd(p,f,P(2.402264791363012e-1f));
+	p = madd(p,f,P(6.931472028550421e-1f));
+	return madd(p,f,P(1.f));
+}
+
+// splits `log2(x)` into the integer `e` and the rest in [-0.5,0.5], a degree 9 minimax polynomial for `ln(1+t)` with the mantissa centered on [sqrt(0.5),sqrt(2))
+template<typename P>
+inline P log2_reduced(const P x, P& e)
+{
+	P m = frexp(x,e);
+	const auto big = m>P(1.41421356237309504880f);
+	m = select(big,m*P(0.5f),m);
+	e = select(big,e+P(1.f),e);
+	const P t = m-P(1.f);
+	const P t2 = t*t;
+
+	P p = madd(t,P(7.0376836292e-2f),P(-1.1514610310e-1f));
+	p = madd(p,t,P(1.1676998740e-1f));
+	p = madd(p,t,P(-1.2420140846e-1f));
+	p = madd(p,t,P(1.4249322787e-1f));
+	p = madd(p,t,P(-1.6668057665e-1f));
+	p = madd(p,t,P(2.0000714765e-1f));
+	p = madd(p,t,P(-2.4999993993e-1f));
+	p = madd(p,t,P(3.3333331174e-1f));
+	const P y = madd(t2,P(-0.5f),p*t2*t);
+
+	// the conversion to base 2 is split in two constants to not lose the low bits, log2(e)-1
+	constexpr float Log2eMinusOne = 0.44269504088896340736f;
+	return madd(y,P(Log2eMinusOne),madd(t,P(Log2eMinusOne),y+t));
+}
+}
+
+//! Polynomial `2^x` for packets, max relative error 1 ulp, underflows to 0 below -127 and overflows to infinity above 128
+template<typename P> requires (traits<P>::Width>1u)
+inline P exp2(P x)
+{
+	x = min(max(x,P(-127.f)),P(128.f));
+	const P n = round(x);
+	return impl::exp2_reduced(x-n)*exp2i(n);
+}
+
+//! Polynomial `log2(x)` for packets, max error 2 ulp or 2^-25 absolute close to 1, only valid for positive normal `x`
+template<typename P> requires (traits<P>::Width>1u)
+inline P log2(const P x)
+{
+	P e;
+	const P l = impl::log2_reduced(x,e);
+	return l+e;
+}
+
+//! `x^y` for packets, non-positive `x` give 0, the max relative error is 3 ulp for `|y|<=4` and grows by about 1 ulp per 4 of `|y|` beyond that
+/*
+	The product `y*log2(x)` is kept in two parts (the exact `y*e` split with an FMA plus `y*log2(mantissa)`) until it's split into integer
+	and fraction for `exp2`, so the rounding of a large exponent doesn't get amplified.
+*/
+template<typename P> requires (traits<P>::Width>1u)
+inline P pow(const P x, const P y)
+{
+	P e;
+	const P l = impl::log2_reduced(x,e);
+	const P hi = y*e;
+	const P lo = madd(y,l,madd(y,e,-hi));
+	const P n = min(max(round(hi+lo),P(-127.f)),P(128.f));
+	const P retval = impl::exp2_reduced((hi-n)+lo)*exp2i(n);
+	return select(x>P(0.f),retval,P(0.f));
+}
+}
+
+#endif
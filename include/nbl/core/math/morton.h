@@ -6,7 +6,12 @@
 #define __NBL_CORE_MORTON_H_INCLUDED__
 
 #include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 #include "nbl/macros.h"
+#include "nbl/core/decl/compile_config.h"
 
 namespace nbl
 {
@@ -35,7 +40,7 @@ namespace impl
         {
             0x1249249249249249ull,
             0x10C30C30C30C30C3ull,
-            0x010F00F00F00F00Full,
+            0x100F00F00F00F00Full,
             0x001F0000FF0000FFull,
             0x001F00000000FFFFull
         };
@@ -54,9 +59,56 @@ namespace impl
         return static_cast<T>(mask[_n]);
     }
 
+    //! Mask of the bits belonging to the first axis of a `dims` dimensional code, the other axes are this shifted left by their index
+    template <typename T, uint32_t dims>
+    constexpr T morton_lane_mask()
+    {
+        if constexpr (dims==2u)
+            return morton2d_mask<T>(0);
+        else if constexpr (dims==3u)
+            return morton3d_mask<T>(0);
+        else
+            return morton4d_mask<T>(0);
+    }
+
+    // BMI2 deposit and extract do a whole (de)interleave in one instruction, but are microcoded and slow on AMD before Zen 3,
+    // which is why the batch functions prefer the AVX2 path when both are available
+#ifdef __NBL_COMPILE_WITH_BMI2_
+    template <typename T>
+    constexpr bool has_bmi2_path = std::is_unsigned_v<T> && (sizeof(T)==4u || sizeof(T)==8u);
+
+    template <typename T>
+    inline T deposit_bits(const T x, const T mask)
+    {
+        if constexpr (sizeof(T)==8u)
+            return static_cast<T>(_pdep_u64(x,mask));
+        else
+            return static_cast<T>(_pdep_u32(x,mask));
+    }
+    template <typename T>
+    inline T extract_bits(const T x, const T mask)
+    {
+        if constexpr (sizeof(T)==8u)
+            return static_cast<T>(_pext_u64(x,mask));
+        else
+            return static_cast<T>(_pext_u32(x,mask));
+    }
+#else
+    template <typename T>
+    constexpr bool has_bmi2_path = false;
+
+    template <typename T>
+    inline T deposit_bits(const T x, const T mask) { return x; }
+    template <typename T>
+    inline T extract_bits(const T x, const T mask) { return x; }
+#endif
+
     template <typename T, uint32_t bitDepth>
     inline T morton2d_decode(T x)
     {
+        if constexpr (has_bmi2_path<T>)
+            return extract_bits<T>(x,morton_lane_mask<T,2u>());
+
         x = x & morton2d_mask<T>(0);
         x = (x | (x >> 1)) & morton2d_mask<T>(1);
         x = (x | (x >> 2)) & morton2d_mask<T>(2);
@@ -70,7 +122,32 @@ namespace impl
         }
         if constexpr (bitDepth>32u)
         {
-            x = (x | (x >> 16));
+            x = (x | (x >> 16)) & static_cast<T>(0xFFFFFFFFull);
+        }
+        return x;
+    }
+
+    //! Inverse of `separate_bits_3d`, gathers every third bit starting from the lowest
+    template <typename T, uint32_t bitDepth>
+    inline T morton3d_decode(T x)
+    {
+        if constexpr (has_bmi2_path<T>)
+            return extract_bits<T>(x,morton_lane_mask<T,3u>());
+
+        x = x & morton3d_mask<T>(0);
+        x = (x | (x >> 2)) & morton3d_mask<T>(1);
+        x = (x | (x >> 4)) & morton3d_mask<T>(2);
+        if constexpr (bitDepth>8u)
+        {
+            x = (x | (x >> 8)) & morton3d_mask<T>(3);
+        }
+        if constexpr (bitDepth>16u)
+        {
+            x = (x | (x >> 16)) & morton3d_mask<T>(4);
+        }
+        if constexpr (bitDepth>32u)
+        {
+            x = (x | (x >> 32)) & static_cast<T>(0x1FFFFFull);
         }
         return x;
     }
@@ -79,6 +156,9 @@ namespace impl
     template <typename T, uint32_t bitDepth>
     inline T separate_bits_2d(T x)
     {
+        if constexpr (has_bmi2_path<T>)
+            return deposit_bits<T>(x,morton_lane_mask<T,2u>());
+
         if constexpr (bitDepth>32u)
         {
             x = (x | (x << 16)) & morton2d_mask<T>(4);
@@ -99,6 +179,9 @@ namespace impl
     template <typename T, uint32_t bitDepth>
     inline T separate_bits_3d(T x)
     {
+        if constexpr (has_bmi2_path<T>)
+            return deposit_bits<T>(x,morton_lane_mask<T,3u>());
+
         if constexpr (bitDepth>32u)
         {
             x = (x | (x << 32)) & morton3d_mask<T>(4);
@@ -119,6 +202,9 @@ namespace impl
     template <typename T, uint32_t bitDepth>
     inline T separate_bits_4d(T x)
     {
+        if constexpr (has_bmi2_path<T>)
+            return deposit_bits<T>(x,morton_lane_mask<T,4u>());
+
         if constexpr (bitDepth>32u)
         {
             x = (x | (x << 24)) & morton4d_mask<T>(3);
@@ -148,6 +234,281 @@ template<typename T, uint32_t bitDepth=sizeof(T)*8u>
 T morton3d_encode(T x, T y, T z) { return impl::separate_bits_3d<T,bitDepth>(x) | (impl::separate_bits_3d<T,bitDepth>(y)<<1) | (impl::separate_bits_3d<T,bitDepth>(z)<<2); }
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
 T morton4d_encode(T x, T y, T z, T w) { return impl::separate_bits_4d<T,bitDepth>(x) | (impl::separate_bits_4d<T,bitDepth>(y)<<1) | (impl::separate_bits_4d<T,bitDepth>(z)<<2) | (impl::separate_bits_4d<T,bitDepth>(w)<<3); }
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton3d_decode_x(T _morton) { return impl::morton3d_decode<T,bitDepth>(_morton); }
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton3d_decode_y(T _morton) { return impl::morton3d_decode<T,bitDepth>(_morton>>1); }
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton3d_decode_z(T _morton) { return impl::morton3d_decode<T,bitDepth>(_morton>>2); }
+
+//! Hilbert curve index of a point on a `2^order` by `2^order` grid, neighbouring indices are always neighbouring cells
+//! which Morton order can't guarantee, at the cost of a loop over the bits.
+template<typename T>
+T hilbert2d_encode(T x, T y, const uint32_t order)
+{
+    const T mask = order<sizeof(T)*8u ? ((T(1)<<order)-T(1)):~T(0);
+    T d = 0;
+    for (T s=T(1)<<(order-1u); s>T(0); s>>=1)
+    {
+        const T rx = (x&s) ? T(1):T(0);
+        const T ry = (y&s) ? T(1):T(0);
+        d += s*s*((T(3)*rx)^ry);
+        if (ry==T(0))
+        {
+            if (rx==T(1))
+            {
+                x ^= mask;
+                y ^= mask;
+            }
+            std::swap(x,y);
+        }
+    }
+    return d;
+}
+template<typename T>
+void hilbert2d_decode(T d, T& x, T& y, const uint32_t order)
+{
+    x = y = T(0);
+    for (uint32_t bit=0u; bit<order; bit++)
+    {
+        const T s = T(1)<<bit;
+        const T rx = T(1)&(d>>1);
+        const T ry = T(1)&(d^rx);
+        if (ry==T(0))
+        {
+            if (rx==T(1))
+            {
+                x = s-T(1)-x;
+                y = s-T(1)-y;
+            }
+            std::swap(x,y);
+        }
+        x += s*rx;
+        y += s*ry;
+        d >>= 2;
+    }
+}
+
+//! 3D Hilbert index through Skilling's transpose ("Programming the Hilbert curve", 2004), `order` bits per axis.
+//! The transposed form interleaved with the first axis as most significant is exactly a Morton code, so the final step reuses the encoder.
+template<typename T>
+T hilbert3d_encode(T x, T y, T z, const uint32_t order)
+{
+    T X[3] = {x,y,z};
+    const T M = T(1)<<(order-1u);
+    // inverse undo
+    for (T Q=M; Q>T(1); Q>>=1)
+    {
+        const T P = Q-T(1);
+        for (uint32_t i=0u; i<3u; i++)
+        {
+            if (X[i]&Q)
+                X[0] ^= P;
+            else
+            {
+                const T t = (X[0]^X[i])&P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    T t = 0;
+    for (T Q=M; Q>T(1); Q>>=1)
+    if (X[2]&Q)
+        t ^= Q-T(1);
+    for (uint32_t i=0u; i<3u; i++)
+        X[i] ^= t;
+
+    return morton3d_encode<T>(X[2],X[1],X[0]);
+}
+template<typename T>
+void hilbert3d_decode(const T d, T& x, T& y, T& z, const uint32_t order)
+{
+    T X[3] = {morton3d_decode_z<T>(d),morton3d_decode_y<T>(d),morton3d_decode_x<T>(d)};
+    const T N = T(2)<<(order-1u);
+    // gray decode
+    T t = X[2]>>1;
+    X[2] ^= X[1];
+    X[1] ^= X[0];
+    X[0] ^= t;
+    // undo excess work
+    for (T Q=T(2); Q!=N; Q<<=1)
+    {
+        const T P = Q-T(1);
+        for (uint32_t i=3u; i--;)
+        {
+            if (X[i]&Q)
+                X[0] ^= P;
+            else
+            {
+                t = (X[0]^X[i])&P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    x = X[0];
+    y = X[1];
+    z = X[2];
+}
+
+//! Turns a float coordinate into a `bits` wide fixed point grid coordinate over `[_min,_min+(2^bits-1)/_scale]` to feed the encoders above,
+//! `_scale` should come from `morton_quantization_scale`. Values outside get clamped and NaNs end up at 0.
+inline float morton_quantization_scale(const float _min, const float _max, const uint32_t bits)
+{
+    const float extent = _max-_min;
+    return extent>0.f ? float((1ull<<bits)-1ull)/extent:0.f;
+}
+inline uint32_t morton_quantize(const float value, const float _min, const float _scale, const uint32_t bits)
+{
+    const float maxValue = float((1ull<<bits)-1ull);
+    const float scaled = (value-_min)*_scale+0.5f;
+    // written so that NaN fails both comparisons
+    if (!(scaled>0.f))
+        return 0u;
+    if (!(scaled<maxValue))
+        return static_cast<uint32_t>((1ull<<bits)-1ull);
+    return static_cast<uint32_t>(scaled);
+}
+
+namespace impl
+{
+#ifdef __NBL_COMPILE_WITH_AVX2_
+    // same magic number sequences as the scalar versions, 8 codes at a time, only for 32bit codes
+    inline __m256i separate_bits_2d_x8(__m256i x)
+    {
+        x = _mm256_and_si256(x,_mm256_set1_epi32(0x0000FFFF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,8)),_mm256_set1_epi32(0x00FF00FF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,4)),_mm256_set1_epi32(0x0F0F0F0F));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,2)),_mm256_set1_epi32(0x33333333));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,1)),_mm256_set1_epi32(0x55555555));
+        return x;
+    }
+    inline __m256i compact_bits_2d_x8(__m256i x)
+    {
+        x = _mm256_and_si256(x,_mm256_set1_epi32(0x55555555));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,1)),_mm256_set1_epi32(0x33333333));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,2)),_mm256_set1_epi32(0x0F0F0F0F));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,4)),_mm256_set1_epi32(0x00FF00FF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,8)),_mm256_set1_epi32(0x0000FFFF));
+        return x;
+    }
+    inline __m256i separate_bits_3d_x8(__m256i x)
+    {
+        x = _mm256_and_si256(x,_mm256_set1_epi32(0x000003FF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,16)),_mm256_set1_epi32(0x030000FF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,8)),_mm256_set1_epi32(0x0300F00F));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,4)),_mm256_set1_epi32(0x030C30C3));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_slli_epi32(x,2)),_mm256_set1_epi32(0x09249249));
+        return x;
+    }
+    inline __m256i compact_bits_3d_x8(__m256i x)
+    {
+        x = _mm256_and_si256(x,_mm256_set1_epi32(0x09249249));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,2)),_mm256_set1_epi32(0x030C30C3));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,4)),_mm256_set1_epi32(0x0300F00F));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,8)),_mm256_set1_epi32(0x030000FF));
+        x = _mm256_and_si256(_mm256_or_si256(x,_mm256_srli_epi32(x,16)),_mm256_set1_epi32(0x000003FF));
+        return x;
+    }
+    inline __m256i loadu_x8(const uint32_t* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+    inline void storeu_x8(uint32_t* ptr, const __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr),v); }
+#endif
+}
+
+//! Batch versions of the above for sorting large key sets, every array needs space for `count` elements.
+//! 32bit codes hold 16 bits per axis in 2D and 10 bits per axis in 3D, 64bit codes hold 32 and 21.
+template<typename T>
+void morton2d_encode(const uint32_t* x, const uint32_t* y, T* out, const size_t count)
+{
+    static_assert(std::is_same_v<T,uint32_t> || std::is_same_v<T,uint64_t>);
+    size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+    if constexpr (std::is_same_v<T,uint32_t>)
+    for (; i+8ull<=count; i+=8ull)
+    {
+        const __m256i code = _mm256_or_si256(impl::separate_bits_2d_x8(impl::loadu_x8(x+i)),_mm256_slli_epi32(impl::separate_bits_2d_x8(impl::loadu_x8(y+i)),1));
+        impl::storeu_x8(out+i,code);
+    }
+#endif
+    for (; i<count; i++)
+        out[i] = morton2d_encode<T>(x[i],y[i]);
+}
+template<typename T>
+void morton3d_encode(const uint32_t* x, const uint32_t* y, const uint32_t* z, T* out, const size_t count)
+{
+    static_assert(std::is_same_v<T,uint32_t> || std::is_same_v<T,uint64_t>);
+    size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+    if constexpr (std::is_same_v<T,uint32_t>)
+    for (; i+8ull<=count; i+=8ull)
+    {
+        __m256i code = impl::separate_bits_3d_x8(impl::loadu_x8(x+i));
+        code = _mm256_or_si256(code,_mm256_slli_epi32(impl::separate_bits_3d_x8(impl::loadu_x8(y+i)),1));
+        code = _mm256_or_si256(code,_mm256_slli_epi32(impl::separate_bits_3d_x8(impl::loadu_x8(z+i)),2));
+        impl::storeu_x8(out+i,code);
+    }
+#endif
+    for (; i<count; i++)
+        out[i] = morton3d_encode<T>(x[i],y[i],z[i]);
+}
+template<typename T>
+void morton2d_decode(const T* in, uint32_t* x, uint32_t* y, const size_t count)
+{
+    static_assert(std::is_same_v<T,uint32_t> || std::is_same_v<T,uint64_t>);
+    size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+    if constexpr (std::is_same_v<T,uint32_t>)
+    for (; i+8ull<=count; i+=8ull)
+    {
+        const __m256i code = impl::loadu_x8(in+i);
+        impl::storeu_x8(x+i,impl::compact_bits_2d_x8(code));
+        impl::storeu_x8(y+i,impl::compact_bits_2d_x8(_mm256_srli_epi32(code,1)));
+    }
+#endif
+    for (; i<count; i++)
+    {
+        x[i] = static_cast<uint32_t>(morton2d_decode_x<T>(in[i]));
+        y[i] = static_cast<uint32_t>(morton2d_decode_y<T>(in[i]));
+    }
+}
+template<typename T>
+void morton3d_decode(const T* in, uint32_t* x, uint32_t* y, uint32_t* z, const size_t count)
+{
+    static_assert(std::is_same_v<T,uint32_t> || std::is_same_v<T,uint64_t>);
+    size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+    if constexpr (std::is_same_v<T,uint32_t>)
+    for (; i+8ull<=count; i+=8ull)
+    {
+        const __m256i code = impl::loadu_x8(in+i);
+        impl::storeu_x8(x+i,impl::compact_bits_3d_x8(code));
+        impl::storeu_x8(y+i,impl::compact_bits_3d_x8(_mm256_srli_epi32(code,1)));
+        impl::storeu_x8(z+i,impl::compact_bits_3d_x8(_mm256_srli_epi32(code,2)));
+    }
+#endif
+    for (; i<count; i++)
+    {
+        x[i] = static_cast<uint32_t>(morton3d_decode_x<T>(in[i]));
+        y[i] = static_cast<uint32_t>(morton3d_decode_y<T>(in[i]));
+        z[i] = static_cast<uint32_t>(morton3d_decode_z<T>(in[i]));
+    }
+}
+template<typename T>
+void hilbert2d_encode(const uint32_t* x, const uint32_t* y, T* out, const size_t count, const uint32_t order)
+{
+    for (size_t i=0ull; i<count; i++)
+        out[i] = hilbert2d_encode<T>(x[i],y[i],order);
+}
+template<typename T>
+void hilbert3d_encode(const uint32_t* x, const uint32_t* y, const uint32_t* z, T* out, const size_t count, const uint32_t order)
+{
+    for (size_t i=0ull; i<count; i++)
+        out[i] = hilbert3d_encode<T>(x[i],y[i],z[i],order);
+}
 
 }}
 
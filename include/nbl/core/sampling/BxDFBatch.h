@@ -0,0 +1,304 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_SAMPLING_BXDF_BATCH_H_INCLUDED_
+#define _NBL_CORE_SAMPLING_BXDF_BATCH_H_INCLUDED_
+
+#include "nbl/core/math/floatpacket.h"
+
+//! CPU batch evaluation and sampling of the shader BxDFs, for lightmap baking and material previews without a GPU
+/*
+	Ports of the models in `builtin/hlsl/bxdf` (delta reflection and transmission) and of the GLSL `builtin/glsl/bxdf`
+	library the HLSL one is being ported from (Lambertian and GGX conductor BRDFs), with the same clamping and
+	special-case behaviour so the CPU and GPU renderers converge to the same images.
+
+	Everything works in tangent space (N=+Z, T=+X, B=+Y) on Structure-of-Arrays inputs, directions are expected to be normalized.
+	Every model has a kernel in `bxdf::kernel` templated on the packet type, the batch functions run them 16 wide with AVX-512,
+	8 wide with AVX2 and finish the remainder with the `float` instantiation which is the scalar reference implementation.
+*/
+namespace nbl::core::bxdf
+{
+
+//! Per sample parameters of the GGX conductor BRDF, `ax==ay` for isotropic materials
+struct SGGXConductorParams
+{
+	const float* ax;
+	const float* ay;
+	//! complex index of refraction per RGB channel
+	const float* eta[3];
+	const float* etak[3];
+};
+
+namespace kernel
+{
+
+inline constexpr float ReciprocalPi = 0.318309886183790671538f;
+inline constexpr float FloatMin = 1.175494351e-38f;
+
+template<typename P>
+struct vec3
+{
+	P x, y, z;
+
+	inline P dot(const vec3& other) const { return packet::madd(x,other.x,packet::madd(y,other.y,z*other.z)); }
+	inline vec3 operator*(const P s) const { return {x*s,y*s,z*s}; }
+	inline vec3 operator-(const vec3& other) const { return {x-other.x,y-other.y,z-other.z}; }
+
+	static inline vec3 load(const float* const ptr[3], const uint32_t i)
+	{
+		return {packet::load<P>(ptr[0]+i),packet::load<P>(ptr[1]+i),packet::load<P>(ptr[2]+i)};
+	}
+	inline void store(float* const ptr[3], const uint32_t i) const
+	{
+		packet::store(ptr[0]+i,x);
+		packet::store(ptr[1]+i,y);
+		packet::store(ptr[2]+i,z);
+	}
+};
+
+//! `nbl_glsl_fresnel_conductor` for a single channel
+template<typename P>
+inline P fresnel_conductor(const P eta, const P etak, const P cosTheta)
+{
+	const P cosTheta2 = cosTheta*cosTheta;
+	const P etaLen2 = packet::madd(eta,eta,etak*etak);
+	const P etaCosTwice = eta*cosTheta*P(2.f);
+
+	const P rs_common = etaLen2+cosTheta2;
+	const P rs2 = (rs_common-etaCosTwice)/(rs_common+etaCosTwice);
+
+	const P rp_common = packet::madd(etaLen2,cosTheta2,P(1.f));
+	const P rp2 = (rp_common-etaCosTwice)/(rp_common+etaCosTwice);
+
+	return (rs2+rp2)*P(0.5f);
+}
+
+//! `nbl_glsl_ggx_aniso`
+template<typename P>
+inline P ggx_aniso(const P TdotH2, const P BdotH2, const P NdotH2, const P ax, const P ay, const P ax2, const P ay2)
+{
+	const P denom = TdotH2/ax2+BdotH2/ay2+NdotH2;
+	return P(ReciprocalPi)/(ax*ay*denom*denom);
+}
+
+//! `nbl_glsl_smith_ggx_devsh_part`
+template<typename P>
+inline P smith_ggx_devsh_part(const vec3<P>& X, const P ax2, const P ay2)
+{
+	return packet::sqrt(packet::madd(X.x*X.x,ax2,packet::madd(X.y*X.y,ay2,X.z*X.z)));
+}
+
+// Delta distributions, the quotient is always 1 and the pdf is infinite (see `transmission.hlsl` for why nothing needs checking)
+template<typename P>
+inline vec3<P> delta_reflection_generate(const vec3<P>& V)
+{
+	// `reflect(V,N,NdotV)` with N=+Z
+	return {-V.x,-V.y,V.z};
+}
+template<typename P>
+inline vec3<P> delta_transmission_generate(const vec3<P>& V)
+{
+	return {-V.x,-V.y,-V.z};
+}
+
+//! `nbl_glsl_lambertian_cos_eval` and `nbl_glsl_lambertian_pdf`, they're equal
+template<typename P>
+inline P lambertian_cos_eval(const P NdotL)
+{
+	return packet::max(NdotL,P(0.f))*P(ReciprocalPi);
+}
+
+//! `nbl_glsl_projected_hemisphere_generate`, the quotient is always 1 and the pdf is `L.z/PI`
+template<typename P>
+inline vec3<P> lambertian_cos_generate(P u0, P u1)
+{
+	// `nbl_glsl_concentricMapping` of the slightly shrunk sample
+	u0 = packet::madd(packet::madd(u0,P(0.99999f),P(0.000005f)),P(2.f),P(-1.f));
+	u1 = packet::madd(packet::madd(u1,P(0.99999f),P(0.000005f)),P(2.f),P(-1.f));
+
+	const auto xMajor = packet::abs(u0)>packet::abs(u1);
+	const P r = packet::select(xMajor,u0,u1);
+	const P ratio = packet::select(xMajor,u1,u0)/r;
+	constexpr float QuarterPi = 0.785398163397448309616f;
+	const P theta = packet::select(xMajor,ratio*P(QuarterPi),packet::madd(ratio,P(-QuarterPi),P(2.f*QuarterPi)));
+	P sinTheta, cosTheta;
+	packet::sincos(theta,sinTheta,cosTheta);
+
+	const auto origin = (u0==P(0.f))&(u1==P(0.f));
+	vec3<P> L;
+	L.x = packet::select(origin,P(0.f),r*cosTheta);
+	L.y = packet::select(origin,P(0.f),r*sinTheta);
+	L.z = packet::sqrt(packet::max(P(0.f),P(1.f)-packet::madd(L.x,L.x,L.y*L.y)));
+	return L;
+}
+
+//! `nbl_glsl_ggx_height_correlated_aniso_cos_eval` for the three colour channels and `nbl_glsl_ggx_pdf_wo_clamps`
+template<typename P>
+inline void ggx_cos_eval(const vec3<P>& V, const vec3<P>& L, const P ax, const P ay, const P eta[3], const P etak[3], P outValue[3], P& outPdf)
+{
+	const P NdotV = V.z;
+	const P NdotL = L.z;
+	const P ax2 = ax*ax;
+	const P ay2 = ay*ay;
+
+	// `nbl_glsl_calcAnisotropicMicrofacetCache` specialized for reflection
+	const P VdotL = V.dot(L);
+	const P LplusV_rcpLen = packet::rsqrt(packet::madd(VdotL,P(2.f),P(2.f)));
+	const P VdotH = packet::madd(LplusV_rcpLen,VdotL,LplusV_rcpLen);
+	const P NdotH = (NdotL+NdotV)*LplusV_rcpLen;
+	const P TdotH = (V.x+L.x)*LplusV_rcpLen;
+	const P BdotH = (V.y+L.y)*LplusV_rcpLen;
+
+	const P ndf = ggx_aniso(TdotH*TdotH,BdotH*BdotH,NdotH*NdotH,ax,ay,ax2,ay2);
+	const P devsh_v = smith_ggx_devsh_part(V,ax2,ay2);
+	const P devsh_l = smith_ggx_devsh_part(L,ax2,ay2);
+	// `nbl_glsl_ggx_pdf_wo_clamps` is the VNDF pdf
+	outPdf = ndf*P(0.5f)/(NdotV+devsh_v);
+
+	// `nbl_glsl_ggx_smith_correlated_wo_numerator`, skipped for perfectly smooth surfaces
+	const P G = P(0.5f)/packet::madd(NdotL,devsh_v,NdotV*devsh_l);
+	const P NG = packet::select((ax>P(FloatMin))|(ay>P(FloatMin)),ndf*G,ndf);
+
+	const auto valid = (NdotL>P(FloatMin))&(NdotV>P(FloatMin));
+	const P NG_cos = packet::select(valid,NG*NdotL,P(0.f));
+	for (uint32_t c=0u; c<3u; c++)
+		outValue[c] = NG_cos*fresnel_conductor(eta[c],etak[c],VdotH);
+}
+
+//! `nbl_glsl_ggx_cos_generate` (Heitz 2018 VNDF sampling) followed by `nbl_glsl_ggx_aniso_cos_remainder_and_pdf`
+template<typename P>
+inline vec3<P> ggx_cos_generate(const vec3<P>& V, const P u0, const P u1, const P ax, const P ay, const P eta[3], const P etak[3], P outQuotient[3], P& outPdf)
+{
+	// stretch view vector so that we're sampling as if roughness=1.0
+	vec3<P> S = {ax*V.x,ay*V.y,V.z};
+	S = S*packet::rsqrt(S.dot(S));
+
+	const P lensq = packet::madd(S.x,S.x,S.y*S.y);
+	const auto lensqPositive = lensq>P(0.f);
+	const P rcpLen = packet::rsqrt(packet::select(lensqPositive,lensq,P(1.f)));
+	const vec3<P> T1 = {packet::select(lensqPositive,-S.y*rcpLen,P(1.f)),packet::select(lensqPositive,S.x*rcpLen,P(0.f)),P(0.f)};
+	// cross(S,T1)
+	const vec3<P> T2 = {-S.z*T1.y,S.z*T1.x,S.x*T1.y-S.y*T1.x};
+
+	const P r = packet::sqrt(u0);
+	P sinPhi, cosPhi;
+	packet::sincos(u1*P(2.f/ReciprocalPi),sinPhi,cosPhi);
+	const P t1 = r*cosPhi;
+	const P s = packet::madd(S.z,P(0.5f),P(0.5f));
+	const P t2 = packet::madd(P(1.f)-s,packet::sqrt(P(1.f)-t1*t1),s*r*sinPhi);
+
+	// reprojection onto hemisphere
+	const P t3 = packet::sqrt(packet::max(P(0.f),P(1.f)-packet::madd(t1,t1,t2*t2)));
+	vec3<P> H = {
+		packet::madd(t1,T1.x,packet::madd(t2,T2.x,t3*S.x)),
+		packet::madd(t1,T1.y,packet::madd(t2,T2.y,t3*S.y)),
+		packet::madd(t2,T2.z,t3*S.z)
+	};
+	// unstretch
+	H = {ax*H.x,ay*H.y,H.z};
+	H = H*packet::rsqrt(H.dot(H));
+
+	const P VdotH = V.dot(H);
+	const vec3<P> L = H*(VdotH*P(2.f))-V;
+
+	const P NdotV = V.z;
+	const P NdotL = L.z;
+	const P ax2 = ax*ax;
+	const P ay2 = ay*ay;
+	const P devsh_v = smith_ggx_devsh_part(V,ax2,ay2);
+	const P ndf = ggx_aniso(H.x*H.x,H.y*H.y,H.z*H.z,ax,ay,ax2,ay2);
+	outPdf = ndf*P(0.5f)/(NdotV+devsh_v);
+
+	// `nbl_glsl_ggx_smith_G2_over_G1_devsh`
+	const P devsh_l = smith_ggx_devsh_part(L,ax2,ay2);
+	const P G2_over_G1 = NdotL*(devsh_v+NdotV)/packet::madd(NdotV,devsh_l,NdotL*devsh_v);
+	const auto valid = (NdotL>P(FloatMin))&(NdotV>P(FloatMin));
+	const P G2_over_G1_valid = packet::select(valid,G2_over_G1,P(0.f));
+	for (uint32_t c=0u; c<3u; c++)
+		outQuotient[c] = G2_over_G1_valid*fresnel_conductor(eta[c],etak[c],VdotH);
+	return L;
+}
+
+}
+
+//! Writes the perfect mirror directions of `V`, quotient is 1 and pdf is infinite
+inline void delta_reflection_generate(const float* const V[3], float* const outL[3], const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		kernel::delta_reflection_generate(kernel::vec3<P>::load(V,i)).store(outL,i);
+	});
+}
+//! Writes the straight-through directions of `V`, quotient is 1 and pdf is infinite
+inline void delta_transmission_generate(const float* const V[3], float* const outL[3], const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		kernel::delta_transmission_generate(kernel::vec3<P>::load(V,i)).store(outL,i);
+	});
+}
+
+//! Cosine weighted Lambertian BRDF value, which is also its sampling pdf
+inline void lambertian_cos_eval(const float* NdotL, float* outValueAndPdf, const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		packet::store(outValueAndPdf+i,kernel::lambertian_cos_eval(packet::load<P>(NdotL+i)));
+	});
+}
+//! Cosine weighted hemisphere sampling from uniform `u` in [0,1)^2, the quotient is always 1
+inline void lambertian_cos_generate(const float* const u[2], float* const outL[3], float* outPdf, const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		const auto L = kernel::lambertian_cos_generate(packet::load<P>(u[0]+i),packet::load<P>(u[1]+i));
+		L.store(outL,i);
+		if (outPdf)
+			packet::store(outPdf+i,L.z*P(kernel::ReciprocalPi));
+	});
+}
+
+//! Height correlated GGX conductor BRDF times the cosine, plus the pdf `ggx_cos_generate` would have generated `L` with
+inline void ggx_cos_eval(const float* const V[3], const float* const L[3], const SGGXConductorParams& params, float* const outValue[3], float* outPdf, const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		P eta[3], etak[3], value[3], pdf;
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			eta[c] = packet::load<P>(params.eta[c]+i);
+			etak[c] = packet::load<P>(params.etak[c]+i);
+		}
+		kernel::ggx_cos_eval(kernel::vec3<P>::load(V,i),kernel::vec3<P>::load(L,i),packet::load<P>(params.ax+i),packet::load<P>(params.ay+i),eta,etak,value,pdf);
+		for (uint32_t c=0u; c<3u; c++)
+			packet::store(outValue[c]+i,value[c]);
+		if (outPdf)
+			packet::store(outPdf+i,pdf);
+	});
+}
+//! Samples the distribution of visible GGX normals from uniform `u` in [0,1)^2, roughness must be non-zero
+inline void ggx_cos_generate(const float* const V[3], const float* const u[2], const SGGXConductorParams& params, float* const outL[3], float* const outQuotient[3], float* outPdf, const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		P eta[3], etak[3], quotient[3], pdf;
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			eta[c] = packet::load<P>(params.eta[c]+i);
+			etak[c] = packet::load<P>(params.etak[c]+i);
+		}
+		const auto L = kernel::ggx_cos_generate(
+			kernel::vec3<P>::load(V,i),packet::load<P>(u[0]+i),packet::load<P>(u[1]+i),
+			packet::load<P>(params.ax+i),packet::load<P>(params.ay+i),eta,etak,quotient,pdf
+		);
+		L.store(outL,i);
+		for (uint32_t c=0u; c<3u; c++)
+			packet::store(outQuotient[c]+i,quotient[c]);
+		if (outPdf)
+			packet::store(outPdf+i,pdf);
+	});
+}
+
+}
+
+#endif
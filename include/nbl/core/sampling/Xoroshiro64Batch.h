@@ -0,0 +1,348 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_SAMPLING_XOROSHIRO64_BATCH_H_INCLUDED_
+#define _NBL_CORE_SAMPLING_XOROSHIRO64_BATCH_H_INCLUDED_
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "nbl/core/math/floatpacket.h"
+#include "nbl/builtin/hlsl/random/xoroshiro.hlsl"
+
+namespace nbl::core
+{
+
+namespace impl
+{
+//! The Xoroshiro64 state transition is linear over GF(2), so advancing by `n` steps is multiplying the state by the `n`-th power of its 64x64 bit matrix
+struct Xoroshiro64Matrix
+{
+	// column `i` is the image of the state with only bit `i` set, state bits 0-31 are `state[0]` and 32-63 are `state[1]`
+	uint64_t columns[64];
+
+	static inline uint64_t pack(const hlsl::uint32_t2 state) {return uint64_t(state[0])|(uint64_t(state[1])<<32ull);}
+	static inline hlsl::uint32_t2 unpack(const uint64_t state) {return hlsl::uint32_t2(static_cast<uint32_t>(state),static_cast<uint32_t>(state>>32ull));}
+
+	static inline Xoroshiro64Matrix step()
+	{
+		Xoroshiro64Matrix retval;
+		for (uint32_t i=0u; i<64u; i++)
+		{
+			hlsl::Xoroshiro64StateHolder holder = {unpack(0x1ull<<i)};
+			holder.xoroshiro64_state_advance();
+			retval.columns[i] = pack(holder.state);
+		}
+		return retval;
+	}
+
+	inline uint64_t operator()(uint64_t state) const
+	{
+		uint64_t retval = 0ull;
+		for (; state; state&=state-1ull)
+			retval ^= columns[std::countr_zero(state)];
+		return retval;
+	}
+	inline Xoroshiro64Matrix operator*(const Xoroshiro64Matrix& rhs) const
+	{
+		Xoroshiro64Matrix retval;
+		for (uint32_t i=0u; i<64u; i++)
+			retval.columns[i] = operator()(rhs.columns[i]);
+		return retval;
+	}
+
+	//! Applies `steps` powers of this matrix to `state`
+	inline uint64_t pow(uint64_t state, uint64_t steps) const
+	{
+		for (Xoroshiro64Matrix power=*this; steps; steps>>=1ull)
+		{
+			if (steps&0x1ull)
+				state = power(state);
+			if (steps>1ull)
+				power = power*power;
+		}
+		return state;
+	}
+
+	//! 2^32 steps, the period is 2^64-1 so this splits it into 2^32 non-overlapping streams
+	static inline const Xoroshiro64Matrix& jump()
+	{
+		static const Xoroshiro64Matrix retval = []() -> Xoroshiro64Matrix
+		{
+			Xoroshiro64Matrix power = step();
+			for (uint32_t i=0u; i<32u; i++)
+				power = power*power;
+			return power;
+		}();
+		return retval;
+	}
+};
+
+// lane-parallel integer ops the generator needs, `Width` consecutive lanes per register
+struct Xoroshiro64Lanes1
+{
+	using reg_t = uint32_t;
+	static inline constexpr uint32_t Width = 1u;
+
+	static inline reg_t load(const uint32_t* ptr) {return *ptr;}
+	static inline void store(uint32_t* ptr, const reg_t v) {*ptr = v;}
+	template<uint32_t Shift>
+	static inline reg_t rotl(const reg_t x) {return std::rotl(x,Shift);}
+	template<uint32_t Shift>
+	static inline reg_t shl(const reg_t x) {return x<<Shift;}
+	static inline reg_t xor3(const reg_t a, const reg_t b, const reg_t c) {return a^b^c;}
+	static inline reg_t xor2(const reg_t a, const reg_t b) {return a^b;}
+	static inline reg_t mulGolden(const reg_t x) {return x*0x9E3779BBu;}
+	static inline reg_t mul5(const reg_t x) {return x*5u;}
+};
+#ifdef __NBL_COMPILE_WITH_AVX2_
+struct Xoroshiro64Lanes8
+{
+	using reg_t = __m256i;
+	static inline constexpr uint32_t Width = 8u;
+
+	static inline reg_t load(const uint32_t* ptr) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));}
+	static inline void store(uint32_t* ptr, const reg_t v) {_mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr),v);}
+	template<uint32_t Shift>
+	static inline reg_t rotl(const reg_t x) {return _mm256_or_si256(_mm256_slli_epi32(x,Shift),_mm256_srli_epi32(x,32u-Shift));}
+	template<uint32_t Shift>
+	static inline reg_t shl(const reg_t x) {return _mm256_slli_epi32(x,Shift);}
+	static inline reg_t xor3(const reg_t a, const reg_t b, const reg_t c) {return _mm256_xor_si256(_mm256_xor_si256(a,b),c);}
+	static inline reg_t xor2(const reg_t a, const reg_t b) {return _mm256_xor_si256(a,b);}
+	static inline reg_t mulGolden(const reg_t x) {return _mm256_mullo_epi32(x,_mm256_set1_epi32(0x9E3779BB));}
+	static inline reg_t mul5(const reg_t x) {return _mm256_add_epi32(_mm256_slli_epi32(x,2),x);}
+};
+#endif
+#ifdef __NBL_COMPILE_WITH_AVX512_
+struct Xoroshiro64Lanes16
+{
+	using reg_t = __m512i;
+	static inline constexpr uint32_t Width = 16u;
+
+	static inline reg_t load(const uint32_t* ptr) {return _mm512_loadu_si512(ptr);}
+	static inline void store(uint32_t* ptr, const reg_t v) {_mm512_storeu_si512(ptr,v);}
+	template<uint32_t Shift>
+	static inline reg_t rotl(const reg_t x) {return _mm512_rol_epi32(x,Shift);}
+	template<uint32_t Shift>
+	static inline reg_t shl(const reg_t x) {return _mm512_slli_epi32(x,Shift);}
+	// 0x96 is the truth table of a^b^c
+	static inline reg_t xor3(const reg_t a, const reg_t b, const reg_t c) {return _mm512_ternarylogic_epi32(a,b,c,0x96);}
+	static inline reg_t xor2(const reg_t a, const reg_t b) {return _mm512_xor_si512(a,b);}
+	static inline reg_t mulGolden(const reg_t x) {return _mm512_mullo_epi32(x,_mm512_set1_epi32(0x9E3779BB));}
+	static inline reg_t mul5(const reg_t x) {return _mm512_add_epi32(_mm512_slli_epi32(x,2),x);}
+};
+#endif
+}
+
+//! `Lanes` independent Xoroshiro64* (or Xoroshiro64** with `StarStar`) generators stepped together with SIMD
+/*
+	The state is kept interleaved (all the `state[0]`s then all the `state[1]`s), so one step of every lane is a handful of
+	AVX-512 or AVX2 instructions. Lane `i` produces exactly the sequence `hlsl::Xoroshiro64Star` (or `Xoroshiro64StarStar`)
+	would from the same state, `getLaneGenerator` gives the matching HLSL generator, so CPU and GPU results can be cross-checked.
+
+	The bulk `fill` functions write the lanes interleaved: element `k*Lanes+i` is the `k`-th number of lane `i`. When the count is
+	not a multiple of `Lanes` the last step is still taken by all the lanes, and the numbers which don't fit get thrown away.
+	Floats in [0,1) are `float(x>>8)*2^-24`, the same conversion in a shader gives bit-identical results. Normal deviates use
+	Box-Muller on the uniforms of lane `i` in steps `2k` and `2k+1`, with polynomial transcendentals, so they're only close to a GPU's.
+
+	Seeding from one state plus a stream index jumps every lane ahead by multiples of 2^32 steps, so all threads can use the same seed
+	with their own stream index and never overlap for 2^32 numbers per lane. The all-zero state is a fixed point and must not be used.
+*/
+template<uint32_t Lanes=8u, bool StarStar=false>
+class Xoroshiro64Batch
+{
+		static_assert(Lanes==8u || Lanes==16u, "Only 8 and 16 lane batches are supported");
+		using matrix_t = impl::Xoroshiro64Matrix;
+
+	public:
+		using state_t = hlsl::uint32_t2;
+		using lane_generator_t = std::conditional_t<StarStar,hlsl::Xoroshiro64StarStar,hlsl::Xoroshiro64Star>;
+		static inline constexpr uint32_t LaneCount = Lanes;
+
+		//! Lane `i` starts at `laneStates[i]`
+		explicit inline Xoroshiro64Batch(const state_t* laneStates)
+		{
+			for (uint32_t i=0u; i<Lanes; i++)
+			{
+				m_state0[i] = laneStates[i][0];
+				m_state1[i] = laneStates[i][1];
+			}
+		}
+		//! Lane `i` starts at `seed` jumped `stream*Lanes+i` times ahead by 2^32 steps
+		explicit inline Xoroshiro64Batch(const state_t seed, const uint64_t stream=0ull)
+		{
+			uint64_t state = matrix_t::jump().pow(matrix_t::pack(seed),stream*Lanes);
+			for (uint32_t i=0u; i<Lanes; i++)
+			{
+				const auto unpacked = matrix_t::unpack(state);
+				m_state0[i] = unpacked[0];
+				m_state1[i] = unpacked[1];
+				state = matrix_t::jump()(state);
+			}
+		}
+
+		//! Advances `state` by `steps` numbers in `O(log(steps))` 64x64 bit matrix products
+		static inline state_t advance(const state_t state, const uint64_t steps)
+		{
+			return matrix_t::unpack(matrix_t::step().pow(matrix_t::pack(state),steps));
+		}
+		//! Advances `state` by `count*2^32` numbers
+		static inline state_t jump(const state_t state, const uint64_t count=1ull)
+		{
+			return matrix_t::unpack(matrix_t::jump().pow(matrix_t::pack(state),count));
+		}
+
+		inline state_t getLaneState(const uint32_t lane) const {return state_t(m_state0[lane],m_state1[lane]);}
+		inline lane_generator_t getLaneGenerator(const uint32_t lane) const {return lane_generator_t::construct(getLaneState(lane));}
+
+		//! Skips `steps` numbers in every lane
+		inline void discard(const uint64_t steps)
+		{
+			if (steps==0ull)
+				return;
+			// the matrix power costs the same for every lane, so only build it once
+			matrix_t power = matrix_t::step(), accumulated;
+			bool first = true;
+			for (uint64_t remaining=steps; remaining; remaining>>=1ull)
+			{
+				if (remaining&0x1ull)
+				{
+					accumulated = first ? power:power*accumulated;
+					first = false;
+				}
+				if (remaining>1ull)
+					power = power*power;
+			}
+			for (uint32_t i=0u; i<Lanes; i++)
+			{
+				const auto state = matrix_t::unpack(accumulated(matrix_t::pack(getLaneState(i))));
+				m_state0[i] = state[0];
+				m_state1[i] = state[1];
+			}
+		}
+
+		//! One number from every lane, `out[i]` comes from lane `i`
+		inline void operator()(uint32_t* out)
+		{
+			generate(out,1ull);
+		}
+
+		inline void fill(uint32_t* out, const size_t count)
+		{
+			const size_t fullSteps = count/Lanes;
+			generate(out,fullSteps);
+			if (const size_t remainder=count-fullSteps*Lanes; remainder)
+			{
+				alignas(64) uint32_t last[Lanes];
+				generate(last,1ull);
+				std::memcpy(out+fullSteps*Lanes,last,remainder*sizeof(uint32_t));
+			}
+		}
+
+		//! Uniform floats in [0,1), multiples of 2^-24
+		inline void fillUnorm(float* out, const size_t count)
+		{
+			alignas(64) uint32_t chunk[ChunkSteps*Lanes];
+			for (size_t offset=0ull; offset<count; offset+=ChunkSteps*Lanes)
+			{
+				const size_t chunkCount = std::min<size_t>(count-offset,ChunkSteps*Lanes);
+				generate(chunk,(chunkCount+Lanes-1u)/Lanes);
+				for (size_t i=0ull; i<chunkCount; i++)
+					out[offset+i] = float(chunk[i]>>8u)*0x1.0p-24f;
+			}
+		}
+
+		//! Normally distributed floats
+		inline void fillNormal(float* out, const size_t count, const float mean=0.f, const float stddev=1.f)
+		{
+			alignas(64) uint32_t chunk[ChunkSteps*Lanes];
+			alignas(64) float radius[ChunkSteps/2u*Lanes];
+			alignas(64) float angle[ChunkSteps/2u*Lanes];
+			alignas(64) float cosines[ChunkSteps/2u*Lanes];
+			alignas(64) float sines[ChunkSteps/2u*Lanes];
+			for (size_t offset=0ull; offset<count; offset+=ChunkSteps*Lanes)
+			{
+				const size_t chunkCount = std::min<size_t>(count-offset,ChunkSteps*Lanes);
+				// steps get consumed in pairs, so round up to an even count
+				const size_t pairCount = (chunkCount+2u*Lanes-1u)/(2u*Lanes);
+				generate(chunk,pairCount*2ull);
+				for (size_t pair=0ull; pair<pairCount; pair++)
+				for (uint32_t i=0u; i<Lanes; i++)
+				{
+					// (0,1] so the log is finite
+					radius[pair*Lanes+i] = float((chunk[2u*pair*Lanes+i]>>8u)+1u)*0x1.0p-24f;
+					angle[pair*Lanes+i] = float(chunk[(2u*pair+1u)*Lanes+i]>>8u)*0x1.0p-24f;
+				}
+				packet::dispatch(pairCount*Lanes,[&]<typename P>(const size_t i) -> void
+				{
+					constexpr float MinusTwoLn2 = -1.38629436111989061883f;
+					constexpr float TwoPi = 6.28318530717958647692f;
+					const P r = packet::sqrt(packet::log2(packet::load<P>(radius+i))*P(MinusTwoLn2))*P(stddev);
+					P s, c;
+					packet::sincos(packet::load<P>(angle+i)*P(TwoPi),s,c);
+					packet::store(cosines+i,packet::madd(r,c,P(mean)));
+					packet::store(sines+i,packet::madd(r,s,P(mean)));
+				});
+				// pair `k` fills steps `2k` and `2k+1`
+				for (size_t i=0ull; i<chunkCount; i++)
+				{
+					const size_t pair = i/(2u*Lanes);
+					const size_t lane = i%Lanes;
+					out[offset+i] = (i/Lanes)&0x1u ? sines[pair*Lanes+lane]:cosines[pair*Lanes+lane];
+				}
+			}
+		}
+
+	protected:
+		// even, so the Box-Muller pairs never straddle chunks
+		static inline constexpr uint32_t ChunkSteps = 32u;
+
+		template<class V>
+		inline void generate_impl(uint32_t* out, const size_t steps)
+		{
+			constexpr uint32_t Groups = Lanes/V::Width;
+			typename V::reg_t s0[Groups], s1[Groups];
+			for (uint32_t g=0u; g<Groups; g++)
+			{
+				s0[g] = V::load(m_state0+g*V::Width);
+				s1[g] = V::load(m_state1+g*V::Width);
+			}
+			for (size_t k=0ull; k<steps; k++, out+=Lanes)
+			for (uint32_t g=0u; g<Groups; g++)
+			{
+				const auto product = V::mulGolden(s0[g]);
+				if constexpr (StarStar)
+					V::store(out+g*V::Width,V::mul5(V::template rotl<5u>(product)));
+				else
+					V::store(out+g*V::Width,product);
+				// same as `hlsl::Xoroshiro64StateHolder::xoroshiro64_state_advance`
+				s1[g] = V::xor2(s1[g],s0[g]);
+				s0[g] = V::xor3(V::template rotl<26u>(s0[g]),s1[g],V::template shl<9u>(s1[g]));
+				s1[g] = V::template rotl<13u>(s1[g]);
+			}
+			for (uint32_t g=0u; g<Groups; g++)
+			{
+				V::store(m_state0+g*V::Width,s0[g]);
+				V::store(m_state1+g*V::Width,s1[g]);
+			}
+		}
+		inline void generate(uint32_t* out, const size_t steps)
+		{
+#ifdef __NBL_COMPILE_WITH_AVX512_
+			if constexpr (Lanes%impl::Xoroshiro64Lanes16::Width==0u)
+				return generate_impl<impl::Xoroshiro64Lanes16>(out,steps);
+#endif
+#ifdef __NBL_COMPILE_WITH_AVX2_
+			if constexpr (Lanes%impl::Xoroshiro64Lanes8::Width==0u)
+				return generate_impl<impl::Xoroshiro64Lanes8>(out,steps);
+#endif
+			generate_impl<impl::Xoroshiro64Lanes1>(out,steps);
+		}
+
+		alignas(64) uint32_t m_state0[Lanes];
+		alignas(64) uint32_t m_state1[Lanes];
+};
+
+}
+#endif
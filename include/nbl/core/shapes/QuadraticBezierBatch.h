@@ -0,0 +1,794 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_SHAPES_QUADRATIC_BEZIER_BATCH_H_INCLUDED_
+#define _NBL_CORE_SHAPES_QUADRATIC_BEZIER_BATCH_H_INCLUDED_
+
+#include "nbl/core/math/floatpacket.h"
+#include "nbl/core/algorithm/spatial_sort.h"
+
+#include <bit>
+#include <cfloat>
+#include <limits>
+
+//! CPU batch queries on quadratic Béziers, for tessellating and binning 2D curves without a GPU
+/*
+	Ports of `shapes::QuadraticBezier`, `shapes::Quadratic::getClosestT` and the line and curve intersection equations of
+	`builtin/hlsl/shapes/beziers.hlsl` together with the `math/equations` solvers they use, keeping the same special cases
+	so CPU tessellation and culling agree with what the shaders compute.
+
+	Curves come as Structure-of-Arrays and query `i` always pairs curve `i` with point or line `i`. The kernels in `bezier::kernel`
+	are templated on the packet type, the batch functions run them 16 wide with AVX-512, 8 wide with AVX2 and finish with the `float`
+	instantiation, which is the scalar reference. Curve-curve intersection is the exception, implicitizing a curve cancels catastrophically
+	in single precision, so just like in the shader that one gets solved in doubles, one pair at a time.
+*/
+namespace nbl::core::bezier
+{
+
+//! Control points of the curves, one array per coordinate
+struct SQuadraticBezierSoA
+{
+	const float* P0[2];
+	const float* P1[2];
+	const float* P2[2];
+};
+
+namespace kernel
+{
+
+template<typename P>
+struct vec2
+{
+	P x, y;
+
+	inline P dot(const vec2& other) const { return packet::madd(x,other.x,y*other.y); }
+	//! z component of the 3D cross product
+	inline P cross(const vec2& other) const { return x*other.y-y*other.x; }
+	inline vec2 operator+(const vec2& other) const { return {x+other.x,y+other.y}; }
+	inline vec2 operator-(const vec2& other) const { return {x-other.x,y-other.y}; }
+	inline vec2 operator*(const P s) const { return {x*s,y*s}; }
+
+	static inline vec2 load(const float* const ptr[2], const uint32_t i) { return {packet::load<P>(ptr[0]+i),packet::load<P>(ptr[1]+i)}; }
+	inline void store(float* const ptr[2], const uint32_t i) const
+	{
+		packet::store(ptr[0]+i,x);
+		packet::store(ptr[1]+i,y);
+	}
+};
+
+//! `shapes::QuadraticBezier`
+template<typename P>
+struct QuadraticBezier
+{
+	vec2<P> P0, P1, P2;
+
+	static inline QuadraticBezier load(const SQuadraticBezierSoA& curves, const uint32_t i)
+	{
+		return {vec2<P>::load(curves.P0,i),vec2<P>::load(curves.P1,i),vec2<P>::load(curves.P2,i)};
+	}
+
+	//! Bernstein form, so `t=0` and `t=1` land exactly on the endpoints
+	inline vec2<P> evaluate(const P t) const
+	{
+		const P s = P(1.f)-t;
+		return P0*(s*s)+P1*(P(2.f)*s*t)+P2*(t*t);
+	}
+
+	//! Lanes where an extremum lies inside the curve also check it, from https://www.shadertoy.com/view/stfSzS
+	inline void computeAABB(vec2<P>& outMin, vec2<P>& outMax) const
+	{
+		outMin = {packet::min(P0.x,P2.x),packet::min(P0.y,P2.y)};
+		outMax = {packet::max(P0.x,P2.x),packet::max(P0.y,P2.y)};
+
+		const vec2<P> a = P0-P1*P(2.f)+P2;
+		const vec2<P> b = P1-P0;
+		// solution for the linear equation `at+b=0`, NaN and infinity for straight coordinates fail the range test
+		const vec2<P> t = {-b.x/a.x,-b.y/a.y};
+		const auto insideX = (t.x>P(0.f))&(t.x<P(1.f));
+		const auto insideY = (t.y>P(0.f))&(t.y<P(1.f));
+		const P qx = evaluate(t.x).x;
+		const P qy = evaluate(t.y).y;
+		outMin.x = packet::select(insideX,packet::min(outMin.x,qx),outMin.x);
+		outMax.x = packet::select(insideX,packet::max(outMax.x,qx),outMax.x);
+		outMin.y = packet::select(insideY,packet::min(outMin.y,qy),outMin.y);
+		outMax.y = packet::select(insideY,packet::max(outMax.y,qy),outMax.y);
+	}
+};
+
+//! `math::equations::Quadratic::computeRoots`, chooses the formula for each root which avoids cancellation
+template<typename P>
+inline void quadraticRoots(const P a, const P b, const P c, P (&outRoots)[2])
+{
+	const P det = b*b-P(4.f)*a*c;
+	const P detSqrt = packet::sqrt(det);
+	const P rcp = P(0.5f)/a;
+	const P bOver2A = b*rcp;
+	const auto positive = b>=P(0.f);
+	outRoots[0] = packet::select(positive,-detSqrt*rcp-bOver2A,P(2.f)*c/(detSqrt-b));
+	outRoots[1] = packet::select(positive,P(2.f)*c/(-b-detSqrt),detSqrt*rcp-bOver2A);
+}
+
+// `sign(x)*pow(abs(x),1/3)` like the shader does it
+template<typename P>
+inline P signedCbrt(const P x)
+{
+	const P retval = packet::pow(packet::abs(x),P(1.f/3.f));
+	return packet::select(x<P(0.f),-retval,retval);
+}
+
+//! `shapes::Quadratic`, the power basis form `At^2+Bt+C` of a curve
+template<typename P>
+struct Quadratic
+{
+	static inline constexpr uint32_t MaxCandidates = 3u;
+
+	vec2<P> A, B, C;
+
+	static inline Quadratic constructFromBezier(const QuadraticBezier<P>& curve)
+	{
+		return {curve.P0-curve.P1*P(2.f)+curve.P2,(curve.P1-curve.P0)*P(2.f),curve.P0};
+	}
+
+	inline vec2<P> evaluate(const P t) const
+	{
+		return {packet::madd(t,packet::madd(A.x,t,B.x),C.x),packet::madd(t,packet::madd(A.y,t,B.y),C.y)};
+	}
+
+	//! Stationary points of the squared distance to `pos`, unused candidates are `2^24` like in the shader
+	inline void getClosestCandidates(const vec2<P> pos, P (&candidates)[MaxCandidates]) const
+	{
+		// exponent so large it would wipe the mantissa on any relative operation
+		const P ParameterThreshold(16777216.f);
+
+		const vec2<P> Bdiv2 = B*P(0.5f);
+		const vec2<P> CsubPos = C-pos;
+		const P Alen2 = A.dot(A);
+		// if A = 0, solve linear instead
+		const auto linear = Alen2<P(1.f/8388608.f)*B.dot(B);
+		const P linearRoot = -B.dot(CsubPos)/B.dot(B);
+
+		// Reducing Quartic to Cubic Solution
+		const P kk = P(1.f)/Alen2;
+		const P kx = kk*Bdiv2.dot(A);
+		const P ky = kk*(P(2.f)*Bdiv2.dot(Bdiv2)+CsubPos.dot(A))/P(3.f);
+		const P kz = kk*CsubPos.dot(Bdiv2);
+
+		// Cardano's Solution to resolvent cubic of the form: y^3 + 3py + q = 0
+		const P p = ky-kx*kx;
+		const P p3 = p*p*p;
+		const P q = kx*(P(2.f)*kx*kx-P(3.f)*ky)+kz;
+		const P h = q*q+P(4.f)*p3;
+		const auto threeRoots = h<P(0.f);
+
+		// 3 roots, the clamp keeps rounding from taking `acos` out of its domain
+		const P z = packet::sqrt(-p);
+		const P v = packet::acos(packet::min(packet::max(q/(p*z*P(2.f)),P(-1.f)),P(1.f)))/P(3.f);
+		P sinV, m;
+		packet::sincos(v,sinV,m);
+		const P n = sinV*P(1.732050808f);
+
+		// 1 root
+		const P hSqrt = packet::sqrt(h);
+		P x0 = (hSqrt-q)*P(0.5f);
+		P x1 = (-hSqrt-q)*P(0.5f);
+		// Solving Catastrophic Cancellation when h and q are close (when p is near 0), linear Taylor expansion of sqrt(1+4p^3/q^2)
+		const auto cancels = packet::abs(packet::abs(hSqrt/q)-P(1.f))<P(0.0001f);
+		x0 = packet::select(cancels,p3/q,x0);
+		x1 = packet::select(cancels,-q-p3/q,x1);
+		const P oneRoot = signedCbrt(x0)+signedCbrt(x1)-kx;
+
+		candidates[0] = packet::select(linear,linearRoot,packet::select(threeRoots,(m+m)*z-kx,oneRoot));
+		candidates[1] = packet::select(linear|!threeRoots,ParameterThreshold,(-n-m)*z-kx);
+		candidates[2] = packet::select(linear|!threeRoots,ParameterThreshold,(n-m)*z-kx);
+	}
+
+	//! `getClosestT` which also hands out the squared distance to the closest point
+	inline P getClosestT(const vec2<P> pos, P& outDistanceSquared) const
+	{
+		P candidates[MaxCandidates];
+		getClosestCandidates(pos,candidates);
+
+		P closestT(0.f);
+		outDistanceSquared = P(std::numeric_limits<float>::max());
+		for (uint32_t i=0u; i<MaxCandidates; i++)
+		{
+			// NaN candidates clamp to 0 like the GPU's `clamp` does
+			const P t = packet::min(packet::max(candidates[i],P(0.f)),P(1.f));
+			const vec2<P> distVector = evaluate(t)-pos;
+			const P candidateDistanceSquared = distVector.dot(distVector);
+			const auto closer = candidateDistanceSquared<outDistanceSquared;
+			closestT = packet::select(closer,t,closestT);
+			outDistanceSquared = packet::select(closer,candidateDistanceSquared,outDistanceSquared);
+		}
+		return closestT;
+	}
+
+	//! Roots of `getBezierLineIntersectionEquation`, the rotation into the line's frame reduces to a cross product with its direction
+	inline void getLineIntersections(const vec2<P> lineStart, const vec2<P> lineVector, P (&outT)[2]) const
+	{
+		const vec2<P> lineDir = lineVector*packet::rsqrt(lineVector.dot(lineVector));
+		quadraticRoots(lineDir.cross(A),lineDir.cross(B),lineDir.cross(C-lineStart),outT);
+	}
+
+	//! Fewest uniform steps of `t` after which the polyline is within `tolerance` of the curve
+	/*
+		The chord of `[t0,t1]` misses the curve by exactly `A(t-t0)(t-t1)`, which is at most `|A|(t1-t0)^2/4` and doesn't
+		depend on where the segment is, so uniform steps are the optimal subdivision of a parabola.
+	*/
+	inline P getSegmentCount(const P tolerance, const P maxSegments) const
+	{
+		const P n = packet::sqrt(packet::sqrt(A.dot(A))*P(0.25f)/tolerance);
+		// ceil, NaN from a zero tolerance or a degenerate curve ends up at the max
+		return packet::max(packet::min(-packet::floor(-n),maxSegments),P(1.f));
+	}
+};
+
+}
+
+namespace impl
+{
+// `math::equations::Cubic::computeRoots`, unused roots are NaN
+inline void cubicRoots(const double (&c)[4], double (&s)[3])
+{
+	constexpr double Pi = 3.14159265358979323846;
+	s[0] = s[1] = s[2] = std::numeric_limits<double>::quiet_NaN();
+	uint32_t rootCount = 0u;
+
+	// normal form: x^3 + Ax^2 + Bx + C = 0
+	const double A = c[2]/c[3];
+	const double B = c[1]/c[3];
+	const double C = c[0]/c[3];
+
+	// substitute x = y - A/3 to eliminate quadric term: x^3 +px + q = 0
+	const double sq_A = A*A;
+	const double p = 1.0/3*(-1.0/3*sq_A+B);
+	const double q = 1.0/2*(2.0/27*A*sq_A-1.0/3*A*B+C);
+
+	// use Cardano's formula
+	const double cb_p = p*p*p;
+	const double D = q*q+cb_p;
+	if (D==0.0)
+	{
+		if (q==0.0) // one triple solution
+			s[rootCount++] = 0.0;
+		else // one single and one double solution
+		{
+			const double u = std::cbrt(-q);
+			s[rootCount++] = 2*u;
+			s[rootCount++] = -u;
+		}
+	}
+	else if (D<0.0) // Casus irreducibilis: three real solutions
+	{
+		const double phi = 1.0/3*std::acos(-q/std::sqrt(-cb_p));
+		const double t = 2*std::sqrt(-p);
+		s[rootCount++] = t*std::cos(phi);
+		s[rootCount++] = -t*std::cos(phi+Pi/3);
+		s[rootCount++] = -t*std::cos(phi-Pi/3);
+	}
+	else // one real solution
+	{
+		const double sqrt_D = std::sqrt(D);
+		s[rootCount++] = std::cbrt(sqrt_D-q)-std::cbrt(sqrt_D+q);
+	}
+
+	// resubstitute
+	const double sub = 1.0/3*A;
+	for (uint32_t i=0u; i<rootCount; i++)
+		s[i] -= sub;
+}
+
+// `math::equations::Quartic::computeRoots`, unused roots are NaN
+inline void quarticRoots(const double a, const double b, const double c, const double d, const double e, double (&s)[4])
+{
+	s[0] = s[1] = s[2] = s[3] = std::numeric_limits<double>::quiet_NaN();
+	uint32_t rootCount = 0u;
+
+	// normal form: x^4 + Ax^3 + Bx^2 + Cx + D = 0
+	const double A = b/a;
+	const double B = c/a;
+	const double C = d/a;
+	const double D = e/a;
+
+	// substitute x = y - A/4 to eliminate cubic term: x^4 + px^2 + qx + r = 0
+	const double sq_A = A*A;
+	const double p = -3.0/8*sq_A+B;
+	const double q = 1.0/8*sq_A*A-1.0/2*A*B+C;
+	const double r = -3.0/256*sq_A*sq_A+1.0/16*sq_A*B-1.0/4*A*C+D;
+
+	if (r==0.0)
+	{
+		// no absolute term: y(y^3 + py + q) = 0
+		double cubic[3];
+		cubicRoots({q,p,0.0,1.0},cubic);
+		for (uint32_t i=0u; i<3u; i++)
+			s[rootCount++] = cubic[i];
+	}
+	else
+	{
+		// solve the resolvent cubic and take the one real solution ...
+		double cubic[3];
+		cubicRoots({1.0/2*r*p-1.0/8*q*q,-r,-1.0/2*p,1.0},cubic);
+		double z = 0.0;
+		for (uint32_t i=0u; i<3u; i++)
+		if (!std::isnan(cubic[i]))
+		{
+			z = cubic[i];
+			break;
+		}
+
+		// ... to build two quadratic equations
+		double u = z*z-r;
+		double v = 2*z-p;
+		if (u==0.0)
+			u = 0.0;
+		else if (u>0.0)
+			u = std::sqrt(u);
+		else
+			return;
+		if (v==0.0)
+			v = 0.0;
+		else if (v>0.0)
+			v = std::sqrt(v);
+		else
+			return;
+
+		auto addQuadraticRoots = [&](const double qb, const double qc) -> void
+		{
+			const double det = qb*qb-4.0*qc;
+			const double detSqrt = std::sqrt(det);
+			const double roots[2] = {
+				qb>=0.0 ? (-detSqrt*0.5-qb*0.5):(2*qc/(-qb+detSqrt)),
+				qb>=0.0 ? (2*qc/(-qb-detSqrt)):(detSqrt*0.5-qb*0.5)
+			};
+			for (const double root : roots)
+			if (!std::isinf(root) && !std::isnan(root))
+				s[rootCount++] = root;
+		};
+		addQuadraticRoots(q<0.0 ? -v:v,z-u);
+		addQuadraticRoots(q<0.0 ? v:-v,z+u);
+	}
+
+	// resubstitute
+	const double sub = 1.0/4*A;
+	for (uint32_t i=0u; i<rootCount; i++)
+		s[i] -= sub;
+}
+
+// `getBezierBezierIntersectionEquation` followed by solving it, writes the roots for `lhs`'s parameter
+inline void bezierBezierIntersections(const double (&lhs)[3][2], const double (&rhs)[3][2], double (&outRoots)[4])
+{
+	// Implicitize `rhs` into kx^2 + bxy + cy^2 + dx + ey + f = 0 (Computer Aided Geometric Design, chapter 17.6)
+	const double p0x = rhs[0][0], p1x = rhs[1][0], p2x = rhs[2][0];
+	const double p0y = rhs[0][1], p1y = rhs[1][1], p2y = rhs[2][1];
+	const double k0 = (4*p0y*p1y)-(4*p0y*p2y)-(4*(p1y*p1y))+(4*p1y*p2y)-((p0y*p0y))+(2*p0y*p2y)-((p2y*p2y));
+	const double k1 = -(4*p0x*p1y)+(4*p0x*p2y)-(4*p1x*p0y)+(8*p1x*p1y)-(4*p1x*p2y)+(4*p2x*p0y)-(4*p2x*p1y)+(2*p0x*p0y)-(2*p0x*p2y)-(2*p2x*p0y)+(2*p2x*p2y);
+	const double k2 = (4*p0x*p1x)-(4*p0x*p2x)-(4*(p1x*p1x))+(4*p1x*p2x)-((p0x*p0x))+(2*p0x*p2x)-((p2x*p2x));
+	const double k3 = (4*p0x*(p1y*p1y))-(4*p0x*p1y*p2y)-(4*p1x*p0y*p1y)+(8*p1x*p0y*p2y)-(4*p1x*p1y*p2y)-(4*p2x*p0y*p1y)+(4*p2x*(p1y*p1y))-(2*p0x*p0y*p2y)+(2*p0x*(p2y*p2y))+(2*p2x*(p0y*p0y))-(2*p2x*p0y*p2y);
+	const double k4 = -(4*p0x*p1x*p1y)-(4*p0x*p1x*p2y)+(8*p0x*p2x*p1y)+(4*(p1x*p1x)*p0y)+(4*(p1x*p1x)*p2y)-(4*p1x*p2x*p0y)-(4*p1x*p2x*p1y)+(2*(p0x*p0x)*p2y)-(2*p0x*p2x*p0y)-(2*p0x*p2x*p2y)+(2*(p2x*p2x)*p0y);
+	const double k5 = (4*p0x*p1x*p1y*p2y)-(4*(p1x*p1x)*p0y*p2y)+(4*p1x*p2x*p0y*p1y)-((p0x*p0x)*(p2y*p2y))+(2*p0x*p2x*p0y*p2y)-((p2x*p2x)*(p0y*p0y))-(4*p0x*p2x*(p1y*p1y));
+
+	// substitute the power basis of `lhs` into the implicit equation
+	double A[2], B[2], C[2];
+	for (uint32_t i=0u; i<2u; i++)
+	{
+		A[i] = lhs[0][i]-2.0*lhs[1][i]+lhs[2][i];
+		B[i] = 2.0*(lhs[1][i]-lhs[0][i]);
+		C[i] = lhs[0][i];
+	}
+	const double a = ((A[0]*A[0])*k0)+(A[0]*A[1]*k1)+(A[1]*A[1]*k2);
+	const double b = (2*A[0]*B[0]*k0)+(A[0]*B[1]*k1)+(B[0]*A[1]*k1)+(2*A[1]*B[1]*k2);
+	const double c = (2*A[0]*C[0]*k0)+(A[0]*C[1]*k1)+(A[0]*k3)+((B[0]*B[0])*k0)+(B[0]*B[1]*k1)+(C[0]*A[1]*k1)+(2*A[1]*C[1]*k2)+(A[1]*k4)+((B[1]*B[1])*k2);
+	const double d = (2*B[0]*C[0]*k0)+(B[0]*C[1]*k1)+(B[0]*k3)+(C[0]*B[1]*k1)+(2*B[1]*C[1]*k2)+(B[1]*k4);
+	const double e = ((C[0]*C[0])*k0)+(C[0]*C[1]*k1)+(C[0]*k3)+((C[1]*C[1])*k2)+(C[1]*k4)+(k5);
+	quarticRoots(a,b,c,d,e,outRoots);
+}
+}
+
+//! Bounding boxes of the curves, tight ones which account for the extrema
+inline void computeAABB(const SQuadraticBezierSoA& curves, float* const outMin[2], float* const outMax[2], const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		kernel::vec2<P> aabbMin, aabbMax;
+		kernel::QuadraticBezier<P>::load(curves,i).computeAABB(aabbMin,aabbMax);
+		aabbMin.store(outMin,i);
+		aabbMax.store(outMax,i);
+	});
+}
+
+//! Parameter of the point of curve `i` closest to `pos` `i`, optionally with the distance to it
+inline void closestPoint(const SQuadraticBezierSoA& curves, const float* const pos[2], float* outT, float* outDistance, const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		const auto quadratic = kernel::Quadratic<P>::constructFromBezier(kernel::QuadraticBezier<P>::load(curves,i));
+		P distanceSquared;
+		packet::store(outT+i,quadratic.getClosestT(kernel::vec2<P>::load(pos,i),distanceSquared));
+		if (outDistance)
+			packet::store(outDistance+i,packet::sqrt(distanceSquared));
+	});
+}
+
+//! Parameters where curve `i` crosses the infinite line through `lineStart` `i` along `lineVector` `i`
+/**
+	Roots outside of [0,1] are replaced by NaN, a curve touching the line writes the same parameter twice.
+*/
+inline void intersectLine(const SQuadraticBezierSoA& curves, const float* const lineStart[2], const float* const lineVector[2], float* const outT[2], const uint32_t count)
+{
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		const auto quadratic = kernel::Quadratic<P>::constructFromBezier(kernel::QuadraticBezier<P>::load(curves,i));
+		P roots[2];
+		quadratic.getLineIntersections(kernel::vec2<P>::load(lineStart,i),kernel::vec2<P>::load(lineVector,i),roots);
+		for (uint32_t r=0u; r<2u; r++)
+			packet::store(outT[r]+i,packet::select((roots[r]>=P(0.f))&(roots[r]<=P(1.f)),roots[r],P(std::numeric_limits<float>::quiet_NaN())));
+	});
+}
+
+//! Parameters along curve `i` of `lhs` where it crosses the parabola curve `i` of `rhs` lies on, ascending and padded with NaN
+/**
+	Only `lhs`'s parameters are range checked, to know whether a crossing lies within `rhs` too run the query with the curves swapped
+	or call `closestPoint` on the crossings. Degenerate pairs (straight or overlapping curves) give no crossings.
+*/
+template<class ExecutionPolicy>
+inline void intersect(ExecutionPolicy&& policy, const SQuadraticBezierSoA& lhs, const SQuadraticBezierSoA& rhs, float* const outT[4], const uint32_t count)
+{
+	core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),count,0x1000u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+	{
+		for (uint32_t i=begin; i<end; i++)
+		{
+			double lhsPoints[3][2], rhsPoints[3][2];
+			for (uint32_t c=0u; c<2u; c++)
+			{
+				lhsPoints[0][c] = lhs.P0[c][i]; lhsPoints[1][c] = lhs.P1[c][i]; lhsPoints[2][c] = lhs.P2[c][i];
+				rhsPoints[0][c] = rhs.P0[c][i]; rhsPoints[1][c] = rhs.P1[c][i]; rhsPoints[2][c] = rhs.P2[c][i];
+			}
+			double roots[4];
+			impl::bezierBezierIntersections(lhsPoints,rhsPoints,roots);
+
+			float sorted[4];
+			uint32_t found = 0u;
+			for (const double root : roots)
+			if (root>=0.0 && root<=1.0)
+				sorted[found++] = static_cast<float>(root);
+			std::sort(sorted,sorted+found);
+			for (uint32_t r=0u; r<4u; r++)
+				outT[r][i] = r<found ? sorted[r]:std::numeric_limits<float>::quiet_NaN();
+		}
+	});
+}
+
+//! Splits every curve into a polyline which stays within `tolerance` of it, using at most `maxSegments` segments per curve
+/**
+	`outOffsets` gets `count+1` entries, the polyline of curve `i` are the points `[outOffsets[i],outOffsets[i+1])` of `outPoints`
+	including both endpoints, which are exactly the control points so neighbouring curves stay watertight.
+*/
+template<class ExecutionPolicy>
+inline void tessellate(
+	ExecutionPolicy&& policy, const SQuadraticBezierSoA& curves, const uint32_t count, const float tolerance, const uint32_t maxSegments,
+	core::vector<uint32_t>& outOffsets, core::vector<float> (&outPoints)[2]
+)
+{
+	outOffsets.resize(count+1u);
+	core::vector<float> segmentCounts(count);
+	packet::dispatch(count,[&]<typename P>(const uint32_t i) -> void
+	{
+		const auto quadratic = kernel::Quadratic<P>::constructFromBezier(kernel::QuadraticBezier<P>::load(curves,i));
+		packet::store(segmentCounts.data()+i,quadratic.getSegmentCount(P(tolerance),P(float(maxSegments))));
+	});
+	outOffsets[0] = 0u;
+	for (uint32_t i=0u; i<count; i++)
+		outOffsets[i+1u] = outOffsets[i]+static_cast<uint32_t>(segmentCounts[i])+1u;
+	for (auto& coordinate : outPoints)
+		coordinate.resize(outOffsets[count]);
+
+	core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),count,0x400u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+	{
+		alignas(64) constexpr float Iota[16] = {0.f,1.f,2.f,3.f,4.f,5.f,6.f,7.f,8.f,9.f,10.f,11.f,12.f,13.f,14.f,15.f};
+		float* const out[2] = {outPoints[0].data(),outPoints[1].data()};
+		for (uint32_t i=begin; i<end; i++)
+		{
+			const float segments = segmentCounts[i];
+			const float rcpSegments = 1.f/segments;
+			const uint32_t offset = outOffsets[i];
+			packet::dispatch(static_cast<uint32_t>(segments)+1u,[&]<typename P>(const uint32_t j) -> void
+			{
+				const kernel::QuadraticBezier<P> curve = {
+					{P(curves.P0[0][i]),P(curves.P0[1][i])},
+					{P(curves.P1[0][i]),P(curves.P1[1][i])},
+					{P(curves.P2[0][i]),P(curves.P2[1][i])}
+				};
+				const P index = packet::load<P>(Iota)+P(float(j));
+				// last point gets `t` of exactly 1
+				const P t = packet::select(index<P(segments),index*P(rcpSegments),P(1.f));
+				curve.evaluate(t).store(out,offset+j);
+			});
+		}
+	});
+}
+
+//! Bounding volume hierarchy over many curves, to bin them into screen tiles and find the curve closest to points
+/*
+	Curves get sorted along a Morton curve through their bounds' centers and the hierarchy is built top-down by splitting at the
+	highest differing bit of the codes, falling back to the median for duplicate codes. Leaves hold up to `MaxLeafSize` curves, whose
+	power basis form is stored in leaf order so that a leaf gets tested with one packet.
+*/
+class CQuadraticBezierBVH
+{
+	public:
+		static inline constexpr uint32_t MaxLeafSize = 8u;
+
+		struct SNode
+		{
+			float aabbMin[2];
+			float aabbMax[2];
+			//! first curve of a leaf in leaf order, or the index of the second child of an internal node, the first child being the next node
+			uint32_t first;
+			//! zero for internal nodes
+			uint32_t count;
+		};
+
+		template<class ExecutionPolicy>
+		inline CQuadraticBezierBVH(ExecutionPolicy&& policy, const SQuadraticBezierSoA& curves, const uint32_t count) : m_order(count)
+		{
+			if (count==0u)
+				return;
+
+			core::vector<float> aabbs[4];
+			for (auto& bound : aabbs)
+				bound.resize(count);
+			{
+				float* const outMin[2] = {aabbs[0].data(),aabbs[1].data()};
+				float* const outMax[2] = {aabbs[2].data(),aabbs[3].data()};
+				computeAABB(curves,outMin,outMax,count);
+			}
+			float sceneMin[3] = {FLT_MAX,FLT_MAX,0.f};
+			float sceneMax[3] = {-FLT_MAX,-FLT_MAX,0.f};
+			core::vector<float> centers(count*3u);
+			for (uint32_t i=0u; i<count; i++)
+			for (uint32_t c=0u; c<2u; c++)
+			{
+				sceneMin[c] = std::min(sceneMin[c],aabbs[c][i]);
+				sceneMax[c] = std::max(sceneMax[c],aabbs[c+2u][i]);
+				centers[i*3u+c] = (aabbs[c][i]+aabbs[c+2u][i])*0.5f;
+			}
+			core::vector<uint64_t> keys(count);
+			// the third axis is flat, so it never contributes a bit and 16 bits per axis still fit the radix sort's budget
+			core::spatial_sort<16u>(std::forward<ExecutionPolicy>(policy),ESFC_MORTON,centers.data(),sizeof(float)*3u,count,sceneMin,sceneMax,m_order.data(),keys.data());
+
+			for (auto& coefficients : m_coefficients)
+				coefficients.resize(count);
+			for (uint32_t i=0u; i<count; i++)
+			{
+				const uint32_t curve = m_order[i];
+				const auto quadratic = kernel::Quadratic<float>::constructFromBezier({
+					{curves.P0[0][curve],curves.P0[1][curve]},
+					{curves.P1[0][curve],curves.P1[1][curve]},
+					{curves.P2[0][curve],curves.P2[1][curve]}
+				});
+				const float coefficients[6] = {quadratic.A.x,quadratic.A.y,quadratic.B.x,quadratic.B.y,quadratic.C.x,quadratic.C.y};
+				for (uint32_t c=0u; c<6u; c++)
+					m_coefficients[c][i] = coefficients[c];
+			}
+
+			m_nodes.reserve((count/MaxLeafSize+1u)*2u);
+			build(0u,count,keys.data(),aabbs);
+		}
+
+		inline uint32_t getCurveCount() const {return static_cast<uint32_t>(m_order.size());}
+		inline const core::vector<SNode>& getNodes() const {return m_nodes;}
+		//! maps leaf order to the index of the curve passed to the constructor
+		inline const core::vector<uint32_t>& getCurveOrder() const {return m_order;}
+
+		//! Calls `visitor(leafOrderIndex)` for every curve whose bounds grown by `margin` overlap `[aabbMin,aabbMax]`
+		template<typename F>
+		inline void queryAABB(const float aabbMin[2], const float aabbMax[2], const float margin, F&& visitor) const
+		{
+			if (m_nodes.empty())
+				return;
+			uint32_t stack[MaxDepth];
+			uint32_t stackSize = 0u;
+			stack[stackSize++] = 0u;
+			while (stackSize)
+			{
+				const uint32_t nodeIndex = stack[--stackSize];
+				const SNode& node = m_nodes[nodeIndex];
+				if (node.aabbMin[0]-margin>aabbMax[0] || node.aabbMin[1]-margin>aabbMax[1] || node.aabbMax[0]+margin<aabbMin[0] || node.aabbMax[1]+margin<aabbMin[1])
+					continue;
+				if (node.count)
+				{
+					for (uint32_t i=0u; i<node.count; i++)
+						visitor(node.first+i);
+				}
+				else
+				{
+					stack[stackSize++] = node.first;
+					stack[stackSize++] = nodeIndex+1u;
+				}
+			}
+		}
+
+		//! Lists the curves touching every tile of a `tileCount[0]` by `tileCount[1]` grid, for strokes `halfThickness` away from the curves
+		/**
+			Tiles are row-major, `outOffsets` gets an entry per tile plus one and tile `i` lists the curves `[outOffsets[i],outOffsets[i+1])`
+			of `outCurves`, in ascending order of their original index so drawing order is kept.
+			Candidates from the hierarchy are refined by the distance from the tile's center, so curves which only graze a tile with their
+			bounds get culled, the test is conservative and never drops a curve which covers part of the tile.
+		*/
+		template<class ExecutionPolicy>
+		inline void binTiles(
+			ExecutionPolicy&& policy, const float origin[2], const float tileSize[2], const uint32_t tileCount[2], const float halfThickness,
+			core::vector<uint32_t>& outOffsets, core::vector<uint32_t>& outCurves
+		) const
+		{
+			const uint32_t totalTiles = tileCount[0]*tileCount[1];
+			const float halfDiagonal = std::sqrt(tileSize[0]*tileSize[0]+tileSize[1]*tileSize[1])*0.5f;
+			const float maxDistance = halfDiagonal+halfThickness;
+			auto forEachCurve = [&](const uint32_t tile, auto&& func) -> void
+			{
+				const float tileMin[2] = {origin[0]+tileSize[0]*float(tile%tileCount[0]),origin[1]+tileSize[1]*float(tile/tileCount[0])};
+				const float tileMax[2] = {tileMin[0]+tileSize[0],tileMin[1]+tileSize[1]};
+				const kernel::vec2<float> center = {(tileMin[0]+tileMax[0])*0.5f,(tileMin[1]+tileMax[1])*0.5f};
+				queryAABB(tileMin,tileMax,halfThickness,[&](const uint32_t i) -> void
+				{
+					float distanceSquared;
+					getQuadratic<float>(i).getClosestT(center,distanceSquared);
+					if (std::sqrt(distanceSquared)<=maxDistance)
+						func(m_order[i]);
+				});
+			};
+
+			// count, then fill, so tiles can be handled in parallel without any per tile allocations
+			outOffsets.assign(totalTiles+1u,0u);
+			core::parallel_for_batches(policy,totalTiles,0x40u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+			{
+				for (uint32_t tile=begin; tile<end; tile++)
+					forEachCurve(tile,[&](const uint32_t) -> void {outOffsets[tile+1u]++;});
+			});
+			for (uint32_t tile=0u; tile<totalTiles; tile++)
+				outOffsets[tile+1u] += outOffsets[tile];
+			outCurves.resize(outOffsets[totalTiles]);
+			core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),totalTiles,0x40u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+			{
+				for (uint32_t tile=begin; tile<end; tile++)
+				{
+					uint32_t* const first = outCurves.data()+outOffsets[tile];
+					uint32_t* out = first;
+					forEachCurve(tile,[&](const uint32_t curve) -> void {*(out++) = curve;});
+					std::sort(first,out);
+				}
+			});
+		}
+
+		//! Finds the closest curve to each point, its parameter and the distance, curves further than `maxDistance` are ignored
+		/**
+			Points with no curve in range get `~0u` as the curve, with the parameter and distance left as they were.
+			Nodes are visited nearest first and culled by the distance to their bounds, leaves get tested one packet at a time.
+		*/
+		template<class ExecutionPolicy>
+		inline void closestCurves(
+			ExecutionPolicy&& policy, const float* const pos[2], const uint32_t count,
+			uint32_t* outCurve, float* outT, float* outDistance, const float maxDistance=FLT_MAX
+		) const
+		{
+			core::parallel_for_batches(std::forward<ExecutionPolicy>(policy),count,0x100u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+			{
+				for (uint32_t i=begin; i<end; i++)
+				{
+					outCurve[i] = ~0u;
+					if (m_nodes.empty())
+						continue;
+
+					const kernel::vec2<float> point = {pos[0][i],pos[1][i]};
+					auto distanceSquaredToNode = [&](const SNode& node) -> float
+					{
+						const float dx = std::max(std::max(node.aabbMin[0]-point.x,point.x-node.aabbMax[0]),0.f);
+						const float dy = std::max(std::max(node.aabbMin[1]-point.y,point.y-node.aabbMax[1]),0.f);
+						return dx*dx+dy*dy;
+					};
+
+					float closestDistanceSquared = maxDistance<FLT_MAX ? maxDistance*maxDistance:FLT_MAX;
+					uint32_t stack[MaxDepth];
+					uint32_t stackSize = 0u;
+					stack[stackSize++] = 0u;
+					while (stackSize)
+					{
+						const SNode& node = m_nodes[stack[--stackSize]];
+						if (distanceSquaredToNode(node)>closestDistanceSquared)
+							continue;
+						if (node.count)
+						{
+							float t[MaxLeafSize], distanceSquared[MaxLeafSize];
+							packet::dispatch(node.count,[&]<typename P>(const uint32_t j) -> void
+							{
+								P leafDistanceSquared;
+								packet::store(t+j,getQuadratic<P>(node.first+j).getClosestT({P(point.x),P(point.y)},leafDistanceSquared));
+								packet::store(distanceSquared+j,leafDistanceSquared);
+							});
+							for (uint32_t j=0u; j<node.count; j++)
+							if (distanceSquared[j]<closestDistanceSquared || (distanceSquared[j]==closestDistanceSquared && outCurve[i]!=~0u && m_order[node.first+j]<outCurve[i]))
+							{
+								closestDistanceSquared = distanceSquared[j];
+								outCurve[i] = m_order[node.first+j];
+								outT[i] = t[j];
+							}
+						}
+						else
+						{
+							// push the further child first, so the nearer one shrinks the search radius before it gets looked at
+							const uint32_t children[2] = {static_cast<uint32_t>(&node-m_nodes.data())+1u,node.first};
+							const bool firstIsNearer = distanceSquaredToNode(m_nodes[children[0]])<=distanceSquaredToNode(m_nodes[children[1]]);
+							stack[stackSize++] = children[firstIsNearer ? 1u:0u];
+							stack[stackSize++] = children[firstIsNearer ? 0u:1u];
+						}
+					}
+					if (outDistance && outCurve[i]!=~0u)
+						outDistance[i] = std::sqrt(closestDistanceSquared);
+				}
+			});
+		}
+
+	protected:
+		// a split per key bit plus the median splits of a single key, which never hold more than 2^32 curves
+		static inline constexpr uint32_t MaxDepth = 64u+32u;
+
+		template<typename P>
+		inline kernel::Quadratic<P> getQuadratic(const uint32_t i) const
+		{
+			const auto load = [&](const uint32_t c) -> P {return packet::load<P>(m_coefficients[c].data()+i);};
+			return {{load(0u),load(1u)},{load(2u),load(3u)},{load(4u),load(5u)}};
+		}
+
+		// builds the subtree over the leaf ordered curves `[begin,end)` and returns its root
+		inline uint32_t build(const uint32_t begin, const uint32_t end, const uint64_t* keys, const core::vector<float> (&aabbs)[4])
+		{
+			const uint32_t nodeIndex = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.emplace_back();
+			if (end-begin<=MaxLeafSize)
+			{
+				SNode node = {{FLT_MAX,FLT_MAX},{-FLT_MAX,-FLT_MAX},begin,end-begin};
+				for (uint32_t i=begin; i<end; i++)
+				for (uint32_t c=0u; c<2u; c++)
+				{
+					node.aabbMin[c] = std::min(node.aabbMin[c],aabbs[c][m_order[i]]);
+					node.aabbMax[c] = std::max(node.aabbMax[c],aabbs[c+2u][m_order[i]]);
+				}
+				m_nodes[nodeIndex] = node;
+				return nodeIndex;
+			}
+
+			uint32_t split = (begin+end)/2u;
+			const uint64_t differingBits = keys[begin]^keys[end-1u];
+			if (differingBits)
+			{
+				// the keys are sorted, so the first one with the highest differing bit set starts the second half
+				const uint64_t highestBit = 0x1ull<<(63u-std::countl_zero(differingBits));
+				split = static_cast<uint32_t>(std::partition_point(keys+begin,keys+end,[&](const uint64_t key) -> bool {return !(key&highestBit);})-keys);
+			}
+			build(begin,split,keys,aabbs);
+			const uint32_t second = build(split,end,keys,aabbs);
+
+			const SNode& left = m_nodes[nodeIndex+1u];
+			const SNode& right = m_nodes[second];
+			SNode node;
+			for (uint32_t c=0u; c<2u; c++)
+			{
+				node.aabbMin[c] = std::min(left.aabbMin[c],right.aabbMin[c]);
+				node.aabbMax[c] = std::max(left.aabbMax[c],right.aabbMax[c]);
+			}
+			node.first = second;
+			node.count = 0u;
+			m_nodes[nodeIndex] = node;
+			return nodeIndex;
+		}
+
+		core::vector<uint32_t> m_order;
+		// A, B and C of the power basis per coordinate, in leaf order
+		core::vector<float> m_coefficients[6];
+		core::vector<SNode> m_nodes;
+};
+
+}
+
+#endif
@@ -18,6 +18,7 @@ class IDeviceMemoryAllocator
 			size_t flags : 5 = 0u; // IDeviceMemoryAllocation::E_MEMORY_ALLOCATE_FLAGS
 			size_t memoryTypeIndex : 5 = 0u;
 			IDeviceMemoryBacked* dedication = nullptr; // if you make the info have a `dedication` the memory will be bound right away, also it will use VK_KHR_dedicated_allocation on vulkan
+			uint8_t alignmentLog2 = 0u; // only matters to sub-allocators, memory straight from the driver is aligned enough for any resource
 			// size_t opaqueCaptureAddress = 0u; Note that this mechanism is intended only to support capture/replay tools, and is not recommended for use in other applications.
 		};
 
@@ -45,6 +46,7 @@ class IDeviceMemoryAllocator
 					ret.flags = m_allocateFlags;
 					ret.memoryTypeIndex = dereference();
 					ret.dedication = dedication;
+					ret.alignmentLog2 = m_reqs.alignmentLog2;
 					return ret;
 				}
 		
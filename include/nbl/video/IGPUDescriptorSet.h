@@ -60,14 +60,7 @@ class IGPUDescriptorSet : public asset::IDescriptorSet<const IGPUDescriptorSetLa
         // small utility
         inline asset::IDescriptor::E_TYPE getBindingType(const uint32_t binding) const
         {
-            for (auto t=0u; t<static_cast<uint32_t>(asset::IDescriptor::E_TYPE::ET_COUNT); t++)
-            {
-                const auto type = static_cast<asset::IDescriptor::E_TYPE>(t);
-                const auto& bindingRedirect = getLayout()->getDescriptorRedirect(type);
-                if (bindingRedirect.getStorageOffset(redirect_t::binding_number_t{binding}).data!=redirect_t::Invalid)
-                    return type;
-            }
-            return asset::IDescriptor::E_TYPE::ET_COUNT;
+            return getLayout()->getBindingType(binding);
         }
 
 	protected:
@@ -77,39 +70,36 @@ class IGPUDescriptorSet : public asset::IDescriptorSet<const IGPUDescriptorSetLa
 	private:
         inline void incrementVersion() { m_version.fetch_add(1ull); }
 
+        using binding_info_t = IGPUDescriptorSetLayout::SBindingInfo;
+
         friend class ILogicalDevice;
-        asset::IDescriptor::E_TYPE validateWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write) const;
-        void processWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write, const asset::IDescriptor::E_TYPE type);
+        // Returns the binding the write targets so it can be handed to `processWrite` without looking it up again, nullptr if the write is invalid.
+        const binding_info_t* validateWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write) const;
+        void processWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write, const binding_info_t& bindingInfo);
         bool validateCopy(const IGPUDescriptorSet::SCopyDescriptorSet& copy) const;
         void processCopy(const IGPUDescriptorSet::SCopyDescriptorSet& copy);
         void dropDescriptors(const IGPUDescriptorSet::SDropDescriptorSet& drop);
 
-        using redirect_t = IGPUDescriptorSetLayout::CBindingRedirect;
         // This assumes that descriptors of a particular type in the set will always be contiguous in pool's storage memory, regardless of which binding in the set they belong to.
-        inline core::smart_refctd_ptr<asset::IDescriptor>* getDescriptors(const asset::IDescriptor::E_TYPE type, const uint32_t binding) const
+        inline core::smart_refctd_ptr<asset::IDescriptor>* getDescriptors(const binding_info_t& bindingInfo) const
         {
-            const auto localOffset = getLayout()->getDescriptorRedirect(type).getStorageOffset(redirect_t::binding_number_t{ binding }).data;
-            if (localOffset == ~0)
-                return nullptr;
-
-            auto* descriptors = getAllDescriptors(type);
+            auto* descriptors = getAllDescriptors(bindingInfo.type);
             if (!descriptors)
                 return nullptr;
 
-            return descriptors+localOffset;
+            return descriptors+bindingInfo.descriptorOffset;
         }
 
-        inline core::smart_refctd_ptr<IGPUSampler>* getMutableSamplers(const uint32_t binding) const
+        inline core::smart_refctd_ptr<IGPUSampler>* getMutableSamplers(const binding_info_t& bindingInfo) const
         {
-            const auto localOffset = getLayout()->getMutableSamplerRedirect().getStorageOffset(redirect_t::binding_number_t{ binding }).data;
-            if (localOffset == getLayout()->getMutableSamplerRedirect().Invalid)
+            if (bindingInfo.mutableSamplerOffset == IGPUDescriptorSetLayout::CBindingRedirect::Invalid)
                 return nullptr;
 
             auto* samplers = getAllMutableSamplers();
             if (!samplers)
                 return nullptr;
 
-            return samplers + localOffset;
+            return samplers + bindingInfo.mutableSamplerOffset;
         }
 
         inline core::smart_refctd_ptr<asset::IDescriptor>* getAllDescriptors(const asset::IDescriptor::E_TYPE type) const
@@ -0,0 +1,148 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_DEVICE_MEMORY_SUB_ALLOCATOR_H_INCLUDED_
+#define _NBL_VIDEO_C_DEVICE_MEMORY_SUB_ALLOCATOR_H_INCLUDED_
+
+#include "nbl/core/alloc/GeneralpurposeAddressAllocator.h"
+
+#include "nbl/video/ILogicalDevice.h"
+
+#include <mutex>
+
+namespace nbl::video
+{
+
+//! Pools device memory into large blocks and sub-allocates resources out of them, instead of a driver allocation per resource
+/*
+	Every `ILogicalDevice::allocate` is a `vkAllocateMemory`, which is slow and counts against `maxMemoryAllocationCount` (as low as 4096).
+	This keeps a list of blocks per memory type and allocate flags, and hands out ranges of them using a `core::GeneralpurposeAddressAllocator`
+	per block (segregated power of two free lists, free ranges get coalesced when an allocation can't be satisfied).
+	When `bufferImageGranularity` is larger than 1, optimally tiled images get their own blocks so their neighbours never need extra padding.
+
+	A dedicated allocation gets made instead when the resource requires one, when it prefers one and is not tiny, when the request would
+	hog a large part of a block, or when it needs an alignment larger than `SCreationParams::maxAlignment`.
+
+	Every heap gets a budget, a fraction of its size, and an allocation which would push the blocks and dedicated allocations of a heap
+	over it fails, which lets `IDeviceMemoryAllocator::allocate` move on to the next compatible memory type.
+
+	Blocks of mappable memory are persistently mapped when created, so users of sub-allocations must not `map` or `unmap` the memory
+	themselves, they should use `getMappedPointer()` plus their offset. Sub-allocations should be returned with `deallocate` once the
+	resource is dead, the resource keeps the block's memory alive (but not its range) until then. All methods are thread-safe.
+*/
+class NBL_API2 CDeviceMemorySubAllocator final : public core::IReferenceCounted, public IDeviceMemoryAllocator
+{
+	public:
+		struct SCreationParams
+		{
+			//! size of the blocks requested from the device, clamped to an eighth of the heap they come from
+			size_t blockSize = 64ull<<20ull;
+			//! granularity of sub-allocations, needs to be a power of two, the free lists take about `64/minAllocationSize` bytes of host memory per byte of a block
+			size_t minAllocationSize = 4096ull;
+			//! largest alignment a sub-allocation can have, needs to be a power of two
+			size_t maxAlignment = 64ull<<10ull;
+			//! resources which prefer a dedicated allocation only get one if they're at least this large
+			size_t preferredDedicatedMinSize = 1ull<<20ull;
+			//! requests larger than this fraction of a block get a dedicated allocation
+			float dedicatedBlockFraction = 0.5f;
+			//! fraction of every heap this allocator lets itself use
+			float heapBudgetFraction = 0.8f;
+			//! empty blocks kept around per pool instead of being freed, to avoid churn
+			uint32_t maxEmptyBlocksPerPool = 1u;
+		};
+		static core::smart_refctd_ptr<CDeviceMemorySubAllocator> create(core::smart_refctd_ptr<ILogicalDevice>&& device, const SCreationParams& params={});
+
+		using IDeviceMemoryAllocator::allocate;
+		//! When `info.dedication` is set the resource also gets bound, just like `ILogicalDevice::allocate` does
+		SAllocation allocate(const SAllocateInfo& info) override;
+		//! `size` needs to be the `SAllocateInfo::size` the allocation was made with
+		void deallocate(const SAllocation& allocation, const size_t size);
+
+		//! Merges the free ranges of all blocks and frees the empty blocks over `SCreationParams::maxEmptyBlocksPerPool`
+		void coalesce();
+
+		inline ILogicalDevice* getDevice() const {return m_device.get();}
+		inline const SCreationParams& getCreationParams() const {return m_params;}
+
+		struct SHeapStatistics
+		{
+			size_t budget = 0ull;
+			//! memory of the heap this allocator got from the device
+			size_t blockBytes = 0ull;
+			size_t dedicatedBytes = 0ull;
+			//! part of `blockBytes` handed out in sub-allocations
+			size_t subAllocatedBytes = 0ull;
+			uint32_t blockCount = 0u;
+			uint32_t dedicatedCount = 0u;
+			uint32_t subAllocationCount = 0u;
+
+			inline size_t getUsage() const {return blockBytes+dedicatedBytes;}
+		};
+		SHeapStatistics getHeapStatistics(const uint32_t heapIndex) const;
+
+		struct SFragmentationStatistics
+		{
+			//! free bytes of all the blocks of a memory type
+			size_t freeBytes = 0ull;
+			//! sum over all blocks of the largest free range of the block, conservative (within a factor of 2)
+			size_t largestFreeRanges = 0ull;
+			//! largest single free range, the largest request which can be sub-allocated without a new block
+			size_t largestFreeRange = 0ull;
+
+			//! 0 when the free space of every block is in one range, approaching 1 as it gets shattered into small ranges
+			inline float getFragmentation() const {return freeBytes ? 1.f-float(double(largestFreeRanges)/double(freeBytes)):0.f;}
+		};
+		//! Freed neighbouring ranges only merge on `coalesce()` or when an allocation fails to find space, so call that first for exact numbers
+		SFragmentationStatistics getFragmentationStatistics(const uint32_t memoryTypeIndex) const;
+
+	protected:
+		using address_allocator_t = core::GeneralpurposeAddressAllocatorST<size_t>;
+
+		struct SBlock
+		{
+			SBlock(core::smart_refctd_ptr<IDeviceMemoryAllocation>&& _memory, const uint32_t _pool, const size_t maxAlignment, const size_t minAllocationSize);
+			SBlock(const SBlock&) = delete;
+			~SBlock();
+
+			core::smart_refctd_ptr<IDeviceMemoryAllocation> memory;
+			void* reserved;
+			address_allocator_t allocator;
+			uint32_t pool;
+			uint32_t subAllocationCount = 0u;
+		};
+		struct SDedicated
+		{
+			core::smart_refctd_ptr<IDeviceMemoryAllocation> memory;
+			uint32_t heapIndex;
+		};
+
+		// memory type, device address allocate flag and whether its for optimally tiled images
+		static inline constexpr uint32_t MaxPools = VK_MAX_MEMORY_TYPES*4u;
+		static inline uint32_t getPoolIndex(const uint32_t memoryTypeIndex, const bool deviceAddress, const bool optimalTiling)
+		{
+			return (memoryTypeIndex<<2u)|(deviceAddress ? 0x2u:0x0u)|(optimalTiling ? 0x1u:0x0u);
+		}
+		static inline uint32_t getPoolMemoryType(const uint32_t pool) {return pool>>2u;}
+
+		CDeviceMemorySubAllocator(core::smart_refctd_ptr<ILogicalDevice>&& device, const SCreationParams& params);
+		~CDeviceMemorySubAllocator();
+
+		size_t getBlockSize(const uint32_t heapIndex) const;
+		// whether `bytes` more of the heap would go over budget or the device would run out of allocations
+		bool exceedsLimits(const uint32_t heapIndex, const size_t bytes) const;
+		bool bind(IDeviceMemoryBacked* resource, IDeviceMemoryAllocation* memory, const size_t offset) const;
+		void releaseEmptyBlocks(const uint32_t pool);
+
+		const core::smart_refctd_ptr<ILogicalDevice> m_device;
+		const SCreationParams m_params;
+
+		mutable std::mutex m_mutex;
+		core::vector<std::unique_ptr<SBlock>> m_pools[MaxPools];
+		core::unordered_map<const IDeviceMemoryAllocation*,SBlock*> m_blockLookup;
+		core::unordered_map<const IDeviceMemoryAllocation*,SDedicated> m_dedicated;
+		SHeapStatistics m_heaps[VK_MAX_MEMORY_HEAPS];
+		uint32_t m_allocationCount = 0u;
+};
+
+}
+#endif
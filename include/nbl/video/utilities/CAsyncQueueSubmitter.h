@@ -0,0 +1,122 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_ASYNC_QUEUE_SUBMITTER_H_INCLUDED_
+#define _NBL_VIDEO_C_ASYNC_QUEUE_SUBMITTER_H_INCLUDED_
+
+#include "nbl/video/CThreadSafeQueueAdapter.h"
+
+#include <future>
+#include <thread>
+#include <chrono>
+
+namespace nbl::video
+{
+
+//! Submission front-end for a `CThreadSafeQueueAdapter` which lets many threads submit without contending on the queue's mutex
+/*
+	Threads push their submits onto a lock-free list and return immediately, a dedicated thread takes everything pushed so far
+	in one go and hands it to the queue as a single `IQueue::submit` with many `SSubmitInfo`s, up to `SCreationParams::maxSubmitsPerBatch`.
+	While that thread is busy in the driver, new submits pile up and become the next batch, so batches grow with contention by themselves.
+
+	The submits of a batch keep the order in which they got pushed, and a single submit with many infos behaves exactly like
+	separate submits in that order, so semaphore waits and signals keep their meaning. Submits made by one thread are never reordered.
+	If a batch fails validation, its submits get retried one by one, so one bad submit does not fail its neighbours.
+	A batch the driver itself rejected fails as a whole, its command buffers are already marked pending by then so retrying is not safe.
+
+	Everything the `SSubmitInfo`s point to gets copied and the semaphores and command buffers are kept alive until the actual submit,
+	so the caller's arrays can go out of scope right after `submit` returns. Command buffers must not be touched until the submit is done,
+	the returned future tells when that happened.
+	The queue (and its device) must outlive the submitter, and other users of the queue are fine since the adapter still does the locking.
+*/
+class NBL_API2 CAsyncQueueSubmitter final : public core::IReferenceCounted
+{
+	public:
+		struct SCreationParams
+		{
+			//! most `SSubmitInfo`s coalesced into one `IQueue::submit`
+			uint32_t maxSubmitsPerBatch = 64u;
+		};
+		static core::smart_refctd_ptr<CAsyncQueueSubmitter> create(CThreadSafeQueueAdapter* queue, const SCreationParams& params={});
+
+		inline CThreadSafeQueueAdapter* getQueue() const {return m_queue;}
+
+		struct SSubmitResult
+		{
+			IQueue::RESULT result = IQueue::RESULT::OTHER_ERROR;
+			//! time between the call to `submit` and the queue submit returning
+			std::chrono::nanoseconds latency = {};
+		};
+		//! Thread-safe and lock-free, `submits` are validated by the queue on the submit thread, so errors only show up in the future's value
+		std::future<SSubmitResult> submit(const std::span<const IQueue::SSubmitInfo> submits);
+		//! Returns after everything pushed before this call has been handed to the queue
+		void flush();
+		//! `flush` followed by `IQueue::waitIdle`
+		IQueue::RESULT waitIdle();
+
+		struct SStatistics
+		{
+			//! calls to `submit` handled so far, and how many of them failed
+			uint64_t submitCount = 0ull;
+			uint64_t failedSubmitCount = 0ull;
+			//! `SSubmitInfo`s handled and `IQueue::submit` calls they went out in, including retries
+			uint64_t submitInfoCount = 0ull;
+			uint64_t batchCount = 0ull;
+			uint32_t maxBatchSize = 0u;
+			std::chrono::nanoseconds totalLatency = {};
+			std::chrono::nanoseconds maxLatency = {};
+
+			inline double getAverageBatchSize() const {return batchCount ? double(submitInfoCount)/double(batchCount):0.0;}
+			inline std::chrono::nanoseconds getAverageLatency() const {return submitCount ? totalLatency/static_cast<std::chrono::nanoseconds::rep>(submitCount):std::chrono::nanoseconds(0);}
+		};
+		//! Snapshot of the counters, they're only ever written by the submit thread
+		SStatistics getStatistics() const;
+		//! The submit thread does the reset, this returns after everything pushed before the call has been counted and then cleared
+		void resetStatistics();
+
+	protected:
+		struct SRequest
+		{
+			// intrusive singly linked list, newest first while pending
+			SRequest* next = nullptr;
+			// copies of the caller's arrays, `infos` point into the other three
+			core::vector<IQueue::SSubmitInfo> infos;
+			core::vector<IQueue::SSubmitInfo::SSemaphoreInfo> semaphores;
+			core::vector<IQueue::SSubmitInfo::SCommandBufferInfo> commandBuffers;
+			core::vector<core::smart_refctd_ptr<IBackendObject>> keepAlive;
+			std::chrono::steady_clock::time_point enqueueTime;
+			std::promise<SSubmitResult> promise;
+			// no infos means its a flush marker, which can also reset the statistics or tell the thread to exit
+			bool resetStatistics = false;
+			bool quit = false;
+		};
+
+		CAsyncQueueSubmitter(CThreadSafeQueueAdapter* queue, const SCreationParams& params);
+		~CAsyncQueueSubmitter();
+
+		void push(SRequest* request);
+		void thread();
+		// submits the requests as few batches as possible, fulfills their promises and deletes them
+		void submitBatch(std::span<SRequest* const> requests);
+
+		CThreadSafeQueueAdapter* const m_queue;
+		const SCreationParams m_params;
+
+		std::atomic<SRequest*> m_pending = nullptr;
+		struct SAtomicStatistics
+		{
+			std::atomic_uint64_t submitCount = 0ull;
+			std::atomic_uint64_t failedSubmitCount = 0ull;
+			std::atomic_uint64_t submitInfoCount = 0ull;
+			std::atomic_uint64_t batchCount = 0ull;
+			std::atomic_uint32_t maxBatchSize = 0u;
+			std::atomic_int64_t totalLatency = 0ll;
+			std::atomic_int64_t maxLatency = 0ll;
+		} m_statistics;
+
+		// must be last, so everything above is constructed before it starts
+		std::thread m_thread;
+};
+
+}
+#endif
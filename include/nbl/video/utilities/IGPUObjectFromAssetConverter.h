@@ -1760,6 +1760,8 @@ inline created_gpu_object_array<asset::ICPUDescriptorSet> IGPUObjectFromAssetCon
                     // over the bindings, which is not really required given we have the index of binding number (since we're iterating
                     // over all the declared bindings).
                     auto descriptorInfos = cpuds->getDescriptorInfoStorage(type);
+                    // same for every descriptor in the binding
+                    const bool isMutableSamplerBinding = (mutableSamplerBindingRedirect.findBindingStorageIndex(asset::ICPUDescriptorSetLayout::CBindingRedirect::binding_number_t{ write_it->binding }).data != mutableSamplerBindingRedirect.Invalid);
 
                     // Iterate through each descriptor in this binding to fill the info structs
                     bool allDescriptorsPresent = true;
@@ -1796,7 +1798,6 @@ inline created_gpu_object_array<asset::ICPUDescriptorSet> IGPUObjectFromAssetCon
 
                             if (!isStorageImgDesc(type))
                             {
-                                const bool isMutableSamplerBinding = (mutableSamplerBindingRedirect.findBindingStorageIndex(asset::ICPUDescriptorSetLayout::CBindingRedirect::binding_number_t{ write_it->binding }).data != mutableSamplerBindingRedirect.Invalid);
                                 if (isMutableSamplerBinding)
                                 {
                                     assert(descriptorInfos.begin()[offset + d].info.image.sampler);
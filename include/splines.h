@@ -8,6 +8,7 @@
 #include "BuildConfigOptions.h"
 #include <cmath>       /* sqrt */
 #include "nbl/core/math/glslFunctions.tcc"
+#include "nbl/core/math/intutil.h"
 
 #include <vector>
 
@@ -64,6 +65,10 @@ class ISpline// : public AllocationOverrideDefault
         virtual float           getParameterUntilBlockChange(const uint32_t& segmentID, const float& param) = 0;
         virtual core::vector<float>   getBlockChangesInSegment(const uint32_t& segmentID, float startParam=0.f) = 0;
 
+        //! coefficients of the segment position as a polynomial of the segment's parameter in `[0,getSegmentParameterRange(segmentID)]`
+        //! pos = ((outCoeffs[3]*parameter+outCoeffs[2])*parameter+outCoeffs[1])*parameter+outCoeffs[0], used by `CSplineBatchSampler`
+        virtual bool            getSegmentPolynomial(const uint32_t& segmentID, vectorSIMDf* outCoeffs) const {return false;}
+
         //is the distance and parameter the same?
         virtual bool            isArcLengthPrecise() const = 0;
         ///virtual float           parameterToDistance(const float& param) const = 0;
@@ -222,6 +227,17 @@ class CLinearSpline : public ISpline
         }
 
 
+        virtual bool            getSegmentPolynomial(const uint32_t& segmentID, vectorSIMDf* outCoeffs) const
+        {
+            if (segmentID>=segments.size())
+                return false;
+
+            outCoeffs[0] = segments[segmentID].weights[1];
+            outCoeffs[1] = segments[segmentID].weights[0];
+            outCoeffs[2] = outCoeffs[3] = vectorSIMDf(0.f);
+            return true;
+        }
+
         virtual bool            isArcLengthPrecise() const {return true;}
         ///virtual float           parameterToDistance(const float& param) const {return param;}
         ///virtual float           distanceToParameter(const float& dist) const {return dist;}
@@ -485,6 +501,18 @@ class CQuadraticSpline : public ISpline
         }
 
 
+        virtual bool            getSegmentPolynomial(const uint32_t& segmentID, vectorSIMDf* outCoeffs) const
+        {
+            if (segmentID>=segments.size())
+                return false;
+
+            outCoeffs[0] = segments[segmentID].weights[2];
+            outCoeffs[1] = segments[segmentID].weights[1];
+            outCoeffs[2] = segments[segmentID].weights[0];
+            outCoeffs[3] = vectorSIMDf(0.f);
+            return true;
+        }
+
         virtual bool            isArcLengthPrecise() const {return true;}/**
         virtual float           parameterToDistance(const float& param) const
         {
@@ -785,6 +813,509 @@ class CQuadraticBSpline : public CQuadraticSpline
         }
 };
 
+
+namespace impl
+{
+// 5 point Gauss-Legendre integration of the speed of a cubic `((c[0]*t+c[1])*t+c[2])*t+c[3]` over `[t0,t1]`
+inline float integrateCubicArcLength(const vectorSIMDf* weights, const float t0, const float t1)
+{
+    constexpr float abscissae[5] = {0.f,-0.5384693101056831f,0.5384693101056831f,-0.9061798459386640f,0.9061798459386640f};
+    constexpr float gaussWeights[5] = {0.5688888888888889f,0.4786286704993665f,0.4786286704993665f,0.2369268850561891f,0.2369268850561891f};
+    const float halfRange = 0.5f*(t1-t0);
+    const float midpoint = 0.5f*(t1+t0);
+    float retval = 0.f;
+    for (uint32_t i=0u; i<5u; i++)
+    {
+        const float t = midpoint+halfRange*abscissae[i];
+        retval += gaussWeights[i]*core::length((weights[0]*(3.f*t)+weights[1]*2.f)*t+weights[2])[0];
+    }
+    return retval*halfRange;
+}
+}
+
+//! Base for piecewise cubic splines, every segment has a parameter range of [0,1] and arc length has no closed form so its integrated numerically
+class ICubicSpline : public ISpline
+{
+    public:
+        //
+        virtual size_t      getSegmentCount() const
+        {
+            return segments.size();
+        }
+        virtual float       getSplineLength() const
+        {
+            return splineLen;
+        }
+
+        //
+        virtual void        getSegmentLengths(float* outSegLens) const
+        {
+            for (size_t i=0; i<segments.size(); i++)
+                outSegLens[i] = segments[i].length;
+        }
+        virtual float       getSegmentLength(const uint32_t& segmentID) const
+        {
+            return segments[segmentID].length;
+        }
+        virtual float       getSegmentParameterRange(const uint32_t& segmentID) const
+        {
+            return 1.f;
+        }
+
+        //get position
+        //this function returns the id of the segment you might have moved into - 0xdeadbeefu is an error code
+        virtual uint32_t    getPos(vectorSIMDf& pos, float& distanceAlongSeg, const uint32_t& segmentID, float* paramHint=NULL, const float& accuracyThresh=0.00390625f) const
+        {
+            if (distanceAlongSeg<0.f)
+                return 0xdeadbeefu;
+
+            uint32_t actualSeg;
+            if (isLoop)
+            {
+                actualSeg = segmentID%segments.size();
+                while (distanceAlongSeg>=segments[actualSeg].length)
+                {
+                    distanceAlongSeg -= segments[actualSeg].length;
+                    actualSeg++;
+                    if (actualSeg==segments.size())
+                        actualSeg = 0;
+                }
+            }
+            else
+            {
+                if (segmentID>=segments.size())
+                    return 0xdeadbeefu;
+
+                actualSeg = segmentID;
+                while (distanceAlongSeg>=segments[actualSeg].length)
+                {
+                    distanceAlongSeg -= segments[actualSeg].length;
+                    actualSeg++;
+                    if (actualSeg==segments.size())
+                        return 0xdeadbeefu;
+                }
+            }
+
+            float hint = paramHint&&actualSeg==segmentID ? (*paramHint):-1.f;
+            hint = segments[actualSeg].getParameterFromArcLen(distanceAlongSeg,hint,accuracyThresh);
+            if (paramHint)
+                *paramHint = hint;
+            pos = segments[actualSeg].posHelper(hint);
+
+            return actualSeg;
+        }
+        virtual bool        getPos_fromParameter(vectorSIMDf& pos, const uint32_t& segmentID, const float& parameter) const
+        {
+            if (segmentID>=segments.size()||parameter>1.f)
+                return false;
+
+            pos = segments[segmentID].posHelper(parameter);
+
+            return true;
+        }
+
+        //to get direction to look in
+        virtual bool        getUnnormDirection(vectorSIMDf& tan, const uint32_t& segmentID, const float& distanceAlongSeg) const
+        {
+            if (segmentID>=segments.size()||distanceAlongSeg>segments[segmentID].length)
+                return false;
+
+            tan = segments[segmentID].directionHelper(segments[segmentID].getParameterFromArcLen(distanceAlongSeg,-1.f,0.00390625f));
+
+            return true;
+        }
+        virtual bool        getUnnormDirection_fromParameter(vectorSIMDf& tan, const uint32_t& segmentID, const float& parameter) const
+        {
+            if (segmentID>=segments.size()||parameter>1.f)
+                return false;
+
+            tan = segments[segmentID].directionHelper(parameter);
+
+            return true;
+        }
+
+        //baw specific -- not supported
+        virtual bool      canGiveParameterUntilBlockChange() const {return false;}
+        virtual float           getParameterUntilBlockChange(const uint32_t& segmentID, const float& param)
+        {
+            return -1.f;
+        }
+        virtual core::vector<float>   getBlockChangesInSegment(const uint32_t& segmentID, float startParam=0.f)
+        {
+            return {};
+        }
+
+        virtual bool            getSegmentPolynomial(const uint32_t& segmentID, vectorSIMDf* outCoeffs) const
+        {
+            if (segmentID>=segments.size())
+                return false;
+
+            for (uint32_t i=0u; i<4u; i++)
+                outCoeffs[i] = segments[segmentID].weights[3u-i];
+            return true;
+        }
+
+        virtual bool            isArcLengthPrecise() const {return false;}
+
+    protected:
+        ICubicSpline(bool loop) : ISpline(loop) {}
+
+        void finalize()
+        {
+            double lenDouble = 0;
+            for (size_t i=0; i<segments.size(); i++)
+            {
+                lenDouble += segments[i].length;
+            }
+            splineLen = lenDouble;
+        }
+
+        class Segment
+        {
+            public:
+                //! from the power basis, highest degree first
+                Segment(const vectorSIMDf& a, const vectorSIMDf& b, const vectorSIMDf& c, const vectorSIMDf& d)
+                {
+                    weights[0] = a;
+                    weights[1] = b;
+                    weights[2] = c;
+                    weights[3] = d;
+
+                    cumulativeLength[0] = 0.f;
+                    for (uint32_t i=0u; i<SubdivisionCount; i++)
+                        cumulativeLength[i+1u] = cumulativeLength[i]+impl::integrateCubicArcLength(weights,float(i)/float(SubdivisionCount),float(i+1u)/float(SubdivisionCount));
+                    length = cumulativeLength[SubdivisionCount];
+                }
+                static Segment createHermite(const vectorSIMDf& startPt, const vectorSIMDf& endPt, const vectorSIMDf& startTangent, const vectorSIMDf& endTangent)
+                {
+                    return Segment(
+                        startPt*2.f-endPt*2.f+startTangent+endTangent,
+                        endPt*3.f-startPt*3.f-startTangent*2.f-endTangent,
+                        startTangent,
+                        startPt
+                    );
+                }
+                static Segment createBezier(const vectorSIMDf& p0, const vectorSIMDf& p1, const vectorSIMDf& p2, const vectorSIMDf& p3)
+                {
+                    return Segment(
+                        (p1-p2)*3.f+p3-p0,
+                        (p0-p1*2.f+p2)*3.f,
+                        (p1-p0)*3.f,
+                        p0
+                    );
+                }
+
+                inline float getArcLenFromParameter(const float& parameter) const
+                {
+                    const float scaled = core::clamp(parameter,0.f,1.f)*float(SubdivisionCount);
+                    const uint32_t interval = std::min(static_cast<uint32_t>(scaled),SubdivisionCount-1u);
+                    return cumulativeLength[interval]+impl::integrateCubicArcLength(weights,float(interval)/float(SubdivisionCount),parameter);
+                }
+
+                //! Newton-Raphson safeguarded by bisection within one of the subdivision intervals
+                inline float getParameterFromArcLen(const float& arcLen, float parameterHint, const float& accuracyThresh) const
+                {
+                    if (arcLen<=0.f)
+                        return 0.f;
+                    if (arcLen>=length)
+                        return 1.f;
+
+                    uint32_t interval = 0u;
+                    while (interval+1u<SubdivisionCount && cumulativeLength[interval+1u]<arcLen)
+                        interval++;
+                    float lo = float(interval)/float(SubdivisionCount);
+                    float hi = float(interval+1u)/float(SubdivisionCount);
+                    if (parameterHint<lo||parameterHint>hi)
+                    {
+                        const float intervalLen = cumulativeLength[interval+1u]-cumulativeLength[interval];
+                        const float frac = intervalLen>0.f ? (arcLen-cumulativeLength[interval])/intervalLen:0.f;
+                        parameterHint = lo+(hi-lo)*frac;
+                    }
+
+                    for (uint32_t i=0u; i<32u; i++)
+                    {
+                        const float diff = arcLen-getArcLenFromParameter(parameterHint);
+                        if (std::abs(diff)<=accuracyThresh)
+                            break;
+                        if (diff>0.f)
+                            lo = parameterHint;
+                        else
+                            hi = parameterHint;
+                        const float speed = core::length(directionHelper(parameterHint))[0];
+                        parameterHint = speed>FLT_MIN ? (parameterHint+diff/speed):hi;
+                        if (parameterHint<=lo||parameterHint>=hi)
+                            parameterHint = 0.5f*(lo+hi);
+                    }
+                    return parameterHint;
+                }
+
+                inline vectorSIMDf posHelper(const float& parameter) const
+                {
+                    return ((weights[0]*parameter+weights[1])*parameter+weights[2])*parameter+weights[3];
+                }
+                inline vectorSIMDf directionHelper(const float& parameter) const
+                {
+                    return (weights[0]*(3.f*parameter)+weights[1]*2.f)*parameter+weights[2];
+                }
+
+                static inline constexpr uint32_t SubdivisionCount = 8u;
+
+                //
+                vectorSIMDf weights[4];
+                //
+                float cumulativeLength[SubdivisionCount+1u];
+                float length;
+        };
+
+        core::vector<Segment> segments;
+        float splineLen;
+};
+
+//! Interpolates all control points, `alpha` of 0 gives the uniform, 0.5 the centripetal (no cusps or self intersections) and 1 the chordal variant
+class CCatmullRomSpline : public ICubicSpline
+{
+    public:
+        CCatmullRomSpline(vectorSIMDf* controlPoints, const size_t& count, const bool loop = false, const float alpha = 0.5f) : ICubicSpline(loop)
+        {
+            assert(count>1ull);
+            auto getPoint = [&](const int64_t i) -> vectorSIMDf
+            {
+                if (isLoop)
+                    return controlPoints[(i+int64_t(count))%int64_t(count)];
+                // reflect the end points to get phantom neighbours
+                if (i<0)
+                    return controlPoints[0]*2.f-controlPoints[1];
+                if (i>=int64_t(count))
+                    return controlPoints[count-1ull]*2.f-controlPoints[count-2ull];
+                return controlPoints[i];
+            };
+            auto knotInterval = [alpha](const vectorSIMDf& a, const vectorSIMDf& b) -> float
+            {
+                return std::max(std::pow(core::length(b-a)[0],alpha),0.0001f);
+            };
+
+            const size_t segmentCount = isLoop ? count:(count-1ull);
+            for (size_t i=0ull; i<segmentCount; i++)
+            {
+                const vectorSIMDf p0 = getPoint(int64_t(i)-1);
+                const vectorSIMDf p1 = getPoint(i);
+                const vectorSIMDf p2 = getPoint(i+1ull);
+                const vectorSIMDf p3 = getPoint(i+2ull);
+                const float t01 = knotInterval(p0,p1);
+                const float t12 = knotInterval(p1,p2);
+                const float t23 = knotInterval(p2,p3);
+                // tangents for non-uniform knots, rescaled to a [0,1] parameter range
+                const vectorSIMDf m1 = ((p1-p0)/t01-(p2-p0)/(t01+t12)+(p2-p1)/t12)*t12;
+                const vectorSIMDf m2 = ((p2-p1)/t12-(p3-p1)/(t12+t23)+(p3-p2)/t23)*t12;
+                segments.push_back(Segment::createHermite(p1,p2,m1,m2));
+            }
+
+            finalize();
+        }
+};
+
+//! Consecutive cubic Bézier curves sharing end points, takes `3n+1` control points (or `3n` if looping, the last segment ends at the first point)
+class CCubicBezierSpline : public ICubicSpline
+{
+    public:
+        CCubicBezierSpline(vectorSIMDf* controlPoints, const size_t& count, const bool loop = false) : ICubicSpline(loop)
+        {
+            assert(count>3ull);
+            const size_t segmentCount = isLoop ? (count/3ull):((count-1ull)/3ull);
+            for (size_t i=0ull; i<segmentCount; i++)
+            {
+                const size_t first = i*3ull;
+                const size_t last = first+3ull;
+                segments.push_back(Segment::createBezier(controlPoints[first],controlPoints[first+1ull],controlPoints[first+2ull],controlPoints[last<count ? last:0ull]));
+            }
+
+            finalize();
+        }
+};
+
+
+//! Evaluates any spline implementing `getSegmentPolynomial` at many arc length distances at once,
+//! segments of splines that don't implement it get sampled along the straight line between their end points.
+//! Precomputes the segment start distances and a per-segment arc length to parameter lookup table,
+//! then for each sample binary searches the segment and evaluates the polynomial (8 at a time with AVX2).
+class CSplineBatchSampler
+{
+    public:
+        CSplineBatchSampler(const ISpline* spline, const uint32_t lutResolution=32u) : isLoop(spline->isLooping()), segmentCount(spline->getSegmentCount()), resolution(std::max(lutResolution,1u))
+        {
+            assert(segmentCount);
+            paddedSegmentCount = core::roundUpToPoT(segmentCount);
+            // pad with infinite start distances so the binary search never goes out of range
+            segmentStart.resize(paddedSegmentCount,FLT_MAX);
+            segmentInvLength.resize(segmentCount);
+            for (auto& coeffs : coefficients)
+                coeffs.resize(segmentCount);
+            parameterLUT.resize(segmentCount*(resolution+1u));
+
+            constexpr uint32_t FineStepsPerEntry = 4u;
+            const uint32_t fineSteps = resolution*FineStepsPerEntry;
+            core::vector<float> fineArcLen(fineSteps+1u);
+
+            double totalLength = 0.0;
+            for (uint32_t seg=0u; seg<segmentCount; seg++)
+            {
+                const float paramRange = spline->getSegmentParameterRange(seg);
+                vectorSIMDf power[4] = {vectorSIMDf(0.f),vectorSIMDf(0.f),vectorSIMDf(0.f),vectorSIMDf(0.f)};
+                if (!spline->getSegmentPolynomial(seg,power))
+                {
+                    // no closed form, fall back to the chord between the segment's end points
+                    vectorSIMDf end(0.f);
+                    power[0] = vectorSIMDf(0.f);
+                    spline->getPos_fromParameter(power[0],seg,0.f);
+                    spline->getPos_fromParameter(end,seg,paramRange);
+                    power[1] = paramRange>0.f ? (end-power[0])*(1.f/paramRange):vectorSIMDf(0.f);
+                    power[2] = power[3] = vectorSIMDf(0.f);
+                }
+                for (uint32_t k=0u; k<4u; k++)
+                for (uint32_t axis=0u; axis<3u; axis++)
+                    coefficients[k*3u+axis][seg] = power[k].pointer[axis];
+
+                // integrate the arc length on a fine grid of the parameter
+                const vectorSIMDf highestFirst[4] = {power[3],power[2],power[1],power[0]};
+                fineArcLen[0] = 0.f;
+                for (uint32_t i=0u; i<fineSteps; i++)
+                    fineArcLen[i+1u] = fineArcLen[i]+impl::integrateCubicArcLength(highestFirst,paramRange*float(i)/float(fineSteps),paramRange*float(i+1u)/float(fineSteps));
+                const float length = fineArcLen[fineSteps];
+
+                // invert it to get the parameter at uniform arc length steps
+                float* lut = parameterLUT.data()+seg*(resolution+1u);
+                uint32_t fine = 0u;
+                for (uint32_t i=0u; i<=resolution; i++)
+                {
+                    const float target = length*float(i)/float(resolution);
+                    while (fine+1u<fineSteps && fineArcLen[fine+1u]<target)
+                        fine++;
+                    const float stepLen = fineArcLen[fine+1u]-fineArcLen[fine];
+                    const float frac = stepLen>0.f ? core::clamp((target-fineArcLen[fine])/stepLen,0.f,1.f):0.f;
+                    lut[i] = paramRange*(float(fine)+frac)/float(fineSteps);
+                }
+
+                segmentStart[seg] = totalLength;
+                segmentInvLength[seg] = length>0.f ? (float(resolution)/length):0.f;
+                totalLength += length;
+            }
+            splineLength = totalLength;
+        }
+
+        inline float getSplineLength() const {return splineLength;}
+
+        //! `distances` are measured along the whole spline, they get wrapped for looping splines and clamped otherwise.
+        //! Outputs are Structure of Arrays, `outTangents` is the unnormalized derivative with respect to the segment parameter and can be null.
+        inline void sample(const float* distances, const uint32_t count, float* const outPositions[3], float* const outTangents[3]=nullptr) const
+        {
+            uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_AVX2_
+            for (; i+8u<=count; i+=8u)
+                sample8(distances+i,i,outPositions,outTangents);
+#endif
+            for (; i<count; i++)
+            {
+                float param;
+                const uint32_t seg = locate(distances[i],param);
+                for (uint32_t axis=0u; axis<3u; axis++)
+                {
+                    const float c0 = coefficients[axis][seg], c1 = coefficients[3u+axis][seg];
+                    const float c2 = coefficients[6u+axis][seg], c3 = coefficients[9u+axis][seg];
+                    outPositions[axis][i] = ((c3*param+c2)*param+c1)*param+c0;
+                    if (outTangents)
+                        outTangents[axis][i] = (3.f*c3*param+2.f*c2)*param+c1;
+                }
+            }
+        }
+
+    private:
+        inline float wrapDistance(float distance) const
+        {
+            if (isLoop)
+            {
+                distance = std::fmod(distance,splineLength);
+                return distance<0.f ? (distance+splineLength):distance;
+            }
+            return core::clamp(distance,0.f,splineLength);
+        }
+
+        inline uint32_t locate(const float distance, float& outParam) const
+        {
+            const float d = wrapDistance(distance);
+            uint32_t seg = 0u;
+            for (uint32_t step=paddedSegmentCount>>1u; step; step>>=1u)
+            if (segmentStart[seg+step]<=d)
+                seg += step;
+
+            const float local = (d-segmentStart[seg])*segmentInvLength[seg];
+            const uint32_t entry = std::min(static_cast<uint32_t>(local),resolution-1u);
+            const float frac = std::min(local-float(entry),1.f);
+            const float* lut = parameterLUT.data()+seg*(resolution+1u)+entry;
+            outParam = lut[0]+(lut[1]-lut[0])*frac;
+            return seg;
+        }
+
+#ifdef __NBL_COMPILE_WITH_AVX2_
+        inline void sample8(const float* distances, const uint32_t offset, float* const outPositions[3], float* const outTangents[3]) const
+        {
+            __m256 d = _mm256_loadu_ps(distances);
+            if (isLoop)
+            {
+                const __m256 len = _mm256_set1_ps(splineLength);
+                d = _mm256_sub_ps(d,_mm256_mul_ps(_mm256_floor_ps(_mm256_div_ps(d,len)),len));
+            }
+            else
+                d = _mm256_min_ps(_mm256_max_ps(d,_mm256_setzero_ps()),_mm256_set1_ps(splineLength));
+
+            // branchless binary search for the segment
+            __m256i seg = _mm256_setzero_si256();
+            for (uint32_t step=paddedSegmentCount>>1u; step; step>>=1u)
+            {
+                const __m256i candidate = _mm256_add_epi32(seg,_mm256_set1_epi32(step));
+                const __m256 start = _mm256_i32gather_ps(segmentStart.data(),candidate,4);
+                seg = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(seg),_mm256_castsi256_ps(candidate),_mm256_cmp_ps(start,d,_CMP_LE_OQ)));
+            }
+
+            const __m256 local = _mm256_mul_ps(_mm256_sub_ps(d,_mm256_i32gather_ps(segmentStart.data(),seg,4)),_mm256_i32gather_ps(segmentInvLength.data(),seg,4));
+            const __m256i entry = _mm256_min_epi32(_mm256_cvttps_epi32(local),_mm256_set1_epi32(resolution-1u));
+            const __m256 frac = _mm256_min_ps(_mm256_sub_ps(local,_mm256_cvtepi32_ps(entry)),_mm256_set1_ps(1.f));
+            const __m256i lutIx = _mm256_add_epi32(_mm256_mullo_epi32(seg,_mm256_set1_epi32(resolution+1u)),entry);
+            const __m256 lut0 = _mm256_i32gather_ps(parameterLUT.data(),lutIx,4);
+            const __m256 lut1 = _mm256_i32gather_ps(parameterLUT.data()+1,lutIx,4);
+            const __m256 t = _mm256_fmadd_ps(_mm256_sub_ps(lut1,lut0),frac,lut0);
+
+            for (uint32_t axis=0u; axis<3u; axis++)
+            {
+                const __m256 c0 = _mm256_i32gather_ps(coefficients[axis].data(),seg,4);
+                const __m256 c1 = _mm256_i32gather_ps(coefficients[3u+axis].data(),seg,4);
+                const __m256 c2 = _mm256_i32gather_ps(coefficients[6u+axis].data(),seg,4);
+                const __m256 c3 = _mm256_i32gather_ps(coefficients[9u+axis].data(),seg,4);
+                _mm256_storeu_ps(outPositions[axis]+offset,_mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(c3,t,c2),t,c1),t,c0));
+                if (outTangents)
+                {
+                    const __m256 dc2 = _mm256_add_ps(c2,c2);
+                    const __m256 dc3 = _mm256_mul_ps(c3,_mm256_set1_ps(3.f));
+                    _mm256_storeu_ps(outTangents[axis]+offset,_mm256_fmadd_ps(_mm256_fmadd_ps(dc3,t,dc2),t,c1));
+                }
+            }
+        }
+#endif
+
+        const bool isLoop;
+        const uint32_t segmentCount;
+        const uint32_t resolution;
+        uint32_t paddedSegmentCount;
+        float splineLength;
+        //! arc length at the start of every segment, padded to a power of two
+        core::vector<float> segmentStart;
+        //! `resolution/segmentLength`
+        core::vector<float> segmentInvLength;
+        //! Structure of Arrays, `coefficients[degree*3+axis][segment]`
+        core::vector<float> coefficients[12];
+        //! `resolution+1` parameter values per segment at uniform arc length intervals
+        core::vector<float> parameterLUT;
+};
+
 }
 }
 
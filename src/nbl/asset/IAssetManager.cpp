@@ -55,6 +55,10 @@
 #include "nbl/asset/interchange/CGLILoader.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+#include "nbl/asset/interchange/CImageLoaderKTX2.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_STL_WRITER_
 #include "nbl/asset/interchange/CSTLMeshWriter.h"
 #endif
@@ -91,6 +95,10 @@
 #include "nbl/asset/interchange/CGLIWriter.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+#include "nbl/asset/interchange/CImageWriterKTX2.h"
+#endif
+
 #include "nbl/asset/interchange/CBufferLoaderBIN.h"
 #include "nbl/asset/utils/CGeometryCreator.h"
 #include "nbl/asset/utils/CMeshManipulator.h"
@@ -171,13 +179,18 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef  _NBL_COMPILE_WITH_GLI_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLILoader>());
 #endif 
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderKTX2>());
+#endif
 #ifdef _NBL_COMPILE_WITH_TGA_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderTGA>());
 #endif
     addAssetLoader(core::make_smart_refctd_ptr<asset::CBufferLoaderBIN>());
-	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLSLLoader>());
-	addAssetLoader(core::make_smart_refctd_ptr<asset::CHLSLLoader>());
-	addAssetLoader(core::make_smart_refctd_ptr<asset::CSPVLoader>());
+	// shader code gets interned in the same pool as the compiler outputs
+	auto* const shaderBlobPool = m_compilerSet->getBlobPool();
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLSLLoader>(core::smart_refctd_ptr<CShaderBlobPool>(shaderBlobPool)));
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CHLSLLoader>(core::smart_refctd_ptr<CShaderBlobPool>(shaderBlobPool)));
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CSPVLoader>(core::smart_refctd_ptr<CShaderBlobPool>(shaderBlobPool)));
 
 #ifdef _NBL_COMPILE_WITH_BAW_WRITER_
 	//addAssetWriter(core::make_smart_refctd_ptr<asset::CBAWMeshWriter>(getFileSystem()));
@@ -206,6 +219,9 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_GLI_WRITER_
 	addAssetWriter(core::make_smart_refctd_ptr<asset::CGLIWriter>(core::smart_refctd_ptr<system::ISystem>(m_system)));
 #endif
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+	addAssetWriter(core::make_smart_refctd_ptr<asset::CImageWriterKTX2>());
+#endif
 
     for (auto& loader : m_loaders.vector)
         loader->initialize();
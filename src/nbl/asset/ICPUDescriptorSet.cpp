@@ -12,34 +12,14 @@ core::SRange<ICPUDescriptorSet::SDescriptorInfo> ICPUDescriptorSet::getDescripto
 
 core::SRange<const ICPUDescriptorSet::SDescriptorInfo> ICPUDescriptorSet::getDescriptorInfos(const ICPUDescriptorSetLayout::CBindingRedirect::binding_number_t binding, IDescriptor::E_TYPE type) const
 {
-	if (type == IDescriptor::E_TYPE::ET_COUNT)
-	{
-		for (uint32_t t = 0; t < static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT); ++t)
-		{
-			const auto possibleType = static_cast<IDescriptor::E_TYPE>(t);
-			const auto& redirect = getLayout()->getDescriptorRedirect(possibleType);
-			if (redirect.findBindingStorageIndex(binding).data != redirect.Invalid)
-			{
-				type = possibleType;
-				break;
-			}
-		}
-
-		if (type == IDescriptor::E_TYPE::ET_COUNT)
-			return { nullptr, nullptr };
-	}
-
-	const auto& redirect = getLayout()->getDescriptorRedirect(type);
-	const auto bindingNumberIndex = redirect.findBindingStorageIndex(binding);
-	if (bindingNumberIndex.data == redirect.Invalid)
+	// binding numbers are unique across all descriptor types of a layout, so one lookup resolves both the type and the storage range
+	const auto* bindingInfo = getLayout()->findBindingInfo(binding.data);
+	if (!bindingInfo || (type != IDescriptor::E_TYPE::ET_COUNT && bindingInfo->type != type))
 		return { nullptr, nullptr };
 
-	const auto offset = redirect.getStorageOffset(asset::ICPUDescriptorSetLayout::CBindingRedirect::storage_range_index_t{ bindingNumberIndex }).data;
-	const auto count = redirect.getCount(asset::ICPUDescriptorSetLayout::CBindingRedirect::storage_range_index_t{ bindingNumberIndex });
-
-	auto infosBegin = m_descriptorInfos[static_cast<uint32_t>(type)]->begin() + offset;
+	auto infosBegin = m_descriptorInfos[static_cast<uint32_t>(bindingInfo->type)]->begin() + bindingInfo->descriptorOffset;
 
-	return { infosBegin, infosBegin + count };
+	return { infosBegin, infosBegin + bindingInfo->count };
 }
 
 core::smart_refctd_ptr<IAsset> ICPUDescriptorSet::clone(uint32_t _depth) const
@@ -23,6 +23,7 @@ SOFTWARE.
 #ifdef _NBL_COMPILE_WITH_GLI_LOADER_
 
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
+#include "nbl/asset/interchange/IImageLoader.h"
 
 #ifdef _NBL_COMPILE_WITH_GLI_
 #include "gli/gli.hpp"
@@ -115,17 +116,21 @@ namespace nbl
 
 			const auto texelBlockDimension = asset::getBlockDimensions(format.first);
 			const auto texelBlockByteSize = asset::getTexelOrBlockBytesize(format.first);
-			auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(texture.size());
-			auto data = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+
+			// requested halvings skip the stored top levels, a region only keeps its one level, the rest is left to the fallback
+			const auto& decodeParams = _params.imageDecode;
+			IImageLoader::SDecodedRegion decodedRegion = {{uint32_t(texture.extent().x),uint32_t(texture.extent().y)}};
+			decodedRegion.mipLevel = core::min<uint32_t>(decodeParams.mipLevel,texture.levels()-1u);
+			const uint16_t baseLevel = decodedRegion.mipLevel;
 
 			ICPUImage::SCreationParams imageInfo = {};
 			imageInfo.type = imageType;
 			imageInfo.samples = ICPUImage::ESCF_1_BIT;
 			imageInfo.format = format.first;
-			imageInfo.extent.width = texture.extent().x;
-			imageInfo.extent.height = texture.extent().y;
-			imageInfo.extent.depth = texture.extent().z;
-			imageInfo.mipLevels = texture.levels();
+			imageInfo.extent.width = texture.extent(baseLevel).x;
+			imageInfo.extent.height = texture.extent(baseLevel).y;
+			imageInfo.extent.depth = texture.extent(baseLevel).z;
+			imageInfo.mipLevels = decodeParams.hasRegion() ? 1u:(texture.levels()-baseLevel);
 			imageInfo.arrayLayers = texture.faces() * texture.layers();
 			imageInfo.flags = isItACubemap ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT : static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
 			imageInfo.usage = IImage::EUF_SAMPLED_BIT;
@@ -135,22 +140,28 @@ namespace nbl
 
 			auto getFullSizeOfRegion = [&](const uint16_t mipLevel) -> uint64_t
 			{
-				return texture.size(mipLevel) * imageInfo.arrayLayers;
+				return texture.size(baseLevel + mipLevel) * imageInfo.arrayLayers;
 			};
 
 			auto getFullSizeOfLayer = [&](const uint16_t mipLevel) -> uint64_t
 			{
-				return texture.size(mipLevel);
+				return texture.size(baseLevel + mipLevel);
 			};
 
+			uint64_t texelBufferSize = 0ull;
+			for (uint16_t mipLevel = 0; mipLevel < imageInfo.mipLevels; ++mipLevel)
+				texelBufferSize += getFullSizeOfRegion(mipLevel);
+			auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(texelBufferSize);
+			auto data = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+
 			{
 				uint16_t regionIndex = {};
 				uint64_t offset = {};
 				for (auto region = regions->begin(); region != regions->end(); ++region)
 				{
-					region->imageExtent.width = texture.extent(regionIndex).x;
-					region->imageExtent.height = texture.extent(regionIndex).y;
-					region->imageExtent.depth = texture.extent(regionIndex).z;
+					region->imageExtent.width = texture.extent(baseLevel + regionIndex).x;
+					region->imageExtent.height = texture.extent(baseLevel + regionIndex).y;
+					region->imageExtent.depth = texture.extent(baseLevel + regionIndex).z;
 					region->bufferRowLength = region->imageExtent.width;
 					region->bufferImageHeight = 0u;
 					region->imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
@@ -196,7 +207,7 @@ namespace nbl
 					const auto gliLayer = layersData.first;
 					const auto gliFace = layersData.second;
 
-					assignGLIDataToRegion((reinterpret_cast<uint8_t*>(data) + tmpDataSizePerRegionSum + (layer * layerSize)), texture, gliLayer, gliFace, mipLevel, layerSize);
+					assignGLIDataToRegion((reinterpret_cast<uint8_t*>(data) + tmpDataSizePerRegionSum + (layer * layerSize)), texture, gliLayer, gliFace, baseLevel + mipLevel, layerSize);
 				}
 				tmpDataSizePerRegionSum += getFullSizeOfRegion(mipLevel);
 			}
@@ -216,6 +227,12 @@ namespace nbl
 			imageViewInfo.subresourceRange.levelCount = imageInfo.mipLevels;
 
 			auto imageView = ICPUImageView::create(std::move(imageViewInfo));
+			if (!decodeParams.isWholeImage())
+			{
+				imageView = IImageLoader::applyDecodeParamsToView(std::move(imageView),decodeParams,decodedRegion,_params.logger);
+				if (!imageView)
+					return {};
+			}
 
 			return SAssetBundle(nullptr,{std::move(imageView)});
 		}
@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "nbl/asset/interchange/IAssetLoader.h"
+#include "nbl/asset/utils/CShaderBlobPool.h"
 #include <nbl/system/ISystem.h>
 
 namespace nbl::asset
@@ -17,7 +18,8 @@ namespace nbl::asset
 class CGLSLLoader final : public asset::IAssetLoader
 {
 	public:
-		CGLSLLoader() = default;
+		//! With a pool, the shader code is taken zero-copy from read-only mapped files and deduplicated against everything else in the pool
+		CGLSLLoader(core::smart_refctd_ptr<CShaderBlobPool>&& blobPool=nullptr) : m_blobPool(std::move(blobPool)) {}
 
 		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger = nullptr) const override
 		{
@@ -55,6 +57,9 @@ class CGLSLLoader final : public asset::IAssetLoader
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_SHADER; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+
+	private:
+		core::smart_refctd_ptr<CShaderBlobPool> m_blobPool;
 };
 
 } // namespace nbl::asset
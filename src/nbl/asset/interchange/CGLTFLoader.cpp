@@ -1566,7 +1566,7 @@ using namespace nbl::asset;
 
 							auto* aabbPtr = reinterpret_cast<core::aabbox3df*>(jointAABBBufferBinding.buffer->getPointer());
 							meshbuffer->setSkin(std::move(inverseBindPoseBinding),std::move(jointAABBBufferBinding),jointCount,meshbuffer->deduceMaxJointsPerVertex());
-							nbl::asset::IMeshManipulator::calculateBoundingBox(meshbuffer.get(),aabbPtr);
+							nbl::asset::IMeshManipulator::calculateBoundingBox(core::execution::par_unseq,meshbuffer.get(),aabbPtr);
 						}
 				}
 			}
@@ -14,17 +14,23 @@ SAssetBundle CHLSLLoader::loadAsset(system::IFile* _file, const IAssetLoader::SA
 	if (!_file)
         return {};
 
-	auto len = _file->getSize();
-	void* source = _NBL_ALIGNED_MALLOC(len+1u,_NBL_SIMD_ALIGNMENT);
-
-	system::IFile::success_t success;
-	_file->read(success, source, 0, len);
-	if (!success)
+	core::smart_refctd_ptr<ICPUBuffer> source;
+	if (m_blobPool)
+		source = m_blobPool->load(_file);
+	else
+	{
+		// keep the null terminator for consumers which still treat the code as a C-string
+		const auto len = _file->getSize();
+		source = core::make_smart_refctd_ptr<ICPUBuffer>(len+1u);
+		system::IFile::success_t success;
+		_file->read(success, source->getPointer(), 0, len);
+		if (!success)
+			return {};
+		reinterpret_cast<char*>(source->getPointer())[len] = 0;
+	}
+	if (!source)
 		return {};
 
-	reinterpret_cast<char*>(source)[len] = 0;
-
-
 	const auto filename = _file->getFileName();
 	auto filenameEnding = filename.filename().string();
 
@@ -49,9 +55,7 @@ SAssetBundle CHLSLLoader::loadAsset(system::IFile* _file, const IAssetLoader::SA
 		}
 	}
 
-	// TODO: allocate the source as an ICPUBuffer right away!
-	auto shader = core::make_smart_refctd_ptr<ICPUShader>(reinterpret_cast<char*>(source), shaderStage, IShader::E_CONTENT_TYPE::ECT_HLSL, filename.string());
-	_NBL_ALIGNED_FREE(source);
+	auto shader = core::make_smart_refctd_ptr<ICPUShader>(std::move(source), shaderStage, IShader::E_CONTENT_TYPE::ECT_HLSL, filename.string());
 
 	return SAssetBundle(nullptr,{std::move(shader)});
 } 
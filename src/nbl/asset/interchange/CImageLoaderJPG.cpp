@@ -240,13 +240,17 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	jpeg_read_header(&cinfo, TRUE);
 
     uint32_t imageSize[3] = { cinfo.image_width,cinfo.image_height,1 };
-    const uint32_t& width = imageSize[0];
-    const uint32_t& height = imageSize[1];
+
+	const auto& decodeParams = _params.imageDecode;
+	uint32_t rectOffset[2], rectExtent[2];
+	if (!getDecodeRect(decodeParams,imageSize,rectOffset,rectExtent))
+	{
+		_params.logger.log("Requested region lies outside of the image %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
 
     ICPUImage::SCreationParams imgInfo;
     imgInfo.type = ICPUImage::ET_2D;
-    imgInfo.extent.width = width;
-    imgInfo.extent.height = height;
     imgInfo.extent.depth = 1u;
     imgInfo.mipLevels = 1u;
     imgInfo.arrayLayers = 1u;
@@ -287,10 +291,40 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 			break;
 	}
 	cinfo.do_fancy_upsampling = TRUE;
+
+	// the IDCT can scale by multiples of 1/8, so the first three halvings cost nothing, the rest is left to the box filter
+	SDecodedRegion decodedRegion = {{imageSize[0],imageSize[1]}};
+	decodedRegion.mipLevel = core::min(decodeParams.mipLevel,3u);
+	cinfo.scale_num = 1u;
+	cinfo.scale_denom = 1u<<decodedRegion.mipLevel;
 	
 	// Start decompressor
 	jpeg_start_decompress(&cinfo);
 
+	// only decode the footprint of the requested rectangle, columns get rounded out to whole iMCUs by libjpeg-turbo,
+	// the rows above get skipped without running the IDCT and the ones below are never touched
+	{
+		const uint32_t shift = core::min(decodeParams.mipLevel-decodedRegion.mipLevel,31u);
+		const uint32_t colBegin = static_cast<uint32_t>(core::min(uint64_t(rectOffset[0])<<shift,uint64_t(cinfo.output_width-1u)));
+		const uint32_t colEnd = static_cast<uint32_t>(core::min(uint64_t(rectOffset[0]+rectExtent[0])<<shift,uint64_t(cinfo.output_width)));
+		const uint32_t rowBegin = static_cast<uint32_t>(core::min(uint64_t(rectOffset[1])<<shift,uint64_t(cinfo.output_height-1u)));
+		const uint32_t rowEnd = static_cast<uint32_t>(core::min(uint64_t(rectOffset[1]+rectExtent[1])<<shift,uint64_t(cinfo.output_height)));
+		if (colBegin!=0u || colEnd!=cinfo.output_width)
+		{
+			JDIMENSION xoffset = colBegin;
+			JDIMENSION cropWidth = core::max(colEnd,colBegin+1u)-colBegin;
+			jpeg_crop_scanline(&cinfo,&xoffset,&cropWidth);
+			decodedRegion.offset[0] = xoffset;
+		}
+		if (rowBegin)
+			jpeg_skip_scanlines(&cinfo,rowBegin);
+		decodedRegion.offset[1] = rowBegin;
+		imgInfo.extent.width = cinfo.output_width;
+		imgInfo.extent.height = core::max(rowEnd,rowBegin+1u)-rowBegin;
+	}
+	const uint32_t width = imgInfo.extent.width;
+	const uint32_t height = imgInfo.extent.height;
+
 	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
 	ICPUImage::SBufferCopy& region = regions->front();
 	region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
@@ -319,14 +353,23 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 
 	// Read rows from bottom order to match OpenGL coords
 	uint32_t rowsRead = 0;
-	while (cinfo.output_scanline < cinfo.output_height)
+	while (rowsRead < height && cinfo.output_scanline < cinfo.output_height)
 		rowsRead += jpeg_read_scanlines(&cinfo, &rowPtr[rowsRead], 1);
 	
-	// Finish decompression
-	jpeg_finish_decompress(&cinfo);
+	// Finish decompression, unless we stopped early
+	if (cinfo.output_scanline < cinfo.output_height)
+		jpeg_abort_decompress(&cinfo);
+	else
+		jpeg_finish_decompress(&cinfo);
 
 	core::smart_refctd_ptr<ICPUImage> image = ICPUImage::create(std::move(imgInfo));
 	image->setBufferAndRegions(std::move(buffer), regions);
+	if (!decodeParams.isWholeImage())
+	{
+		image = applyDecodeParams(std::move(image),decodeParams,decodedRegion,_params.logger);
+		if (!image)
+			return {};
+	}
 
     return SAssetBundle(nullptr,{image});
 
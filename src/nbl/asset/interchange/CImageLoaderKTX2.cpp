@@ -0,0 +1,313 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "CImageLoaderKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include <atomic>
+#include <numeric>
+
+#include "nbl/core/execution.h"
+#include "nbl/system/IFile.h"
+#include "nbl/asset/compile_config.h"
+
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+#include <zconf.h>
+#include <zlib/zlib.h>
+#endif
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+
+using namespace nbl;
+using namespace nbl::asset;
+
+
+namespace
+{
+bool isSupportedSupercompression(const ktx2::E_SUPERCOMPRESSION_SCHEME scheme)
+{
+	switch (scheme)
+	{
+		case ktx2::ESS_NONE:
+			return true;
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		case ktx2::ESS_ZLIB:
+			return true;
+#endif
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ktx2::ESS_ZSTD:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+// a level needs to come out at exactly the size we computed, anything else means a corrupt file
+bool decompressLevel(const ktx2::E_SUPERCOMPRESSION_SCHEME scheme, const uint8_t* src, const size_t srcSize, uint8_t* dst, const size_t dstSize)
+{
+	switch (scheme)
+	{
+		case ktx2::ESS_NONE:
+			if (srcSize!=dstSize)
+				return false;
+			memcpy(dst,src,dstSize);
+			return true;
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		case ktx2::ESS_ZLIB:
+		{
+			uLongf outSize = dstSize;
+			return uncompress(dst,&outSize,src,srcSize)==Z_OK && outSize==dstSize;
+		}
+#endif
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ktx2::ESS_ZSTD:
+		{
+			const size_t outSize = ZSTD_decompress(dst,dstSize,src,srcSize);
+			return !ZSTD_isError(outSize) && outSize==dstSize;
+		}
+#endif
+		default:
+			return false;
+	}
+}
+}
+
+
+bool CImageLoaderKTX2::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	uint8_t identifier[sizeof(ktx2::Identifier)];
+	system::IFile::success_t success;
+	_file->read(success,identifier,0,sizeof(identifier));
+	return success && memcmp(identifier,ktx2::Identifier,sizeof(identifier))==0;
+}
+
+asset::SAssetBundle CImageLoaderKTX2::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	const auto& decodeParams = _params.imageDecode;
+	if (decodeParams.isWholeImage())
+	{
+		auto imageView = loadLevels(_file,0u,~0u,_params.logger);
+		if (!imageView)
+			return {};
+		return SAssetBundle(nullptr,{std::move(imageView)});
+	}
+
+	// the requested level is skipped to using the level index, only a region or more halvings than there are levels need the fallback
+	ktx2::SHeader header;
+	system::IFile::success_t success;
+	_file->read(success,&header,0,sizeof(header));
+	if (!success)
+		return {};
+	SDecodedRegion decodedRegion = {{header.pixelWidth,core::max(header.pixelHeight,1u)}};
+	decodedRegion.mipLevel = core::min(decodeParams.mipLevel,core::max(header.levelCount,1u)-1u);
+	auto imageView = loadLevels(_file,decodedRegion.mipLevel,decodeParams.hasRegion() ? 1u:~0u,_params.logger);
+	imageView = applyDecodeParamsToView(std::move(imageView),decodeParams,decodedRegion,_params.logger);
+	if (!imageView)
+		return {};
+	return SAssetBundle(nullptr,{std::move(imageView)});
+}
+
+core::smart_refctd_ptr<ICPUImageView> CImageLoaderKTX2::loadLevels(system::IFile* _file, const uint32_t baseLevel, const uint32_t levelCount, const system::logger_opt_ptr logger) const
+{
+	if (!_file)
+		return nullptr;
+	const auto fileName = _file->getFileName().string();
+
+	ktx2::SHeader header;
+	system::IFile::success_t success;
+	_file->read(success,&header,0,sizeof(header));
+	if (!success || memcmp(header.identifier,ktx2::Identifier,sizeof(ktx2::Identifier))!=0)
+	{
+		logger.log("LOAD KTX2: %s is not a KTX2 file.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return nullptr;
+	}
+	if (!isSupportedSupercompression(header.supercompressionScheme))
+	{
+		logger.log("LOAD KTX2: unsupported supercompression scheme %d in %s.",system::ILogger::ELL_ERROR,header.supercompressionScheme,fileName.c_str());
+		return nullptr;
+	}
+	const E_FORMAT format = ktx2::getFormatFromVkFormat(header.vkFormat);
+	if (format==EF_UNKNOWN)
+	{
+		logger.log("LOAD KTX2: unsupported VkFormat %d in %s, BasisLZ/UASTC needs transcoding.",system::ILogger::ELL_ERROR,header.vkFormat,fileName.c_str());
+		return nullptr;
+	}
+	const bool isCube = header.faceCount==6u;
+	// KTX2 stores combined depth-stencil interleaved, we can't have regions covering both aspects
+	if (isDepthOrStencilFormat(format) && !isDepthOnlyFormat(format) && !isStencilOnlyFormat(format))
+	{
+		logger.log("LOAD KTX2: combined depth-stencil formats are not supported, %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return nullptr;
+	}
+	const auto aspectMask = isDepthOnlyFormat(format) ? IImage::E_ASPECT_FLAGS::EAF_DEPTH_BIT:(isStencilOnlyFormat(format) ? IImage::E_ASPECT_FLAGS::EAF_STENCIL_BIT:IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT);
+	if (header.pixelWidth==0u || (header.faceCount!=1u && !isCube) || (isCube && (header.pixelWidth!=header.pixelHeight || header.pixelDepth)) || (header.pixelDepth && header.layerCount))
+	{
+		logger.log("LOAD KTX2: invalid dimensions in %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return nullptr;
+	}
+
+	// levels past the full mip chain would all be 1x1x1, a bogus count would only blow up the level index allocation below
+	const uint32_t maxLevelCount = hlsl::findMSB(core::max(core::max(header.pixelWidth,header.pixelHeight),header.pixelDepth))+1u;
+	if (header.levelCount>maxLevelCount)
+	{
+		logger.log("LOAD KTX2: %s claims %d levels but its extent only allows %d.",system::ILogger::ELL_ERROR,fileName.c_str(),header.levelCount,maxLevelCount);
+		return nullptr;
+	}
+	// levelCount of 0 means the file only has the base level and wants mips generated at runtime
+	const uint32_t fileLevelCount = core::max(header.levelCount,1u);
+	if (baseLevel>=fileLevelCount)
+	{
+		logger.log("LOAD KTX2: requested base level %d but %s only has %d levels.",system::ILogger::ELL_ERROR,baseLevel,fileName.c_str(),fileLevelCount);
+		return nullptr;
+	}
+	const uint32_t loadedLevelCount = core::min(levelCount,fileLevelCount-baseLevel);
+	core::vector<ktx2::SLevelIndex> levels(loadedLevelCount);
+	_file->read(success,levels.data(),sizeof(ktx2::SHeader)+baseLevel*sizeof(ktx2::SLevelIndex),loadedLevelCount*sizeof(ktx2::SLevelIndex));
+	if (!success)
+	{
+		logger.log("LOAD KTX2: failed to read the level index of %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return nullptr;
+	}
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.type = header.pixelDepth ? IImage::ET_3D:(header.pixelHeight ? IImage::ET_2D:IImage::ET_1D);
+	imageInfo.samples = ICPUImage::ESCF_1_BIT;
+	imageInfo.format = format;
+	imageInfo.extent.width = core::max(header.pixelWidth>>baseLevel,1u);
+	imageInfo.extent.height = core::max(header.pixelHeight>>baseLevel,1u);
+	imageInfo.extent.depth = core::max(header.pixelDepth>>baseLevel,1u);
+	imageInfo.mipLevels = loadedLevelCount;
+	imageInfo.arrayLayers = core::max(header.layerCount,1u)*header.faceCount;
+	imageInfo.flags = isCube ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image)
+		return nullptr;
+
+	// one tightly packed region per level, KTX2 level data is laid out layer, face, slice, row which is exactly our layer, slice, row order
+	const TexelBlockInfo blockInfo(format);
+	const uint32_t blockByteSize = getTexelOrBlockBytesize(format);
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(loadedLevelCount);
+	size_t bufferSize = 0ull;
+	for (uint32_t i=0u; i<loadedLevelCount; i++)
+	{
+		const auto mipSize = image->getMipSize(i);
+		const auto blocks = blockInfo.convertTexelsToBlocks(mipSize);
+		const size_t levelSize = size_t(blocks.x)*blocks.y*blocks.z*image->getCreationParameters().arrayLayers*blockByteSize;
+		// the offset and length come straight from the file, so don't let their sum wrap around
+		const size_t fileSize = _file->getSize();
+		if (levels[i].uncompressedByteLength!=levelSize || levels[i].byteLength>fileSize || levels[i].byteOffset>fileSize-levels[i].byteLength)
+		{
+			logger.log("LOAD KTX2: level %d of %s has an invalid size or offset.",system::ILogger::ELL_ERROR,baseLevel+i,fileName.c_str());
+			return nullptr;
+		}
+
+		auto& region = regions->operator[](i);
+		region.bufferOffset = bufferSize;
+		region.bufferRowLength = 0u;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.aspectMask = aspectMask;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = image->getCreationParameters().arrayLayers;
+		region.imageOffset = {0u,0u,0u};
+		region.imageExtent = {mipSize.x,mipSize.y,mipSize.z};
+		bufferSize += levelSize;
+	}
+	auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(bufferSize);
+	uint8_t* const texels = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+
+	// levels decompress independently, so they go in parallel straight from the mapped file if we can
+	const auto* mapped = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
+	core::vector<uint8_t> staging;
+	core::vector<const uint8_t*> sources(loadedLevelCount);
+	if (mapped)
+	{
+		for (uint32_t i=0u; i<loadedLevelCount; i++)
+			sources[i] = mapped+levels[i].byteOffset;
+	}
+	else if (header.supercompressionScheme==ktx2::ESS_NONE)
+	{
+		// nothing to decompress, read each level right into place
+		for (uint32_t i=0u; i<loadedLevelCount; i++)
+		{
+			_file->read(success,texels+regions->operator[](i).bufferOffset,levels[i].byteOffset,levels[i].byteLength);
+			if (!success)
+			{
+				logger.log("LOAD KTX2: failed to read level %d of %s.",system::ILogger::ELL_ERROR,baseLevel+i,fileName.c_str());
+				return nullptr;
+			}
+		}
+	}
+	else
+	{
+		// only the compressed bytes of the requested levels get staged
+		size_t stagingSize = 0ull;
+		for (const auto& level : levels)
+			stagingSize += level.byteLength;
+		staging.resize(stagingSize);
+		size_t stagingOffset = 0ull;
+		for (uint32_t i=0u; i<loadedLevelCount; i++)
+		{
+			_file->read(success,staging.data()+stagingOffset,levels[i].byteOffset,levels[i].byteLength);
+			if (!success)
+			{
+				logger.log("LOAD KTX2: failed to read level %d of %s.",system::ILogger::ELL_ERROR,baseLevel+i,fileName.c_str());
+				return nullptr;
+			}
+			sources[i] = staging.data()+stagingOffset;
+			stagingOffset += levels[i].byteLength;
+		}
+	}
+	if (mapped || header.supercompressionScheme!=ktx2::ESS_NONE)
+	{
+		std::atomic_bool failed = false;
+		core::vector<uint32_t> levelIxs(loadedLevelCount);
+		std::iota(levelIxs.begin(),levelIxs.end(),0u);
+		std::for_each(core::execution::par_unseq,levelIxs.begin(),levelIxs.end(),[&](const uint32_t i)->void
+		{
+			const auto& region = regions->operator[](i);
+			if (!decompressLevel(header.supercompressionScheme,sources[i],levels[i].byteLength,texels+region.bufferOffset,levels[i].uncompressedByteLength))
+				failed = true;
+		});
+		if (failed)
+		{
+			logger.log("LOAD KTX2: failed to decompress %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+			return nullptr;
+		}
+	}
+
+	if (!image->setBufferAndRegions(std::move(texelBuffer),regions))
+		return nullptr;
+
+	ICPUImageView::SCreationParams imageViewInfo = {};
+	imageViewInfo.image = std::move(image);
+	imageViewInfo.format = format;
+	switch (imageViewInfo.image->getCreationParameters().type)
+	{
+		case IImage::ET_1D:
+			imageViewInfo.viewType = header.layerCount ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+			break;
+		case IImage::ET_2D:
+			if (isCube)
+				imageViewInfo.viewType = header.layerCount ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+			else
+				imageViewInfo.viewType = header.layerCount ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+			break;
+		default:
+			imageViewInfo.viewType = ICPUImageView::ET_3D;
+			break;
+	}
+	imageViewInfo.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+	imageViewInfo.subresourceRange.aspectMask = aspectMask;
+	imageViewInfo.subresourceRange.baseArrayLayer = 0u;
+	imageViewInfo.subresourceRange.layerCount = imageViewInfo.image->getCreationParameters().arrayLayers;
+	imageViewInfo.subresourceRange.baseMipLevel = 0u;
+	imageViewInfo.subresourceRange.levelCount = loadedLevelCount;
+	return ICPUImageView::create(std::move(imageViewInfo));
+}
+
+#endif
@@ -0,0 +1,132 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IImageLoader.h"
+
+namespace nbl::asset
+{
+
+// these are also used by the KTX2 writer
+namespace ktx2
+{
+//! «KTX 20»\r\n\x1A\n
+inline constexpr uint8_t Identifier[12] = {0xABu,0x4Bu,0x54u,0x58u,0x20u,0x32u,0x30u,0xBBu,0x0Du,0x0Au,0x1Au,0x0Au};
+
+enum E_SUPERCOMPRESSION_SCHEME : uint32_t
+{
+	ESS_NONE = 0u,
+	ESS_BASIS_LZ = 1u,
+	ESS_ZSTD = 2u,
+	ESS_ZLIB = 3u
+};
+
+struct SHeader
+{
+	uint8_t identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	E_SUPERCOMPRESSION_SCHEME supercompressionScheme;
+	// index
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+static_assert(sizeof(SHeader)==80u);
+
+//! Follows the header, one per mip level starting with the largest
+struct SLevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+static_assert(sizeof(SLevelIndex)==24u);
+
+//! Returns EF_UNKNOWN for VkFormats with no Nabla equivalent
+inline E_FORMAT getFormatFromVkFormat(const uint32_t vkFormat)
+{
+	// same ordering as Vulkan, except for depth formats which we put first and ETC2 which we put after ASTC
+	if (vkFormat>=1u && vkFormat<=123u)
+		return static_cast<E_FORMAT>(vkFormat-1u+EF_R4G4_UNORM_PACK8);
+	if (vkFormat>=124u && vkFormat<=130u)
+		return static_cast<E_FORMAT>(vkFormat-124u+EF_D16_UNORM);
+	if (vkFormat>=131u && vkFormat<=146u)
+		return static_cast<E_FORMAT>(vkFormat-131u+EF_BC1_RGB_UNORM_BLOCK);
+	if (vkFormat>=147u && vkFormat<=156u)
+		return static_cast<E_FORMAT>(vkFormat-147u+EF_ETC2_R8G8B8_UNORM_BLOCK);
+	if (vkFormat>=157u && vkFormat<=184u)
+		return static_cast<E_FORMAT>(vkFormat-157u+EF_ASTC_4x4_UNORM_BLOCK);
+	if (vkFormat>=1000054000u && vkFormat<=1000054007u)
+		return static_cast<E_FORMAT>(vkFormat-1000054000u+EF_PVRTC1_2BPP_UNORM_BLOCK_IMG);
+	return EF_UNKNOWN;
+}
+//! Returns 0 (VK_FORMAT_UNDEFINED) for formats KTX2 can't store
+inline uint32_t getVkFormatFromFormat(const E_FORMAT format)
+{
+	if (format>=EF_R4G4_UNORM_PACK8 && format<=EF_E5B9G9R9_UFLOAT_PACK32)
+		return format-EF_R4G4_UNORM_PACK8+1u;
+	if (format>=EF_D16_UNORM && format<=EF_D32_SFLOAT_S8_UINT)
+		return format-EF_D16_UNORM+124u;
+	if (format>=EF_BC1_RGB_UNORM_BLOCK && format<=EF_BC7_SRGB_BLOCK)
+		return format-EF_BC1_RGB_UNORM_BLOCK+131u;
+	if (format>=EF_ETC2_R8G8B8_UNORM_BLOCK && format<=EF_EAC_R11G11_SNORM_BLOCK)
+		return format-EF_ETC2_R8G8B8_UNORM_BLOCK+147u;
+	if (format>=EF_ASTC_4x4_UNORM_BLOCK && format<=EF_ASTC_12x12_SRGB_BLOCK)
+		return format-EF_ASTC_4x4_UNORM_BLOCK+157u;
+	if (format>=EF_PVRTC1_2BPP_UNORM_BLOCK_IMG && format<=EF_PVRTC2_4BPP_SRGB_BLOCK_IMG)
+		return format-EF_PVRTC1_2BPP_UNORM_BLOCK_IMG+1000054000u;
+	return 0u;
+}
+}
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+//! Native KTX2 loader, handles files without supercompression as well as zlib (and zstd if compiled with it) supercompressed ones
+/*
+	Every mip level is read and decompressed independently straight into the `ICPUImage`'s buffer, the decompression
+	of different levels runs in parallel. BasisLZ/UASTC transcoding is not supported.
+*/
+class CImageLoaderKTX2 final : public IImageLoader
+{
+	public:
+		CImageLoaderKTX2() = default;
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* ext[]{ "ktx2", nullptr };
+			return ext;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+
+		//! Loads only the mip levels [baseLevel,baseLevel+levelCount) of the file using the level index, nothing else gets read.
+		/** The file's `baseLevel` becomes mip 0 of the returned image, so low resolution levels can be streamed in first
+		and the full chain loaded later. `levelCount` gets clamped to the levels present in the file. */
+		core::smart_refctd_ptr<ICPUImageView> loadLevels(system::IFile* _file, const uint32_t baseLevel, const uint32_t levelCount, const system::logger_opt_ptr logger) const;
+
+	protected:
+		~CImageLoaderKTX2() = default;
+};
+#endif
+
+}
+
+#endif
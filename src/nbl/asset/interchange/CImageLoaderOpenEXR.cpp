@@ -126,7 +126,7 @@ class SContext;
 bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::logger_opt_ptr);
 bool readHeader(IMF::IStream* nblIStream, SContext& ctx);
 template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels);
+void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels, const int rowBegin, const int rowEnd);
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger);
 
 //! A helpful struct for handling OpenEXR layout
@@ -347,12 +347,31 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 				continue;
 			}
 
+			// a requested region limits the scanlines which get read, the columns and any scaling are left to the fallback
+			const auto& dataWindow = file.header().dataWindow();
+			const auto& decodeParams = _params.imageDecode;
+			IImageLoader::SDecodedRegion decodedRegion = {{uint32_t(dataWindow.max.x-dataWindow.min.x+1),uint32_t(dataWindow.max.y-dataWindow.min.y+1)}};
+			uint32_t rowBegin = 0u, rowEnd = decodedRegion.fullExtent[1];
+			if (decodeParams.hasRegion())
+			{
+				uint32_t rectOffset[2], rectExtent[2];
+				if (!IImageLoader::getDecodeRect(decodeParams,decodedRegion.fullExtent,rectOffset,rectExtent))
+				{
+					_params.logger.log("LOAD EXR: requested region lies outside of the image %s", system::ILogger::ELL_ERROR, file.fileName());
+					continue;
+				}
+				const uint32_t shift = core::min(decodeParams.mipLevel,31u);
+				rowBegin = static_cast<uint32_t>(core::min(uint64_t(rectOffset[1])<<shift,uint64_t(rowEnd-1u)));
+				rowEnd = core::max(static_cast<uint32_t>(core::min(uint64_t(rectOffset[1]+rectExtent[1])<<shift,uint64_t(rowEnd))),rowBegin+1u);
+				decodedRegion.offset[1] = rowBegin;
+			}
+
 			if (params.format == EF_R16G16B16A16_SFLOAT)
-				readRgba(file, perImageData.halfPixelMapArray, width, height, params.format, suffixOfChannels);
+				readRgba(file, perImageData.halfPixelMapArray, width, height, params.format, suffixOfChannels, rowBegin, rowEnd);
 			else if (params.format == EF_R32G32B32A32_SFLOAT)
-				readRgba(file, perImageData.fullFloatPixelMapArray, width, height, params.format, suffixOfChannels);
+				readRgba(file, perImageData.fullFloatPixelMapArray, width, height, params.format, suffixOfChannels, rowBegin, rowEnd);
 			else if (params.format == EF_R32G32B32A32_UINT)
-				readRgba(file, perImageData.uint32_tPixelMapArray, width, height, params.format, suffixOfChannels);
+				readRgba(file, perImageData.uint32_tPixelMapArray, width, height, params.format, suffixOfChannels, rowBegin, rowEnd);
 
 			params.extent.width = width;
 			params.extent.height = height;
@@ -383,6 +402,13 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 			else if (params.format == EF_R32G32B32A32_UINT)
 				ReadTexels(image.get(), perImageData.uint32_tPixelMapArray);
 
+			if (!decodeParams.isWholeImage())
+			{
+				image = IImageLoader::applyDecodeParams(std::move(image),decodeParams,decodedRegion,_params.logger);
+				if (!image)
+					continue;
+			}
+
 			meta->placeMeta(metaOffset++,image.get(),std::string(suffixOfChannels),IImageMetadata::ColorSemantic{ ECP_SRGB,EOTF_IDENTITY });
 
 			images.push_back(std::move(image));
@@ -406,11 +432,13 @@ bool CImageLoaderOpenEXR::isALoadableFileFormat(system::IFile* _file, const syst
 }
 
 template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels)
+void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels, const int rowBegin, const int rowEnd)
 {
+	// only the scanlines `[rowBegin,rowEnd)` of the data window get read, OpenEXR then only decompresses the chunks (line blocks or tiles) overlapping them
 	Box2i dw = file.header().dataWindow();
 	width = dw.max.x - dw.min.x + 1;
-	height = dw.max.y - dw.min.y + 1;
+	height = rowEnd - rowBegin;
+	const int firstRow = dw.min.y + rowBegin;
 
 	constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
 	for (auto& pixelChannelBuffer : pixelRgbaMapArray)
@@ -433,7 +461,7 @@ void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapA
 		(
 			name.c_str(),																					// name
 			Slice(pixelType,																				// type
-			(char*)(&(pixelRgbaMapArray[rgbaChannelIndex])[0][0] - dw.min.x - dw.min.y * width),			// base
+			(char*)(&(pixelRgbaMapArray[rgbaChannelIndex])[0][0] - dw.min.x - firstRow * width),			// base
 				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * 1,                                    // xStride
 				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * width,                                // yStride
 				1, 1,                                                                                       // x/y sampling
@@ -442,7 +470,7 @@ void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapA
 	}
 
 	file.setFrameBuffer(frameBuffer);
-	file.readPixels(dw.min.y, dw.max.y);
+	file.readPixels(firstRow, firstRow + height - 1);
 }
 
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger)
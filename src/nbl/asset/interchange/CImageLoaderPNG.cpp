@@ -226,11 +226,34 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 		Height = h;
 	}
 
+	// rows get inflated one after another, so the ones above a requested rectangle still need decoding but the ones below don't,
+	// interlaced images spread every row over all the passes and have to be read whole
+	const auto& decodeParams = _params.imageDecode;
+	SDecodedRegion decodedRegion = {{Width,Height}};
+	uint32_t rowBegin = 0u, rowEnd = Height;
+	if (!decodeParams.isWholeImage())
+	{
+		uint32_t rectOffset[2], rectExtent[2];
+		if (!getDecodeRect(decodeParams,imageSize,rectOffset,rectExtent))
+		{
+			_params.logger.log("LOAD PNG: Requested region lies outside of the image %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+			png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+			return {};
+		}
+		if (png_get_interlace_type(png_ptr,info_ptr)==PNG_INTERLACE_NONE)
+		{
+			const uint32_t shift = core::min(decodeParams.mipLevel,31u);
+			rowBegin = static_cast<uint32_t>(core::min(uint64_t(rectOffset[1])<<shift,uint64_t(Height-1u)));
+			rowEnd = core::max(static_cast<uint32_t>(core::min(uint64_t(rectOffset[1]+rectExtent[1])<<shift,uint64_t(Height))),rowBegin+1u);
+			decodedRegion.offset[1] = rowBegin;
+		}
+	}
+
 	// Create the image structure to be filled by png data
     ICPUImage::SCreationParams imgInfo;
     imgInfo.type = ICPUImage::ET_2D;
     imgInfo.extent.width = Width;
-    imgInfo.extent.height = Height;
+    imgInfo.extent.height = rowEnd-rowBegin;
     imgInfo.extent.depth = 1u;
     imgInfo.mipLevels = 1u;
     imgInfo.arrayLayers = 1u;
@@ -288,11 +311,17 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 
 	auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(region.bufferRowLength * region.imageExtent.height * texelFormatBytesize);
 
-	// Fill array of pointers to rows in image data
+	// Fill array of pointers to rows in image data, the rows above the requested ones all get decoded into the same scratch row
 	const uint32_t pitch = region.bufferRowLength*texelFormatBytesize;
+	core::vector<uint8_t> scratchRow(rowBegin ? pitch:0u);
 	uint8_t* data = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
 	for (uint32_t i=0; i<Height; ++i)
 	{
+		if (i<rowBegin || i>=rowEnd)
+		{
+			RowPointers[i] = scratchRow.data();
+			continue;
+		}
 		RowPointers[i] = (png_bytep)data;
 		data += pitch;
 	}
@@ -306,13 +335,21 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 	}
 
 	// Read data using the library function that handles all transformations including interlacing
-	png_read_image(png_ptr, RowPointers);
-
-	png_read_end(png_ptr, nullptr);
+	if (rowEnd<Height || rowBegin)
+	{
+		// only happens for non interlaced images, the rest of the stream is never even read
+		for (uint32_t i=0u; i<rowEnd; ++i)
+			png_read_row(png_ptr, RowPointers[i], nullptr);
+	}
+	else
+	{
+		png_read_image(png_ptr, RowPointers);
+		png_read_end(png_ptr, nullptr);
+	}
 	if (lumaAlphaType)
 	{
 		assert(imgInfo.format==asset::EF_R8G8B8A8_SRGB);
-		for (uint32_t i=0u; i<Height; ++i)
+		for (uint32_t i=rowBegin; i<rowEnd; ++i)
 		for (uint32_t j=0u; j<Width;)
 		{
 			uint32_t in = reinterpret_cast<uint16_t*>(RowPointers[i])[j];
@@ -339,6 +376,12 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 	}
 
 	image->setBufferAndRegions(std::move(texelBuffer), regions);
+	if (!decodeParams.isWholeImage())
+	{
+		image = applyDecodeParams(std::move(image),decodeParams,decodedRegion,_params.logger);
+		if (!image)
+			return {};
+	}
 
     return SAssetBundle(nullptr,{image});
 }
@@ -42,59 +42,81 @@ namespace asset
 		return outputBuffer;
 	}
 
-//! loads a compressed tga.
-void CImageLoaderTGA::loadCompressedImage(system::IFile *file, const STGAHeader& header, const uint32_t wholeSizeWithPitchInBytes, core::smart_refctd_ptr<ICPUBuffer>& bufferData) const
+namespace
 {
-	// This was written and sent in by Jon Pry, thank you very much!
-	// I only changed the formatting a little bit.
-	int32_t bytesPerPixel = header.PixelDepth/8;
-	int32_t imageSizeInBytes =  header.ImageHeight * header.ImageWidth * bytesPerPixel;
-	bufferData = core::make_smart_refctd_ptr<ICPUBuffer>(wholeSizeWithPitchInBytes);
-	auto data = reinterpret_cast<uint8_t*>(bufferData->getPointer());
-	int32_t currentByte = 0;
-
-	while(currentByte < imageSizeInBytes)
+// where the texels of a row start in the RLE stream, packets are allowed to cross rows (TGA 2.0 says they shouldn't, plenty of writers do anyway)
+struct SRowStart
+{
+	size_t byteOffset;
+	uint32_t texelsIntoPacket;
+};
+
+//! Decodes RLE `data` into rows `pitch` bytes apart, swapping to RGB(A) and flipping on the way, returns false if the stream is truncated.
+/*
+	A sequential pre-scan only looks at the packet headers to find where every row starts, after that batches of rows
+	get decoded in parallel. Each row gets its channels swizzled right after it's decoded, while it's still in cache.
+*/
+bool decodeRLE(const uint8_t* data, const size_t size, const uint32_t width, const uint32_t height, const uint32_t bytesPerTexel, const bool swapRB, const bool flip, uint8_t* out, const size_t pitch)
+{
+	core::vector<SRowStart> rowStarts(height);
 	{
-		uint8_t chunkheader = 0;
+		const uint64_t texelCount = uint64_t(width)*height;
+		uint64_t texel = 0ull;
+		size_t pos = 0ull;
+		uint32_t row = 0u;
+		while (texel<texelCount)
 		{
-			system::IFile::success_t success;
-			file->read(success, &chunkheader, 0, sizeof(uint8_t)); // Read The Chunk's Header
-			if (!success)
-				return; // TODO: log error
+			if (pos>=size)
+				return false;
+			const uint8_t packetHeader = data[pos];
+			const uint32_t count = (packetHeader&0x7fu)+1u;
+			const size_t packetSize = 1ull+((packetHeader&0x80u) ? bytesPerTexel:size_t(bytesPerTexel)*count);
+			if (pos+packetSize>size)
+				return false;
+			for (; row<height && uint64_t(row)*width<texel+count; row++)
+				rowStarts[row] = {pos,static_cast<uint32_t>(uint64_t(row)*width-texel)};
+			texel += count;
+			pos += packetSize;
 		}
-		if(chunkheader < 128) // If The Chunk Is A 'RAW' Chunk
-		{
-			chunkheader++; // Add 1 To The Value To Get Total Number Of Raw Pixels
+	}
 
-			system::IFile::success_t success;
-			file->read(success, &data[currentByte], 0, bytesPerPixel * chunkheader);
-			if (!success)
-				return; // TODO: log
-			currentByte += bytesPerPixel * chunkheader;
-		}
-		else
+	constexpr uint32_t MinBatchTexels = 0x10000u;
+	const uint32_t minBatchRows = core::max(MinBatchTexels/core::max(width,1u),1u);
+	// the pre-scan made sure every packet covering the image is complete, so the decode needs no bounds checks
+	core::parallel_for_batches(core::execution::par_unseq,height,minBatchRows,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+	{
+		size_t pos = rowStarts[begin].byteOffset;
+		uint32_t skip = rowStarts[begin].texelsIntoPacket;
+		for (uint32_t y=begin; y<end; y++)
 		{
-			// thnx to neojzs for some fixes with this code
-
-			// If It's An RLE Header
-			chunkheader -= 127; // Subtract 127 To Get Rid Of The ID Bit
-
-			int32_t dataOffset = currentByte;
-			system::IFile::success_t success;
-			file->read(success, &data[currentByte], 0, bytesPerPixel);
-			if (!success)
-				return; // TODO: log
-			currentByte += bytesPerPixel;
-
-			for(int32_t counter = 1; counter < chunkheader; counter++)
+			uint8_t* const dst = out+pitch*(flip ? (height-1u-y):y);
+			for (uint32_t x=0u; x<width;)
 			{
-				for(int32_t elementCounter=0; elementCounter < bytesPerPixel; elementCounter++)
-					data[currentByte + elementCounter] = data[dataOffset + elementCounter];
-
-				currentByte += bytesPerPixel;
+				const uint8_t packetHeader = data[pos];
+				const uint32_t count = (packetHeader&0x7fu)+1u;
+				const uint32_t n = core::min(count-skip,width-x);
+				const bool isRun = packetHeader&0x80u;
+				if (isRun)
+				{
+					for (uint32_t i=0u; i<n; i++)
+						memcpy(dst+size_t(x+i)*bytesPerTexel,data+pos+1u,bytesPerTexel);
+				}
+				else
+					memcpy(dst+size_t(x)*bytesPerTexel,data+pos+1u+size_t(skip)*bytesPerTexel,size_t(n)*bytesPerTexel);
+				x += n;
+				skip += n;
+				if (skip==count)
+				{
+					pos += 1ull+(isRun ? bytesPerTexel:size_t(bytesPerTexel)*count);
+					skip = 0u;
+				}
 			}
+			if (swapRB)
+				tga::swapRedBlue(dst,dst,width,bytesPerTexel);
 		}
-	}
+	});
+	return true;
+}
 }
 
 //! returns true if the file maybe is able to be loaded by this class
@@ -147,39 +169,25 @@ bool CImageLoaderTGA::isALoadableFileFormat(system::IFile* _file, const system::
 	return true;
 }
 
-/*
-	Targa formats needs two y-axis flips. The first is a flip to get the Y conforms to OpenGL coords.
-	The second flip is defined from within the .tga file itself (header.ImageDescriptor & 0x20).
-	if flip - perform two flips (OpenGL + Targa) = no flipping. Don't flip the image at all in that case
-	if not - do an OpenGL flip
-*/
-
-core::smart_refctd_ptr<ICPUImage> createImage(ICPUImage::SCreationParams& imgInfo, core::smart_refctd_ptr<ICPUBuffer>&& texelBuffer, bool flip)
+core::smart_refctd_ptr<ICPUImage> createImage(ICPUImage::SCreationParams& imgInfo, core::smart_refctd_ptr<ICPUBuffer>&& texelBuffer)
 {
-	core::smart_refctd_ptr<ICPUImage> inputCreationImage;
-	{
-		auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
-		ICPUImage::SBufferCopy& region = regions->front();
-		
-		region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0u;
-		region.imageSubresource.baseArrayLayer = 0u;
-		region.imageSubresource.layerCount = 1u;
-		region.bufferOffset = 0u;
-		region.bufferRowLength = asset::IImageAssetHandlerBase::calcPitchInBlocks(imgInfo.extent.width, asset::getTexelOrBlockBytesize(imgInfo.format));
-		region.bufferImageHeight = 0u;
-		region.imageOffset = { 0u, 0u, 0u };
-		region.imageExtent = imgInfo.extent;
-
-		inputCreationImage = asset::ICPUImage::create(std::move(imgInfo));
-		inputCreationImage->setBufferAndRegions(std::move(texelBuffer), regions);
-		
-		bool OpenGlFlip = flip;
-		if (OpenGlFlip)
-			asset::IImageAssetHandlerBase::performImageFlip(inputCreationImage);
-	}
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+	ICPUImage::SBufferCopy& region = regions->front();
+	
+	region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0u;
+	region.imageSubresource.baseArrayLayer = 0u;
+	region.imageSubresource.layerCount = 1u;
+	region.bufferOffset = 0u;
+	region.bufferRowLength = asset::IImageAssetHandlerBase::calcPitchInBlocks(imgInfo.extent.width, asset::getTexelOrBlockBytesize(imgInfo.format));
+	region.bufferImageHeight = 0u;
+	region.imageOffset = { 0u, 0u, 0u };
+	region.imageExtent = imgInfo.extent;
 
-	return inputCreationImage;
+	auto image = asset::ICPUImage::create(std::move(imgInfo));
+	if (image)
+		image->setBufferAndRegions(std::move(texelBuffer), regions);
+	return image;
 };
 
 //! creates a surface from the file
@@ -193,24 +201,15 @@ asset::SAssetBundle CImageLoaderTGA::loadAsset(system::IFile* _file, const asset
 			return {};
 	}
 
-	const auto bytesPerTexel = header.PixelDepth / 8;
+	const uint32_t bytesPerTexel = header.PixelDepth / 8u;
 
 	size_t offset = sizeof header;
 	if (header.IdLength) // skip image identification field
 		offset += header.IdLength;
 
+	// color mapped image types aren't supported, but true color images may still carry a map which needs skipping
 	if (header.ColorMapType)
-	{
-		auto colorMapEntryByteSize = header.ColorMapEntrySize / 8 * header.ColorMapLength;
-		auto colorMapEntryBuffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(colorMapEntryByteSize);
-		{
-			system::IFile::success_t success;
-			_file->read(success, colorMapEntryBuffer->getPointer(), offset, header.ColorMapEntrySize / 8 * header.ColorMapLength);
-			if (!success)
-				return {};
-		}
-		offset += header.ColorMapEntrySize / 8 * header.ColorMapLength;
-	}
+		offset += (header.ColorMapEntrySize+7u) / 8u * header.ColorMapLength;
 
 	ICPUImage::SCreationParams imgInfo;
 	imgInfo.type = ICPUImage::ET_2D;
@@ -222,105 +221,112 @@ asset::SAssetBundle CImageLoaderTGA::loadAsset(system::IFile* _file, const asset
 	imgInfo.samples = ICPUImage::ESCF_1_BIT;
 	imgInfo.flags = static_cast<IImage::E_CREATE_FLAGS>(0u);
 
-	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
-	core::smart_refctd_ptr<ICPUBuffer> texelBuffer = nullptr;
-
-	ICPUImage::SBufferCopy& region = regions->front();
-	
-	region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0u;
-	region.imageSubresource.baseArrayLayer = 0u;
-	region.imageSubresource.layerCount = 1u;
-	region.bufferOffset = 0u;
-	region.bufferImageHeight = 0u;
-	region.imageOffset = { 0u, 0u, 0u };
-	region.imageExtent = imgInfo.extent;
+	if (header.ImageWidth==0u || header.ImageHeight==0u)
+	{
+		_params.logger.log("The given TGA %s doesn't have image data", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
 
-	// read image
-	size_t endBufferSize = {};
-	
+	bool compressed = false;
 	switch (header.ImageType)
 	{
-		case STIT_NONE:
-		{
-			_params.logger.log("The given TGA doesn't have image data", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
-			return {};
-		}
 		case STIT_UNCOMPRESSED_RGB_IMAGE: [[fallthrough]];
 		case STIT_UNCOMPRESSED_GRAYSCALE_IMAGE:
-		{
-			region.bufferRowLength = calcPitchInBlocks(region.imageExtent.width, getTexelOrBlockBytesize(EF_R8G8B8_SRGB));
-			const int32_t imageSize = endBufferSize = region.imageExtent.height * region.bufferRowLength * bytesPerTexel;
-			texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(imageSize);
-			{
-				system::IFile::success_t success;
-				_file->read(success, texelBuffer->getPointer(), offset, imageSize);
-				if (!success)
-					return {};
-			}
-			offset += imageSize;
-		}
-		break;
-		case STIT_RLE_TRUE_COLOR_IMAGE: 
-		{
-			region.bufferRowLength = calcPitchInBlocks(region.imageExtent.width, bytesPerTexel);
-			const auto bufferSize = endBufferSize = region.imageExtent.height * region.bufferRowLength * bytesPerTexel;
-			loadCompressedImage(_file, header, bufferSize, texelBuffer);
 			break;
-		}
+		case STIT_RLE_TRUE_COLOR_IMAGE: [[fallthrough]];
+		case STIT_RLE_GRAYSCALE_IMAGE:
+			compressed = true;
+			break;
+		case STIT_NONE:
+			_params.logger.log("The given TGA %s doesn't have image data", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+			return {};
 		default:
-		{
-			_params.logger.log("Unsupported TGA file type", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
-            return {};
-		}
+			_params.logger.log("Unsupported TGA file type in %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+			return {};
 	}
 
-	bool flip = (header.ImageDescriptor & 0x20) == 0;
-
-	core::smart_refctd_ptr<ICPUImage> newConvertedImage;
-
 	switch(header.PixelDepth)
 	{
 		case 8:
+			if (header.ImageType!=STIT_UNCOMPRESSED_GRAYSCALE_IMAGE && header.ImageType!=STIT_RLE_GRAYSCALE_IMAGE)
 			{
-				if (header.ImageType != 3)
-				{
-					_params.logger.log("Loading 8-bit non-grayscale is NOT supported.", system::ILogger::ELL_ERROR);
-					return {};
-				}
-				
-				imgInfo.format = asset::EF_R8_SRGB;
-				newConvertedImage = createImage(imgInfo, std::move(texelBuffer), flip);
+				_params.logger.log("Loading 8-bit non-grayscale is NOT supported.", system::ILogger::ELL_ERROR);
+				return {};
 			}
+			imgInfo.format = asset::EF_R8_SRGB;
 			break;
 		case 16:
-			{
-				imgInfo.format = asset::EF_A1R5G5B5_UNORM_PACK16;
-				newConvertedImage = createImage(imgInfo, std::move(texelBuffer), flip);
-			}
+			imgInfo.format = asset::EF_A1R5G5B5_UNORM_PACK16;
 			break;
 		case 24:
-			{
-				imgInfo.format = asset::EF_R8G8B8_SRGB;
-				newConvertedImage = createImage(imgInfo, std::move(texelBuffer), flip);
-			}
+			imgInfo.format = asset::EF_R8G8B8_SRGB;
 			break;
 		case 32:
-			{
-				imgInfo.format = asset::EF_R8G8B8A8_SRGB;
-				newConvertedImage = createImage(imgInfo, std::move(texelBuffer), flip);
-			}
+			imgInfo.format = asset::EF_R8G8B8A8_SRGB;
 			break;
 		default:
 			_params.logger.log("Unsupported TGA format %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
-			break;
+			return {};
 	}
 
-	core::smart_refctd_ptr<ICPUImage> image = newConvertedImage;
+	// the whole payload gets read at once, RLE streams don't know their size up front so they get everything up to the end of the file
+	const size_t rawSize = size_t(header.ImageWidth)*header.ImageHeight*bytesPerTexel;
+	if (offset>=_file->getSize() || (!compressed && _file->getSize()-offset<rawSize))
+	{
+		_params.logger.log("TGA %s is truncated", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
+	core::vector<uint8_t> payload(compressed ? (_file->getSize()-offset):rawSize);
+	{
+		system::IFile::success_t success;
+		_file->read(success, payload.data(), offset, payload.size());
+		if (!success)
+			return {};
+	}
 
+	// TGA stores BGR(A), and rows go bottom to top unless bit 5 of the descriptor is set, both get undone while writing the rows out
+	const bool swapRB = bytesPerTexel>=3u;
+	const bool flip = (header.ImageDescriptor & 0x20) == 0;
+	const size_t pitch = size_t(calcPitchInBlocks(header.ImageWidth, bytesPerTexel))*bytesPerTexel;
+	auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(pitch*header.ImageHeight);
+	auto* const texels = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+	if (compressed)
+	{
+		if (!decodeRLE(payload.data(), payload.size(), header.ImageWidth, header.ImageHeight, bytesPerTexel, swapRB, flip, texels, pitch))
+		{
+			_params.logger.log("RLE stream of TGA %s is truncated", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+			return {};
+		}
+	}
+	else
+	{
+		const size_t rowSize = size_t(header.ImageWidth)*bytesPerTexel;
+		core::vector<uint32_t> rows(header.ImageHeight);
+		std::iota(rows.begin(), rows.end(), 0u);
+		std::for_each(core::execution::par_unseq, rows.begin(), rows.end(), [&](const uint32_t y) -> void
+		{
+			const uint8_t* src = payload.data()+rowSize*y;
+			uint8_t* dst = texels+pitch*(flip ? (header.ImageHeight-1u-y):y);
+			if (swapRB)
+				tga::swapRedBlue(src, dst, header.ImageWidth, bytesPerTexel);
+			else
+				memcpy(dst, src, rowSize);
+		});
+	}
+
+	auto image = createImage(imgInfo, std::move(texelBuffer));
 	if (!image)
 		return {};
 
+	// neither the raw nor the RLE layout can be decoded out of order, so regions always go through the fallback
+	if (!_params.imageDecode.isWholeImage())
+	{
+		const SDecodedRegion decodedRegion = {{header.ImageWidth,header.ImageHeight}};
+		image = applyDecodeParams(std::move(image),_params.imageDecode,decodedRegion,_params.logger);
+		if (!image)
+			return {};
+	}
+
     return SAssetBundle(nullptr,{std::move(image)});
 }
 
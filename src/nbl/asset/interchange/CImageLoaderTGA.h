@@ -77,11 +77,38 @@ enum STANDARD_TGA_IMAGE_TYPE
 	STIT_UNCOMPRESSED_RGB_IMAGE = 2,
 	STIT_UNCOMPRESSED_GRAYSCALE_IMAGE = 3,
 	STIT_RLE_TRUE_COLOR_IMAGE = 10,
+	STIT_RLE_GRAYSCALE_IMAGE = 11,
 	STIT_COUNT
 };
 // Default alignment
 #include "nbl/nblunpack.h"
 
+namespace tga
+{
+//! TGA stores BGR(A) texels, this swaps the red and blue channels of `count` 24 or 32 bit texels while copying them (works in place too), so it goes both ways
+inline void swapRedBlue(const uint8_t* src, uint8_t* dst, const size_t count, const uint32_t bytesPerTexel)
+{
+	const size_t byteCount = count*bytesPerTexel;
+	size_t i = 0ull;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	// 4 texels per shuffle, for 24bit ones the last 4 bytes of the register pass through untouched and get redone by the next iteration
+	const __m128i mask = bytesPerTexel==4u ? _mm_setr_epi8(2,1,0,3,6,5,4,7,10,9,8,11,14,13,12,15):_mm_setr_epi8(2,1,0,5,4,3,8,7,6,11,10,9,12,13,14,15);
+	const size_t step = size_t(bytesPerTexel)*4ull;
+	for (; i+16ull<=byteCount; i+=step)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i)),mask));
+#endif
+	for (; i<byteCount; i+=bytesPerTexel)
+	{
+		const uint8_t first = src[i];
+		dst[i] = src[i+2u];
+		dst[i+1u] = src[i+1u];
+		dst[i+2u] = first;
+		if (bytesPerTexel==4u)
+			dst[i+3u] = src[i+3u];
+	}
+}
+}
+
 /*!
 	Surface Loader for targa images
 */
@@ -103,11 +130,6 @@ class CImageLoaderTGA final : public IImageLoader
 		}
 
 		virtual asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
-
-
-	private:
-		//! loads a compressed tga. Was written and sent in by Jon Pry, thank you very much!
-		void loadCompressedImage(system::IFile *file, const STGAHeader& header, const uint32_t wholeSizeWithPitchInBytes, core::smart_refctd_ptr<ICPUBuffer>& bufferData) const;
 };
 
 } // end namespace nbl::asset
@@ -0,0 +1,492 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "CImageWriterKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+
+#include <atomic>
+#include <bit>
+#include <numeric>
+
+#include "nbl/core/execution.h"
+#include "nbl/system/IFile.h"
+#include "nbl/asset/compile_config.h"
+#include "nbl/asset/filters/CFlattenRegionsImageFilter.h"
+#include "CImageLoaderKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+#include <zconf.h>
+#include <zlib/zlib.h>
+#endif
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+
+using namespace nbl;
+using namespace nbl::asset;
+
+
+namespace
+{
+// Khronos Data Format Specification values we need
+enum E_DF_MODEL : uint8_t
+{
+	EDFM_RGBSDA = 1u,
+	EDFM_BC1A = 128u,
+	EDFM_BC2 = 129u,
+	EDFM_BC3 = 130u,
+	EDFM_BC4 = 131u,
+	EDFM_BC5 = 132u,
+	EDFM_BC6H = 133u,
+	EDFM_BC7 = 134u,
+	EDFM_ETC2 = 161u,
+	EDFM_ASTC = 162u,
+	EDFM_PVRTC = 164u,
+	EDFM_PVRTC2 = 165u
+};
+enum E_DF_CHANNEL : uint8_t
+{
+	EDFC_R = 0u,
+	EDFC_G = 1u,
+	EDFC_B = 2u,
+	EDFC_STENCIL = 13u,
+	EDFC_DEPTH = 14u,
+	EDFC_A = 15u
+};
+enum E_DF_QUALIFIER : uint8_t
+{
+	EDFQ_LINEAR = 0x10u,
+	EDFQ_SIGNED = 0x40u,
+	EDFQ_FLOAT = 0x80u
+};
+constexpr uint8_t DFPrimariesBT709 = 1u;
+constexpr uint8_t DFTransferLinear = 1u;
+constexpr uint8_t DFTransferSRGB = 2u;
+
+struct SChannelLayout
+{
+	// from the least significant bits up
+	E_DF_CHANNEL channels[4];
+	uint8_t bitLengths[4];
+	uint8_t count;
+	uint8_t typeSize;
+};
+
+// packed formats where the channels are not byte aligned or not in memory order
+bool getPackedLayout(const E_FORMAT format, SChannelLayout& out)
+{
+	switch (format)
+	{
+		case EF_R4G4_UNORM_PACK8:
+			out = {{EDFC_G,EDFC_R},{4,4},2,1};
+			return true;
+		case EF_R4G4B4A4_UNORM_PACK16:
+			out = {{EDFC_A,EDFC_B,EDFC_G,EDFC_R},{4,4,4,4},4,2};
+			return true;
+		case EF_B4G4R4A4_UNORM_PACK16:
+			out = {{EDFC_A,EDFC_R,EDFC_G,EDFC_B},{4,4,4,4},4,2};
+			return true;
+		case EF_R5G6B5_UNORM_PACK16:
+			out = {{EDFC_B,EDFC_G,EDFC_R},{5,6,5},3,2};
+			return true;
+		case EF_B5G6R5_UNORM_PACK16:
+			out = {{EDFC_R,EDFC_G,EDFC_B},{5,6,5},3,2};
+			return true;
+		case EF_R5G5B5A1_UNORM_PACK16:
+			out = {{EDFC_A,EDFC_B,EDFC_G,EDFC_R},{1,5,5,5},4,2};
+			return true;
+		case EF_B5G5R5A1_UNORM_PACK16:
+			out = {{EDFC_A,EDFC_R,EDFC_G,EDFC_B},{1,5,5,5},4,2};
+			return true;
+		case EF_A1R5G5B5_UNORM_PACK16:
+			out = {{EDFC_B,EDFC_G,EDFC_R,EDFC_A},{5,5,5,1},4,2};
+			return true;
+		case EF_A2R10G10B10_UNORM_PACK32: [[fallthrough]];
+		case EF_A2R10G10B10_SNORM_PACK32: [[fallthrough]];
+		case EF_A2R10G10B10_USCALED_PACK32: [[fallthrough]];
+		case EF_A2R10G10B10_SSCALED_PACK32: [[fallthrough]];
+		case EF_A2R10G10B10_UINT_PACK32: [[fallthrough]];
+		case EF_A2R10G10B10_SINT_PACK32:
+			out = {{EDFC_B,EDFC_G,EDFC_R,EDFC_A},{10,10,10,2},4,4};
+			return true;
+		case EF_A2B10G10R10_UNORM_PACK32: [[fallthrough]];
+		case EF_A2B10G10R10_SNORM_PACK32: [[fallthrough]];
+		case EF_A2B10G10R10_USCALED_PACK32: [[fallthrough]];
+		case EF_A2B10G10R10_SSCALED_PACK32: [[fallthrough]];
+		case EF_A2B10G10R10_UINT_PACK32: [[fallthrough]];
+		case EF_A2B10G10R10_SINT_PACK32:
+			out = {{EDFC_R,EDFC_G,EDFC_B,EDFC_A},{10,10,10,2},4,4};
+			return true;
+		case EF_B10G11R11_UFLOAT_PACK32:
+			out = {{EDFC_R,EDFC_G,EDFC_B},{11,11,10},3,4};
+			return true;
+		case EF_X8_D24_UNORM_PACK32:
+			out = {{EDFC_DEPTH},{24},1,4};
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+// basic descriptor block as described in the Khronos Data Format Specification, prefixed with the total size
+/*
+	Our loader and most consumers only look at the VkFormat, so block compressed formats and the few remaining exotic packed
+	ones (shared exponent) get described by a single sample spanning the whole texel block instead of per-channel samples.
+*/
+core::vector<uint32_t> createDFD(const E_FORMAT format, const bool supercompressed, uint32_t& outTypeSize)
+{
+	const auto blockDims = getBlockDimensions(format);
+	const uint32_t blockByteSize = getTexelOrBlockBytesize(format);
+	const bool srgb = isSRGBFormat(format);
+	const bool floatingPoint = isFloatingPointFormat(format);
+	const bool signedFormat = isSignedFormat(format);
+	const bool normalized = isNormalizedFormat(format);
+
+	uint8_t model = EDFM_RGBSDA;
+	if (format>=EF_BC1_RGB_UNORM_BLOCK && format<=EF_BC1_RGBA_SRGB_BLOCK)
+		model = EDFM_BC1A;
+	else if (format>=EF_BC2_UNORM_BLOCK && format<=EF_BC7_SRGB_BLOCK)
+		model = EDFM_BC2+(format-EF_BC2_UNORM_BLOCK)/2u;
+	else if (format>=EF_ETC2_R8G8B8_UNORM_BLOCK && format<=EF_EAC_R11G11_SNORM_BLOCK)
+		model = EDFM_ETC2;
+	else if (format>=EF_ASTC_4x4_UNORM_BLOCK && format<=EF_ASTC_12x12_SRGB_BLOCK)
+		model = EDFM_ASTC;
+	else if (format>=EF_PVRTC1_2BPP_UNORM_BLOCK_IMG && format<=EF_PVRTC2_4BPP_SRGB_BLOCK_IMG)
+		model = (format==EF_PVRTC2_2BPP_UNORM_BLOCK_IMG || format==EF_PVRTC2_4BPP_UNORM_BLOCK_IMG || format==EF_PVRTC2_2BPP_SRGB_BLOCK_IMG || format==EF_PVRTC2_4BPP_SRGB_BLOCK_IMG) ? EDFM_PVRTC2:EDFM_PVRTC;
+
+	SChannelLayout layout = {};
+	const uint32_t channelCount = getFormatChannelCount(format);
+	if (model!=EDFM_RGBSDA)
+	{
+		layout = {{EDFC_R},{static_cast<uint8_t>(blockByteSize*8u)},1,1};
+	}
+	else if (!getPackedLayout(format,layout))
+	{
+		const bool byteAligned = channelCount && blockByteSize%channelCount==0u && format!=EF_E5B9G9R9_UFLOAT_PACK32;
+		if (byteAligned)
+		{
+			const uint8_t bits = static_cast<uint8_t>(blockByteSize/channelCount*8u);
+			layout.count = channelCount;
+			layout.typeSize = blockByteSize/channelCount;
+			if (isDepthOnlyFormat(format))
+				layout.channels[0] = EDFC_DEPTH;
+			else if (isStencilOnlyFormat(format))
+				layout.channels[0] = EDFC_STENCIL;
+			else
+			{
+				constexpr E_DF_CHANNEL RGBA[4] = {EDFC_R,EDFC_G,EDFC_B,EDFC_A};
+				constexpr E_DF_CHANNEL BGRA[4] = {EDFC_B,EDFC_G,EDFC_R,EDFC_A};
+				std::copy_n(isBGRALayoutFormat(format) ? BGRA:RGBA,4u,layout.channels);
+			}
+			std::fill_n(layout.bitLengths,4u,bits);
+		}
+		else
+			layout = {{EDFC_R},{static_cast<uint8_t>(blockByteSize*8u)},1,static_cast<uint8_t>(blockByteSize)};
+	}
+	outTypeSize = layout.typeSize;
+
+	core::vector<uint32_t> dfd(1u+6u+layout.count*4u,0u);
+	const uint32_t blockSize = (6u+layout.count*4u)*sizeof(uint32_t);
+	dfd[0] = sizeof(uint32_t)+blockSize;
+	// vendorId and descriptorType are both 0
+	dfd[1] = 0u;
+	dfd[2] = 2u|(blockSize<<16u);
+	dfd[3] = model|(DFPrimariesBT709<<8u)|((srgb ? DFTransferSRGB:DFTransferLinear)<<16u);
+	dfd[4] = (blockDims.x-1u)|((blockDims.y-1u)<<8u)|((blockDims.z-1u)<<16u);
+	// supercompressed data is unsized
+	dfd[5] = supercompressed ? 0u:blockByteSize;
+	dfd[6] = 0u;
+
+	uint32_t bitOffset = 0u;
+	for (uint32_t i=0u; i<layout.count; i++)
+	{
+		const uint32_t bits = layout.bitLengths[i];
+		uint8_t channel = layout.channels[i];
+		if (model==EDFM_RGBSDA)
+		{
+			if (floatingPoint)
+				channel |= EDFQ_FLOAT;
+			if (signedFormat)
+				channel |= EDFQ_SIGNED;
+			if (srgb && layout.channels[i]==EDFC_A)
+				channel |= EDFQ_LINEAR;
+		}
+		uint32_t* sample = dfd.data()+7u+i*4u;
+		sample[0] = bitOffset|((bits-1u)<<16u)|(uint32_t(channel)<<24u);
+		sample[1] = 0u;
+		if (floatingPoint)
+		{
+			sample[2] = signedFormat ? std::bit_cast<uint32_t>(-1.f):0u;
+			sample[3] = std::bit_cast<uint32_t>(1.f);
+		}
+		else if (normalized || model!=EDFM_RGBSDA)
+		{
+			const uint32_t maxValue = bits>=32u ? 0xffffffffu:((0x1u<<bits)-1u);
+			sample[2] = signedFormat ? static_cast<uint32_t>(-int32_t(maxValue>>1u)):0u;
+			sample[3] = signedFormat ? (maxValue>>1u):maxValue;
+		}
+		else
+		{
+			sample[2] = signedFormat ? ~0u:0u;
+			sample[3] = 1u;
+		}
+		bitOffset += bits;
+	}
+	return dfd;
+}
+
+void appendKeyValue(core::vector<uint8_t>& kvd, const char* key, const char* value, const size_t valueSize)
+{
+	const uint32_t keyAndValueByteLength = static_cast<uint32_t>(strlen(key)+1u+valueSize);
+	const size_t offset = kvd.size();
+	kvd.resize(core::alignUp(offset+sizeof(uint32_t)+keyAndValueByteLength,4ull),0u);
+	memcpy(kvd.data()+offset,&keyAndValueByteLength,sizeof(uint32_t));
+	memcpy(kvd.data()+offset+sizeof(uint32_t),key,strlen(key)+1u);
+	memcpy(kvd.data()+offset+sizeof(uint32_t)+strlen(key)+1u,value,valueSize);
+}
+
+bool compressLevel(const ktx2::E_SUPERCOMPRESSION_SCHEME scheme, const float compressionLevel, const uint8_t* src, const size_t srcSize, core::vector<uint8_t>& dst)
+{
+	switch (scheme)
+	{
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ktx2::ESS_ZSTD:
+		{
+			const int level = compressionLevel>0.f ? core::max(int(compressionLevel*ZSTD_maxCLevel()),1):ZSTD_CLEVEL_DEFAULT;
+			dst.resize(ZSTD_compressBound(srcSize));
+			const size_t size = ZSTD_compress(dst.data(),dst.size(),src,srcSize,level);
+			if (ZSTD_isError(size))
+				return false;
+			dst.resize(size);
+			return true;
+		}
+#endif
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		case ktx2::ESS_ZLIB:
+		{
+			const int level = compressionLevel>0.f ? core::clamp(int(compressionLevel*Z_BEST_COMPRESSION),Z_BEST_SPEED,Z_BEST_COMPRESSION):Z_DEFAULT_COMPRESSION;
+			uLongf size = compressBound(srcSize);
+			dst.resize(size);
+			if (compress2(dst.data(),&size,src,srcSize,level)!=Z_OK)
+				return false;
+			dst.resize(size);
+			return true;
+		}
+#endif
+		default:
+			return false;
+	}
+}
+
+bool isFlattened(const ICPUImage* image)
+{
+	const auto& params = image->getCreationParameters();
+	const auto regions = image->getRegions();
+	if (regions.size()!=params.mipLevels)
+		return false;
+	const TexelBlockInfo blockInfo(params.format);
+	bool mipPresent[16u] = {};
+	for (const auto& region : regions)
+	{
+		const auto mipLevel = region.imageSubresource.mipLevel;
+		if (mipLevel>=params.mipLevels || mipLevel>=16u || mipPresent[mipLevel])
+			return false;
+		mipPresent[mipLevel] = true;
+		const auto mipSize = image->getMipSize(mipLevel);
+		const auto rounded = blockInfo.roundToBlockSize(mipSize);
+		if (region.imageSubresource.baseArrayLayer || region.imageSubresource.layerCount!=params.arrayLayers)
+			return false;
+		if (region.imageOffset.x || region.imageOffset.y || region.imageOffset.z)
+			return false;
+		if (region.imageExtent.width!=mipSize.x || region.imageExtent.height!=mipSize.y || region.imageExtent.depth!=mipSize.z)
+			return false;
+		if ((region.bufferRowLength && region.bufferRowLength!=rounded.x) || (region.bufferImageHeight && region.bufferImageHeight!=rounded.y))
+			return false;
+	}
+	return true;
+}
+}
+
+
+bool CImageWriterKTX2::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
+{
+	if (!_override)
+		getDefaultOverride(_override);
+
+	SAssetWriteContext ctx{_params,_file};
+	auto imageView = IAsset::castDown<const ICPUImageView>(_params.rootAsset);
+	if (!imageView)
+		return false;
+	system::IFile* file = _override->getOutputFile(_file,ctx,{imageView,0u});
+	if (!file)
+		return false;
+	const auto fileName = file->getFileName().string();
+	const auto logger = _params.logger;
+
+	const auto& viewParams = imageView->getCreationParameters();
+	const ICPUImage* image = viewParams.image.get();
+	const auto& imageParams = image->getCreationParameters();
+	const E_FORMAT format = imageParams.format;
+	const uint32_t vkFormat = ktx2::getVkFormatFromFormat(format);
+	if (!vkFormat || (isDepthOrStencilFormat(format) && !isDepthOnlyFormat(format) && !isStencilOnlyFormat(format)))
+	{
+		logger.log("WRITE KTX2: format %d can't be stored in %s.",system::ILogger::ELL_ERROR,format,fileName.c_str());
+		return false;
+	}
+	if (image->getRegions().empty() || !image->getBuffer())
+	{
+		logger.log("WRITE KTX2: image has no contents, %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return false;
+	}
+
+	// KTX2 needs every level tightly packed, respecify the image if its regions are anything else
+	core::smart_refctd_ptr<ICPUImage> flattened;
+	if (!isFlattened(image))
+	{
+		CFlattenRegionsImageFilter::state_type state;
+		state.inImage = image;
+		state.preFill = true;
+		memset(state.fillValue.pointer,0,sizeof(state.fillValue.pointer));
+		if (!CFlattenRegionsImageFilter::execute(core::execution::par_unseq,&state))
+		{
+			logger.log("WRITE KTX2: failed to flatten the regions of the image written to %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+			return false;
+		}
+		flattened = std::move(state.outImage);
+		image = flattened.get();
+	}
+
+	ktx2::E_SUPERCOMPRESSION_SCHEME scheme = ktx2::ESS_NONE;
+	if (_params.flags&EWF_COMPRESSED)
+	{
+#if defined(_NBL_COMPILE_WITH_ZSTD_)
+		scheme = ktx2::ESS_ZSTD;
+#elif defined(_NBL_COMPILE_WITH_ZLIB_)
+		scheme = ktx2::ESS_ZLIB;
+#endif
+	}
+
+	ktx2::SHeader header = {};
+	memcpy(header.identifier,ktx2::Identifier,sizeof(ktx2::Identifier));
+	header.vkFormat = vkFormat;
+	const core::vector<uint32_t> dfd = createDFD(format,scheme!=ktx2::ESS_NONE,header.typeSize);
+	header.pixelWidth = imageParams.extent.width;
+	header.pixelHeight = imageParams.type!=IImage::ET_1D ? imageParams.extent.height:0u;
+	header.pixelDepth = imageParams.type==IImage::ET_3D ? imageParams.extent.depth:0u;
+	const bool isCube = (viewParams.viewType==ICPUImageView::ET_CUBE_MAP || viewParams.viewType==ICPUImageView::ET_CUBE_MAP_ARRAY) && imageParams.arrayLayers%6u==0u;
+	header.faceCount = isCube ? 6u:1u;
+	const uint32_t layers = imageParams.arrayLayers/header.faceCount;
+	const bool isArray = viewParams.viewType==ICPUImageView::ET_1D_ARRAY || viewParams.viewType==ICPUImageView::ET_2D_ARRAY || viewParams.viewType==ICPUImageView::ET_CUBE_MAP_ARRAY;
+	header.layerCount = isArray || layers>1u ? layers:0u;
+	header.levelCount = imageParams.mipLevels;
+	header.supercompressionScheme = scheme;
+
+	// key/value data, keys sorted
+	core::vector<uint8_t> kvd;
+	{
+		const auto& components = viewParams.components;
+		const bool identity = components==ICPUImageView::SComponentMapping{} || components==ICPUImageView::SComponentMapping{ICPUImageView::SComponentMapping::ES_IDENTITY,ICPUImageView::SComponentMapping::ES_IDENTITY,ICPUImageView::SComponentMapping::ES_IDENTITY,ICPUImageView::SComponentMapping::ES_IDENTITY};
+		if (!identity)
+		{
+			constexpr char Swizzles[] = "?01rgba";
+			constexpr char Identity[] = "rgba";
+			char swizzle[5] = {};
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const auto s = (&components.r)[c];
+				swizzle[c] = s==ICPUImageView::SComponentMapping::ES_IDENTITY ? Identity[c]:Swizzles[s];
+			}
+			appendKeyValue(kvd,"KTXswizzle",swizzle,sizeof(swizzle));
+		}
+		constexpr char Writer[] = "Nabla";
+		appendKeyValue(kvd,"KTXwriter",Writer,sizeof(Writer));
+	}
+
+	const size_t indexSize = sizeof(ktx2::SLevelIndex)*header.levelCount;
+	header.dfdByteOffset = sizeof(ktx2::SHeader)+indexSize;
+	header.dfdByteLength = dfd.size()*sizeof(uint32_t);
+	header.kvdByteOffset = header.dfdByteOffset+header.dfdByteLength;
+	header.kvdByteLength = kvd.size();
+
+	// every level gets compressed on its own, in parallel
+	const uint8_t* const texels = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer());
+	const TexelBlockInfo blockInfo(format);
+	const uint32_t blockByteSize = getTexelOrBlockBytesize(format);
+	core::vector<ktx2::SLevelIndex> levels(header.levelCount);
+	core::vector<const uint8_t*> levelData(header.levelCount);
+	for (const auto& region : image->getRegions())
+	{
+		const auto mipLevel = region.imageSubresource.mipLevel;
+		const auto blocks = blockInfo.convertTexelsToBlocks(image->getMipSize(mipLevel));
+		levels[mipLevel].uncompressedByteLength = size_t(blocks.x)*blocks.y*blocks.z*imageParams.arrayLayers*blockByteSize;
+		levelData[mipLevel] = texels+region.bufferOffset;
+	}
+	core::vector<core::vector<uint8_t>> compressed(scheme!=ktx2::ESS_NONE ? header.levelCount:0u);
+	if (scheme!=ktx2::ESS_NONE)
+	{
+		std::atomic_bool failed = false;
+		core::vector<uint32_t> levelIxs(header.levelCount);
+		std::iota(levelIxs.begin(),levelIxs.end(),0u);
+		std::for_each(core::execution::par_unseq,levelIxs.begin(),levelIxs.end(),[&](const uint32_t i)->void
+		{
+			if (!compressLevel(scheme,_params.compressionLevel,levelData[i],levels[i].uncompressedByteLength,compressed[i]))
+				failed = true;
+		});
+		if (failed)
+		{
+			logger.log("WRITE KTX2: supercompression failed for %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+			return false;
+		}
+		for (uint32_t i=0u; i<header.levelCount; i++)
+			levelData[i] = compressed[i].data();
+	}
+
+	// level data goes smallest first, only uncompressed levels need to stay aligned to the texel block
+	const size_t levelAlignment = scheme!=ktx2::ESS_NONE ? 1ull:std::lcm(blockByteSize,4u);
+	size_t offset = header.kvdByteOffset+header.kvdByteLength;
+	for (uint32_t i=header.levelCount; i--;)
+	{
+		offset = core::roundUp(offset,levelAlignment);
+		levels[i].byteOffset = offset;
+		levels[i].byteLength = scheme!=ktx2::ESS_NONE ? compressed[i].size():levels[i].uncompressedByteLength;
+		offset += levels[i].byteLength;
+	}
+
+	// everything before the smallest level, including its padding, in one write
+	core::vector<uint8_t> prologue(levels[header.levelCount-1u].byteOffset,0u);
+	memcpy(prologue.data(),&header,sizeof(header));
+	memcpy(prologue.data()+sizeof(header),levels.data(),indexSize);
+	memcpy(prologue.data()+header.dfdByteOffset,dfd.data(),header.dfdByteLength);
+	memcpy(prologue.data()+header.kvdByteOffset,kvd.data(),header.kvdByteLength);
+	system::IFile::success_t success;
+	file->write(success,prologue.data(),0ull,prologue.size());
+	if (!success)
+	{
+		logger.log("WRITE KTX2: failed to write to %s.",system::ILogger::ELL_ERROR,fileName.c_str());
+		return false;
+	}
+	size_t written = prologue.size();
+	for (uint32_t i=header.levelCount; i--;)
+	{
+		// padding
+		if (written<levels[i].byteOffset)
+		{
+			constexpr uint8_t Zeros[32] = {};
+			file->write(success,Zeros,written,levels[i].byteOffset-written);
+			if (!success)
+				return false;
+		}
+		file->write(success,levelData[i],levels[i].byteOffset,levels[i].byteLength);
+		if (!success)
+		{
+			logger.log("WRITE KTX2: failed to write level %d to %s.",system::ILogger::ELL_ERROR,i,fileName.c_str());
+			return false;
+		}
+		written = levels[i].byteOffset+levels[i].byteLength;
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,44 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_WRITER_KTX2_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_WRITER_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IAssetWriter.h"
+
+namespace nbl::asset
+{
+
+//! Native KTX2 writer, with `EWF_COMPRESSED` every mip level gets supercompressed on its own (zstd if compiled with it, zlib otherwise)
+class CImageWriterKTX2 final : public IAssetWriter
+{
+	public:
+		CImageWriterKTX2() = default;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* ext[]{ "ktx2", nullptr };
+			return ext;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
+
+		uint32_t getSupportedFlags() override { return asset::EWF_BINARY|asset::EWF_COMPRESSED; }
+
+		uint32_t getForcedFlags() override { return asset::EWF_BINARY; }
+
+		bool writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+
+	protected:
+		~CImageWriterKTX2() = default;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_WRITER_
+#endif
@@ -5,11 +5,11 @@
 
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
-#include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
-
 #include "CImageWriterOpenEXR.h"
 
 #ifdef _NBL_COMPILE_WITH_OPENEXR_WRITER_
@@ -26,6 +26,9 @@
 #include "ImfHeader.h"
 
 #include "ImfNamespace.h"
+#include "ImfCompression.h"
+#include "ImfThreading.h"
+#include "Iex.h"
 
 namespace IMF = Imf;
 namespace IMATH = Imath;
@@ -38,12 +41,24 @@ using namespace IMATH;
 
 namespace nbl::asset::impl
 {
+	//! Coalesces the many small writes OpenEXR issues (a few bytes per attribute, one per chunk) into large file writes
 	class nblOStream : public IMF::OStream
 	{
 	public:
 		nblOStream(system::IFile* _nblFile)
-			: IMF::OStream(getFileName(_nblFile).c_str()), nblFile(_nblFile) {}
-		virtual ~nblOStream() {}
+			: IMF::OStream(getFileName(_nblFile).c_str()), nblFile(_nblFile)
+		{
+			buffer.reserve(BufferCapacity);
+		}
+		virtual ~nblOStream()
+		{
+			// OpenEXR can't report anything from here anymore, so `flush()` should have been called explicitly
+			try
+			{
+				flush();
+			}
+			catch (...) {}
+		}
 
 		//----------------------------------------------------------
 		// Write to the stream:
@@ -55,9 +70,16 @@ namespace nbl::asset::impl
 
 		virtual void write(const char c[/*n*/], int n) override
 		{
-			system::IFile::success_t success;
-			nblFile->write(success, c, fileOffset, n);
-			fileOffset += success.getBytesProcessed();
+			const size_t size = static_cast<size_t>(n);
+			if (buffer.size()+size>BufferCapacity)
+				flush();
+			// big chunks (uncompressed scanline blocks of wide images) skip the staging
+			if (size>=BufferCapacity)
+			{
+				writeToFile(c,size);
+				return;
+			}
+			buffer.insert(buffer.end(),c,c+size);
 		}
 
 		//---------------------------------------------------------
@@ -69,7 +91,7 @@ namespace nbl::asset::impl
 
 		virtual uint64_t tellp() override
 		{
-			return static_cast<uint64_t>(fileOffset);
+			return static_cast<uint64_t>(fileOffset+buffer.size());
 		}
 
 		//-------------------------------------------
@@ -79,15 +101,30 @@ namespace nbl::asset::impl
 
 		virtual void seekp(uint64_t pos) override
 		{
+			flush();
 			fileOffset = static_cast<decltype(fileOffset)>(pos);
 		}
 
-		void resetFileOffset()
+		void flush()
 		{
-			fileOffset = 0u;
+			if (buffer.empty())
+				return;
+			writeToFile(buffer.data(),buffer.size());
+			buffer.clear();
 		}
 
 	private:
+		static inline constexpr size_t BufferCapacity = 8u<<20u;
+
+		void writeToFile(const char* data, const size_t size)
+		{
+			system::IFile::success_t success;
+			nblFile->write(success, data, fileOffset, size);
+			if (!success || success.getBytesProcessed()!=size)
+				throw IEX_NAMESPACE::IoExc("Failed to write to the output file");
+			fileOffset += size;
+		}
+
 		const std::string getFileName(system::IFile* _nblFile)
 		{
 			std::filesystem::path filename, extension;
@@ -97,92 +134,124 @@ namespace nbl::asset::impl
 
 		system::IFile* nblFile;
 		size_t fileOffset = {};
+		core::vector<char> buffer;
 	};
 }
 
 constexpr uint8_t availableChannels = 4;
 
-template<typename ilmType>
-bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm, const asset::ICPUImage* image, system::IFile* _file)
+static PixelType getIlmType(const E_FORMAT format)
 {
-	const auto& creationParams = image->getCreationParameters();
-	auto getIlmType = [&creationParams]()
+	switch (format)
 	{
-		if (creationParams.format == EF_R16G16B16A16_SFLOAT)
+		case EF_R16G16B16A16_SFLOAT:
 			return PixelType::HALF;
-		else if (creationParams.format == EF_R32G32B32A32_SFLOAT)
+		case EF_R32G32B32A32_SFLOAT:
 			return PixelType::FLOAT;
-		else if (creationParams.format == EF_R32G32B32A32_UINT)
+		case EF_R32G32B32A32_UINT:
 			return PixelType::UINT;
-		else
+		default:
 			return PixelType::NUM_PIXELTYPES;
-	};
-
-	const auto width = creationParams.extent.width;
-	const auto height = creationParams.extent.height;
-	Header header(width, height);
-	const PixelType pixelType = getIlmType();
-	FrameBuffer frameBuffer;
+	}
+}
 
-	if (pixelType == PixelType::NUM_PIXELTYPES || creationParams.type != IImage::E_TYPE::ET_2D)
-		return false;
+//! Finds a region which holds the whole of the `layer`-th layer of `mipLevel` and returns a pointer to its first texel, or nullptr.
+static const uint8_t* findWholeSubresource(const ICPUImage* image, const uint32_t mipLevel, const uint32_t layer, size_t& outRowPitch)
+{
+	const auto& params = image->getCreationParameters();
+	const auto mipSize = image->getMipSize(mipLevel);
+	const auto texelSize = getTexelOrBlockBytesize(params.format);
+	for (const auto& region : image->getRegions())
+	{
+		const auto& subresource = region.imageSubresource;
+		if (subresource.mipLevel!=mipLevel || layer<subresource.baseArrayLayer || layer>=subresource.baseArrayLayer+subresource.layerCount)
+			continue;
+		if (region.imageOffset.x || region.imageOffset.y || region.imageOffset.z)
+			continue;
+		if (region.imageExtent.width!=mipSize.x || region.imageExtent.height!=mipSize.y)
+			continue;
 
-	for (auto& channelPixelsPtr : pixelsArrayIlm)
-		channelPixelsPtr = _NBL_NEW_ARRAY(ilmType, width * height);
+		const size_t rowLength = region.bufferRowLength ? region.bufferRowLength:region.imageExtent.width;
+		const size_t imageHeight = region.bufferImageHeight ? region.bufferImageHeight:region.imageExtent.height;
+		outRowPitch = rowLength*texelSize;
+		const size_t layerPitch = outRowPitch*imageHeight*region.imageExtent.depth;
+		return reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer())+region.bufferOffset+layerPitch*(layer-subresource.baseArrayLayer);
+	}
+	return nullptr;
+}
 
-	const auto* data = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer());
-	// have to use `std::function` cause MSVC is borderline retarded and feel the need to instantiate separate Lambda types for each reference!?
-	auto writeTexel = std::function([&creationParams, &data, &pixelsArrayIlm](uint32_t ptrOffset, const core::vectorSIMDu32& texelCoord) -> void
-		{
-			assert(texelCoord.w == 0u && texelCoord.z == 0u);
+static Compression getIlmCompression(const COpenEXRMetadata::E_COMPRESSION compression)
+{
+	switch (compression)
+	{
+		case COpenEXRMetadata::EC_NONE:
+			return NO_COMPRESSION;
+		case COpenEXRMetadata::EC_PIZ:
+			return PIZ_COMPRESSION;
+		case COpenEXRMetadata::EC_DWAA:
+			return DWAA_COMPRESSION;
+		default:
+			return ZIP_COMPRESSION;
+	}
+}
 
-			const uint8_t* texelPtr = data + ptrOffset;
-			const uint64_t ptrStyleIlmShiftToDataChannelPixel = (texelCoord.y * creationParams.extent.width) + texelCoord.x;
+//! OpenEXR's global thread pool starts out without any threads, so the per chunk tasks would all run on the calling thread
+static int getWriterThreadCount()
+{
+	static std::once_flag once;
+	std::call_once(once,[]() -> void
+	{
+		// don't shrink a pool the application already set up
+		if (globalThreadCount()==0)
+			setGlobalThreadCount(core::max(static_cast<int>(std::thread::hardware_concurrency()),1));
+	});
+	return globalThreadCount();
+}
 
-			for (uint8_t channelIndex = 0; channelIndex < availableChannels; ++channelIndex)
-			{
-				ilmType channelPixel = *(reinterpret_cast<const ilmType*>(texelPtr) + channelIndex);
-				*(pixelsArrayIlm[channelIndex] + ptrStyleIlmShiftToDataChannelPixel) = channelPixel;
-			}
-		});
+//! The frame buffer slices point straight at the texels in `data`, OpenEXR does the deinterleaving itself while compressing
+static bool writeImage(const uint8_t* data, const size_t rowPitch, const E_FORMAT format, const uint32_t width, const uint32_t height, const COpenEXRMetadata::E_COMPRESSION compression, system::IFile* _file, const system::logger_opt_ptr logger)
+{
+	const PixelType pixelType = getIlmType(format);
+	if (pixelType == PixelType::NUM_PIXELTYPES)
+		return false;
 
-	using StreamToEXR = CRegionBlockFunctorFilter<decltype(writeTexel), true>;
-	typename StreamToEXR::state_type state(writeTexel, image, nullptr);
-	for (auto rit = image->getRegions().begin(); rit != image->getRegions().end(); rit++)
-	{
-		if (rit->imageSubresource.mipLevel || rit->imageSubresource.baseArrayLayer)
-			continue;
+	const size_t texelSize = getTexelOrBlockBytesize(format);
+	const size_t channelSize = texelSize/availableChannels;
 
-		state.regionIterator = rit;
-		StreamToEXR::execute(core::execution::par_unseq, &state);
-	}
+	Header header(width, height);
+	// every chunk gets compressed as a separate task on OpenEXR's thread pool
+	header.compression() = getIlmCompression(compression);
+	FrameBuffer frameBuffer;
 
 	constexpr std::array<const char*, availableChannels> rgbaSignatureAsText = { "R", "G", "B", "A" };
 	for (uint8_t channel = 0; channel < rgbaSignatureAsText.size(); ++channel)
 	{
-		auto rowPitch = sizeof(*pixelsArrayIlm[channel]) * width;
-
 		header.channels().insert(rgbaSignatureAsText[channel], Channel(pixelType));
 		frameBuffer.insert
 		(
 			rgbaSignatureAsText[channel],                                                                // name
 			Slice(pixelType,                                                                             // type
-				(char*)pixelsArrayIlm[channel],                                                             // base
-				sizeof(*pixelsArrayIlm[channel]) * 1,                                                        // xStride
-				rowPitch)																					 // yStride
+				const_cast<char*>(reinterpret_cast<const char*>(data)+channelSize*channel),                 // base
+				texelSize,                                                                                   // xStride
+				rowPitch)                                                                                    // yStride
 		);
 	}
 
-	IMF::OStream* nblOStream = _NBL_NEW(asset::impl::nblOStream, _file);
-	{ // brackets are needed because of OutputFile's destructor
-		OutputFile file(*nblOStream, header);
-		file.setFrameBuffer(frameBuffer);
-		file.writePixels(height);
+	asset::impl::nblOStream nblOStream(_file);
+	try
+	{
+		{ // brackets are needed because of OutputFile's destructor
+			OutputFile file(nblOStream, header, getWriterThreadCount());
+			file.setFrameBuffer(frameBuffer);
+			file.writePixels(height);
+		}
+		nblOStream.flush();
+	}
+	catch (const std::exception& e)
+	{
+		logger.log("OpenEXR writer failed: %s", system::ILogger::ELL_ERROR, e.what());
+		return false;
 	}
-
-	for (auto channelPixelsPtr : pixelsArrayIlm)
-		_NBL_DELETE_ARRAY(channelPixelsPtr, width * height);
-	_NBL_DELETE(nblOStream);
 
 	return true;
 }
@@ -194,35 +263,50 @@ bool CImageWriterOpenEXR::writeAsset(system::IFile* _file, const SAssetWritePara
 
 	SAssetWriteContext ctx{ _params, _file };
 
-	auto imageSmart = asset::IImageAssetHandlerBase::createImageDataForCommonWriting(IAsset::castDown<const ICPUImageView>(_params.rootAsset), _params.logger);
-	const asset::ICPUImage* image = imageSmart.get();
+	const auto* imageView = IAsset::castDown<const ICPUImageView>(_params.rootAsset);
+	const auto& viewParams = imageView->getCreationParameters();
 
-	if (image->getBuffer()->isADummyObjectForCache())
-		return false;
+	// if the view doesn't swizzle or convert, we can write straight out of the image's own buffer
+	core::smart_refctd_ptr<const ICPUImage> image = viewParams.image;
+	uint32_t mipLevel = viewParams.subresourceRange.baseMipLevel;
+	uint32_t layer = viewParams.subresourceRange.baseArrayLayer;
+	bool identityView = viewParams.format==image->getCreationParameters().format && getIlmType(viewParams.format)!=PixelType::NUM_PIXELTYPES;
+	for (auto i=0u; i<availableChannels; i++)
+	{
+		const auto mapping = (&viewParams.components.r)[i];
+		identityView = identityView && (mapping==ICPUImageView::SComponentMapping::ES_IDENTITY || mapping==ICPUImageView::SComponentMapping::ES_R+i);
+	}
+
+	const uint8_t* data = nullptr;
+	size_t rowPitch = 0ull;
+	if (identityView && image->getBuffer() && !image->getBuffer()->isADummyObjectForCache())
+		data = findWholeSubresource(image.get(), mipLevel, layer, rowPitch);
+	if (!data)
+	{
+		image = asset::IImageAssetHandlerBase::createImageDataForCommonWriting(imageView, _params.logger);
+		mipLevel = layer = 0u;
+		if (image->getBuffer()->isADummyObjectForCache())
+			return false;
+		data = findWholeSubresource(image.get(), mipLevel, layer, rowPitch);
+	}
 
-	system::IFile* file = _override->getOutputFile(_file, ctx, { image, 0u });
+	system::IFile* file = _override->getOutputFile(_file, ctx, { image.get(), 0u });
 
 	if (!file)
 		return false;
 
-	return writeImageBinary(file, image);
+	const auto* exrParams = reinterpret_cast<const COpenEXRMetadata::SWriteParams*>(_params.userData);
+	const auto compression = exrParams ? exrParams->compression:COpenEXRMetadata::SWriteParams{}.compression;
+	return writeImageBinary(file, image.get(), data, rowPitch, mipLevel, compression, _params.logger);
 }
 
-bool CImageWriterOpenEXR::writeImageBinary(system::IFile* file, const asset::ICPUImage* image)
+bool CImageWriterOpenEXR::writeImageBinary(system::IFile* file, const asset::ICPUImage* image, const uint8_t* data, const size_t rowPitch, const uint32_t mipLevel, const COpenEXRMetadata::E_COMPRESSION compression, const system::logger_opt_ptr logger)
 {
 	const auto& params = image->getCreationParameters();
+	if (!data || params.type != IImage::E_TYPE::ET_2D)
+		return false;
 
-	std::array<half*, availableChannels> halfPixelMapArray = { nullptr, nullptr, nullptr, nullptr };
-	std::array<float*, availableChannels> fullFloatPixelMapArray = { nullptr, nullptr, nullptr, nullptr };
-	std::array<uint32_t*, availableChannels> uint32_tPixelMapArray = { nullptr, nullptr, nullptr, nullptr };
-
-	if (params.format == EF_R16G16B16A16_SFLOAT)
-		createAndWriteImage(halfPixelMapArray, image, file);
-	else if (params.format == EF_R32G32B32A32_SFLOAT)
-		createAndWriteImage(fullFloatPixelMapArray, image, file);
-	else if (params.format == EF_R32G32B32A32_UINT)
-		createAndWriteImage(uint32_tPixelMapArray, image, file);
-
-	return true;
+	const auto mipSize = image->getMipSize(mipLevel);
+	return writeImage(data, rowPitch, params.format, mipSize.x, mipSize.y, compression, file, logger);
 }
 #endif // _NBL_COMPILE_WITH_OPENEXR_WRITER_
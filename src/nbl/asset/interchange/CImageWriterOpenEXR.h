@@ -10,6 +10,7 @@
 #ifdef _NBL_COMPILE_WITH_OPENEXR_WRITER_
 
 #include "nbl/asset/interchange/IImageWriter.h"
+#include "nbl/asset/metadata/COpenEXRMetadata.h"
 
 namespace nbl
 {
@@ -17,6 +18,7 @@ namespace asset
 {
 
 //! OpenEXR writer capable of saving .exr files
+/** The chunk compression can be picked with a `COpenEXRMetadata::SWriteParams` passed as `SAssetWriteParams::userData`. */
 class CImageWriterOpenEXR final : public IImageWriter
 {
 	protected:
@@ -41,7 +43,7 @@ class CImageWriterOpenEXR final : public IImageWriter
 
 	private:
 
-		bool writeImageBinary(system::IFile* file, const asset::ICPUImage* image);
+		bool writeImageBinary(system::IFile* file, const asset::ICPUImage* image, const uint8_t* data, const size_t rowPitch, const uint32_t mipLevel, const COpenEXRMetadata::E_COMPRESSION compression, const system::logger_opt_ptr logger);
 };
 
 }
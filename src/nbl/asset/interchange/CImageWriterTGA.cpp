@@ -18,6 +18,37 @@
 namespace nbl::asset
 {
 
+namespace
+{
+//! Appends the RLE packets of one row to `out`, packets never cross rows (as TGA 2.0 asks for) which is what lets rows get encoded independently.
+void encodeRLERow(const uint8_t* row, const uint32_t width, const uint32_t bytesPerTexel, core::vector<uint8_t>& out)
+{
+	auto sameTexel = [&](const uint32_t a, const uint32_t b) -> bool
+	{
+		return memcmp(row+size_t(a)*bytesPerTexel, row+size_t(b)*bytesPerTexel, bytesPerTexel)==0;
+	};
+	for (uint32_t x=0u; x<width;)
+	{
+		uint32_t count = 1u;
+		while (count<128u && x+count<width && sameTexel(x, x+count))
+			count++;
+		if (count>1u)
+		{
+			out.push_back(static_cast<uint8_t>(0x80u|(count-1u)));
+			out.insert(out.end(), row+size_t(x)*bytesPerTexel, row+size_t(x+1u)*bytesPerTexel);
+			x += count;
+			continue;
+		}
+		// raw packet up to where the next run starts
+		while (count<128u && x+count<width && !(x+count+1u<width && sameTexel(x+count, x+count+1u)))
+			count++;
+		out.push_back(static_cast<uint8_t>(count-1u));
+		out.insert(out.end(), row+size_t(x)*bytesPerTexel, row+size_t(x+count)*bytesPerTexel);
+		x += count;
+	}
+}
+}
+
 CImageWriterTGA::CImageWriterTGA(core::smart_refctd_ptr<system::ISystem>&& sys) : m_system(std::move(sys))
 {
 #ifdef _NBL_DEBUG
@@ -64,7 +95,11 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 	STGAHeader imageHeader;
 	imageHeader.IdLength = 0;
 	imageHeader.ColorMapType = 0;
-	imageHeader.ImageType = (convertedFormat == EF_R8_SRGB) ? 3 : 2;
+	const bool compress = _params.flags & EWF_COMPRESSED;
+	if (convertedFormat == EF_R8_SRGB)
+		imageHeader.ImageType = compress ? STIT_RLE_GRAYSCALE_IMAGE : STIT_UNCOMPRESSED_GRAYSCALE_IMAGE;
+	else
+		imageHeader.ImageType = compress ? STIT_RLE_TRUE_COLOR_IMAGE : STIT_UNCOMPRESSED_RGB_IMAGE;
 	imageHeader.FirstEntryIndex[0] = 0;
 	imageHeader.FirstEntryIndex[1] = 0;
 	imageHeader.ColorMapLength = 0;
@@ -76,9 +111,8 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 	imageHeader.ImageWidth = trueExtent.X;
 	imageHeader.ImageHeight = trueExtent.Y;
 
-	// top left of image is the top. the image loader needs to
-	// be fixed to only swap/flip
-	imageHeader.ImageDescriptor = 1;
+	// rows get written top to bottom (bit 5), the low 4 bits are the alpha bits per texel
+	imageHeader.ImageDescriptor = 0x20;
 	
 	switch (convertedFormat)
 	{
@@ -120,37 +154,58 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 			return false;
 	}
 
-	uint8_t* scan_lines = (uint8_t*)convertedImage->getBuffer()->getPointer();
+	const uint8_t* scan_lines = reinterpret_cast<const uint8_t*>(convertedImage->getBuffer()->getPointer());
 	if (!scan_lines)
 		return false;
 
-	// size of one pixel in bits
-	uint32_t pixel_size_bits = convertedImage->getBytesPerPixel().getIntegerApprox();
-
-	// length of one row of the source image in bytes
-	uint32_t row_stride = (pixel_size_bits * imageHeader.ImageWidth);
-
-	// length of one output row in bytes
-	int32_t row_size = ((imageHeader.PixelDepth / 8) * imageHeader.ImageWidth);
-
-	// allocate a row do translate data into
-	auto rowPointerBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(row_size);
-	auto row_pointer = reinterpret_cast<uint8_t*>(rowPointerBuffer->getPointer());
+	const uint32_t bytesPerTexel = imageHeader.PixelDepth / 8u;
+	// length of one row of the source image and of an uncompressed output row in bytes
+	const size_t row_stride = size_t(trueExtent.X) * bytesPerTexel;
+	const size_t row_size = size_t(imageHeader.ImageWidth) * bytesPerTexel;
+	const bool swapRB = bytesPerTexel >= 3u;
+
+	// batches of rows get swizzled to BGR(A) and encoded in parallel, then written out in order
+	constexpr uint32_t MinBatchTexels = 0x10000u;
+	const uint32_t height = imageHeader.ImageHeight;
+	const uint32_t minBatchRows = core::max(MinBatchTexels / core::max<uint32_t>(imageHeader.ImageWidth, 1u), 1u);
+	core::vector<core::vector<uint8_t>> encoded(core::parallel_batch_count<decltype(core::execution::par_unseq)>(height, minBatchRows));
+	core::parallel_for_batches(core::execution::par_unseq, height, minBatchRows, [&](const uint32_t batch, const uint32_t begin, const uint32_t end) -> void
+	{
+		auto& out = encoded[batch];
+		core::vector<uint8_t> row;
+		if (compress)
+		{
+			row.resize(row_size);
+			out.reserve(row_size * (end - begin) / 2u);
+		}
+		else
+			out.resize(row_size * (end - begin));
+		for (uint32_t y = begin; y < end; ++y)
+		{
+			const uint8_t* src = scan_lines + row_stride * y;
+			uint8_t* dst = compress ? row.data() : (out.data() + row_size * (y - begin));
+			if (swapRB)
+				tga::swapRedBlue(src, dst, imageHeader.ImageWidth, bytesPerTexel);
+			else
+				memcpy(dst, src, row_size);
+			if (compress)
+				encodeRLERow(dst, imageHeader.ImageWidth, bytesPerTexel, out);
+		}
+	});
 
-	uint32_t y;
 	size_t offset = sizeof(imageHeader);
-	for (y = 0; y < imageHeader.ImageHeight; ++y)
+	for (const auto& chunk : encoded)
 	{
-		memcpy(row_pointer, &scan_lines[y * row_stride], row_size);
-		
+		if (chunk.empty())
+			continue;
 		system::IFile::success_t success;
-		file->write(success, row_pointer, offset, row_size);
+		file->write(success, chunk.data(), offset, chunk.size());
 		if (!success)
-			break;
-		offset += row_size;
+			return false;
+		offset += chunk.size();
 	}
 	
-	STGAExtensionArea extension;
+	STGAExtensionArea extension = {};
 	extension.ExtensionSize = sizeof(extension);
 	extension.Gamma = isSRGBFormat(convertedFormat) ? ((100.0f / 30.0f) - 1.1f) : 1.0f;
 
@@ -160,19 +215,17 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 		if (!success)
 			return false;
 	}
-	offset += sizeof extension;
 
 	STGAFooter imageFooter;
+	// the extension area starts where the pixel data ended, the footer follows it
 	imageFooter.ExtensionOffset = offset;
+	offset += sizeof extension;
 	imageFooter.DeveloperOffset = 0;
 	strncpy(imageFooter.Signature, "TRUEVISION-XFILE.", 18);
 
 	system::IFile::success_t success;
-	file->write(success, &extension, offset, sizeof(extension));
-	if (!success)
-		return false;
-
-	return imageHeader.ImageHeight <= y;
+	file->write(success, &imageFooter, offset, sizeof(imageFooter));
+	return bool(success);
 }
 
 } // namespace nbl::asset
@@ -33,7 +33,7 @@ class CImageWriterTGA : public asset::IAssetWriter
         	return asset::IAsset::ET_IMAGE_VIEW;
         }
 
-        virtual uint32_t getSupportedFlags() override { return 0u; }
+        virtual uint32_t getSupportedFlags() override { return asset::EWF_BINARY | asset::EWF_COMPRESSED; }
 
         virtual uint32_t getForcedFlags() { return asset::EWF_BINARY; }
 
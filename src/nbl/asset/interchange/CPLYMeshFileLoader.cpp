@@ -445,7 +445,7 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const as
 					return {};
             }
 
-			IMeshManipulator::recalculateBoundingBox(mb.get());
+			IMeshManipulator::recalculateBoundingBox(core::execution::par_unseq,mb.get());
 
 			mesh = core::make_smart_refctd_ptr<ICPUMesh>();
 			mesh->getMeshBufferVector().emplace_back(std::move(mb));
@@ -65,17 +65,27 @@ SAssetBundle CSPVLoader::loadAsset(system::IFile* _file, const IAssetLoader::SAs
 	if (!_file)
         return {};
 	
-	auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(_file->getSize());
+	core::smart_refctd_ptr<ICPUBuffer> buffer;
+	if (m_blobPool)
+		buffer = m_blobPool->load(_file);
+	else
+	{
+		buffer = core::make_smart_refctd_ptr<ICPUBuffer>(_file->getSize());
 	
-	system::IFile::success_t success;
-	_file->read(success, buffer->getPointer(), 0, _file->getSize());
-    if (!success)
-        return {};
+		system::IFile::success_t success;
+		_file->read(success, buffer->getPointer(), 0, _file->getSize());
+		if (!success)
+			return {};
+	}
+	if (!buffer || buffer->getSize()<sizeof(uint32_t))
+		return {};
 
-	if (reinterpret_cast<uint32_t*>(buffer->getPointer())[0]!=SPV_MAGIC_NUMBER)
+	// pooled blobs are immutable, only ever read through a const pointer
+	const uint32_t* spirv = reinterpret_cast<const uint32_t*>(static_cast<const ICPUBuffer*>(buffer.get())->getPointer());
+	if (spirv[0]!=SPV_MAGIC_NUMBER)
 		return {};
 
-	SPIRV_CROSS_NAMESPACE::Parser parser(reinterpret_cast<uint32_t*>(buffer->getPointer()), buffer->getSize() / 4ull);
+	SPIRV_CROSS_NAMESPACE::Parser parser(spirv, buffer->getSize() / 4ull);
 	parser.parse();
 	const SPIRV_CROSS_NAMESPACE::ParsedIR& parsedIR = parser.get_parsed_ir();
 	SPIRV_CROSS_NAMESPACE::SPIREntryPoint defaultEntryPoint = parsedIR.entry_points.at(parsedIR.default_entry_point);
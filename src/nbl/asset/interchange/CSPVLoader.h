@@ -6,6 +6,7 @@
 #define _NBL_ASSET_C_SPIR_V_LOADER_H_INCLUDED_
 
 #include "nbl/asset/interchange/IAssetLoader.h"
+#include "nbl/asset/utils/CShaderBlobPool.h"
 
 namespace nbl::asset
 {
@@ -14,7 +15,8 @@ class CSPVLoader final : public asset::IAssetLoader
 {
 		_NBL_STATIC_INLINE_CONSTEXPR uint32_t SPV_MAGIC_NUMBER = 0x07230203u;
 	public:
-		CSPVLoader() = default;
+		//! With a pool, the shader code is taken zero-copy from read-only mapped files and deduplicated against everything else in the pool
+		CSPVLoader(core::smart_refctd_ptr<CShaderBlobPool>&& blobPool=nullptr) : m_blobPool(std::move(blobPool)) {}
 		inline bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr) const override
 		{
 			uint32_t magicNumber = 0u;
@@ -33,6 +35,9 @@ class CSPVLoader final : public asset::IAssetLoader
 		inline uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_SHADER; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+
+	private:
+		core::smart_refctd_ptr<CShaderBlobPool> m_blobPool;
 };
 
 } // namespace nbl::asset
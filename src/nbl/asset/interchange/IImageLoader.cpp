@@ -4,10 +4,161 @@
 
 #include "nbl/asset/interchange/IImageLoader.h"
 
+#include "nbl/asset/format/decodePixels.h"
+#include "nbl/asset/format/encodePixels.h"
+
 using namespace nbl;
 using namespace asset;
 
 IImageLoader::~IImageLoader()
 {
 
-}
\ No newline at end of file
+}
+
+bool IImageLoader::getDecodeRect(const SImageDecodeParams& params, const uint32_t fullExtent[2], uint32_t outOffset[2], uint32_t outExtent[2])
+{
+	for (auto axis=0u; axis<2u; axis++)
+	{
+		const uint32_t levelSize = core::max(fullExtent[axis]>>core::min(params.mipLevel,31u),1u);
+		if (!params.hasRegion())
+		{
+			outOffset[axis] = 0u;
+			outExtent[axis] = levelSize;
+			continue;
+		}
+		if (params.offset[axis]>=levelSize)
+			return false;
+		outOffset[axis] = params.offset[axis];
+		outExtent[axis] = core::min(params.extent[axis],levelSize-params.offset[axis]);
+	}
+	return true;
+}
+
+core::smart_refctd_ptr<ICPUImage> IImageLoader::applyDecodeParams(core::smart_refctd_ptr<ICPUImage>&& decoded, const SImageDecodeParams& params, const SDecodedRegion& region, const system::logger_opt_ptr logger)
+{
+	if (!decoded || decoded->getRegions().size()==0u)
+		return nullptr;
+
+	uint32_t rectOffset[2], rectExtent[2];
+	if (!getDecodeRect(params,region.fullExtent,rectOffset,rectExtent))
+	{
+		logger.log("Requested image region lies outside of mip level %d.",system::ILogger::ELL_ERROR,params.mipLevel);
+		return nullptr;
+	}
+	if (region.mipLevel>params.mipLevel)
+	{
+		logger.log("Image got decoded at a lower resolution than requested!",system::ILogger::ELL_ERROR);
+		return nullptr;
+	}
+
+	const auto& inParams = decoded->getCreationParameters();
+	const uint32_t shift = core::min(params.mipLevel-region.mipLevel,31u);
+	if (shift==0u && rectOffset[0]==region.offset[0] && rectOffset[1]==region.offset[1] && rectExtent[0]==inParams.extent.width && rectExtent[1]==inParams.extent.height)
+		return std::move(decoded);
+	if (isBlockCompressionFormat(inParams.format))
+	{
+		logger.log("Block compressed images can't be cropped or scaled after decoding, returning the whole level.",system::ILogger::ELL_WARNING);
+		return std::move(decoded);
+	}
+
+	const uint32_t texelSize = getTexelOrBlockBytesize(inParams.format);
+	const auto& inRegion = decoded->getRegions().begin()[0];
+	const uint32_t inWidth = inParams.extent.width;
+	const uint32_t inHeight = inParams.extent.height;
+	const size_t inPitch = size_t(inRegion.bufferRowLength ? inRegion.bufferRowLength:inRegion.imageExtent.width)*texelSize;
+	const auto* const inData = reinterpret_cast<const uint8_t*>(decoded->getBuffer()->getPointer())+inRegion.bufferOffset;
+
+	auto outParams = inParams;
+	outParams.extent = {rectExtent[0],rectExtent[1],1u};
+	outParams.mipLevels = 1u;
+	outParams.arrayLayers = 1u;
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+	ICPUImage::SBufferCopy& outRegion = regions->front();
+	outRegion.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+	outRegion.imageSubresource.mipLevel = 0u;
+	outRegion.imageSubresource.baseArrayLayer = 0u;
+	outRegion.imageSubresource.layerCount = 1u;
+	outRegion.bufferOffset = 0u;
+	outRegion.bufferRowLength = calcPitchInBlocks(rectExtent[0],texelSize);
+	outRegion.bufferImageHeight = 0u;
+	outRegion.imageOffset = { 0u, 0u, 0u };
+	outRegion.imageExtent = outParams.extent;
+	const size_t outPitch = size_t(outRegion.bufferRowLength)*texelSize;
+	auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(outPitch*rectExtent[1]);
+	auto* const outData = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+
+	// footprint of an output texel in the decoded image, clamped because odd sized levels and natively scaled decodes (which round up) don't line up exactly
+	auto getFootprint = [shift](const uint32_t outCoord, const uint32_t decodedOffset, const uint32_t decodedSize, uint32_t& begin, uint32_t& end) -> void
+	{
+		const int64_t first = (int64_t(outCoord)<<shift)-int64_t(decodedOffset);
+		begin = static_cast<uint32_t>(std::clamp<int64_t>(first,0ll,int64_t(decodedSize)-1ll));
+		end = static_cast<uint32_t>(std::clamp<int64_t>(first+(1ll<<shift),int64_t(begin)+1ll,int64_t(decodedSize)));
+	};
+	// integer texels can't be averaged meaningfully, those get point sampled
+	const bool filter = shift!=0u && !isIntegerFormat(inParams.format);
+	const uint32_t channels = getFormatChannelCount(inParams.format);
+
+	core::vector<uint32_t> rows(rectExtent[1]);
+	std::iota(rows.begin(),rows.end(),0u);
+	std::for_each(core::execution::par_unseq,rows.begin(),rows.end(),[&](const uint32_t y) -> void
+	{
+		uint32_t y0, y1;
+		getFootprint(rectOffset[1]+y,region.offset[1],inHeight,y0,y1);
+		uint8_t* dst = outData+outPitch*y;
+		for (uint32_t x=0u; x<rectExtent[0]; x++,dst+=texelSize)
+		{
+			uint32_t x0, x1;
+			getFootprint(rectOffset[0]+x,region.offset[0],inWidth,x0,x1);
+			if (!filter)
+			{
+				memcpy(dst,inData+inPitch*y0+size_t(x0)*texelSize,texelSize);
+				continue;
+			}
+
+			double sum[4] = {0.0,0.0,0.0,0.0};
+			for (uint32_t sy=y0; sy<y1; sy++)
+			for (uint32_t sx=x0; sx<x1; sx++)
+			{
+				const void* srcPix[4] = {inData+inPitch*sy+size_t(sx)*texelSize,nullptr,nullptr,nullptr};
+				double texel[4] = {0.0,0.0,0.0,0.0};
+				decodePixelsRuntime(inParams.format,srcPix,texel,0u,0u);
+				for (uint32_t c=0u; c<channels; c++)
+					sum[c] += texel[c];
+			}
+			const double rcpCount = 1.0/double(size_t(y1-y0)*(x1-x0));
+			for (uint32_t c=0u; c<channels; c++)
+				sum[c] *= rcpCount;
+			encodePixelsRuntime(inParams.format,dst,sum);
+		}
+	});
+
+	auto image = ICPUImage::create(std::move(outParams));
+	if (!image)
+		return nullptr;
+	image->setBufferAndRegions(std::move(texelBuffer),regions);
+	return image;
+}
+
+core::smart_refctd_ptr<ICPUImageView> IImageLoader::applyDecodeParamsToView(core::smart_refctd_ptr<ICPUImageView>&& decoded, const SImageDecodeParams& params, const SDecodedRegion& region, const system::logger_opt_ptr logger)
+{
+	if (!decoded)
+		return nullptr;
+	if (!params.hasRegion() && region.mipLevel==params.mipLevel)
+		return std::move(decoded);
+
+	auto viewParams = decoded->getCreationParameters();
+	const auto& imageParams = viewParams.image->getCreationParameters();
+	if (imageParams.type!=IImage::ET_2D || imageParams.arrayLayers!=1u || imageParams.mipLevels!=1u)
+	{
+		logger.log("Only single level, single layer 2D images can be cropped or scaled after decoding, returning the whole image.",system::ILogger::ELL_WARNING);
+		return std::move(decoded);
+	}
+
+	auto image = applyDecodeParams(core::smart_refctd_ptr(viewParams.image),params,region,logger);
+	if (!image)
+		return nullptr;
+	if (image==viewParams.image)
+		return std::move(decoded);
+	viewParams.image = std::move(image);
+	return ICPUImageView::create(std::move(viewParams));
+}
@@ -21,12 +21,14 @@
 #include "nbl/asset/interchange/CImageLoaderTGA.h"
 #include "nbl/asset/interchange/CImageLoaderOpenEXR.h"
 #include "nbl/asset/interchange/CGLILoader.h"
+#include "nbl/asset/interchange/CImageLoaderKTX2.h"
 // writers
 #include "nbl/asset/interchange/CImageWriterJPG.h"
 #include "nbl/asset/interchange/CImageWriterPNG.h"
 #include "nbl/asset/interchange/CImageWriterTGA.h"
 #include "nbl/asset/interchange/CImageWriterOpenEXR.h"
 #include "nbl/asset/interchange/CGLIWriter.h"
+#include "nbl/asset/interchange/CImageWriterKTX2.h"
 
 // shaders
 #include "nbl/asset/utils/CSPIRVIntrospector.h"
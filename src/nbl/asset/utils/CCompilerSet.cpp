@@ -6,6 +6,18 @@
 using namespace nbl;
 using namespace nbl::asset;
 
+// sources interned zero-copy from mapped files are not null-terminated, only copy when that's the case
+static inline const char* getNullTerminatedSource(const ICPUShader* shader, std::string& storage)
+{
+	const auto source = shader->getSourceView();
+	const auto* content = shader->getContent();
+	// only look at the byte past the view when it still belongs to the content, and never assume what it holds
+	if (content && source.data()==content->getPointer() && source.size()<content->getSize() && source.data()[source.size()]=='\0')
+		return source.data();
+	storage = source;
+	return storage.c_str();
+}
+
 core::smart_refctd_ptr<ICPUShader> CCompilerSet::compileToSPIRV(const ICPUShader* shader, const IShaderCompiler::SCompilerOptions& options) const
 {
 	core::smart_refctd_ptr<ICPUShader> outSpirvShader = nullptr;
@@ -16,15 +28,15 @@ core::smart_refctd_ptr<ICPUShader> CCompilerSet::compileToSPIRV(const ICPUShader
 		case IShader::E_CONTENT_TYPE::ECT_HLSL:
 		{
 #ifdef _NBL_PLATFORM_WINDOWS_
-			const char* code = reinterpret_cast<const char*>(shader->getContent()->getPointer());
-			outSpirvShader = m_HLSLCompiler->compileToSPIRV(code, options);
+			std::string storage;
+			outSpirvShader = m_HLSLCompiler->compileToSPIRV(getNullTerminatedSource(shader,storage), options);
 #endif
 		}
 		break;
 		case IShader::E_CONTENT_TYPE::ECT_GLSL:
 		{
-			const char* code = reinterpret_cast<const char*>(shader->getContent()->getPointer());
-			outSpirvShader = m_GLSLCompiler->compileToSPIRV(code, options);
+			std::string storage;
+			outSpirvShader = m_GLSLCompiler->compileToSPIRV(getNullTerminatedSource(shader,storage), options);
 		}
 		break;
 		case IShader::E_CONTENT_TYPE::ECT_SPIRV:
@@ -46,19 +58,21 @@ core::smart_refctd_ptr<ICPUShader> CCompilerSet::preprocessShader(const ICPUShad
 		case IShader::E_CONTENT_TYPE::ECT_HLSL:
 		{
 #ifdef _NBL_PLATFORM_WINDOWS_
-			const char* code = reinterpret_cast<const char*>(shader->getContent()->getPointer());
 			auto stage = shader->getStage();
-			auto resolvedCode = m_HLSLCompiler->preprocessShader(code, stage, preprocessOptions);
-			return core::make_smart_refctd_ptr<ICPUShader>(resolvedCode.c_str(), stage, IShader::E_CONTENT_TYPE::ECT_HLSL, std::string(shader->getFilepathHint()));
+			auto resolvedCode = m_HLSLCompiler->preprocessShader(std::string(shader->getSourceView()), stage, preprocessOptions);
+			// keep the null terminator, permutations often preprocess to identical code
+			auto code = m_blobPool->intern(resolvedCode.c_str(), resolvedCode.size()+1ull);
+			return core::make_smart_refctd_ptr<ICPUShader>(std::move(code), stage, IShader::E_CONTENT_TYPE::ECT_HLSL, std::string(shader->getFilepathHint()));
 #endif
 		}
 		break;
 		case IShader::E_CONTENT_TYPE::ECT_GLSL:
 		{
-			const char* code = reinterpret_cast<const char*>(shader->getContent()->getPointer());
 			auto stage = shader->getStage();
-			auto resolvedCode = m_GLSLCompiler->preprocessShader(code, stage, preprocessOptions);
-			return core::make_smart_refctd_ptr<ICPUShader>(resolvedCode.c_str(), stage, IShader::E_CONTENT_TYPE::ECT_GLSL, std::string(shader->getFilepathHint()));
+			auto resolvedCode = m_GLSLCompiler->preprocessShader(std::string(shader->getSourceView()), stage, preprocessOptions);
+			// keep the null terminator, permutations often preprocess to identical code
+			auto code = m_blobPool->intern(resolvedCode.c_str(), resolvedCode.size()+1ull);
+			return core::make_smart_refctd_ptr<ICPUShader>(std::move(code), stage, IShader::E_CONTENT_TYPE::ECT_GLSL, std::string(shader->getFilepathHint()));
 		}
 		break;
 		case IShader::E_CONTENT_TYPE::ECT_SPIRV:
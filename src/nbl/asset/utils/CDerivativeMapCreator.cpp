@@ -3,10 +3,407 @@
 #include "nbl/asset/filters/CSwizzleAndConvertImageFilter.h"
 #include "nbl/asset/filters/CBlitImageFilter.h"
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
+#include "nbl/asset/format/colorspaceBatch.h"
+#include "nbl/asset/ICPUSampler.h"
 
 using namespace nbl;
 using namespace nbl::asset;
 
+
+namespace
+{
+// tiles are aligned to their own size, so the 2x2 footprint of every in-tile mip texel lies in the same tile
+constexpr uint32_t TileLog2 = 6u;
+constexpr uint32_t TileSize = 0x1u<<TileLog2;
+// the Gaussian derivative is truncated at 3 standard deviations, sampled at texel centers that leaves 2 non-zero taps on each side
+constexpr int32_t DerivativeRadius = 2;
+constexpr uint32_t ApronSize = TileSize+2u*DerivativeRadius;
+// offsets of the in-tile levels in the per-batch scratch, 2 channels per texel
+constexpr uint32_t getTileLevelOffset(const uint32_t level)
+{
+	uint32_t offset = 0u;
+	for (uint32_t l=0u; l<level; l++)
+		offset += (TileSize>>l)*(TileSize>>l)*2u;
+	return offset;
+}
+constexpr uint32_t TileScratchSize = getTileLevelOffset(TileLog2+1u);
+
+// same as the samplers do, but border modes report `-1` instead of asserting
+inline int32_t wrapCoord(const int32_t coord, const uint32_t extent, const ISampler::E_TEXTURE_CLAMP wrap)
+{
+	if (coord>=0 && coord<int32_t(extent))
+		return coord;
+	switch (wrap)
+	{
+		case ISampler::ETC_CLAMP_TO_BORDER:
+			return -1;
+		case ISampler::ETC_MIRROR_CLAMP_TO_BORDER:
+		{
+			const int32_t mirrored = -1-coord;
+			return mirrored>=0 && mirrored<int32_t(extent) ? mirrored:-1;
+		}
+		default:
+			break;
+	}
+	const ISampler::E_TEXTURE_CLAMP wraps[3] = {wrap,ISampler::ETC_CLAMP_TO_EDGE,ISampler::ETC_CLAMP_TO_EDGE};
+	const core::vector3du32_SIMD size(extent,1u,1u,1u);
+	return static_cast<int32_t>(ICPUSampler::wrapTextureCoordinate(core::vectorSIMDi32(coord,0,0,0),wraps,size,size-core::vector3du32_SIMD(1u,1u,1u,1u))[0]);
+}
+
+//! Derivatives and their box filtered mips, produced tile by tile so the full resolution derivatives never hit memory
+class CFusedDerivativeMipChain
+{
+	public:
+		struct SHeightMapParams
+		{
+			ISampler::E_TEXTURE_CLAMP wraps[2];
+			ISampler::E_TEXTURE_BORDER_COLOR borderColor;
+		};
+
+		// `heightMap` being null means the input is a normal map, `format` can override how the input texels get interpreted
+		CFusedDerivativeMipChain(const ICPUImage* image, const E_FORMAT format, const SHeightMapParams* heightMap) : m_image(image), m_format(format), m_fromHeightMap(heightMap)
+		{
+			const auto& params = image->getCreationParameters();
+			m_width = params.extent.width;
+			m_height = params.extent.height;
+			m_layers = params.arrayLayers;
+			m_texelSize = getTexelOrBlockBytesize(format);
+			switch (format)
+			{
+				case EF_R8_SRGB: [[fallthrough]];
+				case EF_R8G8_SRGB: [[fallthrough]];
+				case EF_R8G8B8_SRGB: [[fallthrough]];
+				case EF_R8G8B8A8_SRGB:
+					m_srgb8 = true;
+					[[fallthrough]];
+				case EF_R8_UNORM: [[fallthrough]];
+				case EF_R8G8_UNORM: [[fallthrough]];
+				case EF_R8G8B8_UNORM: [[fallthrough]];
+				case EF_R8G8B8A8_UNORM:
+					m_unorm8 = true;
+					break;
+				default:
+					break;
+			}
+			m_channels = std::min(getFormatChannelCount(format),3u);
+
+			// rows which live in a single region get addressed directly, anything else (block compression, partial regions) goes through region lookups
+			m_rows.resize(size_t(m_height)*m_layers,nullptr);
+			if (!isBlockCompressionFormat(format))
+			for (uint32_t layer=0u; layer<m_layers; layer++)
+			for (uint32_t y=0u; y<m_height; y++)
+			{
+				const core::vectorSIMDu32 coord(0u,y,0u,layer);
+				const auto* region = image->getRegion(0u,coord);
+				if (!region || region->imageOffset.x!=0 || region->imageExtent.width<m_width)
+					continue;
+				core::vectorSIMDu32 blockCoord;
+				const core::vectorSIMDu32 inRegionCoord(0u,y-region->imageOffset.y,0u,layer-region->imageSubresource.baseArrayLayer);
+				m_rows[size_t(layer)*m_height+y] = reinterpret_cast<const uint8_t*>(image->getTexelBlockData(region,inRegionCoord,blockCoord));
+			}
+
+			if (heightMap)
+			{
+				std::copy_n(heightMap->wraps,2u,m_wraps);
+				m_border = heightMap->borderColor==ISampler::ETBC_FLOAT_OPAQUE_WHITE||heightMap->borderColor==ISampler::ETBC_INT_OPAQUE_WHITE ? 1.0:0.0;
+				// derivatives are taken w.r.t. normalized UV coordinates, just like the blit based path
+				for (int32_t k=-DerivativeRadius; k<=DerivativeRadius; k++)
+					m_derivativeTaps[k+DerivativeRadius] = SGaussianFunction<>::weight<1>(-float(k));
+			}
+		}
+
+		inline bool valid() const {return m_width && m_height && m_layers && !isIntegerFormat(m_format);}
+
+		//! `outFormat` is one of the 2 channel signed formats `getRGformat` returns
+		core::smart_refctd_ptr<ICPUImage> create(ICPUImage::SCreationParams&& outParams, const bool isotropic, const bool perMipNormalization, float* out_normalizationFactors)
+		{
+			m_levels = outParams.mipLevels;
+			m_inTileLevels = std::min(m_levels,TileLog2+1u);
+			switch (outParams.format)
+			{
+				case EF_R8G8_SNORM:
+					m_encode = &encodePixels<EF_R8G8_SNORM,double>;
+					break;
+				case EF_R16G16_SNORM:
+					m_encode = &encodePixels<EF_R16G16_SNORM,double>;
+					break;
+				case EF_R32G32_SFLOAT:
+					m_encode = &encodePixels<EF_R32G32_SFLOAT,double>;
+					break;
+				case EF_R64G64_SFLOAT:
+					m_encode = &encodePixels<EF_R64G64_SFLOAT,double>;
+					break;
+				default:
+					return nullptr;
+			}
+
+			// one region per level covering all layers
+			const uint32_t outTexelSize = getTexelOrBlockBytesize(outParams.format);
+			auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(m_levels);
+			size_t bufferSize = 0ull;
+			for (uint32_t level=0u; level<m_levels; level++)
+			{
+				auto& region = regions->operator[](level);
+				region.imageOffset = {0u,0u,0u};
+				region.imageExtent = {getLevelWidth(level),getLevelHeight(level),1u};
+				region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+				region.imageSubresource.mipLevel = level;
+				region.imageSubresource.baseArrayLayer = 0u;
+				region.imageSubresource.layerCount = m_layers;
+				region.bufferRowLength = IImageAssetHandlerBase::calcPitchInBlocks(region.imageExtent.width,outTexelSize);
+				region.bufferImageHeight = 0u;
+				region.bufferOffset = bufferSize;
+				bufferSize += size_t(region.bufferRowLength)*region.imageExtent.height*m_layers*outTexelSize;
+			}
+			auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(bufferSize);
+			auto outImg = ICPUImage::create(std::move(outParams));
+			if (!outImg)
+				return nullptr;
+
+			const uint32_t tilesX = (m_width+TileSize-1u)>>TileLog2;
+			const uint32_t tilesY = (m_height+TileSize-1u)>>TileLog2;
+			const uint32_t tileCount = tilesX*tilesY*m_layers;
+			auto forEachTile = [&](auto&& perTile) -> uint32_t
+			{
+				return core::parallel_for_batches(core::execution::par_unseq,tileCount,1u,[&](const uint32_t batch, const uint32_t begin, const uint32_t end) -> void
+				{
+					core::vector<double> scratch(TileScratchSize+(m_fromHeightMap ? ApronSize*ApronSize:0u));
+					for (uint32_t tile=begin; tile<end; tile++)
+					{
+						const uint32_t tileX = tile%tilesX;
+						const uint32_t tileY = (tile/tilesX)%tilesY;
+						const uint32_t layer = tile/(tilesX*tilesY);
+						computeTile(tileX<<TileLog2,tileY<<TileLog2,layer,scratch.data());
+						perTile(batch,tileX,tileY,layer,scratch.data());
+					}
+				});
+			};
+
+			// the levels coarser than a tile start from an image made of every tile's last level
+			core::vector<core::vector<double>> coarse(m_levels>m_inTileLevels ? m_levels-TileLog2:0u);
+			for (uint32_t i=0u; i<coarse.size(); i++)
+				coarse[i].resize(size_t(getLevelWidth(TileLog2+i))*getLevelHeight(TileLog2+i)*m_layers*2u);
+
+			// first traversal: max of every level, reduced per batch and then across batches
+			const uint32_t maxBatches = core::parallel_batch_count<decltype(core::execution::par_unseq)>(tileCount,1u);
+			core::vector<double> batchMaxAbs(size_t(maxBatches)*m_levels*2u,0.0);
+			const uint32_t batchCount = forEachTile([&](const uint32_t batch, const uint32_t tileX, const uint32_t tileY, const uint32_t layer, const double* tile) -> void
+			{
+				double* maxAbs = batchMaxAbs.data()+size_t(batch)*m_levels*2u;
+				forEachTileTexel(tileX,tileY,tile,[&](const uint32_t level, const uint32_t, const uint32_t, const double* value) -> void
+				{
+					for (uint32_t c=0u; c<2u; c++)
+						maxAbs[level*2u+c] = std::max(maxAbs[level*2u+c],core::abs(value[c]));
+				});
+				if (!coarse.empty() && tileX<getLevelWidth(TileLog2) && tileY<getLevelHeight(TileLog2))
+					std::copy_n(tile+getTileLevelOffset(TileLog2),2u,coarse[0].data()+((size_t(layer)*getLevelHeight(TileLog2)+tileY)*getLevelWidth(TileLog2)+tileX)*2u);
+			});
+			core::vector<double> maxAbs(m_levels*2u,0.0);
+			for (uint32_t batch=0u; batch<batchCount; batch++)
+			for (uint32_t i=0u; i<maxAbs.size(); i++)
+				maxAbs[i] = std::max(maxAbs[i],batchMaxAbs[size_t(batch)*m_levels*2u+i]);
+			// there's at most a tile's worth of texels in all of them, no point going wide
+			for (uint32_t i=1u; i<coarse.size(); i++)
+			{
+				const uint32_t level = TileLog2+i;
+				for (uint32_t layer=0u; layer<m_layers; layer++)
+				for (uint32_t y=0u; y<getLevelHeight(level); y++)
+				for (uint32_t x=0u; x<getLevelWidth(level); x++)
+				{
+					double* dst = coarse[i].data()+((size_t(layer)*getLevelHeight(level)+y)*getLevelWidth(level)+x)*2u;
+					downsample(coarse[i-1].data()+size_t(layer)*getLevelHeight(level-1u)*getLevelWidth(level-1u)*2u,getLevelWidth(level-1u),getLevelWidth(level-1u),getLevelHeight(level-1u),x,y,dst);
+					for (uint32_t c=0u; c<2u; c++)
+						maxAbs[level*2u+c] = std::max(maxAbs[level*2u+c],core::abs(dst[c]));
+				}
+			}
+
+			// the factors are the max magnitudes, same as `CDerivativeMapNormalizationState`
+			core::vector<double> factors(m_levels*2u);
+			for (uint32_t level=0u; level<m_levels; level++)
+			{
+				const double* levelMax = maxAbs.data()+(perMipNormalization ? level:0u)*2u;
+				for (uint32_t c=0u; c<2u; c++)
+					factors[level*2u+c] = isotropic ? std::max(levelMax[0],levelMax[1]):levelMax[c];
+				for (uint32_t c=0u; c<(isotropic ? 1u:2u); c++)
+					out_normalizationFactors[level*(isotropic ? 1u:2u)+c] = static_cast<float>(factors[level*2u+c]);
+			}
+
+			// second traversal: recompute the tiles and write them out normalized
+			uint8_t* const outData = reinterpret_cast<uint8_t*>(buffer->getPointer());
+			auto encode = [&](const uint32_t level, const uint32_t layer, const uint32_t x, const uint32_t y, const double* value) -> void
+			{
+				const auto& region = regions->operator[](level);
+				double normalized[2];
+				for (uint32_t c=0u; c<2u; c++)
+				{
+					const double factor = factors[level*2u+c];
+					// a level of zeros has a zero max
+					normalized[c] = factor>0.0 ? value[c]/factor:0.0;
+				}
+				m_encode(outData+region.bufferOffset+((size_t(layer)*region.imageExtent.height+y)*region.bufferRowLength+x)*outTexelSize,normalized);
+			};
+			forEachTile([&](const uint32_t, const uint32_t tileX, const uint32_t tileY, const uint32_t layer, const double* tile) -> void
+			{
+				forEachTileTexel(tileX,tileY,tile,[&](const uint32_t level, const uint32_t x, const uint32_t y, const double* value) -> void
+				{
+					encode(level,layer,x,y,value);
+				});
+			});
+			for (uint32_t i=1u; i<coarse.size(); i++)
+			{
+				const uint32_t level = TileLog2+i;
+				for (uint32_t layer=0u; layer<m_layers; layer++)
+				for (uint32_t y=0u; y<getLevelHeight(level); y++)
+				for (uint32_t x=0u; x<getLevelWidth(level); x++)
+					encode(level,layer,x,y,coarse[i].data()+((size_t(layer)*getLevelHeight(level)+y)*getLevelWidth(level)+x)*2u);
+			}
+
+			outImg->setBufferAndRegions(std::move(buffer),std::move(regions));
+			return outImg;
+		}
+
+	private:
+		inline uint32_t getLevelWidth(const uint32_t level) const {return std::max(m_width>>level,1u);}
+		inline uint32_t getLevelHeight(const uint32_t level) const {return std::max(m_height>>level,1u);}
+
+		// 2x2 box, levels get floor sized so a texel always has both children along an axis unless the finer level is 1 texel wide
+		static inline void downsample(const double* src, const uint32_t srcStride, const uint32_t srcWidth, const uint32_t srcHeight, const uint32_t x, const uint32_t y, double* dst)
+		{
+			const uint32_t childrenX = x*2u+1u<srcWidth ? 2u:1u;
+			const uint32_t childrenY = y*2u+1u<srcHeight ? 2u:1u;
+			double sum[2] = {0.0,0.0};
+			for (uint32_t cy=0u; cy<childrenY; cy++)
+			for (uint32_t cx=0u; cx<childrenX; cx++)
+			for (uint32_t c=0u; c<2u; c++)
+				sum[c] += src[((y*2u+cy)*srcStride+x*2u+cx)*2u+c];
+			const double rcpCount = 1.0/double(childrenX*childrenY);
+			for (uint32_t c=0u; c<2u; c++)
+				dst[c] = sum[c]*rcpCount;
+		}
+
+		// how many texels of `level` the tile starting at `tileCoord` (level 0) covers
+		static inline int32_t getTileLevelExtent(const uint32_t tileCoord, const uint32_t levelSize, const uint32_t level)
+		{
+			return std::min(int32_t(TileSize>>level),int32_t(levelSize)-int32_t(tileCoord>>level));
+		}
+
+		inline void decodeTexel(const uint32_t x, const uint32_t y, const uint32_t layer, double* out) const
+		{
+			const uint8_t* row = m_rows[size_t(layer)*m_height+y];
+			if (row && m_unorm8)
+			{
+				const uint8_t* texel = row+size_t(x)*m_texelSize;
+				for (uint32_t c=0u; c<m_channels; c++)
+					out[c] = m_srgb8 ? colorspace::decodeSRGB8(texel[c]):double(texel[c])/255.0;
+				return;
+			}
+			core::vectorSIMDu32 blockCoord(0u,0u,0u,0u);
+			const void* src[4] = {nullptr,nullptr,nullptr,nullptr};
+			src[0] = row ? row+size_t(x)*m_texelSize:m_image->getTexelBlockData(0u,core::vectorSIMDu32(x,y,0u,layer),blockCoord);
+			if (src[0])
+				decodePixelsRuntime(m_format,src,out,blockCoord.x,blockCoord.y);
+		}
+
+		// fills the in-tile levels of the tile at level 0 texel `(x0,y0)` of `layer`
+		void computeTile(const uint32_t x0, const uint32_t y0, const uint32_t layer, double* scratch) const
+		{
+			const uint32_t width = std::min(TileSize,m_width-x0);
+			const uint32_t height = std::min(TileSize,m_height-y0);
+			double* const level0 = scratch+getTileLevelOffset(0u);
+			if (m_fromHeightMap)
+			{
+				double* const heights = scratch+TileScratchSize;
+				int32_t columns[ApronSize];
+				for (uint32_t i=0u; i<width+2u*DerivativeRadius; i++)
+					columns[i] = wrapCoord(int32_t(x0+i)-DerivativeRadius,m_width,m_wraps[0]);
+				for (uint32_t j=0u; j<height+2u*DerivativeRadius; j++)
+				{
+					const int32_t row = wrapCoord(int32_t(y0+j)-DerivativeRadius,m_height,m_wraps[1]);
+					for (uint32_t i=0u; i<width+2u*DerivativeRadius; i++)
+					{
+						double texel[4] = {m_border,0.0,0.0,0.0};
+						if (row>=0 && columns[i]>=0)
+							decodeTexel(columns[i],row,layer,texel);
+						heights[j*ApronSize+i] = texel[0];
+					}
+				}
+				const double scaleX = m_width;
+				const double scaleY = m_height;
+				for (uint32_t y=0u; y<height; y++)
+				for (uint32_t x=0u; x<width; x++)
+				{
+					const double* center = heights+(y+DerivativeRadius)*ApronSize+x+DerivativeRadius;
+					double dx = 0.0, dy = 0.0;
+					for (int32_t k=-DerivativeRadius; k<=DerivativeRadius; k++)
+					{
+						dx += m_derivativeTaps[k+DerivativeRadius]*center[k];
+						dy += m_derivativeTaps[k+DerivativeRadius]*center[k*int32_t(ApronSize)];
+					}
+					level0[(y*TileSize+x)*2u+0u] = dx*scaleX;
+					level0[(y*TileSize+x)*2u+1u] = dy*scaleY;
+				}
+			}
+			else
+			{
+				const NormalMapToDerivativeMapSwizzle swizzle = {};
+				for (uint32_t y=0u; y<height; y++)
+				for (uint32_t x=0u; x<width; x++)
+				{
+					double texel[4] = {0.0,0.0,0.0,0.0};
+					decodeTexel(x0+x,y0+y,layer,texel);
+					swizzle(texel,level0+(y*TileSize+x)*2u);
+				}
+			}
+
+			for (uint32_t level=1u; level<m_inTileLevels; level++)
+			{
+				const int32_t srcWidth = getTileLevelExtent(x0,getLevelWidth(level-1u),level-1u);
+				const int32_t srcHeight = getTileLevelExtent(y0,getLevelHeight(level-1u),level-1u);
+				const int32_t levelWidth = getTileLevelExtent(x0,getLevelWidth(level),level);
+				const int32_t levelHeight = getTileLevelExtent(y0,getLevelHeight(level),level);
+				const double* src = scratch+getTileLevelOffset(level-1u);
+				double* dst = scratch+getTileLevelOffset(level);
+				for (int32_t y=0; y<levelHeight; y++)
+				for (int32_t x=0; x<levelWidth; x++)
+					downsample(src,TileSize>>(level-1u),srcWidth,srcHeight,x,y,dst+(y*(TileSize>>level)+x)*2u);
+			}
+		}
+
+		// `func(level,x,y,value)` for every texel of the in-tile levels which exists in the image, `x,y` being coordinates in the level
+		template<typename F>
+		inline void forEachTileTexel(const uint32_t tileX, const uint32_t tileY, const double* scratch, F&& func) const
+		{
+			const uint32_t x0 = tileX<<TileLog2;
+			const uint32_t y0 = tileY<<TileLog2;
+			for (uint32_t level=0u; level<m_inTileLevels; level++)
+			{
+				const int32_t levelWidth = getTileLevelExtent(x0,getLevelWidth(level),level);
+				const int32_t levelHeight = getTileLevelExtent(y0,getLevelHeight(level),level);
+				const double* values = scratch+getTileLevelOffset(level);
+				for (int32_t y=0; y<levelHeight; y++)
+				for (int32_t x=0; x<levelWidth; x++)
+					func(level,(x0>>level)+x,(y0>>level)+y,values+(y*(TileSize>>level)+x)*2u);
+			}
+		}
+
+		const ICPUImage* m_image;
+		E_FORMAT m_format;
+		uint32_t m_width, m_height, m_layers;
+		uint32_t m_texelSize, m_channels;
+		bool m_unorm8 = false, m_srgb8 = false;
+		core::vector<const uint8_t*> m_rows;
+
+		bool m_fromHeightMap;
+		ISampler::E_TEXTURE_CLAMP m_wraps[2] = {ISampler::ETC_REPEAT,ISampler::ETC_REPEAT};
+		double m_border = 0.0;
+		double m_derivativeTaps[2u*DerivativeRadius+1u] = {};
+
+		uint32_t m_levels = 1u;
+		uint32_t m_inTileLevels = 1u;
+		void(*m_encode)(void*,const double*) = nullptr;
+};
+}
+
 template<bool isotropicNormalization>
 core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromHeightMap(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor)
 {
@@ -150,82 +547,67 @@ core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMap
 template<bool isotropicNormalization>
 core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromNormalMap(ICPUImage* _inImg, float* out_normalizationFactor)
 {
-	auto formatOverrideCreationParams = _inImg->getCreationParameters();
-	assert(formatOverrideCreationParams.type == IImage::E_TYPE::ET_2D);
+	// a single level chain is exactly the old swizzle and normalize, just done in parallel
+	// the old `CNormalMapToDerivativeFilter<true>` always normalized isotropically, whatever the template argument was, so keep doing that
+	auto newDerivativeNormalMapImage = createDerivativeMipChainFromNormalMap<true>(_inImg,out_normalizationFactor,1u);
+	if (!newDerivativeNormalMapImage)
+	{
+		_NBL_DEBUG_BREAK_IF(true);
+		// TODO: use logger
+		// os::Printer::log("Something went wrong while performing derivative filter operations!", ELL_ERROR);
+		return nullptr;
+	}
+	if constexpr (!isotropicNormalization)
+		out_normalizationFactor[1] = out_normalizationFactor[0];
+
+	return newDerivativeNormalMapImage;
+}
+
+template<bool isotropicNormalization>
+core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromHeightMap(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization)
+{
+	auto outParams = _inImg->getCreationParameters();
+	if (outParams.type!=IImage::ET_2D)
+		return nullptr;
+	const CFusedDerivativeMipChain::SHeightMapParams heightMap = {{_uwrap,_vwrap},_borderColor};
+	CFusedDerivativeMipChain chain(_inImg,outParams.format,&heightMap);
+	if (!chain.valid())
+		return nullptr;
+
+	outParams.format = getRGformat(outParams.format);
+	const uint32_t fullChain = IImage::calculateFullMipPyramidLevelCount(outParams.extent,outParams.type);
+	outParams.mipLevels = mipLevels ? std::min(mipLevels,fullChain):fullChain;
+	return chain.create(std::move(outParams),isotropicNormalization,perMipNormalization,out_normalizationFactors);
+}
+
+template<bool isotropicNormalization>
+core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromNormalMap(ICPUImage* _inImg, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization)
+{
+	auto outParams = _inImg->getCreationParameters();
+	assert(outParams.type == IImage::E_TYPE::ET_2D);
+	if (outParams.type!=IImage::ET_2D)
+		return nullptr;
 	// tools produce normalmaps with non SRGB encoding but use SRGB formats to store them (WTF!?)
-	switch (formatOverrideCreationParams.format)
+	E_FORMAT inFormat = outParams.format;
+	switch (inFormat)
 	{
 		case EF_R8G8B8_SRGB:
-			formatOverrideCreationParams.format = EF_R8G8B8_UNORM;
+			inFormat = EF_R8G8B8_UNORM;
 			break;
 		case EF_R8G8B8A8_SRGB:
-			formatOverrideCreationParams.format = EF_R8G8B8A8_UNORM;
+			inFormat = EF_R8G8B8A8_UNORM;
 			break;
 		default:
 			break;
 	}
-	auto newImageParams = formatOverrideCreationParams;
-	newImageParams.format = getRGformat(newImageParams.format);
-
-	auto cpuImageNormalTexture = ICPUImage::create(std::move(formatOverrideCreationParams));
-	{
-		const auto& referenceRegions = _inImg->getRegions();
-		auto regionList = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(referenceRegions.size());
-		std::copy(referenceRegions.begin(),referenceRegions.end(),regionList->data());
-		cpuImageNormalTexture->setBufferAndRegions(
-			core::smart_refctd_ptr<ICPUBuffer>(_inImg->getBuffer()),
-			std::move(regionList)
-		);
-	}
-
-	CNormalMapToDerivativeFilter<true> derivativeNormalFilter;
-	decltype(derivativeNormalFilter)::state_type state;
-	state.inOffset = { 0, 0, 0 };
-	state.inBaseLayer = 0;
-	state.outOffset = { 0, 0, 0 };
-	state.outBaseLayer = 0;
-	state.extent = { newImageParams.extent.width,newImageParams.extent.height,newImageParams.extent.depth };
-	state.layerCount = newImageParams.arrayLayers;
-	state.inMipLevel = 0;
-	state.outMipLevel = 0;
-
-	core::smart_refctd_ptr<ICPUImage> newDerivativeNormalMapImage;
-	{
-		const uint32_t pitch = IImageAssetHandlerBase::calcPitchInBlocks(newImageParams.extent.width,getTexelOrBlockBytesize(newImageParams.format));
-		core::smart_refctd_ptr<ICPUBuffer> newCpuBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(getTexelOrBlockBytesize(newImageParams.format) * pitch * newImageParams.extent.height);
-
-		ICPUImage::SBufferCopy region;
-		region.imageOffset = { 0,0,0 };
-		region.imageExtent = newImageParams.extent;
-		region.imageSubresource.baseArrayLayer = 0u;
-		region.imageSubresource.layerCount = 1u;
-		region.imageSubresource.mipLevel = 0u;
-		region.bufferRowLength = pitch;
-		region.bufferImageHeight = 0u;
-		region.bufferOffset = 0u;
-
-		newDerivativeNormalMapImage = ICPUImage::create(std::move(newImageParams));
-		newDerivativeNormalMapImage->setBufferAndRegions(std::move(newCpuBuffer), core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(1ull, region));
-	}
-
-	state.inImage = cpuImageNormalTexture.get();
-	state.outImage = newDerivativeNormalMapImage.get();
-	const bool result = derivativeNormalFilter.execute(&state);
-	if (result)
-	{
-		out_normalizationFactor[0] = state.normalization.maxAbsPerChannel[0];
-		if (!isotropicNormalization)
-			out_normalizationFactor[1] = state.normalization.maxAbsPerChannel[1];
-	}
-	else
-	{
-		_NBL_DEBUG_BREAK_IF(true);
-		// TODO: use logger
-		// os::Printer::log("Something went wrong while performing derivative filter operations!", ELL_ERROR);
+	CFusedDerivativeMipChain chain(_inImg,inFormat,nullptr);
+	if (!chain.valid())
 		return nullptr;
-	}
 
-	return newDerivativeNormalMapImage;
+	outParams.format = getRGformat(inFormat);
+	const uint32_t fullChain = IImage::calculateFullMipPyramidLevelCount(outParams.extent,outParams.type);
+	outParams.mipLevels = mipLevels ? std::min(mipLevels,fullChain):fullChain;
+	return chain.create(std::move(outParams),isotropicNormalization,perMipNormalization,out_normalizationFactors);
 }
 
 template<bool isotropicNormalization>
@@ -257,7 +639,15 @@ core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMap
 
 
 //explicit instantiation
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromHeightMap<false>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromHeightMap<true>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromNormalMap<false>(ICPUImage* _inImg, float* out_normalizationFactor);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMapFromNormalMap<true>(ICPUImage* _inImg, float* out_normalizationFactor);
 template core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMapViewFromHeightMap<false>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor);
 template core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMapViewFromHeightMap<true>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactor);
 template core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMapViewFromNormalMap<false>(ICPUImage* _inImg, float* out_normalizationFactor);
-template core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMapViewFromNormalMap<true>(ICPUImage* _inImg, float* out_normalizationFactor);
\ No newline at end of file
+template core::smart_refctd_ptr<ICPUImageView> CDerivativeMapCreator::createDerivativeMapViewFromNormalMap<true>(ICPUImage* _inImg, float* out_normalizationFactor);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromHeightMap<false>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromHeightMap<true>(ICPUImage* _inImg, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromNormalMap<false>(ICPUImage* _inImg, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization);
+template core::smart_refctd_ptr<ICPUImage> CDerivativeMapCreator::createDerivativeMipChainFromNormalMap<true>(ICPUImage* _inImg, float* out_normalizationFactors, const uint32_t mipLevels, const bool perMipNormalization);
@@ -189,11 +189,12 @@ core::smart_refctd_ptr<ICPUShader> CGLSLCompiler::compileToSPIRV(const char* cod
 
     if (bin_res.GetCompilationStatus() == shaderc_compilation_status_success)
     {
-        auto outSpirv = core::make_smart_refctd_ptr<ICPUBuffer>(std::distance(bin_res.cbegin(), bin_res.cend()) * sizeof(uint32_t));
-        memcpy(outSpirv->getPointer(), bin_res.cbegin(), outSpirv->getSize());
-
+        const size_t spirvSize = std::distance(bin_res.cbegin(), bin_res.cend()) * sizeof(uint32_t);
+        core::smart_refctd_ptr<ICPUBuffer> outSpirv;
         if (glslOptions.spirvOptimizer)
-            outSpirv = glslOptions.spirvOptimizer->optimize(outSpirv.get(), glslOptions.preprocessorOptions.logger);
+            outSpirv = makeCodeBuffer(glslOptions.spirvOptimizer->optimize(bin_res.cbegin(), spirvSize/sizeof(uint32_t), glslOptions.preprocessorOptions.logger));
+        else
+            outSpirv = makeCodeBuffer(bin_res.cbegin(), spirvSize);
         return core::make_smart_refctd_ptr<asset::ICPUShader>(std::move(outSpirv), glslOptions.stage, IShader::E_CONTENT_TYPE::ECT_SPIRV, glslOptions.preprocessorOptions.sourceIdentifier.data());
     }
     else
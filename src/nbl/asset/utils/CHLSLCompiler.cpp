@@ -16,6 +16,7 @@
 #include <wrl.h>
 #include <combaseapi.h>
 #include <sstream>
+#include <mutex>
 #include <dxc/dxcapi.h>
 
 using namespace nbl;
@@ -54,6 +55,78 @@ struct DXC
     ComPtr<IDxcUtils> m_dxcUtils;
     ComPtr<IDxcCompiler3> m_dxcCompiler;
 };
+
+// A single `IDxcCompiler3` cannot be used from multiple threads at once, so we keep a free-list of instances
+// and only create a new one when all existing ones are checked out by other threads.
+class DXCPool
+{
+    public:
+        // RAII handle, returns the instance to the pool on destruction
+        class SInstance
+        {
+            public:
+                SInstance(DXCPool* pool, std::unique_ptr<DXC>&& dxc) : m_pool(pool), m_dxc(std::move(dxc)) {}
+                SInstance(const SInstance&) = delete;
+                SInstance& operator=(const SInstance&) = delete;
+                ~SInstance()
+                {
+                    if (m_dxc)
+                        m_pool->release(std::move(m_dxc));
+                }
+
+                inline DXC* get() const { return m_dxc.get(); }
+                inline DXC* operator->() const { return m_dxc.get(); }
+                explicit inline operator bool() const { return bool(m_dxc); }
+
+            private:
+                DXCPool* m_pool;
+                std::unique_ptr<DXC> m_dxc;
+        };
+
+        inline SInstance acquire()
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                if (!m_free.empty())
+                {
+                    auto retval = std::move(m_free.back());
+                    m_free.pop_back();
+                    return SInstance(this,std::move(retval));
+                }
+            }
+            // creation is slow, don't hold the lock while doing it
+            return SInstance(this,create());
+        }
+
+        inline uint32_t getInstanceCount() const
+        {
+            return m_instanceCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        inline std::unique_ptr<DXC> create()
+        {
+            auto retval = std::make_unique<DXC>();
+            // a half made instance must never get into the pool
+            if (FAILED(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(retval->m_dxcUtils.GetAddressOf()))))
+                return nullptr;
+            if (FAILED(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(retval->m_dxcCompiler.GetAddressOf()))))
+                return nullptr;
+
+            m_instanceCount.fetch_add(1u,std::memory_order_relaxed);
+            return retval;
+        }
+
+        inline void release(std::unique_ptr<DXC>&& dxc)
+        {
+            std::lock_guard lock(m_mutex);
+            m_free.push_back(std::move(dxc));
+        }
+
+        std::mutex m_mutex;
+        core::vector<std::unique_ptr<DXC>> m_free;
+        std::atomic_uint32_t m_instanceCount = 0u;
+};
 }
 
 struct DxcCompilationResult
@@ -70,25 +143,20 @@ struct DxcCompilationResult
 
 
 CHLSLCompiler::CHLSLCompiler(core::smart_refctd_ptr<system::ISystem>&& system)
-    : IShaderCompiler(std::move(system))
+    : IShaderCompiler(std::move(system)), m_dxcPool(new impl::DXCPool())
 {
-    ComPtr<IDxcUtils> utils;
-    auto res = DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(utils.GetAddressOf()));
-    assert(SUCCEEDED(res));
-
-    ComPtr<IDxcCompiler3> compiler;
-    res = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(compiler.GetAddressOf()));
-    assert(SUCCEEDED(res));
-
-    m_dxcCompilerTypes = new impl::DXC{
-        utils,
-        compiler
-    };
+    // create the first instance eagerly, so single threaded usage doesn't pay for it on first compile
+    m_dxcPool->acquire();
 }
 
 CHLSLCompiler::~CHLSLCompiler()
 {
-    delete m_dxcCompilerTypes;
+    delete m_dxcPool;
+}
+
+uint32_t CHLSLCompiler::getDXCInstanceCount() const
+{
+    return m_dxcPool->getInstanceCount();
 }
 
 
@@ -340,10 +408,13 @@ std::string CHLSLCompiler::preprocessShader(std::string&& code, IShader::E_SHADE
     }
     
     // for debugging cause MSVC doesn't like to show more than 21k LoC in TextVisualizer
-    if constexpr (true)
+    // opt-in only, it costs a file write per compile, every source gets its own dump so concurrent compiles don't clobber each other
+#ifdef _NBL_HLSL_DUMP_PREPROCESSED_
     {
+        system::path dumpPath = preprocessOptions.sourceIdentifier;
+        dumpPath += ".preprocessed.hlsl";
         system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
-        m_system->createFile(future,system::path(preprocessOptions.sourceIdentifier).parent_path()/"preprocessed.hlsl",system::IFileBase::ECF_WRITE);
+        m_system->createFile(future,dumpPath,system::IFileBase::ECF_WRITE);
         if (auto file=future.acquire(); file&&bool(*file))
         {
             system::IFile::success_t succ;
@@ -351,6 +422,7 @@ std::string CHLSLCompiler::preprocessShader(std::string&& code, IShader::E_SHADE
             succ.getBytesProcessed(true);
         }
     }
+#endif
 
     if (context.get_hooks().m_dxc_compile_flags_override.size() != 0)
         dxc_compile_flags_override = context.get_hooks().m_dxc_compile_flags_override;
@@ -442,14 +514,21 @@ core::smart_refctd_ptr<ICPUShader> CHLSLCompiler::compileToSPIRV(const char* cod
     for (size_t i = 0; i < argc; i++)
         argsArray[i] = arguments[i].c_str();
     
-    auto compileResult = dxcCompile( 
-        this,
-        m_dxcCompilerTypes,
-        newCode,
-        argsArray,
-        argc,
-        hlslOptions
-    );
+    // hold on to the pooled instance only for the duration of the actual DXC invocation
+    DxcCompilationResult compileResult;
+    if (auto dxc=m_dxcPool->acquire(); dxc)
+    {
+        compileResult = dxcCompile(
+            this,
+            dxc.get(),
+            newCode,
+            argsArray,
+            argc,
+            hlslOptions
+        );
+    }
+    else
+        logger.log("Failed to create a DXC compiler instance!", system::ILogger::ELL_ERROR);
 
     if (argsArray)
         delete[] argsArray;
@@ -459,12 +538,12 @@ core::smart_refctd_ptr<ICPUShader> CHLSLCompiler::compileToSPIRV(const char* cod
         return nullptr;
     }
 
-    auto outSpirv = core::make_smart_refctd_ptr<ICPUBuffer>(compileResult.objectBlob->GetBufferSize());
-    memcpy(outSpirv->getPointer(), compileResult.objectBlob->GetBufferPointer(), compileResult.objectBlob->GetBufferSize());
-    
+    core::smart_refctd_ptr<ICPUBuffer> outSpirv;
     // Optimizer step
     if (hlslOptions.spirvOptimizer)
-        outSpirv = hlslOptions.spirvOptimizer->optimize(outSpirv.get(), logger);
+        outSpirv = makeCodeBuffer(hlslOptions.spirvOptimizer->optimize(reinterpret_cast<const uint32_t*>(compileResult.objectBlob->GetBufferPointer()), compileResult.objectBlob->GetBufferSize()/sizeof(uint32_t), logger));
+    else // straight from the DXC blob, the pool only copies if its the first time its seeing this SPIR-V
+        outSpirv = makeCodeBuffer(compileResult.objectBlob->GetBufferPointer(), compileResult.objectBlob->GetBufferSize());
 
     return core::make_smart_refctd_ptr<asset::ICPUShader>(std::move(outSpirv), stage, IShader::E_CONTENT_TYPE::ECT_SPIRV, hlslOptions.preprocessorOptions.sourceIdentifier.data());
 }
@@ -20,111 +20,101 @@
 namespace nbl::asset
 {
 
-//! Flips the direction of surfaces. Changes backfacing triangles to frontfacing
-//! triangles and vice versa.
-//! \param mesh: Mesh on which the operation is performed.
-void IMeshManipulator::flipSurfaces(ICPUMeshBuffer* inbuffer) 
+namespace
 {
-	if (!inbuffer)
-		return;
-    auto* pipeline = inbuffer->getPipeline();
-    const E_PRIMITIVE_TOPOLOGY primType = pipeline->getCachedCreationParams().primitiveAssembly.primitiveType;
-
-    const uint32_t idxcnt = inbuffer->getIndexCount();
-    if (!inbuffer->getIndices())
-        return;
-
-    if (inbuffer->getIndexType() == EIT_16BIT)
+// swaps the winding of whole spans of indices (or vertices) at once, an even length strip can't be flipped in place
+template<typename IndexT>
+bool flipWinding(IndexT* idx, const uint32_t idxcnt, const E_PRIMITIVE_TOPOLOGY primType)
+{
+    switch (primType)
     {
-        uint16_t* idx = reinterpret_cast<uint16_t*>(inbuffer->getIndices());
-        switch (primType)
-        {
         case EPT_TRIANGLE_FAN:
-            for (uint32_t i = 1; i < idxcnt; i += 2)
-            {
-                const uint16_t tmp = idx[i];
-                idx[i] = idx[i + 1];
-                idx[i + 1] = tmp;
-            }
+            // keep the hub and go around the rim the other way
+            if (idxcnt>1u)
+                std::reverse(idx+1u,idx+idxcnt);
             break;
         case EPT_TRIANGLE_STRIP:
-            if (idxcnt % 2) //odd
-            {
-                for (uint32_t i = 0; i < (idxcnt >> 1); i++)
-                {
-                    const uint16_t tmp = idx[i];
-                    idx[i] = idx[idxcnt - 1 - i];
-                    idx[idxcnt - 1 - i] = tmp;
-                }
-            }
-            else //even
-            {
-                auto newIndexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>((idxcnt + 1u) * sizeof(uint16_t));
-                auto* destPtr = reinterpret_cast<uint16_t*>(newIndexBuffer->getPointer());
-                destPtr[0] = idx[0];
-                memcpy(destPtr + 1u, idx, sizeof(uint16_t) * idxcnt);
-                inbuffer->setIndexCount(idxcnt + 1u);
-                SBufferBinding<ICPUBuffer> ixBufBinding{ 0u, std::move(newIndexBuffer) };
-                inbuffer->setIndexBufferBinding(std::move(ixBufBinding));
-            }
+            if (idxcnt%2u==0u)
+                return false;
+            std::reverse(idx,idx+idxcnt);
             break;
         case EPT_TRIANGLE_LIST:
-            for (uint32_t i = 0; i < idxcnt; i += 3)
-            {
-                const uint16_t tmp = idx[i + 1];
-                idx[i + 1] = idx[i + 2];
-                idx[i + 2] = tmp;
-            }
+            for (uint32_t i=0u; i+2u<idxcnt; i+=3u)
+                std::swap(idx[i+1u],idx[i+2u]);
             break;
         default: break;
-        }
     }
-    else if (inbuffer->getIndexType() == EIT_32BIT)
+    return true;
+}
+
+// an even length strip gets flipped by repeating its first index, which needs a new index buffer
+template<typename IndexT>
+void repeatFirstIndex(ICPUMeshBuffer* inbuffer, const IndexT* idx, const uint32_t idxcnt)
+{
+    auto newIndexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>((idxcnt+1u)*sizeof(IndexT));
+    auto* destPtr = reinterpret_cast<IndexT*>(newIndexBuffer->getPointer());
+    destPtr[0] = idx[0];
+    memcpy(destPtr+1u,idx,sizeof(IndexT)*idxcnt);
+    inbuffer->setIndexCount(idxcnt+1u);
+    SBufferBinding<ICPUBuffer> ixBufBinding{ 0u, std::move(newIndexBuffer) };
+    inbuffer->setIndexBufferBinding(std::move(ixBufBinding));
+}
+
+template<typename IndexT>
+void flipIndices(ICPUMeshBuffer* inbuffer, const E_PRIMITIVE_TOPOLOGY primType)
+{
+    const uint32_t idxcnt = inbuffer->getIndexCount();
+    IndexT* idx = reinterpret_cast<IndexT*>(inbuffer->getIndices());
+    if (!flipWinding(idx,idxcnt,primType))
+        repeatFirstIndex(inbuffer,idx,idxcnt);
+}
+
+// without an index buffer the vertices themselves get reordered, a whole attribute at a time
+void flipVertices(ICPUMeshBuffer* inbuffer, const E_PRIMITIVE_TOPOLOGY primType)
+{
+    const uint32_t vtxcnt = inbuffer->getIndexCount();
+    if (vtxcnt<3u)
+        return;
+    core::vector<uint32_t> order(vtxcnt);
+    std::iota(order.begin(),order.end(),0u);
+    if (!flipWinding(order.data(),vtxcnt,primType))
     {
-        uint32_t* idx = reinterpret_cast<uint32_t*>(inbuffer->getIndices());
-        switch (primType)
-        {
-        case EPT_TRIANGLE_FAN:
-            for (uint32_t i = 1; i < idxcnt; i += 2)
-            {
-                const uint32_t tmp = idx[i];
-                idx[i] = idx[i + 1];
-                idx[i + 1] = tmp;
-            }
-            break;
-        case EPT_TRIANGLE_STRIP:
-            if (idxcnt % 2) //odd
-            {
-                for (uint32_t i = 0; i < (idxcnt >> 1); i++)
-                {
-                    const uint32_t tmp = idx[i];
-                    idx[i] = idx[idxcnt - 1 - i];
-                    idx[idxcnt - 1 - i] = tmp;
-                }
-            }
-            else //even
-            {
-                auto newIndexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>((idxcnt + 1u) * sizeof(uint32_t));
-                auto* destPtr = reinterpret_cast<uint32_t*>(newIndexBuffer->getPointer());
-                destPtr[0] = idx[0];
-                memcpy(destPtr + 1u, idx, sizeof(uint32_t) * idxcnt);
-                inbuffer->setIndexCount(idxcnt + 1);
-                SBufferBinding<ICPUBuffer> ixBufBinding{ 0u, std::move(newIndexBuffer) };
-                inbuffer->setIndexBufferBinding(std::move(ixBufBinding));
-            }
-            break;
-        case EPT_TRIANGLE_LIST:
-            for (uint32_t i = 0; i < idxcnt; i += 3)
-            {
-                const uint32_t tmp = idx[i + 1];
-                idx[i + 1] = idx[i + 2];
-                idx[i + 2] = tmp;
-            }
-            break;
-        default: break;
-        }
+        repeatFirstIndex(inbuffer,order.data(),vtxcnt);
+        inbuffer->setIndexType(EIT_32BIT);
+        return;
+    }
+
+    const auto& vtxParams = inbuffer->getPipeline()->getCachedCreationParams().vertexInput;
+    core::vector<uint8_t> scratch;
+    for (uint32_t attrId=0u; attrId<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; attrId++)
+    {
+        if (!inbuffer->isAttributeEnabled(attrId) || vtxParams.bindings[inbuffer->getBindingNumForAttribute(attrId)].inputRate!=SVertexInputBindingParams::EVIR_PER_VERTEX)
+            continue;
+        const size_t elementSize = getTexelOrBlockBytesize(inbuffer->getAttribFormat(attrId));
+        scratch.resize(vtxcnt*elementSize);
+        if (inbuffer->gatherAttributeSpan(scratch.data(),elementSize,attrId,order.data(),vtxcnt))
+            inbuffer->setAttributeSpan(scratch.data(),elementSize,attrId,0u,vtxcnt);
     }
 }
+}
+
+//! Flips the direction of surfaces. Changes backfacing triangles to frontfacing
+//! triangles and vice versa.
+//! \param mesh: Mesh on which the operation is performed.
+void IMeshManipulator::flipSurfaces(ICPUMeshBuffer* inbuffer) 
+{
+	if (!inbuffer)
+		return;
+    auto* pipeline = inbuffer->getPipeline();
+    const E_PRIMITIVE_TOPOLOGY primType = pipeline->getCachedCreationParams().primitiveAssembly.primitiveType;
+
+    if (!inbuffer->getIndices())
+        flipVertices(inbuffer,primType);
+    else if (inbuffer->getIndexType() == EIT_16BIT)
+        flipIndices<uint16_t>(inbuffer,primType);
+    else if (inbuffer->getIndexType() == EIT_32BIT)
+        flipIndices<uint32_t>(inbuffer,primType);
+}
 
 core::smart_refctd_ptr<ICPUMeshBuffer> CMeshManipulator::createMeshBufferFetchOptimized(const ICPUMeshBuffer* _inbuffer)
 {
@@ -256,6 +246,108 @@ core::smart_refctd_ptr<ICPUMeshBuffer> CMeshManipulator::createMeshBufferFetchOp
 	return outbuffer;
 }
 
+core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferSpatiallyOrdered(const ICPUMeshBuffer* _inbuffer, const core::E_SPACE_FILLING_CURVE curve)
+{
+	if (!_inbuffer || !_inbuffer->getPipeline())
+		return nullptr;
+
+	const uint32_t posAttrId = _inbuffer->getPositionAttributeIx();
+	if (!_inbuffer->isAttributeEnabled(posAttrId) || !_inbuffer->getAttribBoundBuffer(posAttrId).buffer)
+		return nullptr;
+
+	const uint32_t vertexCount = upperBoundVertexID(_inbuffer);
+	if (vertexCount==0u)
+		return nullptr;
+
+	// decode positions of any format once, the keys only need them as floats
+	core::vector<float> positions(size_t(vertexCount)*3u);
+	float aabbMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float aabbMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i=0u; i<vertexCount; i++)
+	{
+		core::vectorSIMDf pos;
+		_inbuffer->getAttribute(pos,posAttrId,i);
+		for (auto axis=0u; axis<3u; axis++)
+		{
+			positions[size_t(i)*3u+axis] = pos[axis];
+			aabbMin[axis] = core::min(aabbMin[axis],pos[axis]);
+			aabbMax[axis] = core::max(aabbMax[axis],pos[axis]);
+		}
+	}
+
+	core::vector<uint32_t> order(vertexCount);
+	core::spatial_sort(core::execution::par_unseq,curve,positions.data(),sizeof(float)*3u,vertexCount,aabbMin,aabbMax,order.data());
+	return createMeshBufferWithVertexOrder(_inbuffer,order.data());
+}
+
+core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWithVertexOrder(const ICPUMeshBuffer* _inbuffer, const uint32_t* order)
+{
+	if (!_inbuffer || !_inbuffer->getPipeline() || !order)
+		return nullptr;
+
+	const uint32_t vertexCount = upperBoundVertexID(_inbuffer);
+	auto outbuffer = core::move_and_static_cast<ICPUMeshBuffer>(_inbuffer->clone(0u));
+	const auto& vtxParams = _inbuffer->getPipeline()->getCachedCreationParams().vertexInput;
+	for (uint32_t binding=0u; binding<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; binding++)
+	{
+		if (!_inbuffer->isVertexAttribBufferBindingEnabled(binding) || vtxParams.bindings[binding].inputRate!=SVertexInputBindingParams::EVIR_PER_VERTEX)
+			continue;
+		const auto& srcBinding = _inbuffer->getVertexBufferBindings()[binding];
+		const size_t stride = vtxParams.bindings[binding].stride;
+		if (!srcBinding.buffer || stride==0ull)
+			continue;
+
+		const int64_t srcBegin = int64_t(srcBinding.offset)+int64_t(_inbuffer->getBaseVertex())*int64_t(stride);
+		if (srcBegin<0 || static_cast<size_t>(srcBegin)>=srcBinding.buffer->getSize())
+			continue;
+		const auto* src = reinterpret_cast<const uint8_t*>(srcBinding.buffer->getPointer())+srcBegin;
+		const size_t srcSize = srcBinding.buffer->getSize()-static_cast<size_t>(srcBegin);
+
+		auto newBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(vertexCount)*stride);
+		auto* dst = reinterpret_cast<uint8_t*>(newBuffer->getPointer());
+		// gathers are memory bound, but huge point clouds still go a lot faster with a few cores issuing loads
+		core::parallel_for_batches(core::execution::par_unseq,vertexCount,0x10000u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+		{
+			for (uint32_t i=begin; i<end; i++)
+			{
+				// the last vertex is allowed to be shorter than the stride
+				const size_t srcOffset = size_t(order[i])*stride;
+				if (srcOffset<srcSize)
+					memcpy(dst+size_t(i)*stride,src+srcOffset,core::min(stride,srcSize-srcOffset));
+			}
+		});
+		outbuffer->setVertexBufferBinding({0ull,std::move(newBuffer)},binding);
+	}
+	outbuffer->setBaseVertex(0);
+
+	core::vector<uint32_t> remap(vertexCount);
+	for (uint32_t i=0u; i<vertexCount; i++)
+		remap[order[i]] = i;
+
+	const uint32_t indexCount = _inbuffer->getIndexCount();
+	const void* indices = _inbuffer->getIndices();
+	const E_INDEX_TYPE indexType = indices ? _inbuffer->getIndexType():EIT_UNKNOWN;
+	if (indexType==EIT_16BIT || indexType==EIT_32BIT)
+	{
+		const size_t indexSize = indexType==EIT_16BIT ? sizeof(uint16_t):sizeof(uint32_t);
+		auto newIndexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(indexCount*indexSize);
+		if (indexType==EIT_16BIT)
+			std::transform(reinterpret_cast<const uint16_t*>(indices),reinterpret_cast<const uint16_t*>(indices)+indexCount,reinterpret_cast<uint16_t*>(newIndexBuffer->getPointer()),[&remap](const uint16_t ix) -> uint16_t {return static_cast<uint16_t>(remap[ix]);});
+		else
+			std::transform(reinterpret_cast<const uint32_t*>(indices),reinterpret_cast<const uint32_t*>(indices)+indexCount,reinterpret_cast<uint32_t*>(newIndexBuffer->getPointer()),[&remap](const uint32_t ix) -> uint32_t {return remap[ix];});
+		outbuffer->setIndexBufferBinding({0ull,std::move(newIndexBuffer)});
+	}
+	else if (_inbuffer->getPipeline()->getCachedCreationParams().primitiveAssembly.primitiveType!=EPT_POINT_LIST)
+	{
+		auto newIndexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(indexCount*sizeof(uint32_t));
+		std::copy_n(remap.data(),indexCount,reinterpret_cast<uint32_t*>(newIndexBuffer->getPointer()));
+		outbuffer->setIndexBufferBinding({0ull,std::move(newIndexBuffer)});
+		outbuffer->setIndexType(EIT_32BIT);
+	}
+
+	return outbuffer;
+}
+
 //! Creates a copy of the mesh, which will only consist of unique primitives
 core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer, bool _makeIndexBuf)
 {
@@ -286,23 +378,15 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferUniqueP
 	{
 		size_t stride = 0;
 		int32_t offset[MAX_ATTRIBS];
-		size_t newAttribSizes[MAX_ATTRIBS];
-		const uint8_t* sourceBuffers[MAX_ATTRIBS] = {NULL};
-		size_t sourceBufferStrides[MAX_ATTRIBS];
 		for (size_t i=0; i< MAX_ATTRIBS; i++)
 		{
 			const auto& vbuf = inbuffer->getAttribBoundBuffer(i);
 			if (inbuffer->isAttributeEnabled(i) && vbuf.buffer)
 			{
 				offset[i] = stride;
-				newAttribSizes[i] = getTexelOrBlockBytesize(inbuffer->getAttribFormat(i));
-				stride += newAttribSizes[i];
+				stride += getTexelOrBlockBytesize(inbuffer->getAttribFormat(i));
 				if (stride>=0xdeadbeefu)
 					return nullptr;
-
-				sourceBuffers[i] = reinterpret_cast<const uint8_t*>(vbuf.buffer->getPointer());
-				sourceBuffers[i] += inbuffer->getAttribCombinedOffset(i);
-				sourceBufferStrides[i] = inbuffer->getAttribStride(i);
 			}
 			else
 				offset[i] = -1;
@@ -324,30 +408,24 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferUniqueP
 		}
 
 		uint8_t* destPointer = reinterpret_cast<uint8_t*>(vertexBuffer->getPointer());
-		if (inbuffer->getIndexType()==EIT_16BIT)
+		const E_INDEX_TYPE indexType = inbuffer->getIndexType();
+		if (indexType==EIT_16BIT || indexType==EIT_32BIT)
 		{
-			uint16_t* idx = reinterpret_cast<uint16_t*>(inbuffer->getIndices());
-			for (uint64_t i=0; i<idxCnt; i++,idx++)
-			for (size_t j=0; j<MAX_ATTRIBS; j++)
+			const void* indices = inbuffer->getIndices();
+			// indices get widened a span at a time, then each attribute of the span is gathered and bounds checked in one go
+			constexpr uint32_t SpanSize = 1024u;
+			uint32_t spanIndices[SpanSize];
+			for (uint32_t first=0u; first<idxCnt; first+=SpanSize)
 			{
-				if (offset[j]<0)
-					continue;
-
-				memcpy(destPointer,sourceBuffers[j]+(int64_t(*idx)+inbuffer->getBaseVertex())*sourceBufferStrides[j],newAttribSizes[j]);
-				destPointer += newAttribSizes[j];
-			}
-		}
-		else if (inbuffer->getIndexType()==EIT_32BIT)
-		{
-			uint32_t* idx = reinterpret_cast<uint32_t*>(inbuffer->getIndices());
-			for (uint64_t i=0; i<idxCnt; i++,idx++)
-			for (size_t j=0; j<MAX_ATTRIBS; j++)
-			{
-				if (offset[j]<0)
-					continue;
+				const uint32_t count = core::min(SpanSize,idxCnt-first);
+				if (indexType==EIT_16BIT)
+					std::copy_n(reinterpret_cast<const uint16_t*>(indices)+first,count,spanIndices);
+				else
+					std::copy_n(reinterpret_cast<const uint32_t*>(indices)+first,count,spanIndices);
 
-				memcpy(destPointer,sourceBuffers[j]+(int64_t(*idx)+inbuffer->getBaseVertex())*sourceBufferStrides[j],newAttribSizes[j]);
-				destPointer += newAttribSizes[j];
+				for (size_t j=0; j<MAX_ATTRIBS; j++)
+				if (offset[j]>=0 && !inbuffer->gatherAttributeSpan(destPointer+size_t(first)*stride+offset[j],stride,j,spanIndices,count))
+					return nullptr;
 			}
 		}
 
@@ -0,0 +1,235 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/asset/utils/CPointCloudOctreeBuilder.h"
+
+#include "nbl/core/algorithm/spatial_sort.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+
+namespace
+{
+constexpr uint32_t KeyBits = CPointCloudOctreeBuilder::MaxDepth;
+
+// octant of the child of a node at `depth` which the point with this key falls into
+inline uint32_t getOctant(const uint64_t key, const uint32_t depth)
+{
+	return static_cast<uint32_t>(key>>(3u*(KeyBits-1u-depth)))&0x7u;
+}
+
+// how many multiples of `stride` (the representatives) are in `[begin,end)`
+inline uint32_t countMultiples(const uint32_t begin, const uint32_t end, const uint32_t stride)
+{
+	return static_cast<uint32_t>((uint64_t(end)+stride-1ull)/stride-(uint64_t(begin)+stride-1ull)/stride);
+}
+
+// state of a node while its level is being split
+struct SLevelNode
+{
+	// range in the work arrays of the level, which are sorted by key
+	uint32_t begin;
+	uint32_t end;
+	// every `stride`-th point (relative to `begin`) is a representative, 0 means the node is a leaf
+	uint32_t stride = 0u;
+	uint32_t octantBegin[8] = {};
+	// where each child's points start in the work arrays of the next level
+	uint32_t childBegin[8] = {};
+};
+}
+
+CPointCloudOctreeBuilder::SResult CPointCloudOctreeBuilder::build(const ICPUMeshBuffer* inbuffer, const SParams& params)
+{
+	SResult result;
+	if (!inbuffer || !inbuffer->getPipeline())
+		return result;
+	if (inbuffer->getPipeline()->getCachedCreationParams().primitiveAssembly.primitiveType!=EPT_POINT_LIST)
+		return result;
+
+	const uint32_t posAttrId = inbuffer->getPositionAttributeIx();
+	if (!inbuffer->isAttributeEnabled(posAttrId) || !inbuffer->getAttribBoundBuffer(posAttrId).buffer)
+		return result;
+
+	const uint32_t pointCount = IMeshManipulator::upperBoundVertexID(inbuffer);
+	if (pointCount==0u)
+		return result;
+	const uint32_t budget = core::max(params.maxPointsPerNode,1u);
+	const uint32_t maxDepth = core::min(params.maxDepth,MaxDepth);
+
+	// decode positions of any format once
+	core::vector<float> positions(size_t(pointCount)*3u);
+	core::parallel_for_batches(core::execution::par_unseq,pointCount,0x4000u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+	{
+		for (uint32_t i=begin; i<end; i++)
+		{
+			core::vectorSIMDf pos;
+			inbuffer->getAttribute(pos,posAttrId,i);
+			std::copy_n(pos.pointer,3u,positions.data()+size_t(i)*3u);
+		}
+	});
+	float aabbMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float aabbMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (size_t i=0ull; i<positions.size(); i+=3ull)
+	for (auto axis=0u; axis<3u; axis++)
+	{
+		aabbMin[axis] = core::min(aabbMin[axis],positions[i+axis]);
+		aabbMax[axis] = core::max(aabbMax[axis],positions[i+axis]);
+	}
+
+	// octree cells are cubes
+	float cubeSize = 0.f;
+	for (auto axis=0u; axis<3u; axis++)
+		cubeSize = core::max(cubeSize,aabbMax[axis]-aabbMin[axis]);
+	if (!(cubeSize>0.f))
+		cubeSize = 1.f;
+
+	// `spatial_sort` rounds to nearest, shifting its range by half a quantum makes it floor into the `2^KeyBits` cells of the cube,
+	// so the key prefix of every depth is exactly the cell of that depth which the point lies in
+	core::vector<uint64_t> keys(pointCount);
+	core::vector<uint32_t> indices(pointCount);
+	{
+		const float quantum = cubeSize/float(1u<<KeyBits);
+		float sortMin[3], sortMax[3];
+		for (auto axis=0u; axis<3u; axis++)
+		{
+			sortMin[axis] = aabbMin[axis]+quantum*0.5f;
+			sortMax[axis] = sortMin[axis]+quantum*float((1u<<KeyBits)-1u);
+		}
+		core::spatial_sort<KeyBits>(core::execution::par_unseq,core::ESFC_MORTON,positions.data(),sizeof(float)*3u,pointCount,sortMin,sortMax,indices.data(),keys.data());
+		core::vector<float>().swap(positions);
+	}
+
+	{
+		SNode root = {};
+		std::copy_n(aabbMin,3u,root.cellMin);
+		root.cellSize = cubeSize;
+		result.nodes.push_back(root);
+	}
+
+	// every point is either written out as part of a node at the current level, or moved to its child's range for the next level
+	core::vector<uint32_t> order(pointCount);
+	core::vector<uint64_t> nextKeys(pointCount);
+	core::vector<uint32_t> nextIndices(pointCount);
+	core::vector<SLevelNode> level(1u);
+	level[0].begin = 0u;
+	level[0].end = pointCount;
+	uint32_t outputOffset = 0u;
+	for (uint32_t depth=0u; !level.empty(); depth++)
+	{
+		const uint32_t firstNode = static_cast<uint32_t>(result.nodes.size()-level.size());
+		result.levelOffsets.push_back(firstNode);
+
+		// find where the octants start, the keys of a node are sorted and share the prefix of the node's cell
+		const bool canSplit = depth<maxDepth;
+		std::for_each(core::execution::par_unseq,level.begin(),level.end(),[&](SLevelNode& node) -> void
+		{
+			const uint32_t count = node.end-node.begin;
+			if (!canSplit || count<=budget)
+				return;
+			node.stride = static_cast<uint32_t>((uint64_t(count)+budget-1ull)/budget);
+			node.octantBegin[0] = node.begin;
+			for (uint32_t octant=1u; octant<8u; octant++)
+			{
+				const auto found = std::lower_bound(keys.begin()+node.octantBegin[octant-1u],keys.begin()+node.end,octant,[depth](const uint64_t key, const uint32_t octant) -> bool
+				{
+					return getOctant(key,depth)<octant;
+				});
+				node.octantBegin[octant] = static_cast<uint32_t>(std::distance(keys.begin(),found));
+			}
+		});
+
+		// breadth first order of the nodes is also the order of their output ranges and of the next level's work ranges
+		core::vector<SLevelNode> nextLevel;
+		uint32_t nextCount = 0u;
+		for (uint32_t i=0u; i<level.size(); i++)
+		{
+			auto& node = level[i];
+			const uint32_t nodeIx = firstNode+i;
+			const uint32_t count = node.end-node.begin;
+			result.nodes[nodeIx].pointOffset = outputOffset;
+			result.nodes[nodeIx].pointCount = node.stride ? countMultiples(0u,count,node.stride):count;
+			result.nodes[nodeIx].firstChild = node.stride ? static_cast<uint32_t>(result.nodes.size()):~0u;
+			outputOffset += result.nodes[nodeIx].pointCount;
+			if (!node.stride)
+				continue;
+
+			for (uint32_t octant=0u; octant<8u; octant++)
+			{
+				const uint32_t octantBegin = node.octantBegin[octant]-node.begin;
+				const uint32_t octantEnd = (octant<7u ? node.octantBegin[octant+1u]:node.end)-node.begin;
+				const uint32_t remaining = octantEnd-octantBegin-countMultiples(octantBegin,octantEnd,node.stride);
+				node.childBegin[octant] = nextCount;
+				if (remaining==0u)
+					continue;
+
+				const SNode& parent = result.nodes[nodeIx];
+				SNode child = {};
+				child.cellSize = parent.cellSize*0.5f;
+				for (auto axis=0u; axis<3u; axis++)
+					child.cellMin[axis] = parent.cellMin[axis]+((octant>>axis)&0x1u ? child.cellSize:0.f);
+				child.depth = static_cast<uint8_t>(depth+1u);
+				result.nodes[nodeIx].childMask |= static_cast<uint8_t>(0x1u<<octant);
+				result.nodes.push_back(child);
+
+				auto& next = nextLevel.emplace_back();
+				next.begin = nextCount;
+				next.end = nextCount+remaining;
+				nextCount = next.end;
+			}
+		}
+
+		// scatter, a batch finds its first node with a binary search and then walks the nodes along with the points
+		const SNode* const levelNodes = result.nodes.data()+firstNode;
+		core::parallel_for_batches(core::execution::par_unseq,level.back().end,0x10000u,[&](const uint32_t, const uint32_t begin, const uint32_t end) -> void
+		{
+			auto nodeIt = std::upper_bound(level.begin(),level.end(),begin,[](const uint32_t ix, const SLevelNode& node) -> bool {return ix<node.begin;})-1;
+			for (uint32_t i=begin; i<end; i++)
+			{
+				while (i>=nodeIt->end)
+					nodeIt++;
+				const SLevelNode& node = *nodeIt;
+				const SNode& outNode = levelNodes[std::distance(level.begin(),nodeIt)];
+				const uint32_t local = i-node.begin;
+				if (!node.stride)
+				{
+					order[outNode.pointOffset+local] = indices[i];
+					continue;
+				}
+				if (local%node.stride==0u)
+				{
+					order[outNode.pointOffset+local/node.stride] = indices[i];
+					continue;
+				}
+				const uint32_t octant = getOctant(keys[i],depth);
+				const uint32_t octantBegin = node.octantBegin[octant]-node.begin;
+				const uint32_t dst = node.childBegin[octant]+(local-octantBegin)-countMultiples(octantBegin,local,node.stride);
+				nextKeys[dst] = keys[i];
+				nextIndices[dst] = indices[i];
+			}
+		});
+
+		std::swap(keys,nextKeys);
+		std::swap(indices,nextIndices);
+		level = std::move(nextLevel);
+	}
+	result.levelOffsets.push_back(static_cast<uint32_t>(result.nodes.size()));
+	assert(outputOffset==pointCount);
+
+	result.meshbuffer = IMeshManipulator::createMeshBufferWithVertexOrder(inbuffer,order.data());
+	if (result.meshbuffer)
+	{
+		// every node range is a draw of its own, indices would only get in the way
+		result.meshbuffer->setIndexBufferBinding({});
+		result.meshbuffer->setIndexType(EIT_UNKNOWN);
+		result.meshbuffer->setIndexCount(pointCount);
+		result.meshbuffer->setBoundingBox(core::aabbox3df(aabbMin[0],aabbMin[1],aabbMin[2],aabbMax[0],aabbMax[1],aabbMax[2]));
+	}
+	else
+	{
+		result.nodes.clear();
+		result.levelOffsets.clear();
+	}
+	return result;
+}
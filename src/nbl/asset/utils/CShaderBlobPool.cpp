@@ -0,0 +1,184 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/asset/utils/CShaderBlobPool.h"
+
+#include "nbl/core/xxHash256.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+
+uint64_t CShaderBlobPool::hash(const void* data, const size_t size)
+{
+	uint64_t out[4];
+	core::XXHash_256(data,size,out);
+	// size goes in as well, so blobs which are prefixes of each other don't collide as often
+	return (out[0]^(out[1]*0x9E3779B97F4A7C15ull))^(out[2]+out[3])^size;
+}
+
+auto CShaderBlobPool::find_impl(const uint64_t hash, const void* data, const size_t size) const -> CBlob*
+{
+	const auto range = m_blobs.equal_range(hash);
+	for (auto it=range.first; it!=range.second; it++)
+	{
+		CBlob* blob = it->second.get();
+		// careful to not call the non-const `getPointer`, pooled blobs are immutable
+		const void* contents = static_cast<const ICPUBuffer*>(blob)->getPointer();
+		if (blob->getSize()==size && (contents==data || memcmp(contents,data,size)==0))
+			return blob;
+	}
+	return nullptr;
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CShaderBlobPool::insert_impl(core::smart_refctd_ptr<CBlob>&& blob)
+{
+	if (m_blobs.size()>=m_trimThreshold)
+		trim_impl();
+	m_stats.uniqueBlobs++;
+	m_stats.uniqueBytes += blob->getSize();
+	if (blob->isZeroCopy())
+		m_stats.zeroCopyBlobs++;
+	core::smart_refctd_ptr<ICPUBuffer> retval(blob.get());
+	m_blobs.emplace(blob->getHash(),std::move(blob));
+	return retval;
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CShaderBlobPool::intern(core::smart_refctd_ptr<ICPUBuffer>&& blob)
+{
+	if (!blob || blob->isADummyObjectForCache())
+		return nullptr;
+	// already one of ours
+	if (isPooled(blob.get()))
+	{
+		std::lock_guard lock(m_mutex);
+		m_stats.internRequests++;
+		m_stats.hits++;
+		return std::move(blob);
+	}
+
+	const ICPUBuffer* constBlob = blob.get();
+	const void* const contents = constBlob->getPointer();
+	const size_t size = constBlob->getSize();
+	// hash outside the lock, its the expensive bit
+	const uint64_t h = hash(contents,size);
+
+	std::lock_guard lock(m_mutex);
+	m_stats.internRequests++;
+	if (auto* found=find_impl(h,contents,size); found)
+	{
+		m_stats.hits++;
+		m_stats.bytesDeduplicated += size;
+		return core::smart_refctd_ptr<ICPUBuffer>(found);
+	}
+	return insert_impl(core::make_smart_refctd_ptr<CBlob>(std::move(blob),contents,size,h,false));
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CShaderBlobPool::intern(const void* data, const size_t size)
+{
+	if (!data)
+		return nullptr;
+	const uint64_t h = hash(data,size);
+	{
+		std::lock_guard lock(m_mutex);
+		if (auto* found=find_impl(h,data,size); found)
+		{
+			m_stats.internRequests++;
+			m_stats.hits++;
+			m_stats.bytesDeduplicated += size;
+			return core::smart_refctd_ptr<ICPUBuffer>(found);
+		}
+	}
+
+	// copy outside the lock, another thread might beat us to inserting the same contents so we need to check again
+	auto copy = core::make_smart_refctd_ptr<ICPUBuffer>(size);
+	if (!copy->getPointer())
+		return nullptr;
+	memcpy(copy->getPointer(),data,size);
+	const void* contents = copy->getPointer();
+
+	std::lock_guard lock(m_mutex);
+	m_stats.internRequests++;
+	if (auto* found=find_impl(h,contents,size); found)
+	{
+		m_stats.hits++;
+		m_stats.bytesDeduplicated += size;
+		return core::smart_refctd_ptr<ICPUBuffer>(found);
+	}
+	return insert_impl(core::make_smart_refctd_ptr<CBlob>(std::move(copy),contents,size,h,false));
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CShaderBlobPool::intern(core::smart_refctd_ptr<system::IFile>&& file)
+{
+	if (!file || (file->getFlags()&system::IFileBase::ECF_WRITE))
+		return nullptr;
+	const system::IFile* constFile = file.get();
+	const void* const contents = constFile->getMappedPointer();
+	if (!contents)
+		return nullptr;
+	const size_t size = file->getSize();
+	const uint64_t h = hash(contents,size);
+
+	std::lock_guard lock(m_mutex);
+	m_stats.internRequests++;
+	if (auto* found=find_impl(h,contents,size); found)
+	{
+		m_stats.hits++;
+		m_stats.bytesDeduplicated += size;
+		return core::smart_refctd_ptr<ICPUBuffer>(found);
+	}
+	return insert_impl(core::make_smart_refctd_ptr<CBlob>(std::move(file),contents,size,h,true));
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CShaderBlobPool::load(system::IFile* file)
+{
+	if (!file)
+		return nullptr;
+	if (auto retval=intern(core::smart_refctd_ptr<system::IFile>(file)); retval)
+		return retval;
+
+	const size_t size = file->getSize();
+	auto contents = core::make_smart_refctd_ptr<ICPUBuffer>(size);
+	if (!contents->getPointer())
+		return nullptr;
+	system::IFile::success_t success;
+	file->read(success,contents->getPointer(),0,size);
+	if (!success)
+		return nullptr;
+	return intern(std::move(contents));
+}
+
+size_t CShaderBlobPool::trim()
+{
+	std::lock_guard lock(m_mutex);
+	return trim_impl();
+}
+
+size_t CShaderBlobPool::trim_impl()
+{
+	size_t released = 0ull;
+	for (auto it=m_blobs.begin(); it!=m_blobs.end();)
+	{
+		const CBlob* blob = it->second.get();
+		if (blob->getReferenceCount()==1)
+		{
+			released += blob->getSize();
+			m_stats.uniqueBlobs--;
+			m_stats.uniqueBytes -= blob->getSize();
+			if (blob->isZeroCopy())
+				m_stats.zeroCopyBlobs--;
+			it = m_blobs.erase(it);
+		}
+		else
+			it++;
+	}
+	// geometric threshold keeps the automatic scans amortized O(1) per insert
+	m_trimThreshold = std::max<size_t>(m_blobs.size()*2u,MinTrimThreshold);
+	return released;
+}
+
+auto CShaderBlobPool::getStatistics() const -> SStatistics
+{
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
@@ -0,0 +1,473 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/asset/utils/CStreamingMeshPipeline.h"
+
+#include <string_view>
+
+#include "nbl/asset/utils/IMeshManipulator.h"
+#include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+
+namespace
+{
+constexpr uint32_t VertexBinding = 0u;
+// attributes get decoded this many vertices at a time
+constexpr uint32_t SpanSize = 256u;
+
+inline uint32_t getChunkStride(const ICPUMeshBuffer* mb)
+{
+	return mb->getPipeline()->getCachedCreationParams().vertexInput.bindings[VertexBinding].stride;
+}
+
+inline uint32_t getChunkVertexCount(const ICPUMeshBuffer* mb)
+{
+	const auto& binding = mb->getVertexBufferBindings()[VertexBinding];
+	const uint32_t stride = getChunkStride(mb);
+	if (!binding.buffer || stride==0u || binding.offset>binding.buffer->getSize())
+		return 0u;
+	return static_cast<uint32_t>((binding.buffer->getSize()-binding.offset)/stride);
+}
+
+inline uint8_t* getChunkVertices(ICPUMeshBuffer* mb)
+{
+	auto& binding = mb->getVertexBufferBindings()[VertexBinding];
+	return reinterpret_cast<uint8_t*>(binding.buffer->getPointer())+binding.offset;
+}
+
+// the chunk layout contract, everything in a single per-vertex binding
+bool isValidChunkLayout(const SVertexInputParams& params)
+{
+	if (params.enabledBindingFlags!=(0x1u<<VertexBinding) || params.bindings[VertexBinding].stride==0u)
+		return false;
+	if (params.bindings[VertexBinding].inputRate!=SVertexInputBindingParams::EVIR_PER_VERTEX)
+		return false;
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+	if (params.enabledAttribFlags&(0x1u<<i))
+	{
+		const auto& attr = params.attributes[i];
+		if (attr.binding!=VertexBinding || attr.relativeOffset+getTexelOrBlockBytesize(static_cast<E_FORMAT>(attr.format))>params.bindings[VertexBinding].stride)
+			return false;
+	}
+	return true;
+}
+}
+
+
+core::smart_refctd_ptr<ICPUMeshBuffer> CStreamingMeshPipeline::relayout(const ICPUMeshBuffer* chunk, const E_FORMAT* formats, core::smart_refctd_ptr<ICPURenderpassIndependentPipeline>& pipeline)
+{
+	// tightly packed, in attribute order
+	SVertexInputParams params;
+	params.enabledBindingFlags = 0x1u<<VertexBinding;
+	params.bindings[VertexBinding].inputRate = SVertexInputBindingParams::EVIR_PER_VERTEX;
+	uint32_t stride = 0u;
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+	if (formats[i]!=EF_UNKNOWN)
+	{
+		params.enabledAttribFlags |= 0x1u<<i;
+		params.attributes[i].binding = VertexBinding;
+		params.attributes[i].format = formats[i];
+		params.attributes[i].relativeOffset = stride;
+		stride += getTexelOrBlockBytesize(formats[i]);
+	}
+	if (stride==0u)
+		return nullptr;
+	params.bindings[VertexBinding].stride = stride;
+
+	if (!pipeline || pipeline->getCachedCreationParams().vertexInput!=params)
+	{
+		pipeline = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(chunk->getPipeline()->clone(0u));
+		pipeline->getCachedCreationParams().vertexInput = params;
+	}
+
+	const uint32_t vertexCount = getChunkVertexCount(chunk);
+	auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(vertexCount)*stride);
+	uint8_t* const dst = reinterpret_cast<uint8_t*>(vertexBuffer->getPointer());
+	// attributes which didn't exist before come out zeroed
+	memset(dst,0,vertexBuffer->getSize());
+
+	core::vector<float> scratch(SpanSize*4u);
+	float* const channels[4] = {scratch.data(),scratch.data()+SpanSize,scratch.data()+SpanSize*2u,scratch.data()+SpanSize*3u};
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+	{
+		if (formats[i]==EF_UNKNOWN || !chunk->isAttributeEnabled(i))
+			continue;
+		const E_FORMAT oldFormat = chunk->getAttribFormat(i);
+		const uint8_t* src = chunk->getAttribPointer(i);
+		const uint32_t oldStride = chunk->getAttribStride(i);
+		uint8_t* out = dst+params.attributes[i].relativeOffset;
+		if (oldFormat==formats[i])
+		{
+			const uint32_t size = getTexelOrBlockBytesize(oldFormat);
+			for (uint32_t v=0u; v<vertexCount; v++)
+				memcpy(out+size_t(v)*stride,src+size_t(v)*oldStride,size);
+		}
+		else if (isIntegerFormat(oldFormat) && isIntegerFormat(formats[i]))
+		{
+			for (uint32_t v=0u; v<vertexCount; v++)
+			{
+				uint32_t tmp[4] = {0u,0u,0u,1u};
+				if (!ICPUMeshBuffer::getAttribute(tmp,src+size_t(v)*oldStride,oldFormat) || !ICPUMeshBuffer::setAttribute(tmp,out+size_t(v)*stride,formats[i]))
+					return nullptr;
+			}
+		}
+		else for (uint32_t first=0u; first<vertexCount; first+=SpanSize)
+		{
+			const uint32_t count = core::min(SpanSize,vertexCount-first);
+			if (!ICPUMeshBuffer::getAttributeSpan(channels,src+size_t(first)*oldStride,oldStride,oldFormat,count))
+				return nullptr;
+			if (!ICPUMeshBuffer::setAttributeSpan(channels,out+size_t(first)*stride,stride,formats[i],count))
+				return nullptr;
+		}
+	}
+
+	auto retval = core::move_and_static_cast<ICPUMeshBuffer>(chunk->clone(0u));
+	retval->setPipeline(core::smart_refctd_ptr(pipeline));
+	retval->setVertexBufferBinding({0ull,std::move(vertexBuffer)},VertexBinding);
+	return retval;
+}
+
+
+bool CStreamingMeshPipeline::CWeldStage::process(SChunk& chunk)
+{
+	ICPUMeshBuffer* mb = chunk.meshbuffer.get();
+	const uint32_t stride = getChunkStride(mb);
+	const uint32_t vertexCount = getChunkVertexCount(mb);
+	const uint8_t* vertices = getChunkVertices(mb);
+
+	// keys point straight into the chunk's vertex buffer, so no vertex data gets copied to hash it
+	core::unordered_map<std::string_view,uint32_t> uniqueVertices;
+	uniqueVertices.reserve(vertexCount);
+	core::vector<uint32_t> remap(vertexCount);
+	core::vector<uint32_t> firstOccurence;
+	for (uint32_t v=0u; v<vertexCount; v++)
+	{
+		const std::string_view key(reinterpret_cast<const char*>(vertices)+size_t(v)*stride,stride);
+		const auto found = uniqueVertices.emplace(key,static_cast<uint32_t>(firstOccurence.size()));
+		remap[v] = found.first->second;
+		if (found.second)
+			firstOccurence.push_back(v);
+	}
+	if (firstOccurence.size()==vertexCount)
+		return true;
+
+	auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(firstOccurence.size()*stride);
+	uint8_t* dst = reinterpret_cast<uint8_t*>(vertexBuffer->getPointer());
+	for (const auto v : firstOccurence)
+	{
+		memcpy(dst,vertices+size_t(v)*stride,stride);
+		dst += stride;
+	}
+
+	uint32_t* indices = reinterpret_cast<uint32_t*>(mb->getIndices());
+	for (uint32_t i=0u; i<mb->getIndexCount(); i++)
+		indices[i] = remap[indices[i]];
+	mb->setVertexBufferBinding({0ull,std::move(vertexBuffer)},VertexBinding);
+	return true;
+}
+
+bool CStreamingMeshPipeline::CRequantizeStage::process(SChunk& chunk)
+{
+	const ICPUMeshBuffer* mb = chunk.meshbuffer.get();
+	E_FORMAT formats[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT];
+	bool changed = false;
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+	{
+		formats[i] = mb->isAttributeEnabled(i) ? mb->getAttribFormat(i):EF_UNKNOWN;
+		if (formats[i]!=EF_UNKNOWN && m_formats[i]!=EF_UNKNOWN && m_formats[i]!=formats[i])
+		{
+			formats[i] = m_formats[i];
+			changed = true;
+		}
+	}
+	if (!changed)
+		return true;
+
+	auto requantized = relayout(mb,formats,m_pipeline);
+	if (!requantized)
+		return false;
+	chunk.meshbuffer = std::move(requantized);
+	return true;
+}
+
+bool CStreamingMeshPipeline::CNormalStage::process(SChunk& chunk)
+{
+	const uint32_t normalAttrId = chunk.meshbuffer->getNormalAttributeIx();
+	const uint32_t posAttrId = chunk.meshbuffer->getPositionAttributeIx();
+	if (!chunk.meshbuffer->isAttributeEnabled(posAttrId) || normalAttrId>=ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT)
+		return false;
+	if (!chunk.meshbuffer->isAttributeEnabled(normalAttrId))
+	{
+		E_FORMAT formats[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT];
+		for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+			formats[i] = chunk.meshbuffer->isAttributeEnabled(i) ? chunk.meshbuffer->getAttribFormat(i):EF_UNKNOWN;
+		formats[normalAttrId] = m_format;
+		auto withNormals = relayout(chunk.meshbuffer.get(),formats,m_pipeline);
+		if (!withNormals)
+			return false;
+		chunk.meshbuffer = std::move(withNormals);
+	}
+	ICPUMeshBuffer* mb = chunk.meshbuffer.get();
+
+	// SoA positions followed by SoA normals
+	const uint32_t vertexCount = getChunkVertexCount(mb);
+	core::vector<float> scratch(size_t(vertexCount)*6u,0.f);
+	float* const positions[4] = {scratch.data(),scratch.data()+vertexCount,scratch.data()+vertexCount*2u,nullptr};
+	float* const normals[4] = {scratch.data()+vertexCount*3u,scratch.data()+vertexCount*4u,scratch.data()+vertexCount*5u,nullptr};
+	if (!mb->getAttributeSpan(positions,posAttrId,0u,vertexCount))
+		return false;
+
+	// unnormalized cross products, so every face contributes proportionally to its area
+	const uint32_t* indices = reinterpret_cast<const uint32_t*>(mb->getIndices());
+	for (uint32_t i=0u; i+2u<mb->getIndexCount(); i+=3u)
+	{
+		const uint32_t a = indices[i], b = indices[i+1u], c = indices[i+2u];
+		float e1[3], e2[3];
+		for (auto j=0u; j<3u; j++)
+		{
+			e1[j] = positions[j][b]-positions[j][a];
+			e2[j] = positions[j][c]-positions[j][a];
+		}
+		const float n[3] = {e1[1]*e2[2]-e1[2]*e2[1],e1[2]*e2[0]-e1[0]*e2[2],e1[0]*e2[1]-e1[1]*e2[0]};
+		for (auto j=0u; j<3u; j++)
+		{
+			normals[j][a] += n[j];
+			normals[j][b] += n[j];
+			normals[j][c] += n[j];
+		}
+	}
+	for (uint32_t v=0u; v<vertexCount; v++)
+	{
+		const float lenSq = normals[0][v]*normals[0][v]+normals[1][v]*normals[1][v]+normals[2][v]*normals[2][v];
+		if (lenSq>0.f)
+		{
+			const float rcpLen = 1.f/std::sqrt(lenSq);
+			for (auto j=0u; j<3u; j++)
+				normals[j][v] *= rcpLen;
+		}
+		else // degenerate or unreferenced
+		{
+			normals[0][v] = 0.f;
+			normals[1][v] = 0.f;
+			normals[2][v] = 1.f;
+		}
+	}
+	return mb->setAttributeSpan(normals,normalAttrId,0u,vertexCount);
+}
+
+bool CStreamingMeshPipeline::CBoundsStage::process(SChunk& chunk)
+{
+	const auto aabb = IMeshManipulator::calculateBoundingBox(chunk.meshbuffer.get());
+	chunk.meshbuffer->setBoundingBox(aabb);
+	m_aabb.addInternalBox(aabb);
+	return true;
+}
+
+bool CStreamingMeshPipeline::CCacheOptimizationStage::process(SChunk& chunk)
+{
+	ICPUMeshBuffer* mb = chunk.meshbuffer.get();
+	const uint32_t stride = getChunkStride(mb);
+	const uint32_t vertexCount = getChunkVertexCount(mb);
+	const uint32_t indexCount = mb->getIndexCount();
+	uint32_t* indices = reinterpret_cast<uint32_t*>(mb->getIndices());
+	CForsythVertexCacheOptimizer().optimizeTriangleOrdering(vertexCount,indexCount,indices,indices);
+
+	// vertices in order of first use, so the fetches are as linear as the triangle order allows
+	constexpr uint32_t Unused = ~0u;
+	core::vector<uint32_t> remap(vertexCount,Unused);
+	uint32_t next = 0u;
+	for (uint32_t i=0u; i<indexCount; i++)
+	{
+		if (remap[indices[i]]==Unused)
+			remap[indices[i]] = next++;
+		indices[i] = remap[indices[i]];
+	}
+	// unreferenced vertices go at the end
+	for (auto& ix : remap)
+	if (ix==Unused)
+		ix = next++;
+
+	const uint8_t* vertices = getChunkVertices(mb);
+	auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(vertexCount)*stride);
+	uint8_t* dst = reinterpret_cast<uint8_t*>(vertexBuffer->getPointer());
+	for (uint32_t v=0u; v<vertexCount; v++)
+		memcpy(dst+size_t(remap[v])*stride,vertices+size_t(v)*stride,stride);
+	mb->setVertexBufferBinding({0ull,std::move(vertexBuffer)},VertexBinding);
+	return true;
+}
+
+
+auto CStreamingMeshPipeline::run(const SInput& input, const SOutput& output, const uint32_t trianglesPerChunk, system::logger_opt_ptr logger) const -> SResult
+{
+	SResult result = {};
+	if (!input.pipeline || !input.vertices || !input.indices || !output.vertices || !output.indices || trianglesPerChunk==0u)
+	{
+		logger.log("CStreamingMeshPipeline: missing input, output or zero triangles per chunk.",system::ILogger::ELL_ERROR);
+		return result;
+	}
+	const auto& inParams = input.pipeline->getCachedCreationParams();
+	if (inParams.primitiveAssembly.primitiveType!=EPT_TRIANGLE_LIST || !isValidChunkLayout(inParams.vertexInput))
+	{
+		logger.log("CStreamingMeshPipeline: input needs to be a triangle list with all attributes in vertex binding 0.",system::ILogger::ELL_ERROR);
+		return result;
+	}
+	if ((input.indexType!=EIT_16BIT && input.indexType!=EIT_32BIT) || input.indexCount%3ull)
+	{
+		logger.log("CStreamingMeshPipeline: invalid index type or index count not a multiple of 3.",system::ILogger::ELL_ERROR);
+		return result;
+	}
+
+	// every chunk starts out with the input layout
+	auto inputPipeline = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(input.pipeline->clone(0u));
+	const uint32_t inStride = inParams.vertexInput.bindings[VertexBinding].stride;
+	const size_t indexSize = input.indexType==EIT_16BIT ? sizeof(uint16_t):sizeof(uint32_t);
+
+	core::vector<uint32_t> globalIndices;
+	core::vector<uint32_t> uniqueIndices;
+	core::vector<uint16_t> shortIndices;
+	core::vector<uint32_t> outIndices;
+	size_t vertexWriteOffset = output.vertexOffset;
+	size_t indexWriteOffset = output.indexOffset;
+	const uint64_t triangleCount = input.indexCount/3ull;
+	for (uint64_t firstTriangle=0ull; firstTriangle<triangleCount; firstTriangle+=trianglesPerChunk)
+	{
+		const uint32_t chunkIx = static_cast<uint32_t>(result.chunkCount);
+		const uint32_t chunkIndexCount = static_cast<uint32_t>(core::min<uint64_t>(trianglesPerChunk,triangleCount-firstTriangle)*3ull);
+		const size_t indexReadOffset = input.indexOffset+firstTriangle*3ull*indexSize;
+
+		// indices, widened to 32bit
+		globalIndices.resize(chunkIndexCount);
+		system::IFile::success_t success;
+		if (input.indexType==EIT_16BIT)
+		{
+			shortIndices.resize(chunkIndexCount);
+			input.indices->read(success,shortIndices.data(),indexReadOffset,chunkIndexCount*sizeof(uint16_t));
+			std::copy(shortIndices.begin(),shortIndices.end(),globalIndices.begin());
+		}
+		else
+			input.indices->read(success,globalIndices.data(),indexReadOffset,chunkIndexCount*sizeof(uint32_t));
+		if (!success)
+		{
+			logger.log("CStreamingMeshPipeline: failed to read indices of chunk %u.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+
+		// the distinct vertices the chunk references, their order defines the chunk-local indices
+		uniqueIndices = globalIndices;
+		std::sort(uniqueIndices.begin(),uniqueIndices.end());
+		uniqueIndices.erase(std::unique(uniqueIndices.begin(),uniqueIndices.end()),uniqueIndices.end());
+		if (uniqueIndices.back()>=input.vertexCount)
+		{
+			logger.log("CStreamingMeshPipeline: index %u out of range in chunk %u.",system::ILogger::ELL_ERROR,uniqueIndices.back(),chunkIx);
+			return {};
+		}
+		const uint32_t chunkVertexCount = static_cast<uint32_t>(uniqueIndices.size());
+
+		auto indexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(chunkIndexCount*sizeof(uint32_t));
+		{
+			uint32_t* localIndices = reinterpret_cast<uint32_t*>(indexBuffer->getPointer());
+			for (uint32_t i=0u; i<chunkIndexCount; i++)
+				localIndices[i] = static_cast<uint32_t>(std::lower_bound(uniqueIndices.begin(),uniqueIndices.end(),globalIndices[i])-uniqueIndices.begin());
+		}
+
+		// read runs of consecutive vertices with a single call, for a mapped file thats just a memcpy
+		auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(chunkVertexCount)*inStride);
+		{
+			uint8_t* dst = reinterpret_cast<uint8_t*>(vertexBuffer->getPointer());
+			for (uint32_t runBegin=0u; runBegin<chunkVertexCount;)
+			{
+				uint32_t runEnd = runBegin+1u;
+				while (runEnd<chunkVertexCount && uniqueIndices[runEnd]==uniqueIndices[runEnd-1u]+1u)
+					runEnd++;
+				const size_t runBytes = size_t(runEnd-runBegin)*inStride;
+				input.vertices->read(success,dst+size_t(runBegin)*inStride,input.vertexOffset+size_t(uniqueIndices[runBegin])*inStride,runBytes);
+				if (!success)
+				{
+					logger.log("CStreamingMeshPipeline: failed to read vertices of chunk %u.",system::ILogger::ELL_ERROR,chunkIx);
+					return {};
+				}
+				runBegin = runEnd;
+			}
+		}
+		result.maxChunkBytes = core::max(result.maxChunkBytes,vertexBuffer->getSize()+size_t(chunkIndexCount)*indexSize);
+
+		SChunk chunk;
+		chunk.firstTriangle = firstTriangle;
+		chunk.meshbuffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+		chunk.meshbuffer->setPipeline(core::smart_refctd_ptr(inputPipeline));
+		chunk.meshbuffer->setVertexBufferBinding({0ull,std::move(vertexBuffer)},VertexBinding);
+		chunk.meshbuffer->setIndexBufferBinding({0ull,std::move(indexBuffer)});
+		chunk.meshbuffer->setIndexType(EIT_32BIT);
+		chunk.meshbuffer->setIndexCount(chunkIndexCount);
+		chunk.meshbuffer->setPositionAttributeIx(input.positionAttributeIx);
+		chunk.meshbuffer->setNormalAttributeIx(input.normalAttributeIx);
+
+		for (const auto& stage : m_stages)
+		if (!stage->process(chunk) || !chunk.meshbuffer)
+		{
+			logger.log("CStreamingMeshPipeline: a stage failed on chunk %u.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+
+		const ICPUMeshBuffer* mb = chunk.meshbuffer.get();
+		const auto* outPipeline = mb->getPipeline();
+		if (!outPipeline || mb->getIndexType()!=EIT_32BIT || !mb->getIndices() || mb->getBaseVertex()!=0)
+		{
+			logger.log("CStreamingMeshPipeline: chunk %u broke the chunk contract.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+		const auto& outParams = outPipeline->getCachedCreationParams().vertexInput;
+		if (!result.pipeline)
+		{
+			if (!isValidChunkLayout(outParams))
+			{
+				logger.log("CStreamingMeshPipeline: stages produced an invalid vertex layout.",system::ILogger::ELL_ERROR);
+				return {};
+			}
+			result.pipeline = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(outPipeline->clone(0u));
+		}
+		else if (result.pipeline->getCachedCreationParams().vertexInput!=outParams)
+		{
+			logger.log("CStreamingMeshPipeline: chunk %u came out with a different vertex layout than the previous ones.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+
+		// append, rebasing the indices by the vertices written so far
+		const uint32_t outVertexCount = getChunkVertexCount(mb);
+		// checked before anything gets written, the rebased indices of this chunk must not wrap around
+		if (result.vertexCount+outVertexCount>0xffffffffull)
+		{
+			logger.log("CStreamingMeshPipeline: output exceeds the 32bit index range.",system::ILogger::ELL_ERROR);
+			return {};
+		}
+		const size_t vertexBytes = size_t(outVertexCount)*outParams.bindings[VertexBinding].stride;
+		const auto& outBinding = mb->getVertexBufferBindings()[VertexBinding];
+		output.vertices->write(success,reinterpret_cast<const uint8_t*>(outBinding.buffer->getPointer())+outBinding.offset,vertexWriteOffset,vertexBytes);
+		if (!success)
+		{
+			logger.log("CStreamingMeshPipeline: failed to write vertices of chunk %u.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+		vertexWriteOffset += vertexBytes;
+
+		const uint32_t* chunkIndices = reinterpret_cast<const uint32_t*>(mb->getIndices());
+		outIndices.resize(mb->getIndexCount());
+		for (uint32_t i=0u; i<mb->getIndexCount(); i++)
+			outIndices[i] = static_cast<uint32_t>(result.vertexCount+chunkIndices[i]);
+		output.indices->write(success,outIndices.data(),indexWriteOffset,outIndices.size()*sizeof(uint32_t));
+		if (!success)
+		{
+			logger.log("CStreamingMeshPipeline: failed to write indices of chunk %u.",system::ILogger::ELL_ERROR,chunkIx);
+			return {};
+		}
+		indexWriteOffset += outIndices.size()*sizeof(uint32_t);
+
+		result.vertexCount += outVertexCount;
+		result.indexCount += outIndices.size();
+		result.chunkCount++;
+	}
+	return result;
+}
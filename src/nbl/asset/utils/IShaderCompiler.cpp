@@ -212,6 +212,7 @@ void IShaderCompiler::CIncludeFinder::addSearchPath(const std::string& searchPat
     if (!loader)
         return;
     m_loaders.push_back(LoaderSearchPath{ loader, searchPath });
+    invalidateCache();
 }
 
 void IShaderCompiler::CIncludeFinder::addGenerator(const core::smart_refctd_ptr<IIncludeGenerator>& generatorToAdd)
@@ -228,6 +229,244 @@ void IShaderCompiler::CIncludeFinder::addGenerator(const core::smart_refctd_ptr<
         });
 
     m_generators.insert(found, generatorToAdd);
+    invalidateCache();
+}
+
+// Finds out whether the whole file is wrapped in a single `#ifndef GUARD`/`#if !defined(GUARD)` block and whether it has a `#pragma once`.
+// Only needs to be conservative, if in doubt we report no guard and the preprocessor will simply process the file again.
+static void analyzeIncludeGuards(const std::string& code, std::string& guardMacro, bool& pragmaOnce)
+{
+    guardMacro.clear();
+    pragmaOnce = false;
+
+    auto isIdentifierChar = [](const char c) -> bool {return std::isalnum(static_cast<unsigned char>(c))||c=='_';};
+    auto trim = [](std::string_view str) -> std::string_view
+    {
+        const auto first = str.find_first_not_of(" \t\r\v\f");
+        if (first==std::string_view::npos)
+            return {};
+        const auto last = str.find_last_not_of(" \t\r\v\f");
+        return str.substr(first,last-first+1);
+    };
+
+    std::string candidate;
+    bool guardValid = false, guardClosed = false;
+    bool pragmaOnceAtTopLevel = false, pragmaOnceInGuard = false;
+    int32_t depth = 0;
+
+    std::string line;
+    bool inBlockComment = false;
+    for (size_t pos=0; pos<code.size();)
+    {
+        // gather a logical line with comments and literals blanked out
+        line.clear();
+        for (; pos<code.size(); pos++)
+        {
+            const char c = code[pos];
+            const char next = pos+1<code.size() ? code[pos+1]:'\0';
+            if (inBlockComment)
+            {
+                if (c=='*' && next=='/')
+                {
+                    inBlockComment = false;
+                    pos++;
+                    line.push_back(' ');
+                }
+                continue;
+            }
+            if (c=='\\' && (next=='\n' || next=='\r'))
+            {
+                pos++;
+                if (next=='\r' && pos+1<code.size() && code[pos+1]=='\n')
+                    pos++;
+                continue;
+            }
+            if (c=='\n')
+            {
+                pos++;
+                break;
+            }
+            if (c=='/' && next=='/')
+            {
+                while (pos+1<code.size() && code[pos+1]!='\n')
+                    pos++;
+                continue;
+            }
+            if (c=='/' && next=='*')
+            {
+                inBlockComment = true;
+                pos++;
+                continue;
+            }
+            if (c=='"' || c=='\'')
+            {
+                size_t end = pos+1;
+                while (end<code.size() && code[end]!=c && code[end]!='\n')
+                    end += code[end]=='\\' ? 2:1;
+                line.push_back(c);
+                line.push_back(c);
+                // don't swallow the newline of an unterminated literal
+                pos = end<code.size() && code[end]=='\n' ? (end-1):end;
+                continue;
+            }
+            line.push_back(c);
+        }
+
+        const auto trimmed = trim(line);
+        if (trimmed.empty())
+            continue;
+
+        // anything significant after the guard's `#endif` means the guard doesn't cover the whole file
+        if (guardClosed)
+        {
+            guardValid = false;
+            break;
+        }
+
+        if (trimmed.front()!='#')
+        {
+            if (depth==0)
+                break; // code outside of any conditional, there's no guard
+            continue;
+        }
+
+        const auto directiveLine = trim(trimmed.substr(1));
+        size_t nameEnd = 0;
+        while (nameEnd<directiveLine.size() && isIdentifierChar(directiveLine[nameEnd]))
+            nameEnd++;
+        const auto name = directiveLine.substr(0,nameEnd);
+        const auto arg = trim(directiveLine.substr(nameEnd));
+
+        if (name=="pragma")
+        {
+            if (arg=="once")
+            {
+                if (depth==0)
+                    pragmaOnceAtTopLevel = true;
+                else if (depth==1)
+                    pragmaOnceInGuard = true;
+            }
+            else if (depth==0)
+                break;
+        }
+        else if (name=="ifndef" || name=="if" || name=="ifdef")
+        {
+            if (depth==0)
+            {
+                std::string_view macro;
+                if (name=="ifndef")
+                    macro = arg;
+                else if (name=="if" && arg.size()>1 && arg.front()=='!')
+                {
+                    // accept `!defined(GUARD)` and `!defined GUARD`
+                    auto rest = trim(arg.substr(1));
+                    if (rest.substr(0,7)=="defined")
+                    {
+                        rest = trim(rest.substr(7));
+                        if (!rest.empty() && rest.front()=='(' && rest.back()==')')
+                            rest = trim(rest.substr(1,rest.size()-2));
+                        macro = rest;
+                    }
+                }
+                if (macro.empty() || !std::all_of(macro.begin(),macro.end(),isIdentifierChar))
+                    break;
+                candidate = macro;
+                guardValid = true;
+            }
+            depth++;
+        }
+        else if (name=="else" || name=="elif" || name=="elifdef" || name=="elifndef")
+        {
+            // an alternative branch to the guard means the file produces something even if the guard macro is defined
+            if (depth==1)
+                break;
+        }
+        else if (name=="endif")
+        {
+            if (--depth==0)
+                guardClosed = true;
+            else if (depth<0)
+                break;
+        }
+        else if (depth==0)
+            break; // some other directive outside of the guard (#define, #include, etc.)
+    }
+
+    if (guardValid && guardClosed && depth==0)
+        guardMacro = std::move(candidate);
+    pragmaOnce = pragmaOnceAtTopLevel || (pragmaOnceInGuard && !guardMacro.empty());
+}
+
+// Includes which aren't files on disk come from archives or generators, those never change
+static bool isStaleInclude(const IShaderCompiler::CIncludeFinder::SCachedInclude& include)
+{
+    if (!include.onDisk)
+        return false;
+    std::error_code error;
+    const auto lastWriteTime = std::filesystem::last_write_time(include.absolutePath,error);
+    if (error)
+        return true;
+    const auto fileSize = std::filesystem::file_size(include.absolutePath,error);
+    return error || lastWriteTime!=include.lastWriteTime || fileSize!=include.fileSize;
+}
+
+auto IShaderCompiler::CIncludeFinder::getCachedInclude(const system::path& requestingSourceDir, const std::string& includeName, const bool standard) const -> std::shared_ptr<const SCachedInclude>
+{
+    std::string key;
+    key.reserve(includeName.size()+requestingSourceDir.native().size()+2);
+    key += standard ? '<':'"';
+    key += requestingSourceDir.string();
+    key += '\n';
+    key += includeName;
+    {
+        std::shared_ptr<const SCachedInclude> cached;
+        {
+            std::shared_lock lock(m_cacheMutex);
+            if (auto found=m_resolvedIncludes.find(key); found!=m_resolvedIncludes.end())
+                cached = found->second;
+        }
+        // a stat per include is still far cheaper than reading and lexing it again, and makes hot reloading just work
+        if (cached && !isStaleInclude(*cached))
+            return cached;
+    }
+
+    // do the slow lookup and loading without holding the lock, worst case two threads load the same file at once
+    auto result = standard ? getIncludeStandard(requestingSourceDir,includeName):getIncludeRelative(requestingSourceDir,includeName);
+    if (!result)
+        return nullptr;
+
+    auto entry = std::make_shared<SCachedInclude>();
+    entry->absolutePath = std::move(result.absolutePath);
+    entry->contents = std::move(result.contents);
+    {
+        std::error_code error;
+        if (entry->absolutePath.is_absolute() && std::filesystem::is_regular_file(entry->absolutePath,error))
+        {
+            entry->lastWriteTime = std::filesystem::last_write_time(entry->absolutePath,error);
+            if (!error)
+                entry->fileSize = std::filesystem::file_size(entry->absolutePath,error);
+            entry->onDisk = !error;
+        }
+    }
+
+    const auto absolutePath = entry->absolutePath.string();
+    std::unique_lock lock(m_cacheMutex);
+    auto loaded = m_loadedIncludes.find(absolutePath);
+    // different spellings of the same file keep sharing an entry (and its lexed tokens) unless the file changed in the meantime
+    if (loaded==m_loadedIncludes.end() || loaded->second->onDisk!=entry->onDisk || loaded->second->lastWriteTime!=entry->lastWriteTime || loaded->second->fileSize!=entry->fileSize)
+    {
+        analyzeIncludeGuards(entry->contents,entry->guardMacro,entry->pragmaOnce);
+        loaded = m_loadedIncludes.insert_or_assign(absolutePath,std::move(entry)).first;
+    }
+    m_resolvedIncludes.insert_or_assign(std::move(key),loaded->second);
+    return loaded->second;
+}
+
+void IShaderCompiler::CIncludeFinder::invalidateCache() const
+{
+    std::unique_lock lock(m_cacheMutex);
+    m_resolvedIncludes.clear();
+    m_loadedIncludes.clear();
 }
 
 auto IShaderCompiler::CIncludeFinder::trySearchPaths(const std::string& includeName) const -> IIncludeLoader::found_t
@@ -15,12 +15,110 @@
 #include <boost/wave/cpplexer/cpp_lex_iterator.hpp>
 
 
+namespace nbl::asset
+{
+// Wave's tokens and strings have non-atomic reference counts, so they can't be shared between threads preprocessing at once.
+// The cache keeps plain copies instead, which get turned back into tokens whenever an include is replayed.
+struct IShaderCompiler::CIncludeFinder::SLexedTokens
+{
+    struct SToken
+    {
+        boost::wave::token_id id;
+        std::string value;
+        uint32_t line;
+        uint32_t column;
+    };
+
+    boost::wave::language_support language;
+    // everything up to and including the `T_EOF`
+    core::vector<SToken> tokens;
+};
+}
+
 namespace nbl::wave
 {
 using namespace boost;
 using namespace boost::wave;
 using namespace boost::wave::util;
 
+using cached_include_t = IShaderCompiler::CIncludeFinder::SCachedInclude;
+using lexed_tokens_t = IShaderCompiler::CIncludeFinder::SLexedTokens;
+
+// lexes a whole include up front so later translation units can replay it, null if the lexer reports anything so the error shows up in context
+template <typename TokenT>
+std::shared_ptr<const lexed_tokens_t> lex_include(std::string source, typename TokenT::position_type const& pos, boost::wave::language_support language)
+{
+    auto retval = std::make_shared<lexed_tokens_t>();
+    retval->language = language;
+    try
+    {
+        boost::wave::cpplexer::lex_iterator<TokenT> it(source.begin(),source.end(),pos,language), end;
+        for (; it!=end; ++it)
+        {
+            const auto& value = it->get_value();
+            const auto& position = it->get_position();
+            retval->tokens.push_back({token_id(*it),std::string(value.c_str(),value.size()),static_cast<uint32_t>(position.get_line()),static_cast<uint32_t>(position.get_column())});
+        }
+    }
+    catch (boost::wave::cpplexer::lexing_exception&)
+    {
+        return nullptr;
+    }
+    return retval;
+}
+
+// hands out the cached tokens of an include instead of lexing it again
+template <typename TokenT>
+class replay_lexer final : public boost::wave::cpplexer::lex_input_interface<TokenT>
+{
+        using position_type = typename TokenT::position_type;
+        using string_type = typename TokenT::string_type;
+
+    public:
+        replay_lexer(std::shared_ptr<const lexed_tokens_t>&& tokens, position_type const& pos)
+            : m_tokens(std::move(tokens)), m_file(pos.get_file()), m_lineOffset(static_cast<int64_t>(pos.get_line())-1) {}
+
+        TokenT& get(TokenT& result) override
+        {
+            if (m_next>=m_tokens->tokens.size())
+                return result = TokenT(); // T_EOI
+            const auto& token = m_tokens->tokens[m_next++];
+            return result = TokenT(token.id,string_type(token.value.data(),token.value.size()),position_type(m_file,static_cast<std::size_t>(token.line+m_lineOffset),token.column));
+        }
+
+        // same as the re2c lexer, `#line` changes the file name and the line of the next token
+        void set_position(position_type const& pos) override
+        {
+            m_file = pos.get_file();
+            if (m_next<m_tokens->tokens.size())
+                m_lineOffset = static_cast<int64_t>(pos.get_line())-m_tokens->tokens[m_next].line;
+        }
+
+    private:
+        std::shared_ptr<const lexed_tokens_t> m_tokens;
+        string_type m_file;
+        int64_t m_lineOffset;
+        size_t m_next = 0;
+};
+
+// stands in for the source iterators, so that `lex_iterator` can be made over the cached tokens of an include
+struct cached_tokens_t
+{
+    std::shared_ptr<const lexed_tokens_t> tokens;
+};
+}
+
+template<>
+struct boost::wave::cpplexer::new_lexer_gen<nbl::wave::cached_tokens_t>
+{
+    static lex_input_interface<lex_token<>>* new_lexer(nbl::wave::cached_tokens_t const& first, nbl::wave::cached_tokens_t const& last, boost::wave::util::file_position_type const& pos, boost::wave::language_support language)
+    {
+        return new nbl::wave::replay_lexer<lex_token<>>(std::shared_ptr(first.tokens),pos);
+    }
+};
+
+namespace nbl::wave
+{
 // for including builtins 
 struct load_to_string final
 {
@@ -31,10 +129,22 @@ struct load_to_string final
             template <typename PositionT>
             static void init_iterators(IterContextT& iter_ctx, PositionT const& act_pos, boost::wave::language_support language)
             {
-                iter_ctx.instring = iter_ctx.ctx.get_located_include_content();
-
                 using iterator_type = IterContextT::iterator_type;
-                iter_ctx.first = iterator_type(iter_ctx.instring.begin(),iter_ctx.instring.end(),PositionT(iter_ctx.filename),language);
+                using token_type = iterator_type::token_type;
+
+                // the first translation unit to include the file lexes it for everyone, the others only replay the tokens
+                const auto& include = iter_ctx.ctx.get_located_include();
+                std::call_once(include->lexOnce,[&]() -> void
+                {
+                    include->lexed = lex_include<token_type>(include->contents,PositionT(iter_ctx.filename),language);
+                });
+                if (include->lexed && include->lexed->language==language)
+                    iter_ctx.first = iterator_type(cached_tokens_t{include->lexed},cached_tokens_t{},PositionT(iter_ctx.filename),language);
+                else
+                {
+                    iter_ctx.instring = include->contents;
+                    iter_ctx.first = iterator_type(iter_ctx.instring.begin(),iter_ctx.instring.end(),PositionT(iter_ctx.filename),language);
+                }
                 iter_ctx.last = iterator_type();
             }
 
@@ -356,9 +466,9 @@ class context : private boost::noncopyable
         {
             current_dir = filepath.parent_path();
         }
-        const core::string& get_located_include_content() const
+        const std::shared_ptr<const cached_include_t>& get_located_include() const
         {
-            return located_include_content;
+            return located_include;
         }
         // Nabla Additions End
 
@@ -465,7 +575,9 @@ class context : private boost::noncopyable
         // Nabla Additions Start
         // these are temporaries!
         system::path current_dir;
-        core::string located_include_content;
+        std::shared_ptr<const cached_include_t> located_include;
+        // absolute paths of already included files which had a `#pragma once`
+        core::unordered_set<std::string> pragma_once_headers;
         // Nabla Additions End
 
         boost::wave::util::if_block_stack ifblocks;   // conditional compilation contexts
@@ -491,15 +603,10 @@ template<> inline bool boost::wave::impl::pp_iterator_functor<nbl::wave::context
         return true;    // client returned false: skip file to include
     file_path = util::impl::unescape_lit(file_path);
 
-    IShaderCompiler::IIncludeLoader::found_t result;
+    std::shared_ptr<const nbl::wave::cached_include_t> result;
     auto* includeFinder = ctx.get_hooks().m_includeFinder;
     if (includeFinder)
-    {
-        if (is_system)
-            result = includeFinder->getIncludeStandard(ctx.get_current_directory(),file_path);
-        else
-            result = includeFinder->getIncludeRelative(ctx.get_current_directory(),file_path);
-    }
+        result = includeFinder->getCachedInclude(ctx.get_current_directory(),file_path,is_system);
     else {
         ctx.get_hooks().m_logger.log("Pre-processor error: Include finder not assigned, preprocessor will not include file " + file_path, nbl::system::ILogger::ELL_ERROR);
         return false;
@@ -512,20 +619,27 @@ template<> inline bool boost::wave::impl::pp_iterator_functor<nbl::wave::context
         return false;
     }
 
-    ctx.located_include_content = std::move(result.contents);
+    // Skip files which would expand to nothing without pushing an iteration context, this saves going through all of their tokens just to find the `#endif`
+    const auto absolutePath = result->absolutePath.string();
+    if (result->pragmaOnce && !ctx.pragma_once_headers.insert(absolutePath).second)
+        return true;
+    if (!result->guardMacro.empty() && ctx.is_defined_macro(result->guardMacro))
+        return true;
+
+    ctx.located_include = result;
     // the new include file determines the actual current directory
-    ctx.set_current_directory(result.absolutePath);
+    ctx.set_current_directory(result->absolutePath);
 
     {
         // preprocess the opened file
         boost::shared_ptr<base_iteration_context_type> new_iter_ctx(
-            new iteration_context_type(ctx,result.absolutePath.string().c_str(),act_pos,
+            new iteration_context_type(ctx,absolutePath.c_str(),act_pos,
                 boost::wave::enable_prefer_pp_numbers(ctx.get_language()),
                 is_system ? base_iteration_context_type::system_header :
                 base_iteration_context_type::user_header));
 
         // call the include policy trace function
-        ctx.get_hooks().opened_include_file(ctx.derived(),file_path,result.absolutePath.string(),is_system);
+        ctx.get_hooks().opened_include_file(ctx.derived(),file_path,absolutePath,is_system);
 
         // store current file position
         iter_ctx->real_relative_filename = ctx.get_current_relative_filename().c_str();
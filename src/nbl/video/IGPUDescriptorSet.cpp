@@ -38,36 +38,33 @@ IGPUDescriptorSet::~IGPUDescriptorSet()
         m_pool->deleteSetStorage(m_storageOffsets.getSetOffset());
 }
 
-asset::IDescriptor::E_TYPE IGPUDescriptorSet::validateWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write) const
+auto IGPUDescriptorSet::validateWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write) const -> const binding_info_t*
 {
     assert(write.dstSet == this);
 
     const char* debugName = getDebugName();
 
     // screw it, we'll need to replace the descriptor writing with update templates of descriptor buffer soon anyway
-    const auto descriptorType = getBindingType(write.binding);
-
-    auto* descriptors = getDescriptors(descriptorType,write.binding);
-    if (!descriptors)
+    const auto* bindingInfo = m_layout->findBindingInfo(write.binding);
+    if (!bindingInfo || !getDescriptors(*bindingInfo))
     {
         if (debugName)
             m_pool->m_logger.log("Descriptor set (%s, %p) doesn't allow descriptor of such type at binding %u.", system::ILogger::ELL_ERROR, debugName, this, write.binding);
         else
             m_pool->m_logger.log("Descriptor set (%p) doesn't allow descriptor of such type at binding %u.", system::ILogger::ELL_ERROR, this, write.binding);
 
-        return asset::IDescriptor::E_TYPE::ET_COUNT;
+        return nullptr;
     }
 
-    core::smart_refctd_ptr<video::IGPUSampler>* mutableSamplers = nullptr;
-    if (descriptorType==asset::IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER && write.info->info.image.sampler)
+    if (bindingInfo->type==asset::IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER && write.info->info.image.sampler)
     {
-        if (m_layout->getImmutableSamplerRedirect().getCount(IGPUDescriptorSetLayout::CBindingRedirect::binding_number_t{ write.binding }) != 0)
+        if (bindingInfo->immutableSamplerOffset != IGPUDescriptorSetLayout::CBindingRedirect::Invalid)
         {
             if (debugName)
                 m_pool->m_logger.log("Descriptor set (%s, %p) doesn't allow immutable samplers at binding %u, but immutable samplers found.", system::ILogger::ELL_ERROR, debugName, this, write.binding);
             else
                 m_pool->m_logger.log("Descriptor set (%p) doesn't allow immutable samplers at binding %u, but immutable samplers found.", system::ILogger::ELL_ERROR, this, write.binding);
-            return asset::IDescriptor::E_TYPE::ET_COUNT;
+            return nullptr;
         }
 
         for (uint32_t i=0; i<write.count; ++i)
@@ -80,36 +77,35 @@ asset::IDescriptor::E_TYPE IGPUDescriptorSet::validateWrite(const IGPUDescriptor
                     m_pool->m_logger.log("Sampler (%s, %p) does not exist or is not device-compatible with descriptor set (%s, %p).", system::ILogger::ELL_ERROR, samplerDebugName, sampler, debugName, write.dstSet);
                 else
                     m_pool->m_logger.log("Sampler (%p) does not exist or is not device-compatible with descriptor set (%p).", system::ILogger::ELL_ERROR, sampler, write.dstSet);
-                return asset::IDescriptor::E_TYPE::ET_COUNT;
+                return nullptr;
             }
         }
 
-        mutableSamplers = getMutableSamplers(write.binding);
-        if (!mutableSamplers)
+        if (!getMutableSamplers(*bindingInfo))
         {
             if (debugName)
                 m_pool->m_logger.log("Descriptor set (%s, %p) doesn't allow mutable samplers at binding %u.", system::ILogger::ELL_ERROR, debugName, this, write.binding);
             else
                 m_pool->m_logger.log("Descriptor set (%p) doesn't allow mutable samplers at binding %u.", system::ILogger::ELL_ERROR, this, write.binding);
 
-            return asset::IDescriptor::E_TYPE::ET_COUNT;
+            return nullptr;
         }
     }
 
-    return descriptorType;
+    return bindingInfo;
 }
 
-void IGPUDescriptorSet::processWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write, const asset::IDescriptor::E_TYPE type)
+void IGPUDescriptorSet::processWrite(const IGPUDescriptorSet::SWriteDescriptorSet& write, const binding_info_t& bindingInfo)
 {
     assert(write.dstSet == this);
 
-    auto* descriptors = getDescriptors(type,write.binding);
+    auto* descriptors = getDescriptors(bindingInfo);
     assert(descriptors);
 
     core::smart_refctd_ptr<video::IGPUSampler>* mutableSamplers = nullptr;
-    if (type==asset::IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER && write.info->info.image.sampler)
+    if (bindingInfo.type==asset::IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER && write.info->info.image.sampler)
     {
-        mutableSamplers = getMutableSamplers(write.binding);
+        mutableSamplers = getMutableSamplers(bindingInfo);
         assert(mutableSamplers);
     }
 
@@ -128,10 +124,12 @@ void IGPUDescriptorSet::dropDescriptors(const IGPUDescriptorSet::SDropDescriptor
 {
     assert(drop.dstSet == this);
 
-    const auto descriptorType = getBindingType(drop.binding);
+    const auto* bindingInfo = m_layout->findBindingInfo(drop.binding);
+    if (!bindingInfo)
+        return;
 
-	auto* dstDescriptors = drop.dstSet->getDescriptors(descriptorType, drop.binding);
-	auto* dstSamplers = drop.dstSet->getMutableSamplers(drop.binding);
+	auto* dstDescriptors = getDescriptors(*bindingInfo);
+	auto* dstSamplers = getMutableSamplers(*bindingInfo);
 
 	if (dstDescriptors)
 		for (uint32_t i = 0; i < drop.count; i++)
@@ -156,25 +154,26 @@ bool IGPUDescriptorSet::validateCopy(const IGPUDescriptorSet::SCopyDescriptorSet
     const char* srcDebugName = copy.srcSet->getDebugName();
     const char* dstDebugName = copy.dstSet->getDebugName();
 
-    for (uint32_t t = 0; t < static_cast<uint32_t>(asset::IDescriptor::E_TYPE::ET_COUNT); ++t)
-    {
-        const auto type = static_cast<asset::IDescriptor::E_TYPE>(t);
-
-        auto* srcDescriptors = copy.srcSet->getDescriptors(type, copy.srcBinding);
-        auto* dstDescriptors = copy.dstSet->getDescriptors(type, copy.dstBinding);
+    // binding numbers are unique within a layout, so the two bindings are compatible if they hold the same type of descriptor and both or neither have mutable samplers
+    const auto* srcBindingInfo = copy.srcSet->getLayout()->findBindingInfo(copy.srcBinding);
+    const auto* dstBindingInfo = copy.dstSet->getLayout()->findBindingInfo(copy.dstBinding);
 
-        auto* srcSamplers = copy.srcSet->getMutableSamplers(copy.srcBinding);
-        auto* dstSamplers = copy.dstSet->getMutableSamplers(copy.dstBinding);
+    bool compatible = (!srcBindingInfo == !dstBindingInfo);
+    if (compatible && srcBindingInfo)
+    {
+        compatible = srcBindingInfo->type == dstBindingInfo->type &&
+            (!copy.srcSet->getDescriptors(*srcBindingInfo) == !copy.dstSet->getDescriptors(*dstBindingInfo)) &&
+            (!copy.srcSet->getMutableSamplers(*srcBindingInfo) == !copy.dstSet->getMutableSamplers(*dstBindingInfo));
+    }
 
-        if ((!srcDescriptors != !dstDescriptors) || (!srcSamplers != !dstSamplers))
-        {
-            if (srcDebugName && dstDebugName)
-                m_pool->m_logger.log("Incompatible copy from descriptor set (%s, %p) at binding %u to descriptor set (%s, %p) at binding %u.", system::ILogger::ELL_ERROR, srcDebugName, copy.srcSet, copy.srcBinding, dstDebugName, copy.dstSet, copy.dstBinding);
-            else
-                m_pool->m_logger.log("Incompatible copy from descriptor set (%p) at binding %u to descriptor set (%p) at binding %u.", system::ILogger::ELL_ERROR, copy.srcSet, copy.srcBinding, copy.dstSet, copy.dstBinding);
+    if (!compatible)
+    {
+        if (srcDebugName && dstDebugName)
+            m_pool->m_logger.log("Incompatible copy from descriptor set (%s, %p) at binding %u to descriptor set (%s, %p) at binding %u.", system::ILogger::ELL_ERROR, srcDebugName, copy.srcSet, copy.srcBinding, dstDebugName, copy.dstSet, copy.dstBinding);
+        else
+            m_pool->m_logger.log("Incompatible copy from descriptor set (%p) at binding %u to descriptor set (%p) at binding %u.", system::ILogger::ELL_ERROR, copy.srcSet, copy.srcBinding, copy.dstSet, copy.dstBinding);
 
-            return false;
-        }
+        return false;
     }
 
     return true;
@@ -184,16 +183,18 @@ void IGPUDescriptorSet::processCopy(const IGPUDescriptorSet::SCopyDescriptorSet&
 {
     assert(copy.dstSet == this);
 
-    for (uint32_t t = 0; t < static_cast<uint32_t>(asset::IDescriptor::E_TYPE::ET_COUNT); ++t)
-    {
-        const auto type = static_cast<asset::IDescriptor::E_TYPE>(t);
+    const auto* srcBindingInfo = copy.srcSet->getLayout()->findBindingInfo(copy.srcBinding);
+    const auto* dstBindingInfo = copy.dstSet->getLayout()->findBindingInfo(copy.dstBinding);
+    assert(!srcBindingInfo == !dstBindingInfo);
 
-        auto* srcDescriptors = copy.srcSet->getDescriptors(type, copy.srcBinding);
-        auto* dstDescriptors = copy.dstSet->getDescriptors(type, copy.dstBinding);
+    if (srcBindingInfo && dstBindingInfo)
+    {
+        auto* srcDescriptors = copy.srcSet->getDescriptors(*srcBindingInfo);
+        auto* dstDescriptors = copy.dstSet->getDescriptors(*dstBindingInfo);
         assert(!(!srcDescriptors != !dstDescriptors));
 
-        auto* srcSamplers = copy.srcSet->getMutableSamplers(copy.srcBinding);
-        auto* dstSamplers = copy.dstSet->getMutableSamplers(copy.dstBinding);
+        auto* srcSamplers = copy.srcSet->getMutableSamplers(*srcBindingInfo);
+        auto* dstSamplers = copy.dstSet->getMutableSamplers(*dstBindingInfo);
         assert(!(!srcSamplers != !dstSamplers));
 
         if (srcDescriptors && dstDescriptors)
@@ -206,4 +207,4 @@ void IGPUDescriptorSet::processCopy(const IGPUDescriptorSet::SCopyDescriptorSet&
     incrementVersion();
 }
 
-}
\ No newline at end of file
+}
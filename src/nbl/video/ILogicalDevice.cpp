@@ -402,6 +402,9 @@ bool ILogicalDevice::updateDescriptorSets(const std::span<const IGPUDescriptorSe
     core::vector<asset::IDescriptor::E_TYPE> writeTypes(descriptorWrites.size());
     auto outCategory = writeTypes.data();
     params.pWriteTypes = outCategory;
+    // resolved once during validation and reused when processing
+    core::vector<const IGPUDescriptorSetLayout::SBindingInfo*> writeBindings(descriptorWrites.size());
+    auto outBinding = writeBindings.data();
     for (const auto& write : descriptorWrites)
     {
         auto* ds = write.dstSet;
@@ -409,7 +412,9 @@ bool ILogicalDevice::updateDescriptorSets(const std::span<const IGPUDescriptorSe
             return false;
 
         const auto writeCount = write.count;
-        switch (asset::IDescriptor::GetTypeCategory(*outCategory=ds->validateWrite(write)))
+        *outBinding = ds->validateWrite(write);
+        *outCategory = *outBinding ? (*outBinding)->type:asset::IDescriptor::E_TYPE::ET_COUNT;
+        switch (asset::IDescriptor::GetTypeCategory(*outCategory))
         {
             case asset::IDescriptor::EC_BUFFER:
                 params.bufferCount += writeCount;
@@ -428,6 +433,7 @@ bool ILogicalDevice::updateDescriptorSets(const std::span<const IGPUDescriptorSe
                 return false;
         }
         outCategory++;
+        outBinding++;
     }
 
     for (const auto& copy : descriptorCopies)
@@ -446,7 +452,7 @@ bool ILogicalDevice::updateDescriptorSets(const std::span<const IGPUDescriptorSe
     for (auto i=0; i<descriptorWrites.size(); i++)
     {
         const auto& write = descriptorWrites[i];
-        write.dstSet->processWrite(write,params.pWriteTypes[i]);
+        write.dstSet->processWrite(write,*writeBindings[i]);
     }
     for (const auto& copy : descriptorCopies)
         copy.dstSet->processCopy(copy);
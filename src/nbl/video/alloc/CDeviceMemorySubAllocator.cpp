@@ -0,0 +1,287 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/video/alloc/CDeviceMemorySubAllocator.h"
+
+using namespace nbl;
+using namespace nbl::video;
+
+
+CDeviceMemorySubAllocator::SBlock::SBlock(core::smart_refctd_ptr<IDeviceMemoryAllocation>&& _memory, const uint32_t _pool, const size_t maxAlignment, const size_t minAllocationSize)
+	: memory(std::move(_memory)),
+	reserved(_NBL_ALIGNED_MALLOC(address_allocator_t::reserved_size(maxAlignment,memory->getAllocationSize(),minAllocationSize),_NBL_SIMD_ALIGNMENT)),
+	allocator(reserved,0ull,0ull,maxAlignment,memory->getAllocationSize(),minAllocationSize), pool(_pool)
+{
+}
+
+CDeviceMemorySubAllocator::SBlock::~SBlock()
+{
+	_NBL_ALIGNED_FREE(reserved);
+}
+
+
+core::smart_refctd_ptr<CDeviceMemorySubAllocator> CDeviceMemorySubAllocator::create(core::smart_refctd_ptr<ILogicalDevice>&& device, const SCreationParams& params)
+{
+	if (!device)
+		return nullptr;
+	if (!core::isPoT(params.minAllocationSize) || !core::isPoT(params.maxAlignment) || params.blockSize<params.minAllocationSize)
+		return nullptr;
+	if (!(params.heapBudgetFraction>0.f) || !(params.dedicatedBlockFraction>0.f))
+		return nullptr;
+	return core::smart_refctd_ptr<CDeviceMemorySubAllocator>(new CDeviceMemorySubAllocator(std::move(device),params),core::dont_grab);
+}
+
+CDeviceMemorySubAllocator::CDeviceMemorySubAllocator(core::smart_refctd_ptr<ILogicalDevice>&& device, const SCreationParams& params)
+	: m_device(std::move(device)), m_params(params)
+{
+	const auto& memoryProps = m_device->getPhysicalDevice()->getMemoryProperties();
+	for (uint32_t i=0u; i<memoryProps.memoryHeapCount; i++)
+		m_heaps[i].budget = static_cast<size_t>(double(memoryProps.memoryHeaps[i].size)*core::min(m_params.heapBudgetFraction,1.f));
+}
+
+CDeviceMemorySubAllocator::~CDeviceMemorySubAllocator()
+{
+	// resources still bound to the blocks keep their memory alive
+	m_blockLookup.clear();
+	for (auto& pool : m_pools)
+		pool.clear();
+}
+
+
+size_t CDeviceMemorySubAllocator::getBlockSize(const uint32_t heapIndex) const
+{
+	const size_t heapSize = m_device->getPhysicalDevice()->getMemoryProperties().memoryHeaps[heapIndex].size;
+	const size_t blockSize = core::min(m_params.blockSize,heapSize/8ull);
+	return core::max(core::roundUp(blockSize,m_params.minAllocationSize),m_params.minAllocationSize);
+}
+
+bool CDeviceMemorySubAllocator::exceedsLimits(const uint32_t heapIndex, const size_t bytes) const
+{
+	// other users of the device make allocations too, leave them some headroom
+	const uint32_t maxAllocationCount = m_device->getPhysicalDeviceLimits().maxMemoryAllocationCount;
+	if (m_allocationCount>=maxAllocationCount-maxAllocationCount/8u)
+		return true;
+	return m_heaps[heapIndex].getUsage()+bytes>m_heaps[heapIndex].budget;
+}
+
+bool CDeviceMemorySubAllocator::bind(IDeviceMemoryBacked* resource, IDeviceMemoryAllocation* memory, const size_t offset) const
+{
+	switch (resource->getObjectType())
+	{
+		case IDeviceMemoryBacked::EOT_BUFFER:
+		{
+			const ILogicalDevice::SBindBufferMemoryInfo info = {.buffer=static_cast<IGPUBuffer*>(resource),.binding={.memory=memory,.offset=offset}};
+			return m_device->bindBufferMemory(1u,&info);
+		}
+		case IDeviceMemoryBacked::EOT_IMAGE:
+		{
+			const ILogicalDevice::SBindImageMemoryInfo info = {.image=static_cast<IGPUImage*>(resource),.binding={.memory=memory,.offset=offset}};
+			return m_device->bindImageMemory({&info,1u});
+		}
+		default:
+			break;
+	}
+	return false;
+}
+
+void CDeviceMemorySubAllocator::releaseEmptyBlocks(const uint32_t pool)
+{
+	auto& blocks = m_pools[pool];
+	uint32_t keptEmpty = 0u;
+	auto newEnd = std::remove_if(blocks.begin(),blocks.end(),[&](const std::unique_ptr<SBlock>& block) -> bool
+	{
+		if (block->subAllocationCount)
+			return false;
+		if (keptEmpty<m_params.maxEmptyBlocksPerPool)
+		{
+			keptEmpty++;
+			// nothing is allocated, so the whole block can become one free range again
+			block->allocator.reset();
+			return false;
+		}
+		auto& heap = m_heaps[m_device->getPhysicalDevice()->getMemoryProperties().memoryTypes[getPoolMemoryType(pool)].heapIndex];
+		heap.blockBytes -= block->memory->getAllocationSize();
+		heap.blockCount--;
+		m_allocationCount--;
+		m_blockLookup.erase(block->memory.get());
+		return true;
+	});
+	blocks.erase(newEnd,blocks.end());
+}
+
+
+auto CDeviceMemorySubAllocator::allocate(const SAllocateInfo& info) -> SAllocation
+{
+	const auto& memoryProps = m_device->getPhysicalDevice()->getMemoryProperties();
+	if (info.size==0ull || info.memoryTypeIndex>=memoryProps.memoryTypeCount)
+		return {};
+	const uint32_t heapIndex = memoryProps.memoryTypes[info.memoryTypeIndex].heapIndex;
+	const size_t blockSize = getBlockSize(heapIndex);
+
+	size_t alignment = 0x1ull<<info.alignmentLog2;
+	bool optimalTiling = false;
+	bool requiresDedicated = false;
+	bool dedicate = double(info.size)>double(blockSize)*m_params.dedicatedBlockFraction;
+	if (info.dedication)
+	{
+		const auto& reqs = info.dedication->getMemoryReqs();
+		alignment = core::max<size_t>(alignment,0x1ull<<reqs.alignmentLog2);
+		requiresDedicated = reqs.requiresDedicatedAllocation;
+		dedicate = dedicate || requiresDedicated || (reqs.prefersDedicatedAllocation && info.size>=m_params.preferredDedicatedMinSize);
+		if (info.dedication->getObjectType()==IDeviceMemoryBacked::EOT_IMAGE)
+			optimalTiling = static_cast<const IGPUImage*>(info.dedication)->getTiling()==IGPUImage::TILING::OPTIMAL;
+	}
+	const size_t bytes = core::roundUp<size_t>(info.size,m_params.minAllocationSize);
+	const bool canSubAllocate = !requiresDedicated && alignment<=m_params.maxAlignment && bytes<=blockSize;
+	dedicate = dedicate || !canSubAllocate;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto& heap = m_heaps[heapIndex];
+	if (dedicate)
+	{
+		if (!exceedsLimits(heapIndex,info.size))
+		{
+			auto allocation = m_device->allocate(info);
+			if (allocation.isValid())
+			{
+				heap.dedicatedBytes += allocation.memory->getAllocationSize();
+				heap.dedicatedCount++;
+				m_allocationCount++;
+				m_dedicated[allocation.memory.get()] = {.memory=allocation.memory,.heapIndex=heapIndex};
+				return allocation;
+			}
+		}
+		// out of budget or allocations, but a resource which only prefers a dedicated allocation can still squeeze into a block
+		if (!canSubAllocate)
+			return {};
+	}
+
+	const bool deviceAddress = core::bitflag<IDeviceMemoryAllocation::E_MEMORY_ALLOCATE_FLAGS>(static_cast<IDeviceMemoryAllocation::E_MEMORY_ALLOCATE_FLAGS>(info.flags)).hasFlags(IDeviceMemoryAllocation::EMAF_DEVICE_ADDRESS_BIT);
+	const uint32_t pool = getPoolIndex(info.memoryTypeIndex,deviceAddress,optimalTiling && m_device->getPhysicalDeviceLimits().bufferImageGranularity>1u);
+	auto subAllocate = [&](SBlock* block) -> SAllocation
+	{
+		const size_t offset = block->allocator.alloc_addr(bytes,alignment);
+		if (offset==address_allocator_t::invalid_address)
+			return {};
+		if (info.dedication && !bind(info.dedication,block->memory.get(),offset))
+		{
+			block->allocator.free_addr(offset,bytes);
+			return {};
+		}
+		block->subAllocationCount++;
+		heap.subAllocatedBytes += bytes;
+		heap.subAllocationCount++;
+		return {.memory=block->memory,.offset=offset};
+	};
+
+	// newest blocks are the emptiest, try them first
+	auto& blocks = m_pools[pool];
+	for (auto it=blocks.rbegin(); it!=blocks.rend(); it++)
+	{
+		if ((*it)->allocator.get_free_size()<bytes)
+			continue;
+		auto allocation = subAllocate(it->get());
+		if (allocation.isValid())
+			return allocation;
+	}
+
+	if (exceedsLimits(heapIndex,blockSize))
+		return {};
+	SAllocateInfo blockInfo = {};
+	blockInfo.size = blockSize;
+	blockInfo.flags = info.flags;
+	blockInfo.memoryTypeIndex = info.memoryTypeIndex;
+	auto blockAllocation = m_device->allocate(blockInfo);
+	if (!blockAllocation.isValid())
+		return {};
+	if (blockAllocation.memory->isMappable())
+	{
+		const auto propertyFlags = blockAllocation.memory->getMemoryPropertyFlags();
+		core::bitflag<IDeviceMemoryAllocation::E_MAPPING_CPU_ACCESS_FLAGS> access = IDeviceMemoryAllocation::EMCAF_NO_MAPPING_ACCESS;
+		if (propertyFlags.hasFlags(IDeviceMemoryAllocation::EMPF_HOST_READABLE_BIT))
+			access |= IDeviceMemoryAllocation::EMCAF_READ;
+		if (propertyFlags.hasFlags(IDeviceMemoryAllocation::EMPF_HOST_WRITABLE_BIT))
+			access |= IDeviceMemoryAllocation::EMCAF_WRITE;
+		blockAllocation.memory->map({0ull,blockSize},access);
+	}
+	heap.blockBytes += blockSize;
+	heap.blockCount++;
+	m_allocationCount++;
+	auto* const block = blocks.emplace_back(std::make_unique<SBlock>(std::move(blockAllocation.memory),pool,m_params.maxAlignment,m_params.minAllocationSize)).get();
+	m_blockLookup.insert({block->memory.get(),block});
+
+	auto allocation = subAllocate(block);
+	// only a failed bind can get us here, the block stays for the next request
+	return allocation;
+}
+
+void CDeviceMemorySubAllocator::deallocate(const SAllocation& allocation, const size_t size)
+{
+	if (!allocation.isValid())
+		return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (auto found=m_dedicated.find(allocation.memory.get()); found!=m_dedicated.end())
+	{
+		auto& heap = m_heaps[found->second.heapIndex];
+		heap.dedicatedBytes -= found->second.memory->getAllocationSize();
+		heap.dedicatedCount--;
+		m_allocationCount--;
+		m_dedicated.erase(found);
+		return;
+	}
+
+	auto found = m_blockLookup.find(allocation.memory.get());
+	if (found==m_blockLookup.end())
+	{
+		assert(false); // memory didn't come from this sub-allocator
+		return;
+	}
+	SBlock* const block = found->second;
+	const size_t bytes = core::roundUp<size_t>(size,m_params.minAllocationSize);
+	block->allocator.free_addr(allocation.offset,bytes);
+	block->subAllocationCount--;
+	auto& heap = m_heaps[m_device->getPhysicalDevice()->getMemoryProperties().memoryTypes[getPoolMemoryType(block->pool)].heapIndex];
+	heap.subAllocatedBytes -= bytes;
+	heap.subAllocationCount--;
+	if (block->subAllocationCount==0u)
+		releaseEmptyBlocks(block->pool);
+}
+
+void CDeviceMemorySubAllocator::coalesce()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (uint32_t pool=0u; pool<MaxPools; pool++)
+	{
+		for (auto& block : m_pools[pool])
+			block->allocator.defragment();
+		releaseEmptyBlocks(pool);
+	}
+}
+
+
+auto CDeviceMemorySubAllocator::getHeapStatistics(const uint32_t heapIndex) const -> SHeapStatistics
+{
+	if (heapIndex>=VK_MAX_MEMORY_HEAPS)
+		return {};
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps[heapIndex];
+}
+
+auto CDeviceMemorySubAllocator::getFragmentationStatistics(const uint32_t memoryTypeIndex) const -> SFragmentationStatistics
+{
+	SFragmentationStatistics retval = {};
+	if (memoryTypeIndex>=VK_MAX_MEMORY_TYPES)
+		return retval;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (uint32_t variant=0u; variant<4u; variant++)
+	for (const auto& block : m_pools[getPoolIndex(memoryTypeIndex,variant&0x2u,variant&0x1u)])
+	{
+		const size_t largest = block->allocator.max_size();
+		retval.freeBytes += block->allocator.get_free_size();
+		retval.largestFreeRanges += largest;
+		retval.largestFreeRange = core::max(retval.largestFreeRange,largest);
+	}
+	return retval;
+}
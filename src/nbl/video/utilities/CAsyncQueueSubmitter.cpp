@@ -0,0 +1,234 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/video/utilities/CAsyncQueueSubmitter.h"
+
+#include "nbl/video/IGPUCommandBuffer.h"
+
+using namespace nbl;
+using namespace nbl::video;
+
+
+core::smart_refctd_ptr<CAsyncQueueSubmitter> CAsyncQueueSubmitter::create(CThreadSafeQueueAdapter* queue, const SCreationParams& params)
+{
+	if (!queue || params.maxSubmitsPerBatch==0u)
+		return nullptr;
+	return core::smart_refctd_ptr<CAsyncQueueSubmitter>(new CAsyncQueueSubmitter(queue,params),core::dont_grab);
+}
+
+CAsyncQueueSubmitter::CAsyncQueueSubmitter(CThreadSafeQueueAdapter* queue, const SCreationParams& params)
+	: m_queue(queue), m_params(params), m_thread(&CAsyncQueueSubmitter::thread,this)
+{
+}
+
+CAsyncQueueSubmitter::~CAsyncQueueSubmitter()
+{
+	// everything pushed before the marker still gets submitted
+	auto* request = new SRequest();
+	request->quit = true;
+	push(request);
+	m_thread.join();
+}
+
+
+std::future<CAsyncQueueSubmitter::SSubmitResult> CAsyncQueueSubmitter::submit(const std::span<const IQueue::SSubmitInfo> submits)
+{
+	if (submits.empty())
+	{
+		std::promise<SSubmitResult> failed;
+		failed.set_value({.result=IQueue::RESULT::OTHER_ERROR});
+		return failed.get_future();
+	}
+
+	auto* request = new SRequest();
+	request->enqueueTime = std::chrono::steady_clock::now();
+	{
+		size_t semaphoreCount = 0ull, commandBufferCount = 0ull;
+		for (const auto& info : submits)
+		{
+			semaphoreCount += info.waitSemaphores.size()+info.signalSemaphores.size();
+			commandBufferCount += info.commandBuffers.size();
+		}
+		// reserving up front keeps the spans into the copies valid
+		request->infos.reserve(submits.size());
+		request->semaphores.reserve(semaphoreCount);
+		request->commandBuffers.reserve(commandBufferCount);
+		request->keepAlive.reserve(semaphoreCount+commandBufferCount);
+	}
+	auto copySemaphores = [request](const std::span<const IQueue::SSubmitInfo::SSemaphoreInfo> semaphores) -> std::span<const IQueue::SSubmitInfo::SSemaphoreInfo>
+	{
+		const auto* const first = request->semaphores.data()+request->semaphores.size();
+		for (const auto& semaphore : semaphores)
+		{
+			request->semaphores.push_back(semaphore);
+			request->keepAlive.emplace_back(semaphore.semaphore);
+		}
+		return {first,semaphores.size()};
+	};
+	for (const auto& info : submits)
+	{
+		auto& copy = request->infos.emplace_back();
+		copy.waitSemaphores = copySemaphores(info.waitSemaphores);
+		const auto* const firstCommandBuffer = request->commandBuffers.data()+request->commandBuffers.size();
+		for (const auto& commandBuffer : info.commandBuffers)
+		{
+			request->commandBuffers.push_back(commandBuffer);
+			request->keepAlive.emplace_back(commandBuffer.cmdbuf);
+		}
+		copy.commandBuffers = {firstCommandBuffer,info.commandBuffers.size()};
+		copy.signalSemaphores = copySemaphores(info.signalSemaphores);
+	}
+
+	auto future = request->promise.get_future();
+	push(request);
+	return future;
+}
+
+void CAsyncQueueSubmitter::flush()
+{
+	auto* request = new SRequest();
+	auto future = request->promise.get_future();
+	push(request);
+	future.wait();
+}
+
+void CAsyncQueueSubmitter::resetStatistics()
+{
+	// the submit thread is the only writer, so it has to be the one that clears the counters too
+	auto* request = new SRequest();
+	request->resetStatistics = true;
+	auto future = request->promise.get_future();
+	push(request);
+	future.wait();
+}
+
+IQueue::RESULT CAsyncQueueSubmitter::waitIdle()
+{
+	flush();
+	return m_queue->waitIdle();
+}
+
+
+auto CAsyncQueueSubmitter::getStatistics() const -> SStatistics
+{
+	SStatistics retval;
+	retval.submitCount = m_statistics.submitCount.load(std::memory_order_relaxed);
+	retval.failedSubmitCount = m_statistics.failedSubmitCount.load(std::memory_order_relaxed);
+	retval.submitInfoCount = m_statistics.submitInfoCount.load(std::memory_order_relaxed);
+	retval.batchCount = m_statistics.batchCount.load(std::memory_order_relaxed);
+	retval.maxBatchSize = m_statistics.maxBatchSize.load(std::memory_order_relaxed);
+	retval.totalLatency = std::chrono::nanoseconds(m_statistics.totalLatency.load(std::memory_order_relaxed));
+	retval.maxLatency = std::chrono::nanoseconds(m_statistics.maxLatency.load(std::memory_order_relaxed));
+	return retval;
+}
+
+
+void CAsyncQueueSubmitter::push(SRequest* request)
+{
+	// Treiber stack push, the submit thread takes the whole stack at once so there's no ABA to worry about
+	SRequest* head = m_pending.load(std::memory_order_relaxed);
+	do
+	{
+		request->next = head;
+	} while (!m_pending.compare_exchange_weak(head,request,std::memory_order_release,std::memory_order_relaxed));
+	m_pending.notify_one();
+}
+
+void CAsyncQueueSubmitter::thread()
+{
+	core::vector<SRequest*> requests;
+	for (bool quit=false; !quit; )
+	{
+		m_pending.wait(nullptr,std::memory_order_acquire);
+		requests.clear();
+		for (SRequest* request=m_pending.exchange(nullptr,std::memory_order_acquire); request; request=request->next)
+			requests.push_back(request);
+		// the stack is newest first
+		std::reverse(requests.begin(),requests.end());
+
+		// markers split the batches, so that they only get signalled after everything before them has been submitted
+		auto batchBegin = requests.begin();
+		for (auto it=requests.begin(); it!=requests.end(); it++)
+		{
+			SRequest* const marker = *it;
+			if (!marker->infos.empty())
+				continue;
+			submitBatch({batchBegin,it});
+			batchBegin = it+1;
+			if (marker->resetStatistics)
+			{
+				m_statistics.submitCount.store(0ull,std::memory_order_relaxed);
+				m_statistics.failedSubmitCount.store(0ull,std::memory_order_relaxed);
+				m_statistics.submitInfoCount.store(0ull,std::memory_order_relaxed);
+				m_statistics.batchCount.store(0ull,std::memory_order_relaxed);
+				m_statistics.maxBatchSize.store(0u,std::memory_order_relaxed);
+				m_statistics.totalLatency.store(0ll,std::memory_order_relaxed);
+				m_statistics.maxLatency.store(0ll,std::memory_order_relaxed);
+			}
+			quit = quit || marker->quit;
+			marker->promise.set_value({.result=IQueue::RESULT::SUCCESS});
+			delete marker;
+		}
+		submitBatch({batchBegin,requests.end()});
+	}
+}
+
+void CAsyncQueueSubmitter::submitBatch(std::span<SRequest* const> requests)
+{
+	auto finish = [this](SRequest* request, const IQueue::RESULT result) -> void
+	{
+		const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-request->enqueueTime);
+		m_statistics.submitCount.fetch_add(1ull,std::memory_order_relaxed);
+		if (result!=IQueue::RESULT::SUCCESS)
+			m_statistics.failedSubmitCount.fetch_add(1ull,std::memory_order_relaxed);
+		m_statistics.totalLatency.fetch_add(latency.count(),std::memory_order_relaxed);
+		// only this thread writes the statistics, so no CAS loop needed
+		if (latency.count()>m_statistics.maxLatency.load(std::memory_order_relaxed))
+			m_statistics.maxLatency.store(latency.count(),std::memory_order_relaxed);
+		// the queue holds onto the semaphores and command buffers now
+		request->promise.set_value({.result=result,.latency=latency});
+		delete request;
+	};
+	auto queueSubmit = [this](const std::span<const IQueue::SSubmitInfo> infos) -> IQueue::RESULT
+	{
+		m_statistics.batchCount.fetch_add(1ull,std::memory_order_relaxed);
+		m_statistics.submitInfoCount.fetch_add(infos.size(),std::memory_order_relaxed);
+		if (infos.size()>m_statistics.maxBatchSize.load(std::memory_order_relaxed))
+			m_statistics.maxBatchSize.store(static_cast<uint32_t>(infos.size()),std::memory_order_relaxed);
+		return m_queue->submit(infos);
+	};
+
+	core::vector<IQueue::SSubmitInfo> infos;
+	for (auto begin=requests.begin(); begin!=requests.end(); )
+	{
+		// a request with more infos than the batch limit still goes out whole
+		infos.clear();
+		auto end = begin;
+		do
+		{
+			infos.insert(infos.end(),(*end)->infos.begin(),(*end)->infos.end());
+			end++;
+		} while (end!=requests.end() && infos.size()+(*end)->infos.size()<=m_params.maxSubmitsPerBatch);
+
+		// `IQueue::submit` validates everything before it marks the command buffers pending and calls the driver
+		const IGPUCommandBuffer* probe = nullptr;
+		for (const auto& info : infos)
+		for (const auto& commandBuffer : info.commandBuffers)
+		if (!probe && commandBuffer.cmdbuf && commandBuffer.cmdbuf->getState()==IGPUCommandBuffer::STATE::EXECUTABLE)
+			probe = commandBuffer.cmdbuf;
+		const auto result = queueSubmit(infos);
+		// so if the probe didn't turn pending, validation failed and nothing got submitted, retry the submits in isolation
+		const bool failedValidation = result==IQueue::RESULT::OTHER_ERROR && !(probe && probe->getState()==IGPUCommandBuffer::STATE::PENDING);
+		if (failedValidation && std::distance(begin,end)>1)
+		{
+			for (auto it=begin; it!=end; it++)
+				finish(*it,queueSubmit((*it)->infos));
+		}
+		else
+		{
+			for (auto it=begin; it!=end; it++)
+				finish(*it,result);
+		}
+		begin = end;
+	}
+}